@@ -3,6 +3,9 @@
 
 #include <stdint.h>
 
+struct dvm_array;
+struct dvm_string;
+
 typedef struct
 {
 	union
@@ -10,6 +13,10 @@ typedef struct
 		int32_t i;
 		float f;
 		uint32_t u;
+		int64_t l;
+		double d;
+		struct dvm_array *a;
+		struct dvm_string *s;
 	};
 } dvm_var;
 
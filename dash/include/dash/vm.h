@@ -8,12 +8,103 @@
 
 struct dvm_context;
 struct dvm_procedure;
+struct dvm_execution;
+struct dvm_pump;
+
+enum dvm_type
+{
+	dvm_type_real,
+	dvm_type_integer,
+	dvm_type_real_array,
+	dvm_type_integer_array,
+	dvm_type_long,
+	dvm_type_double,
+	dvm_type_string,
+};
+
+// Native functions read their parameters from and write their results to the
+// calling frame's registers in place.
+typedef void (*dvm_native_function)(const dvm_var *in_registers, dvm_var *out_registers);
+
+struct dvm_cache_stats
+{
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t stores;
+	uint32_t evictions;
+};
+
+// Filled in by every dvm_exec_proc, for the procedure it ran and everything that procedure called.
+// Wall time is only measured when it's enabled.
+
+struct dvm_exec_stats
+{
+	uint64_t instructions;
+	uint32_t calls;
+	uint32_t native_calls;
+	uint32_t max_depth;
+	double	 wall_time;
+};
+
+// Filled in by every import while they're enabled, times are wall time in seconds.
+// The parser pulls tokens as it goes, so parse_time doesn't include lex_time, and codegen_time includes growth_time.
+// Growth is the time spent moving the context's bytecode, procedures and globals into bigger arrays.
+
+struct dvm_import_stats
+{
+	double	 lex_time;
+	double	 parse_time;
+	double	 codegen_time;
+	double	 growth_time;
+	double	 total_time;
+	uint32_t tokens;
+	uint32_t ast_nodes;
+	uint32_t bytecode_words;
+	uint32_t procedures;
+	uint32_t growths;
+	uint32_t cache_hit;
+	size_t	 arena_bytes;
+};
+
+// A trace records where every jump, call, return and yield an execution takes lands, as a pc from the start of the
+// procedure, along with the opcode that got there. The start of an execution is recorded as reached by a nop.
+
+struct dvm_trace_record
+{
+	uint32_t proc_index;
+	uint32_t pc : 24;
+	uint32_t opcode : 8;
+};
 
 int dvm_create_context(struct dvm_context **context, size_t initial_function_capacity, size_t initial_bytecode_capacity);
 void dvm_destroy_context(struct dvm_context *context);
 
+// Natives have to be registered before importing, calls can only reach the first 256 procedures in a context.
+int dvm_register_native(const char *name, dvm_native_function function, const enum dvm_type *in_types, size_t in_count, const enum dvm_type *out_types, size_t out_count, struct dvm_context *context);
+
+// Arrays the host creates are owned by the context, and are released along with it unless destroyed earlier.
+// So are arrays a script makes and hands back from the procedure an execution entered, the rest of a script's
+// arrays are released once no global or execution that can still run refers to them.
+struct dvm_array *dvm_create_array(enum dvm_type element_type, size_t length, struct dvm_context *context);
+void dvm_destroy_array(struct dvm_array *array, struct dvm_context *context);
+void *dvm_array_data(struct dvm_array *array);
+size_t dvm_array_length(struct dvm_array *array);
+
+// Strings are immutable and interned by the context, equal strings are the same pointer until it's destroyed.
+struct dvm_string *dvm_intern_string(const char *text, size_t length, struct dvm_context *context);
+const char *dvm_string_text(struct dvm_string *string);
+size_t dvm_string_length(struct dvm_string *string);
+uint32_t dvm_string_hash(struct dvm_string *string);
+
 int dvm_import_module(const char *module_filename, struct dvm_context *context);
 int dvm_import_source(FILE *source_file, struct dvm_context *context);
+int dvm_import_source_text(const char *source, size_t length, struct dvm_context *context);
+
+void dvm_enable_import_stats(int enabled, struct dvm_context *context);
+void dvm_get_import_stats(struct dvm_import_stats *stats, struct dvm_context *context);
+
+int dvm_enable_cache(const char *directory, size_t max_entries, size_t max_bytes, struct dvm_context *context);
+void dvm_get_cache_stats(struct dvm_cache_stats *stats, struct dvm_context *context);
 
 struct dvm_procedure *dvm_find_proc(const char *name, size_t in_registers, size_t out_registers, struct dvm_context *context);
 
@@ -21,4 +112,68 @@ void dvm_dissasm_module(FILE *out, struct dvm_context *context);
 void dvm_dissasm_proc(struct dvm_procedure *function, FILE *out, struct dvm_context *context);
 int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *in_registers, dvm_var *out_registers, struct dvm_context *context);
 
+void dvm_enable_exec_timing(int enabled, struct dvm_context *context);
+void dvm_get_exec_stats(struct dvm_exec_stats *stats, struct dvm_context *context);
+
+// Traces are kept in a ring of capacity records (rounded up to a power of two), zero turns tracing off.
+// Getting a trace copies out the latest records it still has, oldest first, and returns how many there were.
+// A trace's records can be decoded into hit counts for each basic block, listed alongside the disassembly.
+
+int dvm_enable_exec_trace(size_t capacity, struct dvm_context *context);
+size_t dvm_get_exec_trace(struct dvm_trace_record *records, size_t max_records, struct dvm_context *context);
+void dvm_dissasm_trace(const struct dvm_trace_record *records, size_t count, FILE *out, struct dvm_context *context);
+
+// A profile counts which way each if went and how often each call was made, by procedure name and place in it.
+// While it's recorded every import numbers its sites, traces of what ran are added in and it can be saved.
+// A loaded profile guides the imports after it, the arm of an if that ran more falls through, hot calls to
+// procedures that only return an expression are inlined and loops in procedures that never ran aren't unrolled.
+
+int dvm_enable_profile_recording(int enabled, struct dvm_context *context);
+int dvm_profile_trace(const struct dvm_trace_record *records, size_t count, struct dvm_context *context);
+int dvm_save_profile(const char *filename, struct dvm_context *context);
+int dvm_load_profile(const char *filename, struct dvm_context *context);
+
+// Names script procedures for system profilers like perf. Every script procedure is entered through a small native
+// trampoline of its own and interpreted from there, so with call graphs the samples are under the procedure running
+// and its callers. A slice resumes from the trampoline of the procedure it stopped in, the callers from before are lost.
+// The trampolines are listed in /tmp/perf-<pid>.map, or described in /tmp/jit-<pid>.dump for perf inject.
+// It's only supported on x86-64 linux, and should be enabled before importing so the procedures' names are known.
+
+enum dvm_perf_mode
+{
+	dvm_perf_map = 1,
+	dvm_perf_jitdump = 2,
+};
+
+int dvm_enable_perf(int modes, struct dvm_context *context);
+
+// An execution can also be run in slices, each given a budget of fuel in instructions (zero for no limit).
+// When the budget runs out it's suspended at the next backward jump or call and resumes from there,
+// a yield statement suspends it the same way whatever fuel is left.
+
+enum dvm_exec_status
+{
+	dvm_exec_status_error = 0,
+	dvm_exec_status_done,
+	dvm_exec_status_budget_exhausted,
+	dvm_exec_status_yielded,
+};
+
+struct dvm_execution *dvm_create_execution(struct dvm_procedure *function, const dvm_var *in_registers, struct dvm_context *context);
+enum dvm_exec_status dvm_resume_execution(struct dvm_execution *execution, uint64_t fuel, dvm_var *out_registers);
+void dvm_get_execution_stats(struct dvm_exec_stats *stats, struct dvm_execution *execution);
+size_t dvm_get_execution_trace(struct dvm_trace_record *records, size_t max_records, struct dvm_execution *execution);
+void dvm_destroy_execution(struct dvm_execution *execution);
+
+// A pump time-slices many executions on one thread, running each for a slice of fuel in turn.
+// Executions that yield or end are taken out and handed to the callback, a yielded one runs again once it's added back.
+// The host owns the executions, destroying the pump doesn't destroy them.
+
+typedef void (*dvm_pump_callback)(struct dvm_execution *execution, enum dvm_exec_status status, const dvm_var *out_registers, void *user_data);
+
+struct dvm_pump *dvm_create_pump(uint64_t fuel_per_slice, dvm_pump_callback callback);
+void dvm_destroy_pump(struct dvm_pump *pump);
+int dvm_pump_add(struct dvm_execution *execution, void *user_data, struct dvm_pump *pump);
+size_t dvm_pump_run(size_t max_slices, struct dvm_pump *pump);
+
 #endif
\ No newline at end of file
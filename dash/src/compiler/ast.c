@@ -32,7 +32,7 @@ dst_statement *dst_create_statement_assignment(dst_id_list *variables, dst_exp_l
 
 	return statement;
 }
-dst_statement *dst_create_statement_call(char *function, dst_exp_list *parameters, dsc_memory *mem)
+dst_statement *dst_create_statement_call(dsc_atom *function, dst_exp_list *parameters, uint32_t site, dsc_memory *mem)
 {
 	if (function == NULL)
 		return NULL;
@@ -45,6 +45,7 @@ dst_statement *dst_create_statement_call(char *function, dst_exp_list *parameter
 	statement->type = dst_statement_type_call;
 	statement->call.function = function;
 	statement->call.parameters = parameters;
+	statement->call.site = site;
 
 	return statement;
 }
@@ -60,7 +61,7 @@ dst_statement *dst_create_statement_block(dst_statement_list *statements, dsc_me
 
 	return statement;
 }
-dst_statement *dst_create_statement_if(dst_exp *condition, dst_statement *true_statement, dst_statement *false_statement, dsc_memory *mem)
+dst_statement *dst_create_statement_if(dst_exp *condition, dst_statement *true_statement, dst_statement *false_statement, uint32_t site, dsc_memory *mem)
 {
 	if (condition == NULL || true_statement == NULL)
 		return NULL;
@@ -74,6 +75,7 @@ dst_statement *dst_create_statement_if(dst_exp *condition, dst_statement *true_s
 	statement->if_else.condition = condition;
 	statement->if_else.true_statement = true_statement;
 	statement->if_else.false_statement = false_statement;
+	statement->if_else.site = site;
 
 	return statement;
 }
@@ -93,6 +95,24 @@ dst_statement *dst_create_statement_while(dst_exp *condition, dst_statement *loo
 
 	return statement;
 }
+dst_statement *dst_create_statement_for(dsc_atom *variable, dst_exp *low, dst_exp *high, dst_statement *loop_statement, dsc_memory *mem)
+{
+	if (variable == NULL || low == NULL || high == NULL || loop_statement == NULL)
+		return NULL;
+
+	dst_statement *statement = (dst_statement *)dsc_alloc(sizeof(dst_statement), mem);
+
+	if (statement == NULL)
+		return NULL;
+
+	statement->type = dst_statement_type_for;
+	statement->for_loop.variable = variable;
+	statement->for_loop.low = low;
+	statement->for_loop.high = high;
+	statement->for_loop.loop_statement = loop_statement;
+
+	return statement;
+}
 dst_statement *dst_create_statement_return(dst_exp_list *values, dsc_memory *mem)
 {
 	dst_statement *statement = (dst_statement *)dsc_alloc(sizeof(dst_statement), mem);
@@ -105,8 +125,70 @@ dst_statement *dst_create_statement_return(dst_exp_list *values, dsc_memory *mem
 
 	return statement;
 }
+dst_statement *dst_create_statement_yield(dsc_memory *mem)
+{
+	dst_statement *statement = (dst_statement *)dsc_alloc(sizeof(dst_statement), mem);
+
+	if (statement == NULL)
+		return NULL;
+
+	statement->type = dst_statement_type_yield;
+
+	return statement;
+}
+dst_statement *dst_create_statement_store(dsc_atom *array, dst_exp *index, dst_exp *value, dsc_memory *mem)
+{
+	if (index == NULL || value == NULL)
+		return NULL;
+
+	dst_statement *statement = (dst_statement *)dsc_alloc(sizeof(dst_statement), mem);
+
+	if (statement == NULL)
+		return NULL;
+
+	statement->type = dst_statement_type_store;
+	statement->store.array = array;
+	statement->store.index = index;
+	statement->store.value = value;
+
+	return statement;
+}
+dst_statement *dst_create_statement_field_store(dsc_atom *variable, dst_id_list *fields, dst_exp *value, dsc_memory *mem)
+{
+	if (fields == NULL || value == NULL)
+		return NULL;
+
+	dst_statement *statement = (dst_statement *)dsc_alloc(sizeof(dst_statement), mem);
+
+	if (statement == NULL)
+		return NULL;
+
+	statement->type = dst_statement_type_field_store;
+	statement->field_store.variable = variable;
+	statement->field_store.fields = fields;
+	statement->field_store.value = value;
+
+	return statement;
+}
 
-dst_exp *dst_create_exp_var(char *value, dsc_memory *mem)
+dst_statement *dst_create_statement_switch(dst_exp *value, dst_switch_case_list *cases, dsc_memory *mem)
+{
+	if (value == NULL)
+		return NULL;
+
+	dst_statement *statement = (dst_statement *)dsc_alloc(sizeof(dst_statement), mem);
+
+	if (statement == NULL)
+		return NULL;
+
+	statement->type = dst_statement_type_switch;
+	statement->switch_case.value = value;
+	statement->switch_case.cases = cases;
+
+	return statement;
+}
+
+dst_exp *dst_create_exp_var(dsc_atom *value, dsc_memory *mem)
 {
 	dst_exp *exp = (dst_exp *)dsc_alloc(sizeof(dst_exp), mem);
 
@@ -145,6 +227,45 @@ dst_exp *dst_create_exp_real(float value, dsc_memory *mem)
 
 	return exp;
 }
+dst_exp *dst_create_exp_long(int64_t value, dsc_memory *mem)
+{
+	dst_exp *exp = (dst_exp *)dsc_alloc(sizeof(dst_exp), mem);
+
+	if (exp == NULL)
+		return NULL;
+
+	exp->type = dst_exp_type_long;
+	exp->long_integer.value = value;
+	exp->temp_count_est = 1;
+
+	return exp;
+}
+dst_exp *dst_create_exp_double(double value, dsc_memory *mem)
+{
+	dst_exp *exp = (dst_exp *)dsc_alloc(sizeof(dst_exp), mem);
+
+	if (exp == NULL)
+		return NULL;
+
+	exp->type = dst_exp_type_double;
+	exp->double_real.value = value;
+	exp->temp_count_est = 1;
+
+	return exp;
+}
+dst_exp *dst_create_exp_string(dsc_atom *value, dsc_memory *mem)
+{
+	dst_exp *exp = (dst_exp *)dsc_alloc(sizeof(dst_exp), mem);
+
+	if (exp == NULL)
+		return NULL;
+
+	exp->type = dst_exp_type_string;
+	exp->string.value = value;
+	exp->temp_count_est = 1;
+
+	return exp;
+}
 dst_exp *dst_create_exp_cast(dst_type dest_type, dst_exp *value, dsc_memory *mem)
 {
 	if (value == NULL)
@@ -171,6 +292,12 @@ dst_exp *dst_create_exp_binary(dst_exp_type type, dst_exp *left, dst_exp *right,
 		type != dst_exp_type_subtraction &&
 		type != dst_exp_type_multiplication &&
 		type != dst_exp_type_division &&
+		type != dst_exp_type_modulo &&
+		type != dst_exp_type_shift_left &&
+		type != dst_exp_type_shift_right &&
+		type != dst_exp_type_bit_and &&
+		type != dst_exp_type_bit_or &&
+		type != dst_exp_type_bit_xor &&
 		type != dst_exp_type_and &&
 		type != dst_exp_type_or &&
 		type != dst_exp_type_eq &&
@@ -216,7 +343,7 @@ dst_exp *dst_create_exp_unary(dst_exp_type type, dst_exp *value, dsc_memory *mem
 
 	return exp;
 }
-dst_exp *dst_create_exp_call(char *function, dst_exp_list *parameters, dsc_memory *mem)
+dst_exp *dst_create_exp_call(dsc_atom *function, dst_exp_list *parameters, uint32_t site, dsc_memory *mem)
 {
 	dst_exp *exp = (dst_exp *)dsc_alloc(sizeof(dst_exp), mem);
 
@@ -226,12 +353,66 @@ dst_exp *dst_create_exp_call(char *function, dst_exp_list *parameters, dsc_memor
 	exp->type = dst_exp_type_call;
 	exp->call.function = function;
 	exp->call.parameters = parameters;
+	exp->call.site = site;
 	exp->temp_count_est = max(dst_exp_list_count(parameters), 1);
 
 	return exp;
 }
 
-dst_proc_param	*dst_create_proc_param(char *id, dst_type type, dsc_memory *mem)
+dst_exp *dst_create_exp_array(dst_type element_type, dst_exp *length, dsc_memory *mem)
+{
+	if (length == NULL)
+		return NULL;
+
+	dst_exp *exp = (dst_exp *)dsc_alloc(sizeof(dst_exp), mem);
+
+	if (exp == NULL)
+		return NULL;
+
+	exp->type = dst_exp_type_array;
+	exp->array.element_type = element_type;
+	exp->array.length = length;
+	exp->temp_count_est = max(length->temp_count_est, 1);
+
+	return exp;
+}
+dst_exp *dst_create_exp_index(dst_exp *array, dst_exp *index, dsc_memory *mem)
+{
+	if (array == NULL || index == NULL)
+		return NULL;
+
+	dst_exp *exp = (dst_exp *)dsc_alloc(sizeof(dst_exp), mem);
+
+	if (exp == NULL)
+		return NULL;
+
+	exp->type = dst_exp_type_index;
+	exp->index.array = array;
+	exp->index.index = index;
+	exp->temp_count_est = max(array->temp_count_est, index->temp_count_est) +
+		((array->temp_count_est == index->temp_count_est) ? 1 : 0);
+
+	return exp;
+}
+dst_exp *dst_create_exp_field(dst_exp *value, dsc_atom *field, dsc_memory *mem)
+{
+	if (value == NULL)
+		return NULL;
+
+	dst_exp *exp = (dst_exp *)dsc_alloc(sizeof(dst_exp), mem);
+
+	if (exp == NULL)
+		return NULL;
+
+	exp->type = dst_exp_type_field;
+	exp->field.value = value;
+	exp->field.field = field;
+	exp->temp_count_est = value->temp_count_est;
+
+	return exp;
+}
+
+dst_proc_param	*dst_create_proc_param(dsc_atom *id, dst_type type, dsc_memory *mem)
 {
 	dst_proc_param *func_param = (dst_proc_param *)dsc_alloc(sizeof(dst_proc_param), mem);
 
@@ -243,7 +424,7 @@ dst_proc_param	*dst_create_proc_param(char *id, dst_type type, dsc_memory *mem)
 
 	return func_param;
 }
-dst_proc *dst_create_proc(char *id, dst_proc_param_list *in_params, dst_type_list *out_types, dst_statement *code, dsc_memory *mem)
+dst_proc *dst_create_proc(dsc_atom *id, dst_proc_param_list *in_params, dst_type_list *out_types, dst_statement *code, uint32_t first_site, dsc_memory *mem)
 {
 	dst_proc *func = (dst_proc *)dsc_alloc(sizeof(dst_proc), mem);
 
@@ -254,9 +435,39 @@ dst_proc *dst_create_proc(char *id, dst_proc_param_list *in_params, dst_type_lis
 	func->in_params = in_params;
 	func->out_types = out_types;
 	func->statement = code;
+	func->first_site = first_site;
 
 	return func;
 }
+dst_switch_case *dst_create_switch_case(dst_exp_list *labels, dst_statement *statement, dsc_memory *mem)
+{
+	if (statement == NULL)
+		return NULL;
+
+	dst_switch_case *value = (dst_switch_case *)dsc_alloc(sizeof(dst_switch_case), mem);
+
+	if (value == NULL)
+		return NULL;
+
+	value->labels = labels;
+	value->statement = statement;
+
+	return value;
+}
+dst_global *dst_create_global(dsc_atom *id, dst_type type, dst_exp *value, int is_const, dsc_memory *mem)
+{
+	dst_global *global = (dst_global *)dsc_alloc(sizeof(dst_global), mem);
+
+	if (global == NULL)
+		return NULL;
+
+	global->id = id;
+	global->type = type;
+	global->value = value;
+	global->is_const = is_const;
+
+	return global;
+}
 
 dst_type_list		*dst_append_type_list(dst_type_list *list, dst_type value, dsc_memory *mem)
 {
@@ -288,7 +499,7 @@ dst_type_list		*dst_append_type_list(dst_type_list *list, dst_type value, dsc_me
 
 	return list;
 }
-dst_id_list			*dst_append_id_list(dst_id_list *list, char *value, dsc_memory *mem)
+dst_id_list			*dst_append_id_list(dst_id_list *list, dsc_atom *value, dsc_memory *mem)
 {
 	if (list == NULL)
 	{
@@ -438,6 +649,66 @@ dst_proc_list		*dst_append_func_list(dst_proc_list *list, dst_proc *value, dsc_m
 
 	return list;
 }
+dst_switch_case_list	*dst_append_switch_case_list(dst_switch_case_list *list, dst_switch_case *value, dsc_memory *mem)
+{
+	if (list == NULL)
+	{
+		list = (dst_switch_case_list *)dsc_alloc(sizeof(dst_switch_case_list), mem);
+
+		if (list == NULL)
+			return NULL;
+
+		list->next = list;
+		list->prev = list;
+		list->value = value;
+	}
+	else
+	{
+		dst_switch_case_list *next = (dst_switch_case_list *)dsc_alloc(sizeof(dst_switch_case_list), mem);
+
+		if (next == NULL)
+			return NULL;
+
+		next->value = value;
+		next->next = list;
+		next->prev = list->prev;
+
+		list->prev->next = next;
+		list->prev = next;
+	}
+
+	return list;
+}
+dst_global_list		*dst_append_global_list(dst_global_list *list, dst_global *value, dsc_memory *mem)
+{
+	if (list == NULL)
+	{
+		list = (dst_global_list *)dsc_alloc(sizeof(dst_global_list), mem);
+
+		if (list == NULL)
+			return NULL;
+
+		list->next = list;
+		list->prev = list;
+		list->value = value;
+	}
+	else
+	{
+		dst_global_list *next = (dst_global_list *)dsc_alloc(sizeof(dst_global_list), mem);
+
+		if (next == NULL)
+			return NULL;
+
+		next->value = value;
+		next->next = list;
+		next->prev = list->prev;
+
+		list->prev->next = next;
+		list->prev = next;
+	}
+
+	return list;
+}
 
 size_t dst_exp_list_count(dst_exp_list *list)
 {
@@ -496,4 +767,156 @@ int dst_type_list_is_real(dst_type_list *list)
 int dst_type_list_is_composite(dst_type_list *list)
 {
 	return list->next != list;
-}
\ No newline at end of file
+}
+int dst_type_list_is_array(dst_type_list *list)
+{
+	return (list->value == dst_type_real_array || list->value == dst_type_integer_array) && (list->next == list);
+}
+
+dst_type dst_type_array_of(dst_type element_type)
+{
+	return element_type == dst_type_integer ? dst_type_integer_array : dst_type_real_array;
+}
+dst_type dst_type_element_of(dst_type array_type)
+{
+	return array_type == dst_type_integer_array ? dst_type_integer : dst_type_real;
+}
+dst_type_list *dst_type_sentinel(dst_type type)
+{
+	switch (type)
+	{
+	case dst_type_integer:
+		return &dst_sentinel_type_integer;
+	case dst_type_real_array:
+		return &dst_sentinel_type_real_array;
+	case dst_type_integer_array:
+		return &dst_sentinel_type_integer_array;
+	case dst_type_long:
+		return &dst_sentinel_type_long;
+	case dst_type_double:
+		return &dst_sentinel_type_double;
+	case dst_type_string:
+		return &dst_sentinel_type_string;
+	default:
+		return &dst_sentinel_type_real;
+	}
+}
+
+dst_struct *dst_create_struct(dsc_atom *id, dst_proc_param_list *fields, dst_struct_table *table, dsc_memory *mem)
+{
+	if (fields == NULL)
+		return NULL;
+
+	dst_struct *value = (dst_struct *)dsc_alloc(sizeof(dst_struct), mem);
+
+	if (value == NULL)
+		return NULL;
+
+	if (table->count == table->capacity)
+	{
+		size_t new_capacity = table->capacity == 0 ? 4 : table->capacity * 2;
+
+		dst_struct **new_structs = (dst_struct **)dsc_alloc(sizeof(dst_struct *) * new_capacity, mem);
+
+		if (new_structs == NULL)
+			return NULL;
+
+		if (table->count > 0)
+			memcpy(new_structs, table->structs, sizeof(dst_struct *) * table->count);
+
+		table->capacity = new_capacity;
+		table->structs = new_structs;
+	}
+
+	// Fields are laid out in declaration order, nested structs are flattened into the window
+
+	size_t size = 0;
+	dst_proc_param_list *current = fields;
+
+	do
+	{
+		size += dst_type_size(current->value->type, table);
+		current = current->next;
+
+	} while (current != fields);
+
+	value->id = id;
+	value->fields = fields;
+	value->type = (dst_type)(dst_type_struct + table->count);
+	value->size = size;
+	value->sentinel.value = value->type;
+	value->sentinel.prev = &value->sentinel;
+	value->sentinel.next = &value->sentinel;
+
+	table->structs[table->count++] = value;
+
+	return value;
+}
+dst_struct *dst_find_struct(dsc_atom *id, dst_struct_table *table)
+{
+	if (table == NULL)
+		return NULL;
+
+	for (size_t i = 0; i < table->count; ++i)
+	{
+		if (table->structs[i]->id == id)
+			return table->structs[i];
+	}
+
+	return NULL;
+}
+dst_struct *dst_struct_of(dst_type type, dst_struct_table *table)
+{
+	if (!dst_type_is_struct(type) || table == NULL || (size_t)(type - dst_type_struct) >= table->count)
+		return NULL;
+
+	return table->structs[type - dst_type_struct];
+}
+dst_proc_param *dst_struct_field(dst_struct *value, dsc_atom *field, size_t *offset, dst_struct_table *table)
+{
+	size_t field_offset = 0;
+	dst_proc_param_list *current = value->fields;
+
+	do
+	{
+		if (current->value->id == field)
+		{
+			*offset = field_offset;
+			return current->value;
+		}
+
+		field_offset += dst_type_size(current->value->type, table);
+		current = current->next;
+
+	} while (current != value->fields);
+
+	return NULL;
+}
+
+int dst_type_is_struct(dst_type type)
+{
+	return type >= dst_type_struct;
+}
+size_t dst_type_size(dst_type type, dst_struct_table *table)
+{
+	dst_struct *value = dst_struct_of(type, table);
+
+	return value == NULL ? 1 : value->size;
+}
+size_t dst_type_list_size(dst_type_list *list, dst_struct_table *table)
+{
+	if (list == NULL)
+		return 0;
+
+	dst_type_list *current = list;
+
+	size_t size = 0;
+	do
+	{
+		size += dst_type_size(current->value, table);
+		current = current->next;
+
+	} while (current != list);
+
+	return size;
+}
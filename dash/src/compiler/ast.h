@@ -3,11 +3,20 @@
 
 #include <stdint.h>
 #include "memory.h"
+#include "intern.h"
 
 enum dst_type
 {
 	dst_type_real = 0,
 	dst_type_integer = 1,
+	dst_type_real_array = 2,
+	dst_type_integer_array = 3,
+	dst_type_long = 4,
+	dst_type_double = 5,
+	dst_type_string = 6,
+
+	// Structs are numbered from here in order of declaration
+	dst_type_struct = 16,
 };
 
 enum dst_statement_type
@@ -20,8 +29,15 @@ enum dst_statement_type
 	dst_statement_type_block,
 	dst_statement_type_if,
 	dst_statement_type_while,
+	dst_statement_type_for,
 
 	dst_statement_type_return,
+	dst_statement_type_yield,
+
+	dst_statement_type_store,
+	dst_statement_type_field_store,
+
+	dst_statement_type_switch,
 };
 struct dst_statement
 {
@@ -41,8 +57,9 @@ struct dst_statement
 
 	struct
 	{
-		char				*function;
+		dsc_atom			*function;
 		struct dst_exp_list *parameters;
+		uint32_t			 site;
 	} call;
 
 	struct
@@ -55,6 +72,7 @@ struct dst_statement
 		struct dst_exp		*condition;
 		struct dst_statement *true_statement;
 		struct dst_statement *false_statement;
+		uint32_t			 site;
 	} if_else;
 
 	struct
@@ -63,16 +81,47 @@ struct dst_statement
 		struct dst_statement *loop_statement;
 	} while_loop;
 
+	struct
+	{
+		dsc_atom			*variable;
+		struct dst_exp		*low;
+		struct dst_exp		*high;
+		struct dst_statement *loop_statement;
+	} for_loop;
+
 	struct
 	{
 		struct dst_exp_list		*values;
 	} ret;
+
+	struct
+	{
+		dsc_atom		*array;
+		struct dst_exp	*index;
+		struct dst_exp	*value;
+	} store;
+
+	struct
+	{
+		dsc_atom			*variable;
+		struct dst_id_list	*fields;
+		struct dst_exp		*value;
+	} field_store;
+
+	struct
+	{
+		struct dst_exp				*value;
+		struct dst_switch_case_list	*cases;
+	} switch_case;
 };
 enum dst_exp_type
 {
 	dst_exp_type_variable,
 	dst_exp_type_integer,
 	dst_exp_type_real,
+	dst_exp_type_long,
+	dst_exp_type_double,
+	dst_exp_type_string,
 
 	dst_exp_type_cast,
 
@@ -80,6 +129,13 @@ enum dst_exp_type
 	dst_exp_type_subtraction,
 	dst_exp_type_multiplication,
 	dst_exp_type_division,
+	dst_exp_type_modulo,
+
+	dst_exp_type_shift_left,
+	dst_exp_type_shift_right,
+	dst_exp_type_bit_and,
+	dst_exp_type_bit_or,
+	dst_exp_type_bit_xor,
 
 	dst_exp_type_and,
 	dst_exp_type_or,
@@ -92,6 +148,10 @@ enum dst_exp_type
 	dst_exp_type_greater_eq,
 
 	dst_exp_type_call,
+
+	dst_exp_type_array,
+	dst_exp_type_index,
+	dst_exp_type_field,
 };
 struct dst_exp
 {
@@ -101,7 +161,7 @@ struct dst_exp
 	{
 		struct
 		{
-			char *id;
+			dsc_atom *id;
 		} variable;
 
 		struct
@@ -114,6 +174,21 @@ struct dst_exp
 			float value;
 		} real;
 
+		struct
+		{
+			int64_t value;
+		} long_integer;
+
+		struct
+		{
+			double value;
+		} double_real;
+
+		struct
+		{
+			dsc_atom *value;
+		} string;
+
 		struct
 		{
 			enum dst_type	dest_type;
@@ -133,24 +208,59 @@ struct dst_exp
 
 		struct
 		{
-			char				*function;
+			dsc_atom			*function;
 			struct dst_exp_list *parameters;
+			uint32_t			 site;
 		} call;
+
+		struct
+		{
+			enum dst_type	element_type;
+			struct dst_exp *length;
+		} array;
+
+		struct
+		{
+			struct dst_exp *array;
+			struct dst_exp *index;
+		} index;
+
+		struct
+		{
+			struct dst_exp	*value;
+			dsc_atom		*field;
+		} field;
 	};
 
 	size_t temp_count_est;
 };
 struct dst_proc_param
 {
-	char			*id;
+	dsc_atom		*id;
 	enum dst_type	 type;
 };
 struct dst_proc
 {
-	char							*id;
+	dsc_atom						*id;
 	struct dst_proc_param_list		*in_params;
 	struct dst_type_list			*out_types;
 	struct dst_statement			*statement;
+
+	// Every if and call is a profile site, numbered in the order they're parsed. The procedure's own
+	// start from first_site, so a site's place in its procedure doesn't depend on the rest of the module.
+	uint32_t						 first_site;
+};
+struct dst_switch_case
+{
+	struct dst_exp_list		*labels;	// NULL for the default case
+	struct dst_statement	*statement;
+};
+struct dst_global
+{
+	dsc_atom			*id;
+	enum dst_type		 type;		// the declared type, when there's no initial value
+	struct dst_exp		*value;
+	int					 is_const;
 };
 typedef enum dst_type				dst_type;
 typedef enum dst_statement_type		dst_statement_type;
@@ -159,6 +269,8 @@ typedef struct dst_statement		dst_statement;
 typedef struct dst_exp				dst_exp;
 typedef struct dst_proc_param		dst_proc_param;
 typedef struct dst_proc				dst_proc;
+typedef struct dst_switch_case		dst_switch_case;
+typedef struct dst_global			dst_global;
 
 /* Lists */
 
@@ -171,7 +283,7 @@ struct dst_type_list
 };
 struct dst_id_list
 {
-	char		*value;
+	dsc_atom	*value;
 
 	struct dst_id_list *prev;
 	struct dst_id_list *next;
@@ -205,43 +317,101 @@ struct dst_proc_list
 	struct dst_proc_list *next;
 };
 
+struct dst_switch_case_list
+{
+	dst_switch_case *value;
+
+	struct dst_switch_case_list *prev;
+	struct dst_switch_case_list *next;
+};
+
+struct dst_global_list
+{
+	dst_global *value;
+
+	struct dst_global_list *prev;
+	struct dst_global_list *next;
+};
+
 typedef struct dst_type_list		dst_type_list;
 typedef struct dst_id_list			dst_id_list;
 typedef struct dst_statement_list	dst_statement_list;
 typedef struct dst_exp_list			dst_exp_list;
 typedef struct dst_proc_list		dst_proc_list;
 typedef struct dst_proc_param_list	dst_proc_param_list;
+typedef struct dst_switch_case_list	dst_switch_case_list;
+typedef struct dst_global_list		dst_global_list;
+
+/* Structs */
+
+struct dst_struct
+{
+	dsc_atom			*id;
+	dst_proc_param_list	*fields;
+	dst_type			 type;
+	size_t				 size;
+
+	dst_type_list		 sentinel;
+};
+struct dst_struct_table
+{
+	size_t				 count;
+	size_t				 capacity;
+	struct dst_struct	**structs;
+};
+typedef struct dst_struct			dst_struct;
+typedef struct dst_struct_table		dst_struct_table;
 
 static dst_type_list dst_sentinel_type_real = { dst_type_real, &dst_sentinel_type_real, &dst_sentinel_type_real };
 static dst_type_list dst_sentinel_type_integer = { dst_type_integer, &dst_sentinel_type_integer, &dst_sentinel_type_integer };
+static dst_type_list dst_sentinel_type_real_array = { dst_type_real_array, &dst_sentinel_type_real_array, &dst_sentinel_type_real_array };
+static dst_type_list dst_sentinel_type_integer_array = { dst_type_integer_array, &dst_sentinel_type_integer_array, &dst_sentinel_type_integer_array };
+static dst_type_list dst_sentinel_type_long = { dst_type_long, &dst_sentinel_type_long, &dst_sentinel_type_long };
+static dst_type_list dst_sentinel_type_double = { dst_type_double, &dst_sentinel_type_double, &dst_sentinel_type_double };
+static dst_type_list dst_sentinel_type_string = { dst_type_string, &dst_sentinel_type_string, &dst_sentinel_type_string };
 
 /* Constructors, Destructors, Accessors */
 
 dst_statement *dst_create_statement_definition(dst_id_list *variables, dst_exp_list *assignments, dsc_memory *mem);
 dst_statement *dst_create_statement_assignment(dst_id_list *variables, dst_exp_list *assignments, dsc_memory *mem);
-dst_statement *dst_create_statement_call(char *function, dst_exp_list *parameters, dsc_memory *mem);
+dst_statement *dst_create_statement_call(dsc_atom *function, dst_exp_list *parameters, uint32_t site, dsc_memory *mem);
 dst_statement *dst_create_statement_block(dst_statement_list *statements, dsc_memory *mem);
-dst_statement *dst_create_statement_if(dst_exp *condition, dst_statement *true_statement, dst_statement *false_statement, dsc_memory *mem);
+dst_statement *dst_create_statement_if(dst_exp *condition, dst_statement *true_statement, dst_statement *false_statement, uint32_t site, dsc_memory *mem);
 dst_statement *dst_create_statement_while(dst_exp *condition, dst_statement *loop_statement, dsc_memory *mem);
+dst_statement *dst_create_statement_for(dsc_atom *variable, dst_exp *low, dst_exp *high, dst_statement *loop_statement, dsc_memory *mem);
 dst_statement *dst_create_statement_return(dst_exp_list *value, dsc_memory *mem);
+dst_statement *dst_create_statement_yield(dsc_memory *mem);
+dst_statement *dst_create_statement_store(dsc_atom *array, dst_exp *index, dst_exp *value, dsc_memory *mem);
+dst_statement *dst_create_statement_field_store(dsc_atom *variable, dst_id_list *fields, dst_exp *value, dsc_memory *mem);
+dst_statement *dst_create_statement_switch(dst_exp *value, dst_switch_case_list *cases, dsc_memory *mem);
 
-dst_exp *dst_create_exp_var(char *value, dsc_memory *mem);
+dst_exp *dst_create_exp_var(dsc_atom *value, dsc_memory *mem);
 dst_exp *dst_create_exp_int(int value, dsc_memory *mem);
 dst_exp *dst_create_exp_real(float value, dsc_memory *mem);
+dst_exp *dst_create_exp_long(int64_t value, dsc_memory *mem);
+dst_exp *dst_create_exp_double(double value, dsc_memory *mem);
+dst_exp *dst_create_exp_string(dsc_atom *value, dsc_memory *mem);
 dst_exp *dst_create_exp_cast(dst_type dest_type, dst_exp *value, dsc_memory *mem);
 dst_exp *dst_create_exp_binary(dst_exp_type type, dst_exp *left, dst_exp *right, dsc_memory *mem);
 dst_exp *dst_create_exp_unary(dst_exp_type type, dst_exp *value, dsc_memory *mem);
-dst_exp *dst_create_exp_call(char *function, dst_exp_list *parameters, dsc_memory *mem);
+dst_exp *dst_create_exp_call(dsc_atom *function, dst_exp_list *parameters, uint32_t site, dsc_memory *mem);
+dst_exp *dst_create_exp_array(dst_type element_type, dst_exp *length, dsc_memory *mem);
+dst_exp *dst_create_exp_index(dst_exp *array, dst_exp *index, dsc_memory *mem);
+dst_exp *dst_create_exp_field(dst_exp *value, dsc_atom *field, dsc_memory *mem);
 
-dst_proc_param	*dst_create_proc_param(char *id, dst_type type, dsc_memory *mem);
-dst_proc		*dst_create_proc(char *id, dst_proc_param_list *in_params, dst_type_list *out_types, dst_statement *statement, dsc_memory *mem);
+dst_proc_param	*dst_create_proc_param(dsc_atom *id, dst_type type, dsc_memory *mem);
+dst_proc		*dst_create_proc(dsc_atom *id, dst_proc_param_list *in_params, dst_type_list *out_types, dst_statement *statement, uint32_t first_site, dsc_memory *mem);
+dst_switch_case	*dst_create_switch_case(dst_exp_list *labels, dst_statement *statement, dsc_memory *mem);
+dst_global		*dst_create_global(dsc_atom *id, dst_type type, dst_exp *value, int is_const, dsc_memory *mem);
 
 dst_type_list		*dst_append_type_list(dst_type_list *list, dst_type value, dsc_memory *mem);
-dst_id_list			*dst_append_id_list(dst_id_list *list, char *value, dsc_memory *mem);
+dst_id_list			*dst_append_id_list(dst_id_list *list, dsc_atom *value, dsc_memory *mem);
 dst_statement_list	*dst_append_statement_list(dst_statement_list *list, dst_statement *value, dsc_memory *mem);
 dst_exp_list		*dst_append_exp_list(dst_exp_list *list, dst_exp *value, dsc_memory *mem);
 dst_proc_param_list	*dst_append_func_param_list(dst_proc_param_list *list, dst_proc_param *value, dsc_memory *mem);
 dst_proc_list		*dst_append_func_list(dst_proc_list *list, dst_proc *value, dsc_memory *mem);
+dst_switch_case_list	*dst_append_switch_case_list(dst_switch_case_list *list, dst_switch_case *value, dsc_memory *mem);
+dst_global_list		*dst_append_global_list(dst_global_list *list, dst_global *value, dsc_memory *mem);
 
 size_t dst_exp_list_count(dst_exp_list *list);
 size_t dst_type_list_count(dst_type_list *list);
@@ -250,5 +420,20 @@ size_t dst_proc_param_list_count(dst_proc_param_list *list);
 int dst_type_list_is_integer(dst_type_list *list);
 int dst_type_list_is_real(dst_type_list *list);
 int dst_type_list_is_composite(dst_type_list *list);
+int dst_type_list_is_array(dst_type_list *list);
+
+dst_type		 dst_type_array_of(dst_type element_type);
+dst_type		 dst_type_element_of(dst_type array_type);
+dst_type_list	*dst_type_sentinel(dst_type type);
+
+// Structs occupy a window of consecutive registers, one per scalar or array field
+dst_struct		*dst_create_struct(dsc_atom *id, dst_proc_param_list *fields, dst_struct_table *table, dsc_memory *mem);
+dst_struct		*dst_find_struct(dsc_atom *id, dst_struct_table *table);
+dst_struct		*dst_struct_of(dst_type type, dst_struct_table *table);
+dst_proc_param	*dst_struct_field(dst_struct *value, dsc_atom *field, size_t *offset, dst_struct_table *table);
+
+int				 dst_type_is_struct(dst_type type);
+size_t			 dst_type_size(dst_type type, dst_struct_table *table);
+size_t			 dst_type_list_size(dst_type_list *list, dst_struct_table *table);
 
 #endif
\ No newline at end of file
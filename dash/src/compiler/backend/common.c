@@ -1,38 +1,114 @@
 #include "common.h"
 
-dcg_proc_decl_list *dcg_append_proc_decl_list(dcg_proc_decl_list *list, dcg_proc_decl *value, dsc_memory *mem)
+dcg_proc_decl_table *dcg_create_proc_decl_table(size_t initial_bucket_count, dsc_memory *mem)
 {
-	if (list == NULL)
+	dcg_proc_decl_table *table = (dcg_proc_decl_table *)dsc_alloc(sizeof(dcg_proc_decl_table), mem);
+
+	if (table == NULL)
+	{
+		return NULL;
+	}
+
+	size_t bucket_count = 16;
+	while (bucket_count < initial_bucket_count)
+		bucket_count *= 2;
+
+	table->count = 0;
+	table->bucket_count = bucket_count;
+	table->buckets = (dcg_proc_decl **)dsc_alloc(sizeof(dcg_proc_decl *) * bucket_count, mem);
+	table->structs = NULL;
+	table->global_count = 0;
+	table->globals = NULL;
+	table->vm = NULL;
+	table->intrinsics = NULL;
+	table->proc = NULL;
+	table->proc_hash = 0;
+	table->mem = mem;
+
+	if (table->buckets == NULL)
 	{
-		list = (dcg_proc_decl_list *)dsc_alloc(sizeof(dcg_proc_decl_list), mem);
+		return NULL;
+	}
+
+	memset(table->buckets, 0, sizeof(dcg_proc_decl *) * bucket_count);
+
+	return table;
+}
+
+int dcg_proc_decl_table_grow(dcg_proc_decl_table *table)
+{
+	size_t new_bucket_count = table->bucket_count * 2;
 
-		if (list == NULL)
-			return NULL;
+	dcg_proc_decl **new_buckets = (dcg_proc_decl **)dsc_alloc(sizeof(dcg_proc_decl *) * new_bucket_count, table->mem);
 
-		list->next = list;
-		list->prev = list;
-		list->value = value;
+	if (new_buckets == NULL)
+	{
+		return 0;
 	}
-	else
+
+	memset(new_buckets, 0, sizeof(dcg_proc_decl *) * new_bucket_count);
+
+	// Rehash every chain, appending to the tail keeps the order of declarations
+
+	for (size_t i = 0; i < table->bucket_count; ++i)
 	{
-		dcg_proc_decl_list *next = (dcg_proc_decl_list *)dsc_alloc(sizeof(dcg_proc_decl_list), mem);
+		dcg_proc_decl *current = table->buckets[i];
 
-		if (next == NULL)
-			return NULL;
+		while (current != NULL)
+		{
+			dcg_proc_decl *next = current->next_in_bucket;
+			dcg_proc_decl **tail = &new_buckets[current->id->hash & (new_bucket_count - 1)];
+
+			while (*tail != NULL)
+				tail = &(*tail)->next_in_bucket;
 
-		next->value = value;
-		next->next = list;
-		next->prev = list->prev;
+			current->next_in_bucket = NULL;
+			*tail = current;
 
-		list->prev->next = next;
-		list->prev = next;
+			current = next;
+		}
 	}
 
-	return list;
+	table->bucket_count = new_bucket_count;
+	table->buckets = new_buckets;
+
+	return 1;
 }
 
-dcg_proc_decl *dcg_create_proc_decl(const char *id, dst_proc_param_list *in_params, dst_type_list *out_types, size_t index, dsc_memory *mem)
+int dcg_proc_decl_table_insert(dcg_proc_decl *value, dcg_proc_decl_table *table)
 {
+	if (value == NULL)
+	{
+		return 0;
+	}
+
+	if (table->count >= table->bucket_count && !dcg_proc_decl_table_grow(table))
+	{
+		return 0;
+	}
+
+	// Declarations go on the tail of their chain, so the first declaration of a name is the one found
+
+	dcg_proc_decl **tail = &table->buckets[value->id->hash & (table->bucket_count - 1)];
+
+	while (*tail != NULL)
+		tail = &(*tail)->next_in_bucket;
+
+	value->next_in_bucket = NULL;
+	*tail = value;
+
+	++table->count;
+
+	return 1;
+}
+
+dcg_proc_decl *dcg_create_proc_decl(dsc_atom *id, dst_proc_param_list *in_params, dst_type_list *out_types, size_t index, dsc_memory *mem)
+{
+	if (id == NULL)
+	{
+		return NULL;
+	}
+
 	dcg_proc_decl *value = (dcg_proc_decl *)dsc_alloc(sizeof(dcg_proc_decl), mem);
 
 	if (value == NULL)
@@ -44,32 +120,119 @@ dcg_proc_decl *dcg_create_proc_decl(const char *id, dst_proc_param_list *in_para
 	value->index = index;
 	value->in_params = in_params;
 	value->out_types = out_types;
+	value->proc = NULL;
+	value->next_in_bucket = NULL;
 
 	return value;
 }
 
-dcg_proc_decl *dcg_proc_decl_list_find(const char *id, dcg_proc_decl_list *list)
+dcg_proc_decl *dcg_proc_decl_table_find(dsc_atom *id, dcg_proc_decl_table *table)
 {
-	dcg_proc_decl_list *current = list;
-
-	if (current == NULL)
+	if (table == NULL)
 	{
 		return NULL;
 	}
 
-	do
+	dcg_proc_decl *current = table->buckets[id->hash & (table->bucket_count - 1)];
+
+	while (current != NULL)
 	{
-		if (strcmp(current->value->id, id) == 0)
+		if (current->id == id)
 		{
-			return current->value;
+			return current;
 		}
 
-		current = current->next;
-	} while (current != list);
+		current = current->next_in_bucket;
+	}
 
 	return NULL;
 }
 
+size_t dcg_type_size(dst_type type, dcg_proc_decl_table *module)
+{
+	return dst_type_size(type, module->structs);
+}
+size_t dcg_type_list_size(dst_type_list *list, dcg_proc_decl_table *module)
+{
+	return dst_type_list_size(list, module->structs);
+}
+size_t dcg_proc_in_size(dst_proc_param_list *params, dcg_proc_decl_table *module)
+{
+	if (params == NULL)
+		return 0;
+
+	dst_proc_param_list *current = params;
+
+	size_t size = 0;
+	do
+	{
+		size += dcg_type_size(current->value->type, module);
+		current = current->next;
+
+	} while (current != params);
+
+	return size;
+}
+dst_type_list *dcg_type_sentinel(dst_type type, dcg_proc_decl_table *module)
+{
+	dst_struct *value = dst_struct_of(type, module->structs);
+
+	return value == NULL ? dst_type_sentinel(type) : &value->sentinel;
+}
+
+int dcg_intern_intrinsics(dsc_intern_table *atoms, dcg_proc_decl_table *module)
+{
+	static const char *names[dcg_intrinsic_count] =
+	{
+		NULL,
+		"length",
+		"string_hash",
+		"sqrt",
+		"sin",
+		"cos",
+		"tan",
+		"pow",
+		"abs",
+		"min",
+		"max",
+		"floor",
+		"fma",
+		"select",
+	};
+
+	module->intrinsics = (dsc_atom **)dsc_alloc(sizeof(dsc_atom *) * dcg_intrinsic_count, module->mem);
+
+	if (module->intrinsics == NULL)
+	{
+		return 0;
+	}
+
+	module->intrinsics[dcg_intrinsic_none] = NULL;
+
+	for (int i = dcg_intrinsic_none + 1; i < dcg_intrinsic_count; ++i)
+	{
+		if ((module->intrinsics[i] = dsc_intern_str(names[i], atoms)) == NULL)
+			return 0;
+	}
+
+	return 1;
+}
+dcg_intrinsic dcg_find_intrinsic(dsc_atom *id, dcg_proc_decl_table *module)
+{
+	if (module->intrinsics == NULL)
+	{
+		return dcg_intrinsic_none;
+	}
+
+	for (int i = dcg_intrinsic_none + 1; i < dcg_intrinsic_count; ++i)
+	{
+		if (module->intrinsics[i] == id)
+			return (dcg_intrinsic)i;
+	}
+
+	return dcg_intrinsic_none;
+}
+
 int	dcg_start_proc_emit(
 	size_t initial_var_capacity,
 	dcg_register_allocator *reg_alloc,
@@ -84,12 +247,18 @@ int	dcg_start_proc_emit(
 	reg_alloc->named_vars_capacity = initial_var_capacity == 0 ? 4 : initial_var_capacity;
 	reg_alloc->named_vars = (dcg_var_binding *)dsc_alloc(sizeof(dcg_var_binding) * reg_alloc->named_vars_capacity, mem);
 
+	reg_alloc->scope = 0;
+	reg_alloc->bucket_count = 16;
+	reg_alloc->buckets = (size_t *)dsc_alloc(sizeof(size_t) * reg_alloc->bucket_count, mem);
+
 	reg_alloc->mem = mem;
 
-	if (reg_alloc->named_vars == NULL)
+	if (reg_alloc->named_vars == NULL || reg_alloc->buckets == NULL)
 	{
 		return 0;
 	}
+
+	memset(reg_alloc->buckets, 0xFF, sizeof(size_t) * reg_alloc->bucket_count);
 	
 	if (!dvm_proc_emitter_begin_create(&bc_emit->vm_emitter, vm))
 	{
@@ -100,15 +269,16 @@ int	dcg_start_proc_emit(
 }
 int dcg_finalize_proc_emit(
 	dst_proc *ast_proc,
+	dcg_proc_decl_table *module,
 	dcg_register_allocator *reg_alloc,
 	dcg_bc_emitter *bc_emit,
 	dvm_context *vm)
 {
-	size_t in_count = dst_proc_param_list_count(ast_proc->in_params);
-	size_t out_count = dst_type_list_count(ast_proc->out_types);
+	size_t in_count = dcg_proc_in_size(ast_proc->in_params, module);
+	size_t out_count = dcg_type_list_size(ast_proc->out_types, module);
 
 	dvm_procedure *result = dvm_proc_emitter_finalize(
-		ast_proc->id,
+		ast_proc->id->text,
 		(uint8_t)in_count,
 		(uint8_t)(reg_alloc->vars_max_allocated - in_count),
 		(uint8_t)out_count,
@@ -124,21 +294,88 @@ void dcg_cancel_proc_emit(
 	dvm_proc_emitter_cancel(&bc_emit->vm_emitter);
 }
 
-dcg_var_binding *dcg_map(const char *name, dcg_register_allocator *reg_alloc)
+dcg_var_binding *dcg_map(dsc_atom *name, dcg_register_allocator *reg_alloc)
 {
-	uint32_t hashed_name = dsh_hash(name);
+	// Bindings are pushed on the front of their chain, so the innermost scope is found first
 
-	for (size_t i = 0; i < reg_alloc->vars_named_count; ++i)
+	size_t current = reg_alloc->buckets[name->hash & (reg_alloc->bucket_count - 1)];
+
+	while (current != ~0)
 	{
-		if (reg_alloc->named_vars[i].hashed_name == hashed_name)
+		dcg_var_binding *binding = &reg_alloc->named_vars[current];
+
+		if (binding->name == name)
 		{
-			return &reg_alloc->named_vars[i];
+			return binding;
 		}
+
+		current = binding->next_in_bucket;
 	}
 
 	return NULL;
 }
 
+int		dcg_grow_var_buckets(dcg_register_allocator *reg_alloc)
+{
+	size_t new_bucket_count = reg_alloc->bucket_count * 2;
+
+	size_t *new_buckets = (size_t *)dsc_alloc(sizeof(size_t) * new_bucket_count, reg_alloc->mem);
+
+	if (new_buckets == NULL)
+	{
+		return 0;
+	}
+
+	memset(new_buckets, 0xFF, sizeof(size_t) * new_bucket_count);
+
+	// Relinking in register order leaves the newest (innermost) binding at the front of each chain
+
+	for (size_t i = 0; i < reg_alloc->vars_named_count; ++i)
+	{
+		if (reg_alloc->named_vars[i].name == NULL)
+			continue;
+
+		size_t bucket = reg_alloc->named_vars[i].name->hash & (new_bucket_count - 1);
+
+		reg_alloc->named_vars[i].next_in_bucket = new_buckets[bucket];
+		new_buckets[bucket] = i;
+	}
+
+	reg_alloc->bucket_count = new_bucket_count;
+	reg_alloc->buckets = new_buckets;
+
+	return 1;
+}
+void	dcg_unlink_named(size_t named_count, dcg_register_allocator *reg_alloc)
+{
+	// Named registers are popped in stack order, so each one is at the front of its chain
+
+	while (reg_alloc->vars_named_count > named_count)
+	{
+		dcg_var_binding *binding = &reg_alloc->named_vars[--reg_alloc->vars_named_count];
+
+		// The rest of a struct's window isn't linked, only its first register is named
+
+		if (binding->name == NULL)
+			continue;
+
+		reg_alloc->buckets[binding->name->hash & (reg_alloc->bucket_count - 1)] = binding->next_in_bucket;
+	}
+}
+
+void	dcg_push_scope(dcg_register_allocator *reg_alloc)
+{
+	++reg_alloc->scope;
+}
+void	dcg_pop_scope(size_t named_reg_index, dcg_register_allocator *reg_alloc)
+{
+	assert(reg_alloc->scope > 0);
+
+	dcg_pop_named_past(named_reg_index, reg_alloc);
+
+	--reg_alloc->scope;
+}
+
 size_t	dcg_push_temp(dcg_register_allocator *reg_alloc)
 {
 	if (reg_alloc->vars_named_count + reg_alloc->vars_temp_count >= 255)
@@ -151,6 +388,18 @@ size_t	dcg_push_temp(dcg_register_allocator *reg_alloc)
 
 	return result;
 }
+size_t	dcg_push_temp_window(size_t size, dcg_register_allocator *reg_alloc)
+{
+	size_t result = dcg_push_temp(reg_alloc);
+
+	for (size_t i = 1; i < size && result != ~0; ++i)
+	{
+		if (dcg_push_temp(reg_alloc) == ~0)
+			result = ~0;
+	}
+
+	return result;
+}
 void	dcg_pop_temp_to(size_t temp_reg_index, dcg_register_allocator *reg_alloc)
 {
 	assert(temp_reg_index >= reg_alloc->vars_named_count);
@@ -166,23 +415,32 @@ void	dcg_pop_temp_past(size_t temp_reg_index, dcg_register_allocator *reg_alloc)
 	reg_alloc->vars_temp_count = temp_reg_index - reg_alloc->vars_named_count;
 }
 
-size_t	dcg_push_named(const char *name, dst_type type, dcg_register_allocator *reg_alloc)
+size_t	dcg_push_named(dsc_atom *name, dst_type type, dcg_register_allocator *reg_alloc)
+{
+	return dcg_push_named_window(name, type, 1, reg_alloc);
+}
+size_t	dcg_push_named_window(dsc_atom *name, dst_type type, size_t size, dcg_register_allocator *reg_alloc)
 {
 	assert(reg_alloc->vars_temp_count == 0);
 
-	if (reg_alloc->vars_named_count >= 255)
+	if (reg_alloc->vars_named_count + size > 255)
 	{
 		return ~0;
 	}
 
-	if (dcg_map(name, reg_alloc) != NULL)
+	// Shadowing a variable from an enclosing scope is fine, redefining one in the same scope is not
+
+	dcg_var_binding *existing = dcg_map(name, reg_alloc);
+
+	if (existing != NULL && existing->scope == reg_alloc->scope)
 	{
 		return ~0;
 	}
 
-	if (reg_alloc->vars_named_count == reg_alloc->named_vars_capacity)
+	if (reg_alloc->vars_named_count + size > reg_alloc->named_vars_capacity)
 	{
-		reg_alloc->named_vars_capacity *= 2;
+		while (reg_alloc->vars_named_count + size > reg_alloc->named_vars_capacity)
+			reg_alloc->named_vars_capacity *= 2;
 
 		dcg_var_binding *new_stack = (dcg_var_binding *)dsc_alloc(sizeof(dcg_var_binding) * reg_alloc->named_vars_capacity, reg_alloc->mem);
 
@@ -196,25 +454,57 @@ size_t	dcg_push_named(const char *name, dst_type type, dcg_register_allocator *r
 		reg_alloc->named_vars = new_stack;
 	}
 	
-	reg_alloc->named_vars[reg_alloc->vars_named_count].hashed_name = dsh_hash(name);
-	reg_alloc->named_vars[reg_alloc->vars_named_count].reg_index = reg_alloc->vars_named_count;
-	reg_alloc->named_vars[reg_alloc->vars_named_count].type = type;
+	if (reg_alloc->vars_named_count >= reg_alloc->bucket_count * 2 && !dcg_grow_var_buckets(reg_alloc))
+	{
+		return ~0;
+	}
+
+	dcg_var_binding *binding = &reg_alloc->named_vars[reg_alloc->vars_named_count];
+	size_t bucket = name->hash & (reg_alloc->bucket_count - 1);
+
+	binding->name = name;
+	binding->reg_index = reg_alloc->vars_named_count;
+	binding->type = type;
+	binding->scope = reg_alloc->scope;
+	binding->next_in_bucket = reg_alloc->buckets[bucket];
+
+	reg_alloc->buckets[bucket] = reg_alloc->vars_named_count;
 
-	return reg_alloc->vars_named_count++;
+	size_t result = reg_alloc->vars_named_count++;
+
+	// Pad out the rest of the window with unnamed bindings, so bindings stay parallel to registers
+
+	for (size_t i = 1; i < size; ++i)
+	{
+		dcg_var_binding *padding = &reg_alloc->named_vars[reg_alloc->vars_named_count];
+
+		padding->name = NULL;
+		padding->reg_index = reg_alloc->vars_named_count;
+		padding->type = type;
+		padding->scope = reg_alloc->scope;
+		padding->next_in_bucket = ~0;
+
+		++reg_alloc->vars_named_count;
+	}
+
+	if (reg_alloc->vars_max_allocated < reg_alloc->vars_named_count)
+		reg_alloc->vars_max_allocated = reg_alloc->vars_named_count;
+
+	return result;
 }
 void	dcg_pop_named_to(size_t named_reg_index, dcg_register_allocator *reg_alloc)
 {
 	assert(named_reg_index <= reg_alloc->vars_named_count);
 	assert(reg_alloc->vars_temp_count == 0);
 
-	reg_alloc->vars_named_count = named_reg_index + 1;
+	dcg_unlink_named(named_reg_index + 1, reg_alloc);
 }
 void	dcg_pop_named_past(size_t named_reg_index, dcg_register_allocator *reg_alloc)
 {
 	assert(named_reg_index <= reg_alloc->vars_named_count);
 	assert(reg_alloc->vars_temp_count == 0);
 
-	reg_alloc->vars_named_count = named_reg_index;
+	dcg_unlink_named(named_reg_index, reg_alloc);
 }
 
 int		dcg_is_named(size_t reg_index, dcg_register_allocator *reg_alloc)
@@ -230,6 +520,62 @@ dvm_bc  *dcg_push_bc(size_t amount, dcg_bc_emitter *bc_emit)
 {
 	return dvm_proc_emitter_push_bc(amount, &bc_emit->vm_emitter);
 }
+dvm_bc  *dcg_bc_at(size_t location, dcg_bc_emitter *bc_emit)
+{
+	// Bytecode may move as the context grows, so don't hold on to pointers across pushes
+
+	return bc_emit->vm_emitter.context->bytecode + bc_emit->vm_emitter.bytecode_start + location;
+}
+int		 dcg_push_global(uint8_t opcode, size_t global_index, size_t reg_index, dcg_bc_emitter *bc_emit)
+{
+	dvm_bc *bc = dcg_push_bc(1, bc_emit);
+
+	if (bc == NULL)
+	{
+		return 0;
+	}
+
+	bc[0].opcode = opcode;
+	bc[0].a = global_index & 0xFF;
+	bc[0].b = global_index >> 8;
+	bc[0].c = reg_index;
+
+	return 1;
+}
+int		 dcg_push_move(size_t from_reg, size_t to_reg, dst_type type, dcg_proc_decl_table *module, dcg_bc_emitter *bc_emit)
+{
+	if (from_reg == to_reg)
+	{
+		return 1;
+	}
+
+	dvm_bc *bc = dcg_push_bc(1, bc_emit);
+
+	if (bc == NULL)
+	{
+		return 0;
+	}
+
+	// Whole structs are moved in one block copy
+
+	size_t size = dcg_type_size(type, module);
+
+	if (size == 1)
+	{
+		bc[0].opcode = dvm_opcode_mov;
+		bc[0].a = from_reg;
+		bc[0].c = to_reg;
+	}
+	else
+	{
+		bc[0].opcode = dvm_opcode_movn;
+		bc[0].a = from_reg;
+		bc[0].b = size;
+		bc[0].c = to_reg;
+	}
+
+	return 1;
+}
 
 size_t dcg_next_reg_index(dcg_register_allocator *reg_alloc)
 {
@@ -13,33 +13,102 @@
 
 struct dcg_proc_decl
 {
-	const char			*id;
+	dsc_atom			*id;
 	dst_proc_param_list *in_params;
 	dst_type_list		*out_types;
 	size_t				 index;
+	dst_proc			*proc;		// the procedure's tree, NULL for natives
+
+	struct dcg_proc_decl *next_in_bucket;
+};
+struct dcg_global
+{
+	dsc_atom	*id;
+	dst_type	 type;
+	int			 is_const;
+	dvm_var		 value;		// the folded value of a constant, or the initial value of a global
+	uint32_t	 index;		// slot in the context's data segment
 };
-struct dcg_proc_decl_list
+struct dcg_proc_decl_table
 {
-	struct dcg_proc_decl *value;
+	size_t					 count;
+	size_t					 bucket_count;
+	struct dcg_proc_decl	**buckets;
+
+	// Struct declarations of the module being compiled, used to size and lay out struct values
+	dst_struct_table		*structs;
+
+	// Globals and constants of the module being compiled
+	size_t					 global_count;
+	struct dcg_global		*globals;
 
-	struct dcg_proc_decl_list *prev;
-	struct dcg_proc_decl_list *next;
+	// The context being compiled into, string constants are interned in its pool
+	dvm_context				*vm;
+
+	// The names of the intrinsics as atoms, indexed by dcg_intrinsic
+	dsc_atom				**intrinsics;
+
+	// The procedure being compiled and the hash of its name, which its profile sites are found by
+	dst_proc				*proc;
+	uint32_t				 proc_hash;
+
+	dsc_memory *mem;
 };
 typedef struct dcg_proc_decl dcg_proc_decl;
-typedef struct dcg_proc_decl_list dcg_proc_decl_list;
+typedef struct dcg_proc_decl_table dcg_proc_decl_table;
+typedef struct dcg_global dcg_global;
 
-dcg_proc_decl_list *dcg_append_proc_decl_list(dcg_proc_decl_list *list, dcg_proc_decl *value, dsc_memory *mem);
+dcg_proc_decl_table *dcg_create_proc_decl_table(size_t initial_bucket_count, dsc_memory *mem);
+int dcg_proc_decl_table_insert(dcg_proc_decl *value, dcg_proc_decl_table *table);
 
-dcg_proc_decl *dcg_create_proc_decl(const char *id, dst_proc_param_list *in_params, dst_type_list *out_types, size_t index, dsc_memory *mem);
+dcg_proc_decl *dcg_create_proc_decl(dsc_atom *id, dst_proc_param_list *in_params, dst_type_list *out_types, size_t index, dsc_memory *mem);
 
-dcg_proc_decl *dcg_proc_decl_list_find(const char *id, dcg_proc_decl_list *list);
+dcg_proc_decl *dcg_proc_decl_table_find(dsc_atom *id, dcg_proc_decl_table *table);
+
+dcg_global *dcg_find_global(dsc_atom *id, dcg_proc_decl_table *module);
+
+// Struct values take a window of registers, everything else takes one
+size_t			 dcg_type_size(dst_type type, dcg_proc_decl_table *module);
+size_t			 dcg_type_list_size(dst_type_list *list, dcg_proc_decl_table *module);
+size_t			 dcg_proc_in_size(dst_proc_param_list *params, dcg_proc_decl_table *module);
+dst_type_list	*dcg_type_sentinel(dst_type type, dcg_proc_decl_table *module);
+
+// Intrinsics are called like procedures but compile to instructions. The script's own procedures and structs take
+// precedence over them, and they take precedence over natives of the same name.
+enum dcg_intrinsic
+{
+	dcg_intrinsic_none,
+	dcg_intrinsic_length,
+	dcg_intrinsic_hash,
+
+	dcg_intrinsic_sqrt,
+	dcg_intrinsic_sin,
+	dcg_intrinsic_cos,
+	dcg_intrinsic_tan,
+	dcg_intrinsic_pow,
+	dcg_intrinsic_abs,
+	dcg_intrinsic_min,
+	dcg_intrinsic_max,
+	dcg_intrinsic_floor,
+	dcg_intrinsic_fma,
+	dcg_intrinsic_select,
+
+	dcg_intrinsic_count,
+};
+typedef enum dcg_intrinsic dcg_intrinsic;
+
+int dcg_intern_intrinsics(dsc_intern_table *atoms, dcg_proc_decl_table *module);
+dcg_intrinsic dcg_find_intrinsic(dsc_atom *id, dcg_proc_decl_table *module);
 
 
 struct dcg_var_binding
 {
-	uint32_t		hashed_name;
+	dsc_atom		*name;
 	size_t			reg_index;
 	dst_type		type;
+
+	size_t			scope;
+	size_t			next_in_bucket;
 };
 struct dcg_register_allocator
 {
@@ -50,6 +119,10 @@ struct dcg_register_allocator
 	size_t					named_vars_capacity;
 	struct dcg_var_binding *named_vars;
 
+	size_t					scope;
+	size_t					bucket_count;
+	size_t				   *buckets;
+
 	dsc_memory *mem;
 };
 struct dcg_bc_emitter
@@ -68,6 +141,7 @@ int	dcg_start_proc_emit(
 	dsc_memory *mem);
 int dcg_finalize_proc_emit(
 	dst_proc *ast_proc,
+	dcg_proc_decl_table *module,
 	dcg_register_allocator *reg_alloc,
 	dcg_bc_emitter *bc_emit,
 	dvm_context *vm);
@@ -76,13 +150,18 @@ void dcg_cancel_proc_emit(
 	dcg_bc_emitter *bc_emit,
 	dvm_context *vm);
 
-dcg_var_binding *dcg_map(const char *name, dcg_register_allocator *reg_alloc);
+dcg_var_binding *dcg_map(dsc_atom *name, dcg_register_allocator *reg_alloc);
+
+void	dcg_push_scope(dcg_register_allocator *reg_alloc);
+void	dcg_pop_scope(size_t named_reg_index, dcg_register_allocator *reg_alloc);
 
 size_t	dcg_push_temp(dcg_register_allocator *reg_alloc);
+size_t	dcg_push_temp_window(size_t size, dcg_register_allocator *reg_alloc);
 void	dcg_pop_temp_to(size_t temp_reg_index, dcg_register_allocator *reg_alloc);
 void	dcg_pop_temp_past(size_t temp_reg_index, dcg_register_allocator *reg_alloc);
 
-size_t	dcg_push_named(const char *name, dst_type type, dcg_register_allocator *reg_alloc);
+size_t	dcg_push_named(dsc_atom *name, dst_type type, dcg_register_allocator *reg_alloc);
+size_t	dcg_push_named_window(dsc_atom *name, dst_type type, size_t size, dcg_register_allocator *reg_alloc);
 void	dcg_pop_named_to(size_t named_reg_index, dcg_register_allocator *reg_alloc);
 void	dcg_pop_named_past(size_t named_reg_index, dcg_register_allocator *reg_alloc);
 
@@ -90,6 +169,22 @@ int		dcg_is_named(size_t reg_index, dcg_register_allocator *reg_alloc);
 int		dcg_is_temp(size_t reg_index, dcg_register_allocator *reg_alloc);
 
 dvm_bc  *dcg_push_bc(size_t amount, dcg_bc_emitter *bc_emit);
+dvm_bc  *dcg_bc_at(size_t location, dcg_bc_emitter *bc_emit);
+int		 dcg_push_global(uint8_t opcode, size_t global_index, size_t reg_index, dcg_bc_emitter *bc_emit);		// also sload, strings are indexed the same way
+int		 dcg_push_move(size_t from_reg, size_t to_reg, dst_type type, dcg_proc_decl_table *module, dcg_bc_emitter *bc_emit);
+
+// Evaluates an expression of literals and constants, without emitting anything or reporting errors
+int dcg_fold_constant(dst_exp *exp, dvm_var *out_value, dst_type *out_type, dcg_proc_decl_table *module, dcg_register_allocator *reg_alloc);
+
+// Profile guided choices, every one of them is the unguided choice when no profile is loaded
+int		 dcg_profile_site(uint8_t kind, uint32_t site, int inverted, size_t location, dcg_proc_decl_table *module, dcg_bc_emitter *bc_emit);
+int		 dcg_profile_inlined_site(uint32_t site, dcg_proc_decl_table *module);
+int		 dcg_profile_prefers_else(uint32_t site, dcg_proc_decl_table *module);
+int		 dcg_profile_is_hot_call(uint32_t site, dcg_proc_decl_table *module);
+int		 dcg_profile_is_cold(dcg_proc_decl_table *module);
+
+// The expression a call to a procedure that only returns one is, with its arguments in place of its parameters
+dst_exp *dcg_inline_call(dst_exp *exp, dcg_proc_decl *callee, dcg_proc_decl_table *module, dcg_register_allocator *reg_alloc, dsc_memory *mem);
 
 size_t dcg_next_reg_index(dcg_register_allocator *reg_alloc);
 size_t dcg_bc_written(dcg_bc_emitter *bc_emit);
@@ -1,68 +1,187 @@
 #include "common.h"
 
-int dcg_import_expression(
+int dcg_import_intrinsic(
+	dcg_intrinsic intrinsic,
 	dst_exp *exp,
 	size_t *out_reg,
 	dst_type_list **out_type,
-	dcg_proc_decl_list *module,
+	dcg_proc_decl_table *module,
 	dcg_register_allocator *reg_alloc,
 	dcg_bc_emitter *bc_emit,
 	dsc_memory *mem
+	);
+
+int dcg_import_call_params(
+	dst_proc_param_list *params,
+	dst_exp_list *param_exps,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit,
+	dsc_memory *mem
+	);
+
+// Stores a value known at compile time in a new temporary
+
+int dcg_import_constant(
+	dvm_var value,
+	dst_type type,
+	size_t *out_reg,
+	dst_type_list **out_type,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit
 	)
 {
-	switch (exp->type)
-	{
-	case dst_exp_type_variable:
+	size_t result_reg = dcg_push_temp(reg_alloc);
+
+	if (result_reg == ~0)
 	{
-		dcg_var_binding	*binding = dcg_map(exp->variable.id, reg_alloc);
+		dsc_error_oor();
+		return 0;
+	}
 
-		if (binding == NULL)
+	// Strings are loaded by their index in the context's table
+
+	if (type == dst_type_string)
+	{
+		if (!dcg_push_global(dvm_opcode_sload, value.s->index, result_reg, bc_emit))
 		{
-			dsc_error("couldn't find variable (%s)\n", exp->variable.id);
+			dsc_error_oom();
 			return 0;
 		}
 
-		(*out_reg) = binding->reg_index;
-		(*out_type) = binding->type == dst_type_real ? &dst_sentinel_type_real : &dst_sentinel_type_integer;
+		(*out_reg) = result_reg;
+		(*out_type) = &dst_sentinel_type_string;
 
 		return 1;
 	}
-	break;
 
-	case dst_exp_type_integer:
-	case dst_exp_type_real:
+	// 32 bit constants fit in one immediate slot, 64 bit constants take two
+
+	int wide = type == dst_type_long || type == dst_type_double;
+
+	dvm_bc *bc = dcg_push_bc(wide ? 3 : 2, bc_emit);
+
+	if (bc == NULL)
 	{
-		size_t result_reg = dcg_push_temp(reg_alloc);
+		dsc_error_oom();
+		return 0;
+	}
 
-		if (result_reg == ~0)
+	bc[0].opcode = wide ? dvm_opcode_storl : dvm_opcode_stor;
+	bc[0].c = result_reg;
+
+	if (wide)
+	{
+		memcpy(bc + 1, &value.l, sizeof(int64_t));
+	}
+	else
+	{
+		*(uint32_t *)(bc + 1) = value.u;
+	}
+
+	(*out_reg) = result_reg;
+	(*out_type) = dst_type_sentinel(type);
+
+	return 1;
+}
+
+// Conversion instructions indexed by source and destination type, nop where there's no conversion
+
+static const uint8_t dcg_cast_opcode[6][6] =
+{
+	/* real */		{ dvm_opcode_nop, dvm_opcode_casti, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_castfl, dvm_opcode_castfd },
+	/* integer */	{ dvm_opcode_castf, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_castil, dvm_opcode_castid },
+	/* real[] */	{ dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_nop },
+	/* integer[] */	{ dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_nop },
+	/* long */		{ dvm_opcode_castlf, dvm_opcode_castli, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_castld },
+	/* double */	{ dvm_opcode_castdf, dvm_opcode_castdi, dvm_opcode_nop, dvm_opcode_nop, dvm_opcode_castdl, dvm_opcode_nop },
+};
+
+// Picks the variant of an arithmetic or comparison instruction for the operand type
+
+static uint8_t dcg_typed_opcode(dst_type type, uint8_t integer_opcode, uint8_t real_opcode, uint8_t long_opcode, uint8_t double_opcode)
+{
+	switch (type)
+	{
+	case dst_type_integer:
+		return integer_opcode;
+	case dst_type_long:
+		return long_opcode;
+	case dst_type_double:
+		return double_opcode;
+	default:
+		return real_opcode;
+	}
+}
+
+int dcg_import_expression(
+	dst_exp *exp,
+	size_t *out_reg,
+	dst_type_list **out_type,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit,
+	dsc_memory *mem
+	)
+{
+	dvm_var		constant;
+	dst_type	constant_type;
+
+	// Literals, constants and anything built only from them are evaluated now and stored with one instruction
+
+	if (dcg_fold_constant(exp, &constant, &constant_type, module, reg_alloc))
+	{
+		return dcg_import_constant(constant, constant_type, out_reg, out_type, reg_alloc, bc_emit);
+	}
+
+	switch (exp->type)
+	{
+	case dst_exp_type_string:
+	{
+		// Literals always fold, unless they couldn't be interned
+
+		dsc_error("invalid string, the context can't hold any more strings.");
+		return 0;
+	}
+
+	case dst_exp_type_variable:
+	{
+		dcg_var_binding	*binding = dcg_map(exp->variable.id, reg_alloc);
+
+		if (binding != NULL)
 		{
-			dsc_error_oor();
-			return 0;
+			(*out_reg) = binding->reg_index;
+			(*out_type) = dcg_type_sentinel(binding->type, module);
+
+			return 1;
 		}
 
-		dvm_bc *bc = dcg_push_bc(2, bc_emit);
+		// Mutable globals are loaded into a temporary, they may have changed in any call
 
-		if (bc == NULL)
+		dcg_global *global = dcg_find_global(exp->variable.id, module);
+
+		if (global == NULL)
 		{
-			dsc_error_oom();
+			dsc_error("couldn't find variable (%s)\n", exp->variable.id->text);
 			return 0;
 		}
 
-		bc[0].opcode = dvm_opcode_stor;
-		bc[0].c = result_reg;
+		size_t result_reg = dcg_push_temp(reg_alloc);
 
-		if (exp->type == dst_type_integer)
+		if (result_reg == ~0)
 		{
-			*(int32_t *)(bc + 1) = exp->integer.value;
-			(*out_type) = &dst_sentinel_type_integer;
+			dsc_error_oor();
+			return 0;
 		}
-		else
+
+		if (!dcg_push_global(dvm_opcode_gload, global->index, result_reg, bc_emit))
 		{
-			*(float *)(bc + 1) = exp->real.value;
-			(*out_type) = &dst_sentinel_type_real;
+			dsc_error_oom();
+			return 0;
 		}
 
 		(*out_reg) = result_reg;
+		(*out_type) = dst_type_sentinel(global->type);
 
 		return 1;
 	}
@@ -88,10 +207,11 @@ int dcg_import_expression(
 		}
 
 		if (dst_type_list_is_composite(source_type) ||
-			dst_type_list_is_integer(source_type) && exp->cast.dest_type == dst_type_integer ||
-			dst_type_list_is_real(source_type) && exp->cast.dest_type == dst_type_real)
+			source_type->value > dst_type_double ||
+			exp->cast.dest_type > dst_type_double ||
+			dcg_cast_opcode[source_type->value][exp->cast.dest_type] == dvm_opcode_nop)
 		{
-			dsc_error("invalid cast expression, value must be an integer or a real, and be casted to a different type.");
+			dsc_error("invalid cast expression, value must be a number, and be casted to a different number type.");
 			return 0;
 		}
 
@@ -118,20 +238,11 @@ int dcg_import_expression(
 			return 0;
 		}
 
-		if (exp->cast.dest_type == dst_type_real)
-		{
-			bc[0].opcode = dvm_opcode_castf;
-			(*out_type) = &dst_sentinel_type_real;
-		}
-		else
-		{
-			bc[0].opcode = dvm_opcode_casti;
-			(*out_type) = &dst_sentinel_type_integer;
-		}
-
+		bc[0].opcode = dcg_cast_opcode[source_type->value][exp->cast.dest_type];
 		bc[0].a = source_register;
 		bc[0].c = result_register;
 
+		(*out_type) = dst_type_sentinel(exp->cast.dest_type);
 		(*out_reg) = result_register;
 
 		return 1;
@@ -190,7 +301,7 @@ int dcg_import_expression(
 		{
 			case dst_exp_type_not:
 			{
-				if (source_type->value == dst_type_real)
+				if (source_type->value != dst_type_integer)
 				{
 					dsc_error("invalid not expression, value must be an integer.");
 					return 0;
@@ -216,6 +327,12 @@ int dcg_import_expression(
 	case dst_exp_type_subtraction:
 	case dst_exp_type_multiplication:
 	case dst_exp_type_division:
+	case dst_exp_type_modulo:
+	case dst_exp_type_shift_left:
+	case dst_exp_type_shift_right:
+	case dst_exp_type_bit_and:
+	case dst_exp_type_bit_or:
+	case dst_exp_type_bit_xor:
 	case dst_exp_type_and:
 	case dst_exp_type_or:
 	case dst_exp_type_eq:
@@ -288,9 +405,39 @@ int dcg_import_expression(
 			return 0;
 		}
 
-		if (left_exp_type->value != right_exp_type->value)
+		if (dst_type_list_is_array(left_exp_type) || dst_type_list_is_array(right_exp_type))
+		{
+			dsc_error("invalid operands to binary expression, cannot be arrays");
+			return 0;
+		}
+
+		if (dst_type_is_struct(left_exp_type->value) || dst_type_is_struct(right_exp_type->value))
+		{
+			dsc_error("invalid operands to binary expression, cannot be structs");
+			return 0;
+		}
+
+		// Strings can only be compared for equality, which interning makes a pointer comparison
+
+		if ((left_exp_type->value == dst_type_string || right_exp_type->value == dst_type_string) && exp->type != dst_exp_type_eq)
+		{
+			dsc_error("invalid operands to binary expression, strings can only be compared with ==");
+			return 0;
+		}
+
+		// Shift counts are always integers, whatever the width of the value being shifted
+
+		if (exp->type == dst_exp_type_shift_left || exp->type == dst_exp_type_shift_right)
+		{
+			if (right_exp_type->value != dst_type_integer)
+			{
+				dsc_error("invalid operands to shift expression, count must be of type integer");
+				return 0;
+			}
+		}
+		else if (left_exp_type->value != right_exp_type->value)
 		{
-			dsc_error("invalid operands to binary expression, mismatch integer, real");
+			dsc_error("invalid operands to binary expression, mismatch of number types");
 			return 0;
 		}
 
@@ -344,7 +491,7 @@ int dcg_import_expression(
 		switch (exp->type)
 		{
 		case dst_exp_type_addition:
-			bc[0].opcode = left_exp_type->value == dst_type_integer ? dvm_opcode_addi : dvm_opcode_addf;
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_addi, dvm_opcode_addf, dvm_opcode_addl, dvm_opcode_addd);
 			bc[0].a = left_exp_register;
 			bc[0].b = right_exp_register;
 			bc[0].c = result_register;
@@ -352,7 +499,7 @@ int dcg_import_expression(
 			(*out_type) = left_exp_type;
 			break;
 		case dst_exp_type_subtraction:
-			bc[0].opcode = left_exp_type->value == dst_type_integer ? dvm_opcode_subi : dvm_opcode_subf;
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_subi, dvm_opcode_subf, dvm_opcode_subl, dvm_opcode_subd);
 			bc[0].a = left_exp_register;
 			bc[0].b = right_exp_register;
 			bc[0].c = result_register;
@@ -360,7 +507,7 @@ int dcg_import_expression(
 			(*out_type) = left_exp_type;
 			break;
 		case dst_exp_type_multiplication:
-			bc[0].opcode = left_exp_type->value == dst_type_integer ? dvm_opcode_muli : dvm_opcode_mulf;
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_muli, dvm_opcode_mulf, dvm_opcode_mull, dvm_opcode_muld);
 			bc[0].a = left_exp_register;
 			bc[0].b = right_exp_register;
 			bc[0].c = result_register;
@@ -368,7 +515,55 @@ int dcg_import_expression(
 			(*out_type) = left_exp_type;
 			break;
 		case dst_exp_type_division:
-			bc[0].opcode = left_exp_type->value == dst_type_integer ? dvm_opcode_divi : dvm_opcode_divf;
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_divi, dvm_opcode_divf, dvm_opcode_divl, dvm_opcode_divd);
+			bc[0].a = left_exp_register;
+			bc[0].b = right_exp_register;
+			bc[0].c = result_register;
+
+			(*out_type) = left_exp_type;
+			break;
+		case dst_exp_type_modulo:
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_modi, dvm_opcode_nop, dvm_opcode_modl, dvm_opcode_nop);
+			bc[0].a = left_exp_register;
+			bc[0].b = right_exp_register;
+			bc[0].c = result_register;
+
+			(*out_type) = left_exp_type;
+			break;
+		case dst_exp_type_shift_left:
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_shli, dvm_opcode_nop, dvm_opcode_shll, dvm_opcode_nop);
+			bc[0].a = left_exp_register;
+			bc[0].b = right_exp_register;
+			bc[0].c = result_register;
+
+			(*out_type) = left_exp_type;
+			break;
+		case dst_exp_type_shift_right:
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_shri, dvm_opcode_nop, dvm_opcode_shrl, dvm_opcode_nop);
+			bc[0].a = left_exp_register;
+			bc[0].b = right_exp_register;
+			bc[0].c = result_register;
+
+			(*out_type) = left_exp_type;
+			break;
+		case dst_exp_type_bit_and:
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_bandi, dvm_opcode_nop, dvm_opcode_bandl, dvm_opcode_nop);
+			bc[0].a = left_exp_register;
+			bc[0].b = right_exp_register;
+			bc[0].c = result_register;
+
+			(*out_type) = left_exp_type;
+			break;
+		case dst_exp_type_bit_or:
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_bori, dvm_opcode_nop, dvm_opcode_borl, dvm_opcode_nop);
+			bc[0].a = left_exp_register;
+			bc[0].b = right_exp_register;
+			bc[0].c = result_register;
+
+			(*out_type) = left_exp_type;
+			break;
+		case dst_exp_type_bit_xor:
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_bxori, dvm_opcode_nop, dvm_opcode_bxorl, dvm_opcode_nop);
 			bc[0].a = left_exp_register;
 			bc[0].b = right_exp_register;
 			bc[0].c = result_register;
@@ -377,7 +572,7 @@ int dcg_import_expression(
 			break;
 
 		case dst_exp_type_and:
-			if (left_exp_type->value == dst_type_real || right_exp_type->value == dst_type_real)
+			if (left_exp_type->value != dst_type_integer)
 			{
 				dsc_error("invalid operands to and expression, must be of type integer");
 				return 0;
@@ -392,7 +587,7 @@ int dcg_import_expression(
 			break;
 			
 		case dst_exp_type_or:
-			if (left_exp_type->value == dst_type_real || right_exp_type->value == dst_type_real)
+			if (left_exp_type->value != dst_type_integer)
 			{
 				dsc_error("invalid operands to or expression, must be of type integer");
 				return 0;
@@ -407,7 +602,8 @@ int dcg_import_expression(
 			break;
 
 		case dst_exp_type_eq:
-			bc[0].opcode = left_exp_type->value == dst_type_integer ? dvm_opcode_cmpi_e : dvm_opcode_cmpf_e;
+			bc[0].opcode = left_exp_type->value == dst_type_string ? dvm_opcode_cmps_e :
+				dcg_typed_opcode(left_exp_type->value, dvm_opcode_cmpi_e, dvm_opcode_cmpf_e, dvm_opcode_cmpl_e, dvm_opcode_cmpd_e);
 			bc[0].a = left_exp_register;
 			bc[0].b = right_exp_register;
 			bc[0].c = result_register;
@@ -415,7 +611,7 @@ int dcg_import_expression(
 			(*out_type) = &dst_sentinel_type_integer;
 			break;
 		case dst_exp_type_less:
-			bc[0].opcode = left_exp_type->value == dst_type_integer ? dvm_opcode_cmpi_l : dvm_opcode_cmpf_l;
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_cmpi_l, dvm_opcode_cmpf_l, dvm_opcode_cmpl_l, dvm_opcode_cmpd_l);
 			bc[0].a = left_exp_register;
 			bc[0].b = right_exp_register;
 			bc[0].c = result_register;
@@ -423,7 +619,7 @@ int dcg_import_expression(
 			(*out_type) = &dst_sentinel_type_integer;
 			break;
 		case dst_exp_type_less_eq:
-			bc[0].opcode = left_exp_type->value == dst_type_integer ? dvm_opcode_cmpi_le : dvm_opcode_cmpf_le;
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_cmpi_le, dvm_opcode_cmpf_le, dvm_opcode_cmpl_le, dvm_opcode_cmpd_le);
 			bc[0].a = left_exp_register;
 			bc[0].b = right_exp_register;
 			bc[0].c = result_register;
@@ -431,7 +627,7 @@ int dcg_import_expression(
 			(*out_type) = &dst_sentinel_type_integer;
 			break;
 		case dst_exp_type_greater:
-			bc[0].opcode = left_exp_type->value == dst_type_integer ? dvm_opcode_cmpi_l : dvm_opcode_cmpf_l;
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_cmpi_l, dvm_opcode_cmpf_l, dvm_opcode_cmpl_l, dvm_opcode_cmpd_l);
 			bc[0].a = right_exp_register;
 			bc[0].b = left_exp_register;
 			bc[0].c = result_register;
@@ -439,7 +635,7 @@ int dcg_import_expression(
 			(*out_type) = &dst_sentinel_type_integer;
 			break;
 		case dst_exp_type_greater_eq:
-			bc[0].opcode = left_exp_type->value == dst_type_integer ? dvm_opcode_cmpi_le : dvm_opcode_cmpf_le;
+			bc[0].opcode = dcg_typed_opcode(left_exp_type->value, dvm_opcode_cmpi_le, dvm_opcode_cmpf_le, dvm_opcode_cmpl_le, dvm_opcode_cmpd_le);
 			bc[0].a = right_exp_register;
 			bc[0].b = left_exp_register;
 			bc[0].c = result_register;
@@ -448,6 +644,14 @@ int dcg_import_expression(
 			break;
 		}
 
+		// Integer only operators don't have a real variant
+
+		if (bc[0].opcode == dvm_opcode_nop)
+		{
+			dsc_error("invalid operands to binary expression, must be of type integer or long");
+			return 0;
+		}
+
 		(*out_reg) = result_register;
 
 		return 1;
@@ -456,165 +660,598 @@ int dcg_import_expression(
 
 	case dst_exp_type_call:
 	{
-		dcg_proc_decl *next_proc = dcg_proc_decl_list_find(exp->call.function, module);
+		// A struct's name constructs it, the fields are evaluated straight into its window
+
+		dst_struct *structure = dst_find_struct(exp->call.function, module->structs);
+
+		if (structure != NULL)
+		{
+			size_t start_field_reg = dcg_next_reg_index(reg_alloc);
+
+			if (!dcg_import_call_params(structure->fields, exp->call.parameters, module, reg_alloc, bc_emit, mem))
+			{
+				return 0;
+			}
+
+			(*out_type) = &structure->sentinel;
+			(*out_reg) = start_field_reg;
+
+			return 1;
+		}
+
+		dcg_proc_decl *next_proc = dcg_proc_decl_table_find(exp->call.function, module);
+
+		// Intrinsics are only shadowed by the script's own procedures, natives like sin are compiled to instructions
+
+		if (next_proc == NULL || next_proc->proc == NULL)
+		{
+			dcg_intrinsic intrinsic = dcg_find_intrinsic(exp->call.function, module);
+
+			if (intrinsic != dcg_intrinsic_none)
+			{
+				return dcg_import_intrinsic(intrinsic, exp, out_reg, out_type, module, reg_alloc, bc_emit, mem);
+			}
+		}
 
 		if (next_proc == NULL)
 		{
-			dsc_error("invalid call expression, cannot find procedure %s.", exp->call.function);
+			dsc_error("invalid call expression, cannot find procedure %s.", exp->call.function->text);
 			return 0;
 		}
 
-		dst_proc_param_list *cur_param = next_proc->in_params;
-		dst_exp_list *cur_param_exp = exp->call.parameters;
+		if (next_proc->index > 255)
+		{
+			dsc_error("invalid call expression, procedure %s is out of range of the call instruction.", exp->call.function->text);
+			return 0;
+		}
+
+		// A hot call to a procedure that only returns an expression is compiled as the expression
+
+		if (dcg_profile_is_hot_call(exp->call.site, module))
+		{
+			dst_exp *inlined = dcg_inline_call(exp, next_proc, module, reg_alloc, mem);
+
+			if (inlined != NULL)
+			{
+				if (!dcg_profile_inlined_site(exp->call.site, module))
+				{
+					dsc_error_oom();
+					return 0;
+				}
+
+				return dcg_import_expression(inlined, out_reg, out_type, module, reg_alloc, bc_emit, mem);
+			}
+		}
+
+		size_t start_param_reg = dcg_next_reg_index(reg_alloc);
 
-		if (cur_param == NULL && cur_param_exp != NULL)
+		if (!dcg_import_call_params(next_proc->in_params, exp->call.parameters, module, reg_alloc, bc_emit, mem))
 		{
-			dsc_error("invalid call expression, no parameters expected in procedure.");
 			return 0;
 		}
 
-		if (cur_param_exp == NULL && cur_param != NULL)
+		if (!dcg_profile_site(dvm_profile_kind_call, exp->call.site, 0, dcg_bc_written(bc_emit), module, bc_emit))
 		{
-			dsc_error("invalid call expression, expected a parameter.");
+			dsc_error_oom();
 			return 0;
 		}
 
-		size_t start_param_reg = dcg_next_reg_index(reg_alloc);
+		dvm_bc *call = dcg_push_bc(1, bc_emit);
 
-		if (cur_param_exp != NULL)
+		if (call == NULL)
 		{
-			do
+			dsc_error_oom();
+			return 0;
+		}
+
+		call->opcode = dvm_opcode_call;
+		call->a = next_proc->index;
+		call->b = start_param_reg;
+		call->c = start_param_reg;
+
+		dcg_pop_temp_past(start_param_reg, reg_alloc);
+
+		size_t out_val_count = dcg_type_list_size(next_proc->out_types, module);
+
+		while (out_val_count > 0)
+		{
+			dcg_push_temp(reg_alloc);
+			--out_val_count;
+		}
+
+		(*out_type) = next_proc->out_types;
+		(*out_reg) = start_param_reg;
+
+		return 1;
+	}
+
+	case dst_exp_type_array:
+	{
+		size_t			 result_register = dcg_next_reg_index(reg_alloc);
+		size_t			 length_register;
+		dst_type_list	*length_type;
+
+		if (!dcg_import_expression(exp->array.length, &length_register, &length_type, module, reg_alloc, bc_emit, mem))
+		{
+			return 0;
+		}
+
+		if (length_type == NULL || !dst_type_list_is_integer(length_type))
+		{
+			dsc_error("invalid array expression, length must be an integer.");
+			return 0;
+		}
+
+		if (exp->array.element_type != dst_type_integer && exp->array.element_type != dst_type_real)
+		{
+			dsc_error("invalid array expression, elements must be integers or reals.");
+			return 0;
+		}
+
+		// The result can reuse the first temporary, the length is read before it's written
+
+		dcg_pop_temp_past(result_register, reg_alloc);
+
+		if (dcg_push_temp(reg_alloc) == ~0)
+		{
+			dsc_error_oor();
+			return 0;
+		}
+
+		dvm_bc *bc = dcg_push_bc(1, bc_emit);
+
+		if (bc == NULL)
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		bc[0].opcode = dvm_opcode_anew;
+		bc[0].a = length_register;
+		bc[0].b = exp->array.element_type == dst_type_integer ? dvm_type_integer : dvm_type_real;
+		bc[0].c = result_register;
+
+		(*out_type) = dst_type_sentinel(dst_type_array_of(exp->array.element_type));
+		(*out_reg) = result_register;
+
+		return 1;
+	}
+
+	case dst_exp_type_index:
+	{
+		size_t			 result_register = dcg_next_reg_index(reg_alloc);
+		size_t			 array_register;
+		dst_type_list	*array_type;
+		size_t			 index_register;
+		dst_type_list	*index_type;
+
+		if (!dcg_import_expression(exp->index.array, &array_register, &array_type, module, reg_alloc, bc_emit, mem) ||
+			!dcg_import_expression(exp->index.index, &index_register, &index_type, module, reg_alloc, bc_emit, mem))
+		{
+			return 0;
+		}
+
+		if (array_type == NULL || !dst_type_list_is_array(array_type))
+		{
+			dsc_error("invalid index expression, only arrays can be indexed.");
+			return 0;
+		}
+
+		if (index_type == NULL || !dst_type_list_is_integer(index_type))
+		{
+			dsc_error("invalid index expression, index must be an integer.");
+			return 0;
+		}
+
+		// The result can reuse the first temporary, the operands are read before it's written
+
+		dcg_pop_temp_past(result_register, reg_alloc);
+
+		if (dcg_push_temp(reg_alloc) == ~0)
+		{
+			dsc_error_oor();
+			return 0;
+		}
+
+		dvm_bc *bc = dcg_push_bc(1, bc_emit);
+
+		if (bc == NULL)
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		bc[0].opcode = dvm_opcode_aload;
+		bc[0].a = array_register;
+		bc[0].b = index_register;
+		bc[0].c = result_register;
+
+		(*out_type) = dst_type_sentinel(dst_type_element_of(array_type->value));
+		(*out_reg) = result_register;
+
+		return 1;
+	}
+
+	case dst_exp_type_field:
+	{
+		size_t			 value_register;
+		dst_type_list	*value_type;
+
+		if (!dcg_import_expression(exp->field.value, &value_register, &value_type, module, reg_alloc, bc_emit, mem))
+		{
+			return 0;
+		}
+
+		dst_struct *structure = NULL;
+
+		if (value_type == NULL ||
+			dst_type_list_is_composite(value_type) ||
+			(structure = dst_struct_of(value_type->value, module->structs)) == NULL)
+		{
+			dsc_error("invalid field expression, only structs have fields.");
+			return 0;
+		}
+
+		// Fields are at a fixed offset into the struct's window
+
+		size_t			 field_offset;
+		dst_proc_param	*field = dst_struct_field(structure, exp->field.field, &field_offset, module->structs);
+
+		if (field == NULL)
+		{
+			dsc_error("invalid field expression, struct %s has no field %s.", structure->id->text, exp->field.field->text);
+			return 0;
+		}
+
+		size_t field_register = value_register + field_offset;
+
+		// A named struct's field can be read in place, a temporary struct has its field moved down and the rest dropped
+
+		if (dcg_is_temp(value_register, reg_alloc))
+		{
+			dcg_pop_temp_past(value_register, reg_alloc);
+
+			if (dcg_push_temp_window(dcg_type_size(field->type, module), reg_alloc) == ~0)
+			{
+				dsc_error_oor();
+				return 0;
+			}
+
+			if (!dcg_push_move(field_register, value_register, field->type, module, bc_emit))
+			{
+				dsc_error_oom();
+				return 0;
+			}
+
+			field_register = value_register;
+		}
+
+		(*out_type) = dcg_type_sentinel(field->type, module);
+		(*out_reg) = field_register;
+
+		return 1;
+	}
+
+	}
+
+	dsc_error_internal();
+	return 0;
+}
+
+// Evaluates the parameters of a call into consecutive temporaries from the next free register,
+// a struct value takes up its whole window. The callee's registers start at them, so nothing can be live past them.
+
+int dcg_import_call_params(
+	dst_proc_param_list *params,
+	dst_exp_list *param_exps,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit,
+	dsc_memory *mem
+	)
+{
+	dst_proc_param_list *cur_param = params;
+	dst_exp_list *cur_param_exp = param_exps;
+
+	if (cur_param == NULL && cur_param_exp != NULL)
+	{
+		dsc_error("invalid call expression, no parameters expected in procedure.");
+		return 0;
+	}
+
+	if (cur_param_exp == NULL && cur_param != NULL)
+	{
+		dsc_error("invalid call expression, expected a parameter.");
+		return 0;
+	}
+
+	if (cur_param_exp != NULL)
+	{
+		do
+		{
+			size_t			 exp_reg_start;
+			dst_type_list	*exp_types;
+
+			// Evaluate the expression, returning n >= 1 possible values
+			// n is the length of the exp_types linked list
+			// the register storing n is exp_reg_start + n
+
+			if (!dcg_import_expression(cur_param_exp->value, &exp_reg_start, &exp_types, module, reg_alloc, bc_emit, mem))
+			{
+				return 0;
+			}
+
+			if (exp_types == NULL)
+			{
+				dsc_error("invalid call expression, every expression must produce at least one value.");
+				return 0;
+			}
+
+			// Clear out the temp registers we were using, this allows us to reclaim them with new temp variables for output
+
+			if (dcg_is_temp(exp_reg_start, reg_alloc))
 			{
-				size_t			 exp_reg_start;
-				dst_type_list	*exp_types;
+				dcg_pop_temp_past(exp_reg_start, reg_alloc);
+			}
 
-				// Evaluate the expression, returning n >= 1 possible values
-				// n is the length of the exp_types linked list
-				// the register storing n is exp_reg_start + n
+			// Move the values into the output registers
 
-				if (!dcg_import_expression(cur_param_exp->value, &exp_reg_start, &exp_types, module, reg_alloc, bc_emit, mem))
+			dst_type_list	*sub_val_type = exp_types;
+			size_t			 sub_val_offset = 0;
+
+			while (1)
+			{
+				if (sub_val_type->value != cur_param->value->type)
 				{
+					dsc_error("invalid call expression, parameter has wrong type.");
 					return 0;
 				}
 
-				if (exp_types == NULL)
+				size_t sub_val_reg = exp_reg_start + sub_val_offset;
+				size_t sub_val_size = dcg_type_size(sub_val_type->value, module);
+				size_t out_reg = dcg_push_temp_window(sub_val_size, reg_alloc);
+
+				if (out_reg == ~0)
 				{
-					dsc_error("invalid call expression, every expression must produce at least one value.");
+					dsc_error_oor();
 					return 0;
 				}
 
-				// Clear out the temp registers we were using, this allows us to reclaim them with new temp variables for output
+				// Store the value in the out registers, if it's not already there
 
-				if (dcg_is_temp(exp_reg_start, reg_alloc))
+				if (!dcg_push_move(sub_val_reg, out_reg, sub_val_type->value, module, bc_emit))
 				{
-					dcg_pop_temp_past(exp_reg_start, reg_alloc);
+					dsc_error_oom();
+					return 0;
 				}
 
-				// Move the values into the output registers
+				// Go to the next value of this expression
 
-				dst_type_list	*sub_val_type = exp_types;
-				size_t			 sub_val_index = 0;
+				sub_val_offset += sub_val_size;
+				sub_val_type = sub_val_type->next;
 
-				while (1)
-				{
-					if (sub_val_type->value != cur_param->value->type)
-					{
-						dsc_error("invalid call expression, parameter has wrong type.");
-						return 0;
-					}
+				// Go to the next param of this call
 
-					size_t sub_val_reg = exp_reg_start + sub_val_index;
-					size_t out_reg = dcg_push_temp(reg_alloc);
+				cur_param = cur_param->next;
 
-					if (out_reg == ~0)
-					{
-						dsc_error_oor();
-						return 0;
-					}
+				if (cur_param == params || sub_val_type == exp_types)
+					break;
+			}
 
-					// Store the value in the out register, if it's not already there
+			// Go to the next expression for its values
+			cur_param_exp = cur_param_exp->next;
 
-					if (out_reg != sub_val_reg)
-					{
-						dvm_bc *bc = dcg_push_bc(1, bc_emit);
+			// Check to see if we ran out of params before sub vals or expressions
 
-						if (bc == NULL)
-						{
-							dsc_error_oom();
-							return 0;
-						}
+			if (cur_param == params && (sub_val_type != exp_types || cur_param_exp != param_exps))
+			{
+				dsc_error("invalid call expression, too many parameters.");
+				return 0;
+			}
 
-						bc[0].opcode = dvm_opcode_mov;
-						bc[0].a = sub_val_reg;
-						bc[0].c = out_reg;
-					}
+			// Check to see if we ran out of expression before params
+
+			if (cur_param != params && cur_param_exp == param_exps)
+			{
+				dsc_error("invalid call expression, not enough parameters.");
+				return 0;
+			}
 
-					// Go to the next value of this expression
+		} while (cur_param_exp != param_exps);
+	}
 
-					++sub_val_index;
-					sub_val_type = sub_val_type->next;
+	return 1;
+}
 
-					// Go to the next param of this call
+int dcg_import_intrinsic(
+	dcg_intrinsic intrinsic,
+	dst_exp *exp,
+	size_t *out_reg,
+	dst_type_list **out_type,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit,
+	dsc_memory *mem
+	)
+{
+	size_t		result_register = dcg_next_reg_index(reg_alloc);
+	size_t		param_registers[3];
+	dst_type	param_types[3];
+	size_t		param_count = dst_exp_list_count(exp->call.parameters);
+	size_t		expected_count;
 
-					cur_param = cur_param->next;
+	switch (intrinsic)
+	{
+	case dcg_intrinsic_pow:
+	case dcg_intrinsic_min:
+	case dcg_intrinsic_max:
+		expected_count = 2;
+		break;
+	case dcg_intrinsic_fma:
+	case dcg_intrinsic_select:
+		expected_count = 3;
+		break;
+	default:
+		expected_count = 1;
+		break;
+	}
 
-					if (cur_param == next_proc->in_params || sub_val_type == exp_types)
-						break;
-				}
+	if (param_count != expected_count)
+	{
+		dsc_error("invalid call to %s, expected %u parameters.", exp->call.function->text, (unsigned int)expected_count);
+		return 0;
+	}
 
-				// Go to the next expression for its values
-				cur_param_exp = cur_param_exp->next;
+	// fma and select accumulate into their result, so the result can't share a register with the operands
 
-				// Check to see if we ran out of params before sub vals or expressions
+	int accumulates = intrinsic == dcg_intrinsic_fma || intrinsic == dcg_intrinsic_select;
 
-				if (cur_param == next_proc->in_params && (sub_val_type != exp_types || cur_param_exp != exp->call.parameters))
-				{
-					dsc_error("invalid call expression, too many parameters.");
-					return 0;
-				}
+	if (accumulates && dcg_push_temp(reg_alloc) == ~0)
+	{
+		dsc_error_oor();
+		return 0;
+	}
 
-				// Check to see if we ran out of expression before params
+	dst_exp_list *param = exp->call.parameters;
 
-				if (cur_param != next_proc->in_params && cur_param_exp == exp->call.parameters)
-				{
-					dsc_error("invalid call expression, not enough parameters.");
-					return 0;
-				}
+	for (size_t i = 0; i < param_count; ++i, param = param->next)
+	{
+		dst_type_list *param_type;
 
-			} while (cur_param_exp != exp->call.parameters);
+		if (!dcg_import_expression(param->value, &param_registers[i], &param_type, module, reg_alloc, bc_emit, mem))
+		{
+			return 0;
 		}
 
-		dvm_bc *call = dcg_push_bc(1, bc_emit);
+		if (param_type == NULL || dst_type_list_is_composite(param_type))
+		{
+			dsc_error("invalid call to %s, every parameter must produce one value.", exp->call.function->text);
+			return 0;
+		}
 
-		if (call == NULL)
+		param_types[i] = param_type->value;
+	}
+
+	// Pick the instruction for the operand types
+
+	uint8_t		opcode = dvm_opcode_nop;
+	dst_type	result_type = dst_type_real;
+	int			all_real = 1;
+	int			all_integer = 1;
+
+	for (size_t i = 0; i < param_count; ++i)
+	{
+		all_real &= param_types[i] == dst_type_real;
+		all_integer &= param_types[i] == dst_type_integer;
+	}
+
+	switch (intrinsic)
+	{
+	case dcg_intrinsic_length:
+		if (param_types[0] == dst_type_integer_array || param_types[0] == dst_type_real_array)
+		{
+			opcode = dvm_opcode_alen;
+			result_type = dst_type_integer;
+		}
+		else if (param_types[0] == dst_type_string)
+		{
+			opcode = dvm_opcode_slen;
+			result_type = dst_type_integer;
+		}
+		break;
+
+	case dcg_intrinsic_hash:
+		if (param_types[0] == dst_type_string)
+		{
+			opcode = dvm_opcode_shash;
+			result_type = dst_type_integer;
+		}
+		break;
+
+	case dcg_intrinsic_sqrt:	opcode = all_real ? dvm_opcode_sqrtf : dvm_opcode_nop; break;
+	case dcg_intrinsic_sin:		opcode = all_real ? dvm_opcode_sinf : dvm_opcode_nop; break;
+	case dcg_intrinsic_cos:		opcode = all_real ? dvm_opcode_cosf : dvm_opcode_nop; break;
+	case dcg_intrinsic_tan:		opcode = all_real ? dvm_opcode_tanf : dvm_opcode_nop; break;
+	case dcg_intrinsic_pow:		opcode = all_real ? dvm_opcode_powf : dvm_opcode_nop; break;
+	case dcg_intrinsic_floor:	opcode = all_real ? dvm_opcode_floorf : dvm_opcode_nop; break;
+	case dcg_intrinsic_fma:		opcode = all_real ? dvm_opcode_fmaf : dvm_opcode_nop; break;
+
+	case dcg_intrinsic_select:
+		if (param_types[0] == dst_type_integer && param_types[1] == param_types[2] && !dst_type_is_struct(param_types[1]))
+		{
+			opcode = dvm_opcode_select;
+			result_type = param_types[1];
+		}
+		break;
+
+	case dcg_intrinsic_abs:
+		opcode = all_real ? dvm_opcode_absf : all_integer ? dvm_opcode_absi : dvm_opcode_nop;
+		result_type = param_types[0];
+		break;
+	case dcg_intrinsic_min:
+		opcode = all_real ? dvm_opcode_minf : all_integer ? dvm_opcode_mini : dvm_opcode_nop;
+		result_type = param_types[0];
+		break;
+	case dcg_intrinsic_max:
+		opcode = all_real ? dvm_opcode_maxf : all_integer ? dvm_opcode_maxi : dvm_opcode_nop;
+		result_type = param_types[0];
+		break;
+	}
+
+	if (opcode == dvm_opcode_nop)
+	{
+		dsc_error("invalid call to %s, parameter has wrong type.", exp->call.function->text);
+		return 0;
+	}
+
+	dvm_bc *bc;
+
+	if (accumulates)
+	{
+		bc = dcg_push_bc(2, bc_emit);
+
+		if (bc == NULL)
 		{
 			dsc_error_oom();
 			return 0;
 		}
 
-		call->opcode = dvm_opcode_call;
-		call->a = next_proc->index;
-		call->b = start_param_reg;
-		call->c = start_param_reg;
+		bc[0].opcode = dvm_opcode_mov;
+		bc[0].a = param_registers[2];
+		bc[0].c = result_register;
 
-		dcg_pop_temp_past(start_param_reg, reg_alloc);
+		++bc;
 
-		size_t out_val_count = dst_type_list_count(next_proc->out_types);
+		dcg_pop_temp_to(result_register, reg_alloc);
+	}
+	else
+	{
+		// The result can reuse the first temporary, the operands are read before it's written
 
-		while (out_val_count > 0)
+		dcg_pop_temp_past(result_register, reg_alloc);
+
+		if (dcg_push_temp(reg_alloc) == ~0)
 		{
-			dcg_push_temp(reg_alloc);
-			--out_val_count;
+			dsc_error_oor();
+			return 0;
 		}
 
-		(*out_type) = next_proc->out_types;
-		(*out_reg) = start_param_reg;
+		bc = dcg_push_bc(1, bc_emit);
 
-		return 1;
+		if (bc == NULL)
+		{
+			dsc_error_oom();
+			return 0;
+		}
 	}
 
-	}
+	bc[0].opcode = opcode;
+	bc[0].a = param_registers[0];
+	bc[0].b = param_count > 1 ? param_registers[1] : 0;
+	bc[0].c = result_register;
 
-	dsc_error_internal();
-	return 0;
+	(*out_type) = dst_type_sentinel(result_type);
+	(*out_reg) = result_register;
+
+	return 1;
 }
\ No newline at end of file
@@ -0,0 +1,382 @@
+#include "common.h"
+#include "codegen.h"
+
+#include <stdint.h>
+
+dcg_global *dcg_find_global(dsc_atom *id, dcg_proc_decl_table *module)
+{
+	for (size_t i = 0; i < module->global_count; ++i)
+	{
+		if (module->globals[i].id == id)
+			return &module->globals[i];
+	}
+
+	return NULL;
+}
+
+// Conversions match the cast instructions, the VM has none between a type and itself
+
+static int dcg_fold_cast(dvm_var value, dst_type from, dst_type to, dvm_var *out_value)
+{
+	#define DCG_FOLD_CAST(source) \
+		switch (to) \
+		{ \
+		case dst_type_integer:	out_value->i = (int32_t)(source); break; \
+		case dst_type_real:		out_value->f = (float)(source); break; \
+		case dst_type_long:		out_value->l = (int64_t)(source); break; \
+		case dst_type_double:	out_value->d = (double)(source); break; \
+		default:				return 0; \
+		}
+
+	if (from == to)
+	{
+		return 0;
+	}
+
+	switch (from)
+	{
+	case dst_type_integer:	DCG_FOLD_CAST(value.i); break;
+	case dst_type_real:		DCG_FOLD_CAST(value.f); break;
+	case dst_type_long:		DCG_FOLD_CAST(value.l); break;
+	case dst_type_double:	DCG_FOLD_CAST(value.d); break;
+	default:				return 0;
+	}
+
+	#undef DCG_FOLD_CAST
+
+	return 1;
+}
+
+// Arithmetic matches the instructions for the type, integers wrap and anything that would trap is left to run
+
+static int dcg_fold_binary(dst_exp_type op, dvm_var left, dvm_var right, dst_type type, dvm_var *out_value, dst_type *out_type)
+{
+	#define DCG_FOLD_COMPARISON(field) \
+		case dst_exp_type_eq:			out_value->i = left.field == right.field; *out_type = dst_type_integer; break; \
+		case dst_exp_type_less:			out_value->i = left.field < right.field; *out_type = dst_type_integer; break; \
+		case dst_exp_type_less_eq:		out_value->i = left.field <= right.field; *out_type = dst_type_integer; break; \
+		case dst_exp_type_greater:		out_value->i = left.field > right.field; *out_type = dst_type_integer; break; \
+		case dst_exp_type_greater_eq:	out_value->i = left.field >= right.field; *out_type = dst_type_integer; break;
+
+	*out_type = type;
+
+	switch (type)
+	{
+	case dst_type_integer:
+		switch (op)
+		{
+		case dst_exp_type_addition:			out_value->i = (int32_t)((uint32_t)left.i + (uint32_t)right.i); break;
+		case dst_exp_type_subtraction:		out_value->i = (int32_t)((uint32_t)left.i - (uint32_t)right.i); break;
+		case dst_exp_type_multiplication:	out_value->i = (int32_t)((uint32_t)left.i * (uint32_t)right.i); break;
+		case dst_exp_type_division:
+		case dst_exp_type_modulo:
+			if (right.i == 0 || (left.i == INT32_MIN && right.i == -1))
+				return 0;
+
+			out_value->i = op == dst_exp_type_division ? left.i / right.i : left.i % right.i;
+			break;
+		case dst_exp_type_shift_left:		out_value->i = (int32_t)((uint32_t)left.i << (right.i & 31)); break;
+		case dst_exp_type_shift_right:		out_value->i = left.i >> (right.i & 31); break;
+		case dst_exp_type_and:
+		case dst_exp_type_bit_and:			out_value->i = left.i & right.i; break;
+		case dst_exp_type_or:
+		case dst_exp_type_bit_or:			out_value->i = left.i | right.i; break;
+		case dst_exp_type_bit_xor:			out_value->i = left.i ^ right.i; break;
+		DCG_FOLD_COMPARISON(i)
+		default:							return 0;
+		}
+		break;
+
+	case dst_type_long:
+		switch (op)
+		{
+		case dst_exp_type_addition:			out_value->l = (int64_t)((uint64_t)left.l + (uint64_t)right.l); break;
+		case dst_exp_type_subtraction:		out_value->l = (int64_t)((uint64_t)left.l - (uint64_t)right.l); break;
+		case dst_exp_type_multiplication:	out_value->l = (int64_t)((uint64_t)left.l * (uint64_t)right.l); break;
+		case dst_exp_type_division:
+		case dst_exp_type_modulo:
+			if (right.l == 0 || (left.l == INT64_MIN && right.l == -1))
+				return 0;
+
+			out_value->l = op == dst_exp_type_division ? left.l / right.l : left.l % right.l;
+			break;
+		case dst_exp_type_shift_left:		out_value->l = (int64_t)((uint64_t)left.l << (right.i & 63)); break;
+		case dst_exp_type_shift_right:		out_value->l = left.l >> (right.i & 63); break;
+		case dst_exp_type_bit_and:			out_value->l = left.l & right.l; break;
+		case dst_exp_type_bit_or:			out_value->l = left.l | right.l; break;
+		case dst_exp_type_bit_xor:			out_value->l = left.l ^ right.l; break;
+		DCG_FOLD_COMPARISON(l)
+		default:							return 0;
+		}
+		break;
+
+	case dst_type_real:
+		switch (op)
+		{
+		case dst_exp_type_addition:			out_value->f = left.f + right.f; break;
+		case dst_exp_type_subtraction:		out_value->f = left.f - right.f; break;
+		case dst_exp_type_multiplication:	out_value->f = left.f * right.f; break;
+		case dst_exp_type_division:			out_value->f = left.f / right.f; break;
+		DCG_FOLD_COMPARISON(f)
+		default:							return 0;
+		}
+		break;
+
+	case dst_type_double:
+		switch (op)
+		{
+		case dst_exp_type_addition:			out_value->d = left.d + right.d; break;
+		case dst_exp_type_subtraction:		out_value->d = left.d - right.d; break;
+		case dst_exp_type_multiplication:	out_value->d = left.d * right.d; break;
+		case dst_exp_type_division:			out_value->d = left.d / right.d; break;
+		DCG_FOLD_COMPARISON(d)
+		default:							return 0;
+		}
+		break;
+
+	case dst_type_string:
+		switch (op)
+		{
+		case dst_exp_type_eq:				out_value->i = left.s == right.s; *out_type = dst_type_integer; break;
+		default:							return 0;
+		}
+		break;
+
+	default:
+		return 0;
+	}
+
+	#undef DCG_FOLD_COMPARISON
+
+	return 1;
+}
+
+int dcg_fold_constant(
+	dst_exp *exp,
+	dvm_var *out_value,
+	dst_type *out_type,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc
+	)
+{
+	// Every bit of the result is written, so folded values are the same from one compile to the next
+
+	memset(out_value, 0, sizeof(dvm_var));
+
+	switch (exp->type)
+	{
+	case dst_exp_type_integer:
+		out_value->i = exp->integer.value;
+		*out_type = dst_type_integer;
+		return 1;
+
+	case dst_exp_type_real:
+		out_value->f = exp->real.value;
+		*out_type = dst_type_real;
+		return 1;
+
+	case dst_exp_type_long:
+		out_value->l = exp->long_integer.value;
+		*out_type = dst_type_long;
+		return 1;
+
+	case dst_exp_type_double:
+		out_value->d = exp->double_real.value;
+		*out_type = dst_type_double;
+		return 1;
+
+	case dst_exp_type_string:
+		// The folded value is the interned string, the same one the program will see
+
+		if (module->vm == NULL)
+			return 0;
+
+		out_value->s = dvm_intern_string(exp->string.value->text, exp->string.value->length, module->vm);
+		*out_type = dst_type_string;
+		return out_value->s != NULL;
+
+	case dst_exp_type_variable:
+	{
+		// Locals shadow globals, and only constants have a value known now
+
+		if (reg_alloc != NULL && dcg_map(exp->variable.id, reg_alloc) != NULL)
+			return 0;
+
+		dcg_global *global = dcg_find_global(exp->variable.id, module);
+
+		if (global == NULL || !global->is_const)
+			return 0;
+
+		*out_value = global->value;
+		*out_type = global->type;
+		return 1;
+	}
+
+	case dst_exp_type_cast:
+	{
+		dvm_var		value;
+		dst_type	type;
+
+		if (!dcg_fold_constant(exp->cast.value, &value, &type, module, reg_alloc))
+			return 0;
+
+		*out_type = exp->cast.dest_type;
+		return dcg_fold_cast(value, type, exp->cast.dest_type, out_value);
+	}
+
+	case dst_exp_type_not:
+	{
+		dvm_var		value;
+		dst_type	type;
+
+		if (!dcg_fold_constant(exp->unary.value, &value, &type, module, reg_alloc) || type != dst_type_integer)
+			return 0;
+
+		out_value->i = !value.i;
+		*out_type = dst_type_integer;
+		return 1;
+	}
+
+	case dst_exp_type_addition:
+	case dst_exp_type_subtraction:
+	case dst_exp_type_multiplication:
+	case dst_exp_type_division:
+	case dst_exp_type_modulo:
+	case dst_exp_type_shift_left:
+	case dst_exp_type_shift_right:
+	case dst_exp_type_bit_and:
+	case dst_exp_type_bit_or:
+	case dst_exp_type_bit_xor:
+	case dst_exp_type_and:
+	case dst_exp_type_or:
+	case dst_exp_type_eq:
+	case dst_exp_type_less:
+	case dst_exp_type_less_eq:
+	case dst_exp_type_greater:
+	case dst_exp_type_greater_eq:
+	{
+		dvm_var		left, right;
+		dst_type	left_type, right_type;
+
+		if (!dcg_fold_constant(exp->binary.left, &left, &left_type, module, reg_alloc) ||
+			!dcg_fold_constant(exp->binary.right, &right, &right_type, module, reg_alloc))
+		{
+			return 0;
+		}
+
+		// Mismatched operands aren't folded, so the error is reported where the code is generated
+
+		if (exp->type == dst_exp_type_shift_left || exp->type == dst_exp_type_shift_right)
+		{
+			if (right_type != dst_type_integer)
+				return 0;
+		}
+		else if (left_type != right_type)
+		{
+			return 0;
+		}
+
+		return dcg_fold_binary(exp->type, left, right, left_type, out_value, out_type);
+	}
+
+	default:
+		return 0;
+	}
+}
+
+int dcg_import_global_list(
+	dst_global_list *list,
+	dcg_proc_decl_table *module,
+	dvm_context *vm,
+	dsc_memory *mem
+	)
+{
+	if (list == NULL)
+		return 1;
+
+	size_t count = 0;
+	dst_global_list *current = list;
+
+	do
+	{
+		++count;
+		current = current->next;
+	} while (current != list);
+
+	module->globals = (dcg_global *)dsc_alloc(sizeof(dcg_global) * count, mem);
+	module->global_count = 0;
+
+	if (module->globals == NULL)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	do
+	{
+		dst_global	*decl = current->value;
+		dcg_global	*global = &module->globals[module->global_count];
+
+		if (dcg_find_global(decl->id, module) != NULL)
+		{
+			dsc_error("invalid global, %s is already declared.", decl->id->text);
+			return 0;
+		}
+
+		global->id = decl->id;
+		global->is_const = decl->is_const;
+		global->index = 0;
+
+		// Initial values are folded now, a global without one starts out zeroed
+
+		if (decl->value != NULL)
+		{
+			if (!dcg_fold_constant(decl->value, &global->value, &global->type, module, NULL))
+			{
+				dsc_error("invalid global, %s must be initialized with a constant expression.", decl->id->text);
+				return 0;
+			}
+		}
+		else
+		{
+			if (dst_type_is_struct(decl->type))
+			{
+				dsc_error("invalid global, %s can't be a struct.", decl->id->text);
+				return 0;
+			}
+
+			memset(&global->value, 0, sizeof(dvm_var));
+			global->type = decl->type;
+		}
+
+		// A string in the data segment would be a pointer into this context, which a cached image can't hold
+
+		if (!global->is_const && global->type == dst_type_string)
+		{
+			dsc_error("invalid global, %s can't be a string, only constants can.", decl->id->text);
+			return 0;
+		}
+
+		// Constants are only ever folded, mutable globals get a slot in the context's data segment
+
+		if (!global->is_const)
+		{
+			dvm_var *slot = dvm_context_push_globals(1, vm);
+
+			if (slot == NULL)
+			{
+				dsc_error("invalid global, %s doesn't fit in the data segment.", decl->id->text);
+				return 0;
+			}
+
+			*slot = global->value;
+			global->index = vm->global_count - 1;
+		}
+
+		++module->global_count;
+		current = current->next;
+
+	} while (current != list);
+
+	return 1;
+}
@@ -0,0 +1,207 @@
+#include "common.h"
+
+// Only procedures whose whole body is one return of a scalar expression are inlined, and only with arguments
+// that can be evaluated any number of times, so putting them in place of the parameters changes nothing but the call
+
+static int dcg_inline_is_scalar(dst_type type)
+{
+	return type == dst_type_integer || type == dst_type_real || type == dst_type_long || type == dst_type_double;
+}
+
+static dst_proc_param *dcg_inline_find_param(dsc_atom *id, dst_proc_param_list *params)
+{
+	dst_proc_param_list *current = params;
+
+	if (current == NULL)
+		return NULL;
+
+	do
+	{
+		if (current->value->id == id)
+			return current->value;
+
+		current = current->next;
+
+	} while (current != params);
+
+	return NULL;
+}
+
+// The body can be made of literals, parameters and the operators that don't need anything else
+
+static int dcg_inline_is_simple(dst_exp *exp, dst_proc_param_list *params)
+{
+	switch (exp->type)
+	{
+	case dst_exp_type_variable:
+		return dcg_inline_find_param(exp->variable.id, params) != NULL;
+
+	case dst_exp_type_integer:
+	case dst_exp_type_real:
+	case dst_exp_type_long:
+	case dst_exp_type_double:
+		return 1;
+
+	case dst_exp_type_cast:
+		return dcg_inline_is_simple(exp->cast.value, params);
+
+	case dst_exp_type_not:
+		return dcg_inline_is_simple(exp->unary.value, params);
+
+	case dst_exp_type_addition:
+	case dst_exp_type_subtraction:
+	case dst_exp_type_multiplication:
+	case dst_exp_type_division:
+	case dst_exp_type_modulo:
+	case dst_exp_type_shift_left:
+	case dst_exp_type_shift_right:
+	case dst_exp_type_bit_and:
+	case dst_exp_type_bit_or:
+	case dst_exp_type_bit_xor:
+	case dst_exp_type_and:
+	case dst_exp_type_or:
+	case dst_exp_type_eq:
+	case dst_exp_type_less:
+	case dst_exp_type_less_eq:
+	case dst_exp_type_greater:
+	case dst_exp_type_greater_eq:
+		return dcg_inline_is_simple(exp->binary.left, params) && dcg_inline_is_simple(exp->binary.right, params);
+
+	default:
+		return 0;
+	}
+}
+
+// The type of an argument that's a literal or a variable, or the string type for anything else
+
+static dst_type dcg_inline_argument_type(dst_exp *exp, dcg_proc_decl_table *module, dcg_register_allocator *reg_alloc)
+{
+	switch (exp->type)
+	{
+	case dst_exp_type_integer:
+		return dst_type_integer;
+	case dst_exp_type_real:
+		return dst_type_real;
+	case dst_exp_type_long:
+		return dst_type_long;
+	case dst_exp_type_double:
+		return dst_type_double;
+
+	case dst_exp_type_variable:
+	{
+		dcg_var_binding *binding = dcg_map(exp->variable.id, reg_alloc);
+
+		if (binding != NULL)
+			return binding->type;
+
+		dcg_global *global = dcg_find_global(exp->variable.id, module);
+
+		if (global != NULL)
+			return global->type;
+
+		return dst_type_string;
+	}
+
+	default:
+		return dst_type_string;
+	}
+}
+
+static dst_exp *dcg_inline_substitute(dst_exp *exp, dst_proc_param_list *params, dst_exp_list *arguments, dsc_memory *mem)
+{
+	switch (exp->type)
+	{
+	case dst_exp_type_variable:
+	{
+		// The argument in the same place as the parameter
+
+		dst_proc_param_list *param = params;
+		dst_exp_list *argument = arguments;
+
+		while (param->value->id != exp->variable.id)
+		{
+			param = param->next;
+			argument = argument->next;
+		}
+
+		return argument->value;
+	}
+
+	case dst_exp_type_cast:
+		return dst_create_exp_cast(exp->cast.dest_type, dcg_inline_substitute(exp->cast.value, params, arguments, mem), mem);
+
+	case dst_exp_type_not:
+		return dst_create_exp_unary(exp->type, dcg_inline_substitute(exp->unary.value, params, arguments, mem), mem);
+
+	case dst_exp_type_integer:
+	case dst_exp_type_real:
+	case dst_exp_type_long:
+	case dst_exp_type_double:
+		return exp;
+
+	default:
+		return dst_create_exp_binary(
+			exp->type,
+			dcg_inline_substitute(exp->binary.left, params, arguments, mem),
+			dcg_inline_substitute(exp->binary.right, params, arguments, mem),
+			mem);
+	}
+}
+
+dst_exp *dcg_inline_call(dst_exp *exp, dcg_proc_decl *callee, dcg_proc_decl_table *module, dcg_register_allocator *reg_alloc, dsc_memory *mem)
+{
+	dst_proc *proc = callee->proc;
+
+	if (proc == NULL || proc == module->proc)
+		return NULL;
+
+	if (proc->out_types == NULL || proc->out_types->next != proc->out_types || !dcg_inline_is_scalar(proc->out_types->value))
+		return NULL;
+
+	// A block of a single return counts as the return
+
+	dst_statement *body = proc->statement;
+
+	if (body->type == dst_statement_type_block &&
+		body->block.statements != NULL &&
+		body->block.statements->next == body->block.statements)
+	{
+		body = body->block.statements->value;
+	}
+
+	if (body->type != dst_statement_type_return ||
+		body->ret.values == NULL ||
+		body->ret.values->next != body->ret.values ||
+		!dcg_inline_is_simple(body->ret.values->value, proc->in_params))
+	{
+		return NULL;
+	}
+
+	// Every argument has to be there and be of its parameter's type, a mismatch is left to the call to report
+
+	dst_proc_param_list *param = proc->in_params;
+	dst_exp_list *argument = exp->call.parameters;
+
+	if (param != NULL)
+	{
+		do
+		{
+			if (argument == NULL ||
+				!dcg_inline_is_scalar(param->value->type) ||
+				dcg_inline_argument_type(argument->value, module, reg_alloc) != param->value->type)
+				return NULL;
+
+			param = param->next;
+			argument = argument->next;
+
+			if (argument == exp->call.parameters)
+				argument = NULL;
+
+		} while (param != proc->in_params);
+	}
+
+	if (argument != NULL)
+		return NULL;
+
+	return dcg_inline_substitute(body->ret.values->value, proc->in_params, exp->call.parameters, mem);
+}
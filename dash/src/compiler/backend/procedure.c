@@ -1,7 +1,7 @@
 #include "common.h"
 #include "codegen.h"
 
-dcg_proc_decl_list *dcg_import_proc_decls(dst_proc_list *procs, dcg_proc_decl_list *list, dvm_context *context, dsc_memory *mem)
+int dcg_import_proc_decls(dst_proc_list *procs, dcg_proc_decl_table *table, dvm_context *context, dsc_memory *mem)
 {
 	dst_proc_list *current = procs;
 
@@ -9,21 +9,22 @@ dcg_proc_decl_list *dcg_import_proc_decls(dst_proc_list *procs, dcg_proc_decl_li
 
 	while (current != NULL)
 	{
-		dcg_proc_decl *decl = (dcg_proc_decl *)dsc_alloc(sizeof(dcg_proc_decl), mem);
+		dcg_proc_decl *decl = dcg_create_proc_decl(
+			current->value->id,
+			current->value->in_params,
+			current->value->out_types,
+			base_index,
+			mem);
 
-		if (decl == NULL)
+		if (decl != NULL)
+			decl->proc = current->value;
+
+		if (!dcg_proc_decl_table_insert(decl, table))
 		{
 			dsc_error_oom();
-			break;
+			return 0;
 		}
 
-		decl->id = current->value->id;
-		decl->index = base_index;
-		decl->in_params = current->value->in_params;
-		decl->out_types = current->value->out_types;
-
-		list = dcg_append_proc_decl_list(list, decl, mem);
-
 		current = current->next;
 		++base_index;
 
@@ -31,17 +32,20 @@ dcg_proc_decl_list *dcg_import_proc_decls(dst_proc_list *procs, dcg_proc_decl_li
 			break;
 	}
 
-	return list;
+	return 1;
 }
 
 int dcg_import_procedure_list(
 	dst_proc_list *list,
-	dcg_proc_decl_list *module,
+	dcg_proc_decl_table *module,
 	dvm_context *vm,
 	dsc_memory *mem
 	)
 {
-	module = dcg_import_proc_decls(list, module, vm, mem);
+	if (!dcg_import_proc_decls(list, module, vm, mem))
+	{
+		return 0;
+	}
 
 	dst_proc_list *current = list;
 
@@ -63,6 +67,7 @@ int dcg_import_procedure_list(
 
 int dcg_import_procedure_params(
 	dst_proc_param_list *params,
+	dcg_proc_decl_table *module,
 	dcg_register_allocator *reg_alloc,
 	dsc_memory *mem
 	)
@@ -74,7 +79,9 @@ int dcg_import_procedure_params(
 
 	do
 	{
-		if (dcg_push_named(current->value->id, current->value->type, reg_alloc) == ~0)
+		dst_type type = current->value->type;
+
+		if (dcg_push_named_window(current->value->id, type, dcg_type_size(type, module), reg_alloc) == ~0)
 		{
 			dsc_error_oor();
 			return 0;
@@ -89,13 +96,13 @@ int dcg_import_procedure_params(
 
 int dcg_import_procedure(
 	dst_proc *proc,
-	dcg_proc_decl_list *module,
+	dcg_proc_decl_table *module,
 	dvm_context *vm,
 	dsc_memory *mem
 	)
 {
-	size_t in_count = dst_proc_param_list_count(proc->in_params);
-	size_t out_count = dst_type_list_count(proc->out_types);
+	size_t in_count = dcg_proc_in_size(proc->in_params, module);
+	size_t out_count = dcg_type_list_size(proc->out_types, module);
 
 	if (in_count > 255 || out_count > 255)
 	{
@@ -112,7 +119,18 @@ int dcg_import_procedure(
 		return 0;
 	}
 
-	if (!dcg_import_procedure_params(proc->in_params, &reg_alloc, mem))
+	module->proc = proc;
+	module->proc_hash = dsh_hash(proc->id->text);
+
+	if (!dcg_profile_site(dvm_profile_kind_proc, proc->first_site, 0, 0, module, &bc_emit))
+	{
+		dcg_cancel_proc_emit(&reg_alloc, &bc_emit, vm);
+
+		dsc_error_oom();
+		return 0;
+	}
+
+	if (!dcg_import_procedure_params(proc->in_params, module, &reg_alloc, mem))
 	{
 		dcg_cancel_proc_emit(&reg_alloc, &bc_emit, vm);
 
@@ -128,6 +146,7 @@ int dcg_import_procedure(
 
 	if (!dcg_finalize_proc_emit(
 		proc,
+		module,
 		&reg_alloc,
 		&bc_emit,
 		vm))
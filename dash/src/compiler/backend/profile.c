@@ -0,0 +1,81 @@
+#include "common.h"
+
+// Calls at least this fraction of the hottest call in the profile are worth inlining
+#define DCG_PROFILE_HOT_CALL_RATIO 16
+
+// Sites are numbered from the first in their procedure, so they're found again after the rest of the module changes
+
+static const dvm_profile_site *dcg_profile_find(uint8_t kind, uint32_t site, dcg_proc_decl_table *module)
+{
+	return dvm_profile_find(module->proc_hash, site - module->proc->first_site, kind, module->vm);
+}
+
+// Records where a site's instruction is in the context, its pc in the procedure doesn't change once it's written
+
+int dcg_profile_site(uint8_t kind, uint32_t site, int inverted, size_t location, dcg_proc_decl_table *module, dcg_bc_emitter *bc_emit)
+{
+	if (!module->vm->profile.recording)
+	{
+		return 1;
+	}
+
+	return dvm_profile_push_site(
+		module->proc_hash,
+		site - module->proc->first_site,
+		kind,
+		(uint8_t)(inverted != 0),
+		bc_emit->vm_emitter.bytecode_start + (uint32_t)location,
+		module->vm) != NULL;
+}
+
+// An inlined call has no instruction to count, it keeps what the loaded profile counted so it stays inlined
+
+int dcg_profile_inlined_site(uint32_t site, dcg_proc_decl_table *module)
+{
+	if (!module->vm->profile.recording)
+	{
+		return 1;
+	}
+
+	const dvm_profile_site *found = dcg_profile_find(dvm_profile_kind_call, site, module);
+
+	dvm_profile_site *result = dvm_profile_push_site(
+		module->proc_hash,
+		site - module->proc->first_site,
+		dvm_profile_kind_call,
+		0,
+		DVM_PROFILE_NO_PC,
+		module->vm);
+
+	if (result == NULL)
+	{
+		return 0;
+	}
+
+	result->count = found != NULL ? found->count : 0;
+
+	return 1;
+}
+
+int dcg_profile_prefers_else(uint32_t site, dcg_proc_decl_table *module)
+{
+	const dvm_profile_site *found = dcg_profile_find(dvm_profile_kind_branch, site, module);
+
+	return found != NULL && found->else_count * 2 > found->count;
+}
+
+int dcg_profile_is_hot_call(uint32_t site, dcg_proc_decl_table *module)
+{
+	const dvm_profile_site *found = dcg_profile_find(dvm_profile_kind_call, site, module);
+
+	return found != NULL && found->count > 0 && found->count * DCG_PROFILE_HOT_CALL_RATIO >= module->vm->profile.hottest_call;
+}
+
+// A procedure is only cold when the profile saw it and it never ran, one it doesn't know is compiled as usual
+
+int dcg_profile_is_cold(dcg_proc_decl_table *module)
+{
+	const dvm_profile_site *found = dcg_profile_find(dvm_profile_kind_proc, module->proc->first_site, module);
+
+	return found != NULL && found->count == 0;
+}
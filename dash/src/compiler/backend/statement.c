@@ -1,10 +1,427 @@
 #include "common.h"
 #include "codegen.h"
 
+// Arms of an if statement this cheap are evaluated unconditionally and blended with a select,
+// a mispredicted branch costs more than running a few extra instructions
+
+#define DCG_SELECT_MAX_COST 4
+
+// The instruction count of an expression, or more than the maximum if it can trap or has side effects
+size_t dcg_speculation_cost(dst_exp *exp)
+{
+	switch (exp->type)
+	{
+	case dst_exp_type_variable:
+		return 0;
+
+	case dst_exp_type_integer:
+	case dst_exp_type_real:
+	case dst_exp_type_long:
+	case dst_exp_type_double:
+	case dst_exp_type_string:
+		return 1;
+
+	case dst_exp_type_cast:
+		return 1 + dcg_speculation_cost(exp->cast.value);
+
+	case dst_exp_type_field:
+		return dcg_speculation_cost(exp->field.value);
+
+	case dst_exp_type_not:
+		return 1 + dcg_speculation_cost(exp->unary.value);
+
+	case dst_exp_type_addition:
+	case dst_exp_type_subtraction:
+	case dst_exp_type_multiplication:
+	case dst_exp_type_shift_left:
+	case dst_exp_type_shift_right:
+	case dst_exp_type_bit_and:
+	case dst_exp_type_bit_or:
+	case dst_exp_type_bit_xor:
+	case dst_exp_type_and:
+	case dst_exp_type_or:
+	case dst_exp_type_eq:
+	case dst_exp_type_less:
+	case dst_exp_type_less_eq:
+	case dst_exp_type_greater:
+	case dst_exp_type_greater_eq:
+		return 1 + dcg_speculation_cost(exp->binary.left) + dcg_speculation_cost(exp->binary.right);
+
+	default:
+		return DCG_SELECT_MAX_COST + 1;
+	}
+}
+
+// Finds the assignment of a single value to a single variable in an arm, looking through a block of one statement
+dst_statement *dcg_select_arm(dst_statement *statement)
+{
+	if (statement->type == dst_statement_type_block &&
+		statement->block.statements != NULL &&
+		statement->block.statements->next == statement->block.statements)
+	{
+		statement = statement->block.statements->value;
+	}
+
+	if (statement->type != dst_statement_type_assignment ||
+		statement->assignment.variables->next != statement->assignment.variables ||
+		statement->assignment.values->next != statement->assignment.values ||
+		dcg_speculation_cost(statement->assignment.values->value) > DCG_SELECT_MAX_COST)
+	{
+		return NULL;
+	}
+
+	return statement;
+}
+
+int dcg_import_select_value(
+	dst_exp *exp,
+	dcg_var_binding *var,
+	size_t *out_reg,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit,
+	dsc_memory *mem
+	)
+{
+	dst_type_list *type;
+
+	if (!dcg_import_expression(exp, out_reg, &type, module, reg_alloc, bc_emit, mem))
+	{
+		return 0;
+	}
+
+	if (type == NULL || dst_type_list_is_composite(type))
+	{
+		dsc_error("invalid assignment, every expression must produce a value.");
+		return 0;
+	}
+
+	if (type->value != var->type)
+	{
+		dsc_error("invalid assignment, trying to assign the wrong type to variable.");
+		return 0;
+	}
+
+	return 1;
+}
+
+// Compiles 'if (c) x = a; else x = b;' and 'if (c) x = a;' to straight line code ending in a select
+int dcg_import_select(
+	dst_statement *statement,
+	dst_statement *true_arm,
+	dst_statement *false_arm,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit,
+	dsc_memory *mem
+	)
+{
+	dsc_atom		*name = true_arm->assignment.variables->value;
+	dcg_var_binding	*var = dcg_map(name, reg_alloc);
+
+	if (var == NULL)
+	{
+		dsc_error("invalid assignment, cannot find variable (%s).", name->text);
+		return 0;
+	}
+
+	size_t			 start_register = dcg_next_reg_index(reg_alloc);
+	size_t			 cond_register;
+	dst_type_list	*cond_type;
+	size_t			 true_register;
+	size_t			 false_register;
+
+	if (!dcg_import_expression(statement->if_else.condition, &cond_register, &cond_type, module, reg_alloc, bc_emit, mem))
+	{
+		return 0;
+	}
+
+	if (!dst_type_list_is_integer(cond_type))
+	{
+		dsc_error("invalid if statement, conditional must be an integer.");
+		return 0;
+	}
+
+	if (!dcg_import_select_value(true_arm->assignment.values->value, var, &true_register, module, reg_alloc, bc_emit, mem))
+	{
+		return 0;
+	}
+
+	if (false_arm == NULL)
+	{
+		// Without an else the variable keeps its value when the condition fails
+
+		dvm_bc *bc = dcg_push_bc(1, bc_emit);
+
+		if (bc == NULL)
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		bc[0].opcode = dvm_opcode_select;
+		bc[0].a = cond_register;
+		bc[0].b = true_register;
+		bc[0].c = var->reg_index;
+	}
+	else
+	{
+		if (!dcg_import_select_value(false_arm->assignment.values->value, var, &false_register, module, reg_alloc, bc_emit, mem))
+		{
+			return 0;
+		}
+
+		// Blend into a temporary, the variable may still be read by the condition or either value
+
+		int copy_false = dcg_is_named(false_register, reg_alloc);
+		size_t blend_register = copy_false ? dcg_push_temp(reg_alloc) : false_register;
+
+		if (blend_register == ~0)
+		{
+			dsc_error_oor();
+			return 0;
+		}
+
+		dvm_bc *bc = dcg_push_bc(copy_false ? 3 : 2, bc_emit);
+
+		if (bc == NULL)
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		if (copy_false)
+		{
+			bc[0].opcode = dvm_opcode_mov;
+			bc[0].a = false_register;
+			bc[0].c = blend_register;
+
+			++bc;
+		}
+
+		bc[0].opcode = dvm_opcode_select;
+		bc[0].a = cond_register;
+		bc[0].b = true_register;
+		bc[0].c = blend_register;
+
+		bc[1].opcode = dvm_opcode_mov;
+		bc[1].a = blend_register;
+		bc[1].c = var->reg_index;
+	}
+
+	dcg_pop_temp_past(start_register, reg_alloc);
+
+	return 1;
+}
+
+// Whether a statement, or any statement nested in it, assigns to a variable
+int dcg_assigns_variable(dst_statement *statement, dsc_atom *name)
+{
+	switch (statement->type)
+	{
+	case dst_statement_type_assignment:
+	{
+		dst_id_list *cur_var = statement->assignment.variables;
+
+		do
+		{
+			if (cur_var->value == name)
+				return 1;
+
+			cur_var = cur_var->next;
+		} while (cur_var != statement->assignment.variables);
+
+		return 0;
+	}
+
+	case dst_statement_type_block:
+	{
+		dst_statement_list *current = statement->block.statements;
+
+		if (current != NULL)
+		{
+			do
+			{
+				if (dcg_assigns_variable(current->value, name))
+					return 1;
+
+				current = current->next;
+			} while (current != statement->block.statements);
+		}
+
+		return 0;
+	}
+
+	case dst_statement_type_if:
+		return dcg_assigns_variable(statement->if_else.true_statement, name) ||
+			(statement->if_else.false_statement != NULL && dcg_assigns_variable(statement->if_else.false_statement, name));
+
+	case dst_statement_type_while:
+		return dcg_assigns_variable(statement->while_loop.loop_statement, name);
+
+	case dst_statement_type_for:
+		return dcg_assigns_variable(statement->for_loop.loop_statement, name);
+
+	case dst_statement_type_switch:
+	{
+		dst_switch_case_list *current = statement->switch_case.cases;
+
+		if (current != NULL)
+		{
+			do
+			{
+				if (dcg_assigns_variable(current->value->statement, name))
+					return 1;
+
+				current = current->next;
+			} while (current != statement->switch_case.cases);
+		}
+
+		return 0;
+	}
+
+	default:
+		return 0;
+	}
+}
+
+// An atom that isn't interned, so a binding made with it can't be named by the program
+dsc_atom *dcg_create_hidden_atom(dsc_memory *mem)
+{
+	dsc_atom *atom = (dsc_atom *)dsc_alloc(sizeof(dsc_atom), mem);
+
+	if (atom == NULL)
+		return NULL;
+
+	atom->hash = 0;
+	atom->length = 0;
+	atom->next_in_bucket = NULL;
+	atom->text[0] = 0;
+
+	return atom;
+}
+
+// Evaluates a bound of a for loop into the register that holds it for the whole loop
+int dcg_import_for_bound(
+	dst_exp *exp,
+	size_t bound_register,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit,
+	dsc_memory *mem
+	)
+{
+	size_t			 exp_register;
+	dst_type_list	*exp_type;
+
+	if (!dcg_import_expression(exp, &exp_register, &exp_type, module, reg_alloc, bc_emit, mem))
+	{
+		return 0;
+	}
+
+	if (exp_type == NULL || !dst_type_list_is_integer(exp_type))
+	{
+		dsc_error("invalid for statement, bounds must be integers.");
+		return 0;
+	}
+
+	if (exp_register != bound_register)
+	{
+		dvm_bc *bc = dcg_push_bc(1, bc_emit);
+
+		if (bc == NULL)
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		bc[0].opcode = dvm_opcode_mov;
+		bc[0].a = exp_register;
+		bc[0].c = bound_register;
+	}
+
+	if (dcg_is_temp(exp_register, reg_alloc))
+	{
+		dcg_pop_temp_past(exp_register, reg_alloc);
+	}
+
+	return 1;
+}
+
+// Writes a conditional jmp over the code that follows, when the counter isn't below the limit
+int dcg_push_loop_guard(size_t counter_register, size_t limit_register, dcg_register_allocator *reg_alloc, dcg_bc_emitter *bc_emit)
+{
+	size_t cond_register = dcg_push_temp(reg_alloc);
+
+	if (cond_register == ~0)
+	{
+		dsc_error_oor();
+		return 0;
+	}
+
+	dvm_bc *bc = dcg_push_bc(2, bc_emit);
+
+	if (bc == NULL)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	bc[0].opcode = dvm_opcode_cmpi_l;
+	bc[0].a = counter_register;
+	bc[0].b = limit_register;
+	bc[0].c = cond_register;
+
+	bc[1].opcode = dvm_opcode_jmp_cn;
+	bc[1].a = cond_register;
+
+	dcg_pop_temp_past(cond_register, reg_alloc);
+
+	return 1;
+}
+
+// Writes the fused increment, compare and branch back to the start of a loop body
+int dcg_push_loop_back_edge(size_t counter_register, size_t limit_register, size_t body_loc, dcg_bc_emitter *bc_emit)
+{
+	size_t loop_loc = dcg_bc_written(bc_emit);
+	dvm_bc *bc = dcg_push_bc(1, bc_emit);
+
+	if (bc == NULL)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	int8_t offset = (int8_t)((int)body_loc - (int)loop_loc);
+
+	bc[0].opcode = dvm_opcode_loop;
+	bc[0].a = counter_register;
+	bc[0].b = limit_register;
+	bc[0].c = *(uint8_t *)&offset;
+
+	return 1;
+}
+
+// Appends another copy of bytecode that's already been written, loop bodies only use relative jmps so they can be repeated
+int dcg_repeat_bc(size_t start_loc, size_t length, dcg_bc_emitter *bc_emit)
+{
+	dvm_bc *copy = dcg_push_bc(length, bc_emit);
+
+	if (copy == NULL && length != 0)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	memcpy(copy, dcg_bc_at(start_loc, bc_emit), sizeof(dvm_bc) * length);
+
+	return 1;
+}
+
 int dcg_import_statement(
 	dst_statement *statement,
 	dst_proc *procedure,
-	dcg_proc_decl_list *module,
+	dcg_proc_decl_table *module,
 	dcg_register_allocator *reg_alloc,
 	dcg_bc_emitter *bc_emit,
 	dsc_memory *mem
@@ -63,12 +480,13 @@ int dcg_import_statement(
 			// Push named registers for the variables and move the values into the registers
 
 			dst_type_list	*sub_val_type = exp_out_types;
-			size_t			 sub_val_index = 0;
+			size_t			 sub_val_offset = 0;
 
 			while (1)
 			{
-				size_t val_reg = exp_out_reg_start + sub_val_index;
-				size_t var_reg = dcg_push_named(cur_var->value, sub_val_type->value, reg_alloc);
+				size_t val_reg = exp_out_reg_start + sub_val_offset;
+				size_t val_size = dcg_type_size(sub_val_type->value, module);
+				size_t var_reg = dcg_push_named_window(cur_var->value, sub_val_type->value, val_size, reg_alloc);
 
 				if (var_reg == ~0)
 				{
@@ -78,24 +496,15 @@ int dcg_import_statement(
 
 				// Store the value in the variable, if it's not already there
 
-				if (var_reg != val_reg)
+				if (!dcg_push_move(val_reg, var_reg, sub_val_type->value, module, bc_emit))
 				{
-					dvm_bc *bc = dcg_push_bc(1, bc_emit);
-
-					if (bc == NULL)
-					{
-						dsc_error_oom();
-						return 0;
-					}
-
-					bc[0].opcode = dvm_opcode_mov;
-					bc[0].a = exp_out_reg_start + sub_val_index;
-					bc[0].c = var_reg;
+					dsc_error_oom();
+					return 0;
 				}
 
 				// Go to the next value of this expression
 
-				++sub_val_index;
+				sub_val_offset += val_size;
 				sub_val_type = sub_val_type->next;
 
 				// Go to the next var of this definition
@@ -176,45 +585,63 @@ int dcg_import_statement(
 			// Move each sub value into it's proper variable register, checking types along the way
 
 			dst_type_list *sub_val_type = exp_out_types;
-			size_t sub_val_index = 0;
+			size_t sub_val_offset = 0;
 
 			while (1)
 			{
-				size_t val_reg = exp_out_reg_start + sub_val_index;
+				size_t val_reg = exp_out_reg_start + sub_val_offset;
 				dcg_var_binding *var = dcg_map(cur_var->value, reg_alloc);
 
-				if (var == NULL)
+				if (var != NULL)
 				{
-					dsc_error("invalid assignment, cannot find variable (%s).", cur_var->value);
-					return 0;
-				}
+					if (var->type != sub_val_type->value)
+					{
+						dsc_error("invalid assignment, trying to assign the wrong type to variable.");
+						return 0;
+					}
 
-				if (var->type != sub_val_type->value)
-				{
-					dsc_error("invalid assignment, trying to assign the wrong type to variable.");
-					return 0;
+					// Store the value in the variable, if it's not already there
+
+					if (!dcg_push_move(val_reg, var->reg_index, var->type, module, bc_emit))
+					{
+						dsc_error_oom();
+						return 0;
+					}
 				}
+				else
+				{
+					// Assigning a global stores straight to its slot in the data segment
 
-				// Store the value in the variable, if it's not already there
+					dcg_global *global = dcg_find_global(cur_var->value, module);
 
-				if (var->reg_index != val_reg)
-				{
-					dvm_bc *bc = dcg_push_bc(1, bc_emit);
+					if (global == NULL)
+					{
+						dsc_error("invalid assignment, cannot find variable (%s).", cur_var->value->text);
+						return 0;
+					}
 
-					if (bc == NULL)
+					if (global->is_const)
 					{
-						dsc_error_oom();
+						dsc_error("invalid assignment, (%s) is a constant.", cur_var->value->text);
 						return 0;
 					}
 
-					bc[0].opcode = dvm_opcode_mov;
-					bc[0].a = exp_out_reg_start + sub_val_index;
-					bc[0].c = var->reg_index;
+					if (global->type != sub_val_type->value)
+					{
+						dsc_error("invalid assignment, trying to assign the wrong type to variable.");
+						return 0;
+					}
+
+					if (!dcg_push_global(dvm_opcode_gstor, global->index, val_reg, bc_emit))
+					{
+						dsc_error_oom();
+						return 0;
+					}
 				}
 
 				// Go to the next value of this expression
 
-				++sub_val_index;
+				sub_val_offset += dcg_type_size(sub_val_type->value, module);
 				sub_val_type = sub_val_type->next;
 
 				// Go to the next var of this definition
@@ -263,6 +690,7 @@ int dcg_import_statement(
 		call_exp.type = dst_exp_type_call;
 		call_exp.call.function = statement->call.function;
 		call_exp.call.parameters = statement->call.parameters;
+		call_exp.call.site = statement->call.site;
 
 		size_t			 out_reg;
 		dst_type_list	*out_type;
@@ -291,6 +719,8 @@ int dcg_import_statement(
 	{
 		size_t base_register = reg_alloc->vars_named_count;
 
+		dcg_push_scope(reg_alloc);
+
 		dst_statement_list *current = statement->block.statements;
 		if (current != NULL)
 		{
@@ -305,7 +735,7 @@ int dcg_import_statement(
 			} while (current != statement->block.statements);
 		}
 
-		dcg_pop_named_past(base_register, reg_alloc);
+		dcg_pop_scope(base_register, reg_alloc);
 
 		return 1;
 	}
@@ -315,6 +745,27 @@ int dcg_import_statement(
 		size_t			 cond_register;
 		dst_type_list	*cond_type;
 
+		// Assigning one variable in both arms doesn't need a branch
+
+		dst_statement *true_arm = dcg_select_arm(statement->if_else.true_statement);
+		dst_statement *false_arm = statement->if_else.false_statement == NULL ? NULL : dcg_select_arm(statement->if_else.false_statement);
+
+		// A select blends one register, so struct variables and globals keep the branch
+
+		dcg_var_binding *select_var = true_arm == NULL ? NULL : dcg_map(true_arm->assignment.variables->value, reg_alloc);
+
+		if (select_var == NULL || dst_type_is_struct(select_var->type))
+		{
+			true_arm = NULL;
+		}
+
+		if (true_arm != NULL &&
+			(statement->if_else.false_statement == NULL ||
+			 false_arm != NULL && false_arm->assignment.variables->value == true_arm->assignment.variables->value))
+		{
+			return dcg_import_select(statement, true_arm, false_arm, module, reg_alloc, bc_emit, mem);
+		}
+
 		// Write the if conditional first
 
 		if (!dcg_import_expression(statement->if_else.condition, &cond_register, &cond_type, module, reg_alloc, bc_emit, mem))
@@ -335,28 +786,41 @@ int dcg_import_statement(
 			dcg_pop_temp_past(cond_register, reg_alloc);
 		}
 
-		// Write the jmp that will skip the true block and execute the false block
+		// The arm the profile saw run more falls through, the other is jumped to
+
+		int prefer_else = statement->if_else.false_statement != NULL && dcg_profile_prefers_else(statement->if_else.site, module);
 
-		size_t	jmp_to_false_loc = dcg_bc_written(bc_emit);
-		dvm_bc *jmp_to_false = dcg_push_bc(1, bc_emit);
-		if (jmp_to_false == NULL)
+		dst_statement *first_statement = prefer_else ? statement->if_else.false_statement : statement->if_else.true_statement;
+		dst_statement *second_statement = prefer_else ? statement->if_else.true_statement : statement->if_else.false_statement;
+
+		// Write the jmp that will skip the first block and execute the second block
+
+		size_t	jmp_to_second_loc = dcg_bc_written(bc_emit);
+		dvm_bc *jmp_to_second = dcg_push_bc(1, bc_emit);
+		if (jmp_to_second == NULL)
 		{
 			dsc_error_oom();
 			return 0;
 		}
-		jmp_to_false[0].opcode = dvm_opcode_jmp_cn;
-		jmp_to_false[0].a = cond_register;
+		jmp_to_second[0].opcode = prefer_else ? dvm_opcode_jmp_c : dvm_opcode_jmp_cn;
+		jmp_to_second[0].a = cond_register;
 
-		// Write the true statement
+		if (!dcg_profile_site(dvm_profile_kind_branch, statement->if_else.site, prefer_else, jmp_to_second_loc, module, bc_emit))
+		{
+			dsc_error_oom();
+			return 0;
+		}
 
-		if (!dcg_import_statement(statement->if_else.true_statement, procedure, module, reg_alloc, bc_emit, mem))
+		// Write the first statement
+
+		if (!dcg_import_statement(first_statement, procedure, module, reg_alloc, bc_emit, mem))
 		{
 			return 0;
 		}
 
-		if (statement->if_else.false_statement != NULL)
+		if (second_statement != NULL)
 		{
-			// Write the jmp to skip the false statement after the true statement
+			// Write the jmp to skip the second statement after the first statement
 
 			size_t	jmp_to_end_loc = dcg_bc_written(bc_emit);
 			dvm_bc *jmp_to_end = dcg_push_bc(1, bc_emit);
@@ -367,21 +831,24 @@ int dcg_import_statement(
 			}
 			jmp_to_end[0].opcode = dvm_opcode_jmp_u;
 
-			// Write the false statement
+			// Write the second statement
 
-			size_t false_statement_start_loc = dcg_bc_written(bc_emit);
-			if (!dcg_import_statement(statement->if_else.false_statement, procedure, module, reg_alloc, bc_emit, mem))
+			size_t second_statement_start_loc = dcg_bc_written(bc_emit);
+			if (!dcg_import_statement(second_statement, procedure, module, reg_alloc, bc_emit, mem))
 			{
 				return 0;
 			}
-			size_t false_statement_end_loc = dcg_bc_written(bc_emit);
+			size_t second_statement_end_loc = dcg_bc_written(bc_emit);
 
 			// Resolve jmp offsets
 
-			int8_t offset1 = (int8_t)(((int)false_statement_start_loc) - ((int)jmp_to_false_loc));
-			jmp_to_false[0].c = *(uint8_t *)&offset1;
+			jmp_to_second = dcg_bc_at(jmp_to_second_loc, bc_emit);
+			jmp_to_end = dcg_bc_at(jmp_to_end_loc, bc_emit);
+
+			int8_t offset1 = (int8_t)(((int)second_statement_start_loc) - ((int)jmp_to_second_loc));
+			jmp_to_second[0].c = *(uint8_t *)&offset1;
 
-			int8_t offset2 = (int8_t)((int)false_statement_end_loc - (int)jmp_to_end_loc);
+			int8_t offset2 = (int8_t)((int)second_statement_end_loc - (int)jmp_to_end_loc);
 			jmp_to_end[0].c = *(uint8_t *)&offset2;
 		}
 		else
@@ -390,8 +857,10 @@ int dcg_import_statement(
 
 			// Resolve jmp offsets
 
-			int8_t offset1 = (int8_t)(((int)end_loc) - ((int)jmp_to_false_loc));
-			jmp_to_false[0].c = *(uint8_t *)&offset1;
+			jmp_to_second = dcg_bc_at(jmp_to_second_loc, bc_emit);
+
+			int8_t offset1 = (int8_t)(((int)end_loc) - ((int)jmp_to_second_loc));
+			jmp_to_second[0].c = *(uint8_t *)&offset1;
 		}
 
 		return 1;
@@ -456,6 +925,8 @@ int dcg_import_statement(
 
 		// Resolve the jmp offsets
 
+		jmp_break = dcg_bc_at(jmp_break_loc, bc_emit);
+
 		int8_t offset1 = (int8_t)((int)cond_loc - (int)jmp_continue_loc);
 		jmp_continue[0].c = *(uint8_t *)&offset1;
 
@@ -465,6 +936,197 @@ int dcg_import_statement(
 		return 1;
 	}
 
+	case dst_statement_type_for:
+	{
+		dsc_atom *name = statement->for_loop.variable;
+
+		if (dcg_assigns_variable(statement->for_loop.loop_statement, name))
+		{
+			dsc_error("invalid for statement, the loop variable (%s) can't be assigned in the loop.", name->text);
+			return 0;
+		}
+
+		size_t base_register = reg_alloc->vars_named_count;
+
+		dcg_push_scope(reg_alloc);
+
+		// The upper bound and the limit of the unrolled loop are kept in registers the body can't name
+
+		dsc_atom *high_name = dcg_create_hidden_atom(mem);
+		dsc_atom *limit_name = dcg_create_hidden_atom(mem);
+
+		if (high_name == NULL || limit_name == NULL)
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		size_t high_register = dcg_push_named(high_name, dst_type_integer, reg_alloc);
+		size_t limit_register = dcg_push_named(limit_name, dst_type_integer, reg_alloc);
+
+		if (high_register == ~0 || limit_register == ~0)
+		{
+			dsc_error_oor();
+			return 0;
+		}
+
+		// Both bounds are evaluated once, before the loop variable is in scope
+
+		if (!dcg_import_for_bound(statement->for_loop.low, limit_register, module, reg_alloc, bc_emit, mem) ||
+			!dcg_import_for_bound(statement->for_loop.high, high_register, module, reg_alloc, bc_emit, mem))
+		{
+			return 0;
+		}
+
+		size_t var_register = dcg_push_named(name, dst_type_integer, reg_alloc);
+
+		if (var_register == ~0)
+		{
+			dsc_error_oor();
+			return 0;
+		}
+
+		// The unrolled loop runs while a whole pass fits below the upper bound, limit = high - (unroll - 1).
+		// The upper bound is raised to at least INT_MIN + (unroll - 1) first so the subtract can't wrap, a limit of
+		// INT_MIN skips the unrolled loop and leaves every iteration to the remainder.
+		// The unroll factor isn't known until the body is written, so the immediates are filled in after.
+
+		size_t step_register = dcg_push_temp(reg_alloc);
+
+		if (step_register == ~0)
+		{
+			dsc_error_oor();
+			return 0;
+		}
+
+		size_t unroll_loc = dcg_bc_written(bc_emit);
+		dvm_bc *bc = dcg_push_bc(7, bc_emit);
+
+		if (bc == NULL)
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		bc[0].opcode = dvm_opcode_mov;
+		bc[0].a = limit_register;
+		bc[0].c = var_register;
+
+		bc[1].opcode = dvm_opcode_stor;
+		bc[1].c = limit_register;
+
+		bc[3].opcode = dvm_opcode_maxi;
+		bc[3].a = high_register;
+		bc[3].b = limit_register;
+		bc[3].c = limit_register;
+
+		bc[4].opcode = dvm_opcode_stor;
+		bc[4].c = step_register;
+
+		bc[6].opcode = dvm_opcode_subi;
+		bc[6].a = limit_register;
+		bc[6].b = step_register;
+		bc[6].c = limit_register;
+
+		dcg_pop_temp_past(step_register, reg_alloc);
+
+		size_t jmp_skip_loc = dcg_bc_written(bc_emit) + 1;
+
+		if (!dcg_push_loop_guard(var_register, limit_register, reg_alloc, bc_emit))
+		{
+			return 0;
+		}
+
+		// Write the body once, then repeat it as many times as the back edge can reach
+
+		size_t body_loc = dcg_bc_written(bc_emit);
+
+		if (!dcg_import_statement(statement->for_loop.loop_statement, procedure, module, reg_alloc, bc_emit, mem))
+		{
+			return 0;
+		}
+
+		size_t body_length = dcg_bc_written(bc_emit) - body_loc;
+		// Copies of the body aren't profile sites, so nothing's unrolled while a profile is recorded,
+		// and procedures the profile never saw run aren't worth the extra code
+
+		size_t unroll = DSC_UNROLL_FACTOR < 1 || module->vm->profile.recording || dcg_profile_is_cold(module) ? 1 : DSC_UNROLL_FACTOR;
+
+		while (unroll > 1 && unroll * (body_length + 1) > 126)
+		{
+			--unroll;
+		}
+
+		if (body_length + 1 > 126)
+		{
+			dsc_error("invalid for statement, the loop body is too large to jmp over.");
+			return 0;
+		}
+
+		for (size_t i = 1; i < unroll; ++i)
+		{
+			dvm_bc *inc = dcg_push_bc(1, bc_emit);
+
+			if (inc == NULL)
+			{
+				dsc_error_oom();
+				return 0;
+			}
+
+			inc[0].opcode = dvm_opcode_inci;
+			inc[0].a = var_register;
+
+			if (!dcg_repeat_bc(body_loc, body_length, bc_emit))
+			{
+				return 0;
+			}
+		}
+
+		if (!dcg_push_loop_back_edge(var_register, limit_register, body_loc, bc_emit))
+		{
+			return 0;
+		}
+
+		// The remaining iterations run through a copy of the body that isn't unrolled
+
+		if (unroll > 1)
+		{
+			size_t jmp_end_loc = dcg_bc_written(bc_emit) + 1;
+
+			if (!dcg_push_loop_guard(var_register, high_register, reg_alloc, bc_emit))
+			{
+				return 0;
+			}
+
+			size_t remainder_loc = dcg_bc_written(bc_emit);
+
+			if (!dcg_repeat_bc(body_loc, body_length, bc_emit) ||
+				!dcg_push_loop_back_edge(var_register, high_register, remainder_loc, bc_emit))
+			{
+				return 0;
+			}
+
+			dvm_bc *jmp_end = dcg_bc_at(jmp_end_loc, bc_emit);
+
+			int8_t offset = (int8_t)((int)dcg_bc_written(bc_emit) - (int)jmp_end_loc);
+			jmp_end[0].c = *(uint8_t *)&offset;
+		}
+
+		// Resolve the unroll factor and the jmp over the unrolled loop
+
+		*(int32_t *)dcg_bc_at(unroll_loc + 2, bc_emit) = INT32_MIN + (int32_t)(unroll - 1);
+		*(int32_t *)dcg_bc_at(unroll_loc + 5, bc_emit) = (int32_t)(unroll - 1);
+
+		dvm_bc *jmp_skip = dcg_bc_at(jmp_skip_loc, bc_emit);
+
+		int8_t offset = (int8_t)((int)(body_loc + unroll * (body_length + 1)) - (int)jmp_skip_loc);
+		jmp_skip[0].c = *(uint8_t *)&offset;
+
+		dcg_pop_scope(base_register, reg_alloc);
+
+		return 1;
+	}
+
 	case dst_statement_type_return:
 	{
 		dst_type_list *cur_out = procedure->out_types;
@@ -525,7 +1187,7 @@ int dcg_import_statement(
 				// Move the values into the output registers
 
 				dst_type_list	*sub_val_type = exp_types;
-				size_t			 sub_val_index = 0;
+				size_t			 sub_val_offset = 0;
 
 				while (1)
 				{
@@ -535,8 +1197,9 @@ int dcg_import_statement(
 						return 0;
 					}
 
-					size_t sub_val_reg = exp_reg_start + sub_val_index;
-					size_t out_reg = dcg_push_temp(reg_alloc);
+					size_t sub_val_reg = exp_reg_start + sub_val_offset;
+					size_t sub_val_size = dcg_type_size(sub_val_type->value, module);
+					size_t out_reg = dcg_push_temp_window(sub_val_size, reg_alloc);
 
 					if (out_reg == ~0)
 					{
@@ -544,26 +1207,17 @@ int dcg_import_statement(
 						return 0;
 					}
 					
-					// Store the value in the out register, if it's not already there
+					// Store the value in the out registers, if it's not already there
 
-					if (out_reg != sub_val_reg)
+					if (!dcg_push_move(sub_val_reg, out_reg, sub_val_type->value, module, bc_emit))
 					{
-						dvm_bc *bc = dcg_push_bc(1, bc_emit);
-
-						if (bc == NULL)
-						{
-							dsc_error_oom();
-							return 0;
-						}
-
-						bc[0].opcode = dvm_opcode_mov;
-						bc[0].a = sub_val_reg;
-						bc[0].c = out_reg;
+						dsc_error_oom();
+						return 0;
 					}
 
 					// Go to the next value of this expression
 
-					++sub_val_index;
+					sub_val_offset += sub_val_size;
 					sub_val_type = sub_val_type->next;
 
 					// Go to the next out of this ret
@@ -615,6 +1269,180 @@ int dcg_import_statement(
 		return 1;
 	}
 
+	case dst_statement_type_store:
+	{
+		dcg_var_binding *array = dcg_map(statement->store.array, reg_alloc);
+		dcg_global		*global = array == NULL ? dcg_find_global(statement->store.array, module) : NULL;
+
+		if (array == NULL && global == NULL)
+		{
+			dsc_error("invalid store, cannot find variable (%s).", statement->store.array->text);
+			return 0;
+		}
+
+		dst_type array_type = array != NULL ? array->type : global->type;
+
+		if (array_type != dst_type_integer_array && array_type != dst_type_real_array)
+		{
+			dsc_error("invalid store, variable (%s) is not an array.", statement->store.array->text);
+			return 0;
+		}
+
+		size_t			 start_temp_register = dcg_next_reg_index(reg_alloc);
+		size_t			 array_register;
+
+		// A global array is loaded first, the store goes through the array it points to
+
+		if (array != NULL)
+		{
+			array_register = array->reg_index;
+		}
+		else
+		{
+			array_register = dcg_push_temp(reg_alloc);
+
+			if (array_register == ~0)
+			{
+				dsc_error_oor();
+				return 0;
+			}
+
+			if (!dcg_push_global(dvm_opcode_gload, global->index, array_register, bc_emit))
+			{
+				dsc_error_oom();
+				return 0;
+			}
+		}
+
+		size_t			 index_register;
+		dst_type_list	*index_type;
+		size_t			 value_register;
+		dst_type_list	*value_type;
+
+		if (!dcg_import_expression(statement->store.index, &index_register, &index_type, module, reg_alloc, bc_emit, mem) ||
+			!dcg_import_expression(statement->store.value, &value_register, &value_type, module, reg_alloc, bc_emit, mem))
+		{
+			return 0;
+		}
+
+		if (index_type == NULL || !dst_type_list_is_integer(index_type))
+		{
+			dsc_error("invalid store, index must be an integer.");
+			return 0;
+		}
+
+		if (value_type == NULL || dst_type_list_is_composite(value_type) || value_type->value != dst_type_element_of(array_type))
+		{
+			dsc_error("invalid store, value has a different type than the array's elements.");
+			return 0;
+		}
+
+		dvm_bc *bc = dcg_push_bc(1, bc_emit);
+
+		if (bc == NULL)
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		bc[0].opcode = dvm_opcode_astor;
+		bc[0].a = array_register;
+		bc[0].b = index_register;
+		bc[0].c = value_register;
+
+		dcg_pop_temp_past(start_temp_register, reg_alloc);
+
+		return 1;
+	}
+
+	case dst_statement_type_field_store:
+	{
+		dcg_var_binding *var = dcg_map(statement->field_store.variable, reg_alloc);
+
+		if (var == NULL)
+		{
+			dsc_error("invalid field store, cannot find variable (%s).", statement->field_store.variable->text);
+			return 0;
+		}
+
+		// Walk the path down to the field, its register is known at compile time
+
+		size_t		 field_register = var->reg_index;
+		dst_type	 field_type = var->type;
+		dst_id_list	*cur_field = statement->field_store.fields;
+
+		do
+		{
+			dst_struct *structure = dst_struct_of(field_type, module->structs);
+
+			if (structure == NULL)
+			{
+				dsc_error("invalid field store, only structs have fields (%s).", cur_field->value->text);
+				return 0;
+			}
+
+			size_t			 field_offset;
+			dst_proc_param	*field = dst_struct_field(structure, cur_field->value, &field_offset, module->structs);
+
+			if (field == NULL)
+			{
+				dsc_error("invalid field store, struct %s has no field %s.", structure->id->text, cur_field->value->text);
+				return 0;
+			}
+
+			field_register += field_offset;
+			field_type = field->type;
+
+			cur_field = cur_field->next;
+
+		} while (cur_field != statement->field_store.fields);
+
+		size_t			 start_temp_register = dcg_next_reg_index(reg_alloc);
+		size_t			 value_register;
+		dst_type_list	*value_type;
+
+		if (!dcg_import_expression(statement->field_store.value, &value_register, &value_type, module, reg_alloc, bc_emit, mem))
+		{
+			return 0;
+		}
+
+		if (value_type == NULL || dst_type_list_is_composite(value_type) || value_type->value != field_type)
+		{
+			dsc_error("invalid field store, value has a different type than the field.");
+			return 0;
+		}
+
+		if (!dcg_push_move(value_register, field_register, field_type, module, bc_emit))
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		dcg_pop_temp_past(start_temp_register, reg_alloc);
+
+		return 1;
+	}
+
+	case dst_statement_type_switch:
+		return dcg_import_switch(statement, procedure, module, reg_alloc, bc_emit, mem);
+
+	case dst_statement_type_yield:
+	{
+		// Suspends the execution, the registers are left as they are for when the host resumes it
+
+		dvm_bc *bc = dcg_push_bc(1, bc_emit);
+
+		if (bc == NULL)
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		bc->opcode = dvm_opcode_yield;
+
+		return 1;
+	}
+
 	}
 
 	dsc_error_internal();
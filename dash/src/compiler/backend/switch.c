@@ -0,0 +1,690 @@
+#include "common.h"
+#include "codegen.h"
+
+// A switch is a dispatch followed by its arms in order, every arm but the last jumps past the rest.
+// Arms can be further away than jmpu reaches, so everything leaving the dispatch is a jmpl or a jmpt entry.
+
+// Fewer labels than this are compared one after another, the table's setup costs about as much as the compares
+#define DCG_SWITCH_MIN_TABLE 4
+
+// jmpt counts its entries in one byte
+#define DCG_SWITCH_MAX_BUCKETS 128
+#define DCG_SWITCH_MAX_TABLE 255
+
+struct dcg_switch_label
+{
+	dvm_var		 value;
+	size_t		 arm;
+};
+
+// A 32 bit offset filled in once every target is written, relative to the jump it belongs to
+struct dcg_switch_fixup
+{
+	size_t		 jump_loc;
+	size_t		 immediate_loc;
+	size_t		 target;
+};
+
+// Targets are the arms, then the default, the end of the switch and the buckets of a table
+struct dcg_switch
+{
+	dst_type					 type;
+	size_t						 value_register;
+
+	size_t						 label_count;
+	struct dcg_switch_label		*labels;
+
+	size_t						 arm_count;
+	size_t						 default_arm;
+
+	size_t						 bucket_count;
+	uint32_t					 bucket_shift;
+
+	size_t						 target_count;
+	size_t						*target_locs;
+
+	size_t						 fixup_count;
+	size_t						 fixup_capacity;
+	struct dcg_switch_fixup		*fixups;
+
+	dsc_memory					*mem;
+};
+typedef struct dcg_switch_label dcg_switch_label;
+typedef struct dcg_switch_fixup dcg_switch_fixup;
+typedef struct dcg_switch dcg_switch;
+
+#define dcg_switch_default_target(sw) ((sw)->arm_count)
+#define dcg_switch_end_target(sw) ((sw)->arm_count + 1)
+#define dcg_switch_bucket_target(sw, bucket) ((sw)->arm_count + 2 + (bucket))
+
+#define dcg_switch_bucket(sw, label) (((label)->value.s->hash >> (sw)->bucket_shift) & ((sw)->bucket_count - 1))
+
+static int dcg_switch_push_fixup(size_t jump_loc, size_t immediate_loc, size_t target, dcg_switch *sw)
+{
+	if (sw->fixup_count == sw->fixup_capacity)
+	{
+		size_t new_capacity = sw->fixup_capacity == 0 ? 16 : sw->fixup_capacity * 2;
+
+		dcg_switch_fixup *new_fixups = (dcg_switch_fixup *)dsc_alloc(sizeof(dcg_switch_fixup) * new_capacity, sw->mem);
+
+		if (new_fixups == NULL)
+			return 0;
+
+		if (sw->fixups != NULL)
+			memcpy(new_fixups, sw->fixups, sizeof(dcg_switch_fixup) * sw->fixup_count);
+
+		sw->fixup_capacity = new_capacity;
+		sw->fixups = new_fixups;
+	}
+
+	dcg_switch_fixup *fixup = &sw->fixups[sw->fixup_count++];
+
+	fixup->jump_loc = jump_loc;
+	fixup->immediate_loc = immediate_loc;
+	fixup->target = target;
+
+	return 1;
+}
+
+static int dcg_switch_push_jump(size_t target, dcg_switch *sw, dcg_bc_emitter *bc_emit)
+{
+	size_t	jump_loc = dcg_bc_written(bc_emit);
+	dvm_bc *bc = dcg_push_bc(2, bc_emit);
+
+	if (bc == NULL)
+		return 0;
+
+	bc[0].opcode = dvm_opcode_jmp_l;
+
+	return dcg_switch_push_fixup(jump_loc, jump_loc + 1, target, sw);
+}
+
+// Branches to the label's arm when the value equals it, falls through otherwise
+
+static int dcg_switch_push_compare(
+	dcg_switch_label *label,
+	dcg_switch *sw,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit
+	)
+{
+	size_t			 label_register;
+	dst_type_list	*label_type;
+
+	if (!dcg_import_constant(label->value, sw->type, &label_register, &label_type, reg_alloc, bc_emit))
+	{
+		return 0;
+	}
+
+	dvm_bc *bc = dcg_push_bc(2, bc_emit);
+
+	if (bc == NULL)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	bc[0].opcode = sw->type == dst_type_string ? dvm_opcode_cmps_e : dvm_opcode_cmpi_e;
+	bc[0].a = sw->value_register;
+	bc[0].b = label_register;
+	bc[0].c = label_register;
+
+	// Skip over the jmpl and its offset when they're different
+
+	bc[1].opcode = dvm_opcode_jmp_cn;
+	bc[1].a = label_register;
+	bc[1].c = 3;
+
+	dcg_pop_temp_past(label_register, reg_alloc);
+
+	if (!dcg_switch_push_jump(label->arm, sw, bc_emit))
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	return 1;
+}
+
+// Picks the smallest table, up to four times the labels, and the bits of the hash that give every label its own bucket.
+// When there's no such table the labels share buckets in the smallest one.
+
+static void dcg_switch_size_table(dcg_switch *sw)
+{
+	size_t min_bucket_count = 1;
+
+	while (min_bucket_count < sw->label_count && min_bucket_count < DCG_SWITCH_MAX_BUCKETS)
+		min_bucket_count *= 2;
+
+	for (sw->bucket_count = min_bucket_count; sw->bucket_count <= min_bucket_count * 4 && sw->bucket_count <= DCG_SWITCH_MAX_BUCKETS; sw->bucket_count *= 2)
+	{
+		for (sw->bucket_shift = 0; ((uint64_t)sw->bucket_count << sw->bucket_shift) <= ((uint64_t)1 << 32); ++sw->bucket_shift)
+		{
+			int collides = 0;
+
+			for (size_t i = 0; i < sw->label_count && !collides; ++i)
+			{
+				for (size_t j = i + 1; j < sw->label_count && !collides; ++j)
+				{
+					collides = dcg_switch_bucket(sw, &sw->labels[i]) == dcg_switch_bucket(sw, &sw->labels[j]);
+				}
+			}
+
+			if (!collides)
+				return;
+		}
+	}
+
+	sw->bucket_count = min_bucket_count;
+	sw->bucket_shift = 0;
+}
+
+// Strings are dispatched on their precomputed hash through a table, then compared with the few labels in their bucket
+
+static int dcg_switch_push_string_table(
+	dcg_switch *sw,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit
+	)
+{
+	dcg_switch_size_table(sw);
+
+	size_t hash_register = dcg_push_temp(reg_alloc);
+	size_t mask_register = dcg_push_temp(reg_alloc);
+
+	if (hash_register == ~0 || mask_register == ~0)
+	{
+		dsc_error_oor();
+		return 0;
+	}
+
+	// bucket = (hash >> shift) & (bucket_count - 1), the shift is left out when it's zero
+
+	size_t	shift_length = sw->bucket_shift != 0 ? 3 : 0;
+	size_t	table_loc = dcg_bc_written(bc_emit) + 1 + shift_length + 3;
+	dvm_bc *bc = dcg_push_bc(1 + shift_length + 3 + 1 + 1 + sw->bucket_count, bc_emit);
+
+	if (bc == NULL)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	bc[0].opcode = dvm_opcode_shash;
+	bc[0].a = sw->value_register;
+	bc[0].c = hash_register;
+
+	++bc;
+
+	if (shift_length != 0)
+	{
+		bc[0].opcode = dvm_opcode_stor;
+		bc[0].c = mask_register;
+		*(uint32_t *)(bc + 1) = sw->bucket_shift;
+
+		bc[2].opcode = dvm_opcode_shri;
+		bc[2].a = hash_register;
+		bc[2].b = mask_register;
+		bc[2].c = hash_register;
+
+		bc += 3;
+	}
+
+	bc[0].opcode = dvm_opcode_stor;
+	bc[0].c = mask_register;
+	*(uint32_t *)(bc + 1) = (uint32_t)(sw->bucket_count - 1);
+
+	bc[2].opcode = dvm_opcode_bandi;
+	bc[2].a = hash_register;
+	bc[2].b = mask_register;
+	bc[2].c = hash_register;
+
+	bc[3].opcode = dvm_opcode_jmp_t;
+	bc[3].a = hash_register;
+	bc[3].b = sw->bucket_count;
+
+	dcg_pop_temp_past(hash_register, reg_alloc);
+
+	if (!dcg_switch_push_fixup(table_loc, table_loc + 1, dcg_switch_default_target(sw), sw))
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	for (size_t bucket = 0; bucket < sw->bucket_count; ++bucket)
+	{
+		// Empty buckets go straight to the default
+
+		size_t target = dcg_switch_default_target(sw);
+
+		for (size_t i = 0; i < sw->label_count; ++i)
+		{
+			if (dcg_switch_bucket(sw, &sw->labels[i]) == bucket)
+			{
+				target = dcg_switch_bucket_target(sw, bucket);
+				break;
+			}
+		}
+
+		if (!dcg_switch_push_fixup(table_loc, table_loc + 2 + bucket, target, sw))
+		{
+			dsc_error_oom();
+			return 0;
+		}
+	}
+
+	for (size_t bucket = 0; bucket < sw->bucket_count; ++bucket)
+	{
+		int used = 0;
+
+		for (size_t i = 0; i < sw->label_count; ++i)
+		{
+			if (dcg_switch_bucket(sw, &sw->labels[i]) != bucket)
+				continue;
+
+			if (!used)
+			{
+				sw->target_locs[dcg_switch_bucket_target(sw, bucket)] = dcg_bc_written(bc_emit);
+				used = 1;
+			}
+
+			if (!dcg_switch_push_compare(&sw->labels[i], sw, module, reg_alloc, bc_emit))
+			{
+				return 0;
+			}
+		}
+
+		if (used && !dcg_switch_push_jump(dcg_switch_default_target(sw), sw, bc_emit))
+		{
+			dsc_error_oom();
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+// Integers are dispatched through a table indexed by value - min when at least half of the range has a label.
+// Values below min wrap around to large indices, so both ends of the range fall through to the default.
+
+static int dcg_switch_is_dense(dcg_switch_label *labels, size_t count)
+{
+	int64_t range = (int64_t)labels[count - 1].value.i - (int64_t)labels[0].value.i + 1;
+
+	return count >= DCG_SWITCH_MIN_TABLE && range <= DCG_SWITCH_MAX_TABLE && range <= (int64_t)count * 2;
+}
+
+static int dcg_switch_push_integer_table(
+	dcg_switch_label *labels,
+	size_t count,
+	dcg_switch *sw,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit
+	)
+{
+	size_t			 index_register;
+	dst_type_list	*index_type;
+
+	if (!dcg_import_constant(labels[0].value, dst_type_integer, &index_register, &index_type, reg_alloc, bc_emit))
+	{
+		return 0;
+	}
+
+	size_t	range = (size_t)((int64_t)labels[count - 1].value.i - (int64_t)labels[0].value.i + 1);
+	size_t	table_loc = dcg_bc_written(bc_emit) + 1;
+	dvm_bc *bc = dcg_push_bc(1 + 1 + 1 + range, bc_emit);
+
+	if (bc == NULL)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	bc[0].opcode = dvm_opcode_subi;
+	bc[0].a = sw->value_register;
+	bc[0].b = index_register;
+	bc[0].c = index_register;
+
+	bc[1].opcode = dvm_opcode_jmp_t;
+	bc[1].a = index_register;
+	bc[1].b = range;
+
+	dcg_pop_temp_past(index_register, reg_alloc);
+
+	if (!dcg_switch_push_fixup(table_loc, table_loc + 1, dcg_switch_default_target(sw), sw))
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	// Labels are sorted, so the entries are filled in one pass with the gaps going to the default
+
+	size_t label = 0;
+
+	for (size_t entry = 0; entry < range; ++entry)
+	{
+		size_t target = dcg_switch_default_target(sw);
+
+		if ((int64_t)labels[label].value.i - (int64_t)labels[0].value.i == (int64_t)entry)
+		{
+			target = labels[label++].arm;
+		}
+
+		if (!dcg_switch_push_fixup(table_loc, table_loc + 2 + entry, target, sw))
+		{
+			dsc_error_oom();
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+// Sparse labels are split on the middle one until what's left is dense or short enough to compare in a chain.
+// Every leaf ends in a jump, so the lower half never falls into the upper one.
+
+static int dcg_switch_push_search(
+	dcg_switch_label *labels,
+	size_t count,
+	dcg_switch *sw,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit
+	)
+{
+	if (dcg_switch_is_dense(labels, count))
+	{
+		return dcg_switch_push_integer_table(labels, count, sw, reg_alloc, bc_emit);
+	}
+
+	if (count < DCG_SWITCH_MIN_TABLE)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			if (!dcg_switch_push_compare(&labels[i], sw, module, reg_alloc, bc_emit))
+			{
+				return 0;
+			}
+		}
+
+		if (!dcg_switch_push_jump(dcg_switch_default_target(sw), sw, bc_emit))
+		{
+			dsc_error_oom();
+			return 0;
+		}
+
+		return 1;
+	}
+
+	size_t			 middle = count / 2;
+	size_t			 pivot_register;
+	dst_type_list	*pivot_type;
+
+	if (!dcg_import_constant(labels[middle].value, dst_type_integer, &pivot_register, &pivot_type, reg_alloc, bc_emit))
+	{
+		return 0;
+	}
+
+	// Below the pivot skips the jmpl over the lower half
+
+	size_t	upper_jump_loc = dcg_bc_written(bc_emit) + 2;
+	dvm_bc *bc = dcg_push_bc(4, bc_emit);
+
+	if (bc == NULL)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	bc[0].opcode = dvm_opcode_cmpi_l;
+	bc[0].a = sw->value_register;
+	bc[0].b = pivot_register;
+	bc[0].c = pivot_register;
+
+	bc[1].opcode = dvm_opcode_jmp_c;
+	bc[1].a = pivot_register;
+	bc[1].c = 3;
+
+	bc[2].opcode = dvm_opcode_jmp_l;
+
+	dcg_pop_temp_past(pivot_register, reg_alloc);
+
+	if (!dcg_switch_push_search(labels, middle, sw, module, reg_alloc, bc_emit))
+	{
+		return 0;
+	}
+
+	*(int32_t *)dcg_bc_at(upper_jump_loc + 1, bc_emit) = (int32_t)(dcg_bc_written(bc_emit) - upper_jump_loc);
+
+	return dcg_switch_push_search(labels + middle, count - middle, sw, module, reg_alloc, bc_emit);
+}
+
+static int dcg_switch_compare_labels(const void *left, const void *right)
+{
+	int32_t l = ((const dcg_switch_label *)left)->value.i;
+	int32_t r = ((const dcg_switch_label *)right)->value.i;
+
+	return (l > r) - (l < r);
+}
+
+static int dcg_switch_push_dispatch(
+	dcg_switch *sw,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit
+	)
+{
+	if (sw->type == dst_type_string && sw->label_count >= DCG_SWITCH_MIN_TABLE)
+	{
+		return dcg_switch_push_string_table(sw, module, reg_alloc, bc_emit);
+	}
+
+	if (sw->type == dst_type_integer && sw->label_count > 0)
+	{
+		qsort(sw->labels, sw->label_count, sizeof(dcg_switch_label), dcg_switch_compare_labels);
+
+		return dcg_switch_push_search(sw->labels, sw->label_count, sw, module, reg_alloc, bc_emit);
+	}
+
+	for (size_t i = 0; i < sw->label_count; ++i)
+	{
+		if (!dcg_switch_push_compare(&sw->labels[i], sw, module, reg_alloc, bc_emit))
+		{
+			return 0;
+		}
+	}
+
+	if (!dcg_switch_push_jump(dcg_switch_default_target(sw), sw, bc_emit))
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	return 1;
+}
+
+// Folds every label, they have to be constants of the value's type and can't repeat
+
+static int dcg_switch_collect_labels(
+	dst_statement *statement,
+	dcg_switch *sw,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc
+	)
+{
+	dst_switch_case_list *current = statement->switch_case.cases;
+
+	sw->label_count = 0;
+	sw->arm_count = 0;
+
+	if (current == NULL)
+		return 1;
+
+	do
+	{
+		sw->label_count += dst_exp_list_count(current->value->labels);
+		++sw->arm_count;
+
+		current = current->next;
+	} while (current != statement->switch_case.cases);
+
+	sw->labels = (dcg_switch_label *)dsc_alloc(sizeof(dcg_switch_label) * (sw->label_count + 1), sw->mem);
+
+	if (sw->labels == NULL)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	size_t arm = 0;
+	size_t label_index = 0;
+
+	sw->default_arm = ~0;
+
+	do
+	{
+		dst_exp_list *label = current->value->labels;
+
+		if (label == NULL)
+		{
+			if (sw->default_arm != ~0)
+			{
+				dsc_error("invalid switch statement, there can only be one default case.");
+				return 0;
+			}
+
+			sw->default_arm = arm;
+		}
+		else
+		{
+			do
+			{
+				dcg_switch_label	*out = &sw->labels[label_index];
+				dst_type			 type;
+
+				if (!dcg_fold_constant(label->value, &out->value, &type, module, reg_alloc))
+				{
+					dsc_error("invalid switch statement, case labels must be constants.");
+					return 0;
+				}
+
+				if (type != sw->type)
+				{
+					dsc_error("invalid switch statement, case label has a different type than the value.");
+					return 0;
+				}
+
+				for (size_t i = 0; i < label_index; ++i)
+				{
+					if (sw->type == dst_type_string ? sw->labels[i].value.s == out->value.s : sw->labels[i].value.i == out->value.i)
+					{
+						dsc_error("invalid switch statement, a value has more than one case.");
+						return 0;
+					}
+				}
+
+				out->arm = arm;
+				++label_index;
+
+				label = label->next;
+			} while (label != current->value->labels);
+		}
+
+		++arm;
+		current = current->next;
+	} while (current != statement->switch_case.cases);
+
+	return 1;
+}
+
+int dcg_import_switch(
+	dst_statement *statement,
+	dst_proc *procedure,
+	dcg_proc_decl_table *module,
+	dcg_register_allocator *reg_alloc,
+	dcg_bc_emitter *bc_emit,
+	dsc_memory *mem
+	)
+{
+	dcg_switch sw;
+	memset(&sw, 0, sizeof(sw));
+
+	sw.mem = mem;
+
+	size_t			 start_temp_register = dcg_next_reg_index(reg_alloc);
+	dst_type_list	*value_type;
+
+	if (!dcg_import_expression(statement->switch_case.value, &sw.value_register, &value_type, module, reg_alloc, bc_emit, mem))
+	{
+		return 0;
+	}
+
+	if (value_type == NULL ||
+		dst_type_list_is_composite(value_type) ||
+		(value_type->value != dst_type_integer && value_type->value != dst_type_string))
+	{
+		dsc_error("invalid switch statement, value must be an integer or a string.");
+		return 0;
+	}
+
+	sw.type = value_type->value;
+
+	if (!dcg_switch_collect_labels(statement, &sw, module, reg_alloc))
+	{
+		return 0;
+	}
+
+	sw.target_count = sw.arm_count + 2 + DCG_SWITCH_MAX_BUCKETS;
+	sw.target_locs = (size_t *)dsc_alloc(sizeof(size_t) * sw.target_count, mem);
+
+	if (sw.target_locs == NULL)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	if (!dcg_switch_push_dispatch(&sw, module, reg_alloc, bc_emit))
+	{
+		return 0;
+	}
+
+	// The value isn't needed by the arms
+
+	dcg_pop_temp_past(start_temp_register, reg_alloc);
+
+	dst_switch_case_list *current = statement->switch_case.cases;
+
+	for (size_t arm = 0; arm < sw.arm_count; ++arm, current = current->next)
+	{
+		sw.target_locs[arm] = dcg_bc_written(bc_emit);
+
+		if (!dcg_import_statement(current->value->statement, procedure, module, reg_alloc, bc_emit, mem))
+		{
+			return 0;
+		}
+
+		if (arm + 1 < sw.arm_count && !dcg_switch_push_jump(dcg_switch_end_target(&sw), &sw, bc_emit))
+		{
+			dsc_error_oom();
+			return 0;
+		}
+	}
+
+	sw.target_locs[dcg_switch_end_target(&sw)] = dcg_bc_written(bc_emit);
+	sw.target_locs[dcg_switch_default_target(&sw)] = sw.default_arm != ~0 ? sw.target_locs[sw.default_arm] : dcg_bc_written(bc_emit);
+
+	// Resolve the jumps, now that every target is written
+
+	for (size_t i = 0; i < sw.fixup_count; ++i)
+	{
+		dcg_switch_fixup *fixup = &sw.fixups[i];
+
+		int32_t offset = (int32_t)((int64_t)sw.target_locs[fixup->target] - (int64_t)fixup->jump_loc);
+
+		*(int32_t *)dcg_bc_at(fixup->immediate_loc, bc_emit) = offset;
+	}
+
+	return 1;
+}
@@ -7,10 +7,27 @@
 struct dsc_parse_context
 {
 	dsc_memory		 *memory;
+	dsc_intern_table *atoms;
 	dst_proc_list	 *parsed_module;
+	dst_global_list	 *globals;
+	dst_struct_table  structs;
+
+	// Profile sites parsed so far, and the first of the procedure being parsed
+	uint32_t		  site_count;
+	uint32_t		  first_site;
 };
 typedef struct dsc_parse_context dsc_parse_context;
 
+// Bump whenever the emitted bytecode changes, so stale cached images are ignored
+#define DSC_COMPILER_VERSION 13
+
+// How many copies of a for loop's body go between back edges, bodies too large for a jmp get fewer
+#ifndef DSC_UNROLL_FACTOR
+	#define DSC_UNROLL_FACTOR 4
+#endif
+
+#define DSC_COMPILER_OPTIONS (DSC_UNROLL_FACTOR)
+
 /* ;) */
 #define dsc_error_code (rand() % 2000) + 2555
 
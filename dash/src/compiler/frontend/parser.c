@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.4.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison implementation for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -33,6 +34,10 @@
 /* C LALR(1) parser skeleton written by Richard Stallman, by
    simplifying the original so-called "semantic" parser.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 /* All symbols defined below should begin with yy or YY, to avoid
    infringing on user name space.  This should be done even for local
    variables, as they might otherwise be expanded by user macros.
@@ -40,11 +45,11 @@
    define necessary library symbols; they are noted "INFRINGES ON
    USER NAME SPACE" below.  */
 
-/* Identify Bison output.  */
-#define YYBISON 1
+/* Identify Bison output, and Bison version.  */
+#define YYBISON 30802
 
-/* Bison version.  */
-#define YYBISON_VERSION "3.0.4"
+/* Bison version string.  */
+#define YYBISON_VERSION "3.8.2"
 
 /* Skeleton name.  */
 #define YYSKELETON_NAME "yacc.c"
@@ -61,157 +66,213 @@
 
 
 
-/* Copy the first part of user declarations.  */
-#line 1 "parser.y" /* yacc.c:339  */
+/* First part of user prologue.  */
+#line 1 "parser.y"
 
 	#include "../common.h"
+	#include "scanner.h"
+
+	#include <stdio.h>
+
+	#define yylex dsc_lex
 
-	int yylex (union YYSTYPE *yyval_param, struct YYLTYPE *yylloc_param, void *yyscanner);
-	int yyerror(struct YYLTYPE *yylloc_param, dsc_parse_context *context, void *scanner, const char *msg);
+	int yyerror(struct YYLTYPE *yylloc_param, dsc_parse_context *context, struct dsc_scanner *scanner, const char *msg);
 
-#line 73 "parser.c" /* yacc.c:339  */
+#line 82 "parser.c"
 
+# ifndef YY_CAST
+#  ifdef __cplusplus
+#   define YY_CAST(Type, Val) static_cast<Type> (Val)
+#   define YY_REINTERPRET_CAST(Type, Val) reinterpret_cast<Type> (Val)
+#  else
+#   define YY_CAST(Type, Val) ((Type) (Val))
+#   define YY_REINTERPRET_CAST(Type, Val) ((Type) (Val))
+#  endif
+# endif
 # ifndef YY_NULLPTR
-#  if defined __cplusplus && 201103L <= __cplusplus
-#   define YY_NULLPTR nullptr
+#  if defined __cplusplus
+#   if 201103L <= __cplusplus
+#    define YY_NULLPTR nullptr
+#   else
+#    define YY_NULLPTR 0
+#   endif
 #  else
-#   define YY_NULLPTR 0
+#   define YY_NULLPTR ((void*)0)
 #  endif
 # endif
 
-/* Enabling verbose error messages.  */
-#ifdef YYERROR_VERBOSE
-# undef YYERROR_VERBOSE
-# define YYERROR_VERBOSE 1
-#else
-# define YYERROR_VERBOSE 0
-#endif
-
-/* In a future release of Bison, this section will be replaced
-   by #include "parser.h".  */
-#ifndef YY_YY_PARSER_H_INCLUDED
-# define YY_YY_PARSER_H_INCLUDED
-/* Debug traces.  */
-#ifndef YYDEBUG
-# define YYDEBUG 0
-#endif
-#if YYDEBUG
-extern int yydebug;
-#endif
-
-/* Token type.  */
-#ifndef YYTOKENTYPE
-# define YYTOKENTYPE
-  enum yytokentype
-  {
-    TOKEN_INTEGER = 258,
-    TOKEN_REAL = 259,
-    TOKEN_IDENTIFIER = 260,
-    TOKEN_TYPE = 261,
-    TOKEN_DEF = 262,
-    TOKEN_ARROW = 263,
-    TOKEN_LET = 264,
-    TOKEN_WHILE = 265,
-    TOKEN_IF = 266,
-    TOKEN_ELSE = 267,
-    TOKEN_RETURN = 268,
-    TOKEN_OP_ADD = 269,
-    TOKEN_OP_SUB = 270,
-    TOKEN_OP_MUL = 271,
-    TOKEN_OP_DIV = 272,
-    TOKEN_OP_AND = 273,
-    TOKEN_OP_OR = 274,
-    TOKEN_OP_NOT = 275,
-    TOKEN_OP_EQ = 276,
-    TOKEN_OP_LESS = 277,
-    TOKEN_OP_LESS_EQ = 278,
-    TOKEN_OP_GREATER = 279,
-    TOKEN_OP_GREATER_EQ = 280
-  };
-#endif
-
-/* Value type.  */
-#if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-
-union YYSTYPE
+#include "parser.h"
+/* Symbol kind.  */
+enum yysymbol_kind_t
 {
-#line 17 "parser.y" /* yacc.c:355  */
-
-	dst_type			 type;
-	dst_type_list		*type_list;
-	char				*identifier;
-	dst_id_list			*identifier_list;
-	dst_statement		*statement;
-	dst_statement_list	*statement_list;
-	dst_exp				*expression;
-	dst_exp_list		*expression_list;
-	dst_proc_param		*proc_param;
-	dst_proc_param_list	*proc_param_list;
-	dst_proc			*proc; 
-	dst_proc_list		*proc_list;
-
-	int			 integer;
-	float		 real;
-	char		*string;
-
-#line 158 "parser.c" /* yacc.c:355  */
+  YYSYMBOL_YYEMPTY = -2,
+  YYSYMBOL_YYEOF = 0,                      /* "end of file"  */
+  YYSYMBOL_YYerror = 1,                    /* error  */
+  YYSYMBOL_YYUNDEF = 2,                    /* "invalid token"  */
+  YYSYMBOL_TOKEN_INTEGER = 3,              /* TOKEN_INTEGER  */
+  YYSYMBOL_TOKEN_REAL = 4,                 /* TOKEN_REAL  */
+  YYSYMBOL_TOKEN_LONG = 5,                 /* TOKEN_LONG  */
+  YYSYMBOL_TOKEN_DOUBLE = 6,               /* TOKEN_DOUBLE  */
+  YYSYMBOL_TOKEN_IDENTIFIER = 7,           /* TOKEN_IDENTIFIER  */
+  YYSYMBOL_TOKEN_STRING = 8,               /* TOKEN_STRING  */
+  YYSYMBOL_TOKEN_TYPE = 9,                 /* TOKEN_TYPE  */
+  YYSYMBOL_TOKEN_DEF = 10,                 /* TOKEN_DEF  */
+  YYSYMBOL_TOKEN_ARROW = 11,               /* TOKEN_ARROW  */
+  YYSYMBOL_TOKEN_LET = 12,                 /* TOKEN_LET  */
+  YYSYMBOL_TOKEN_WHILE = 13,               /* TOKEN_WHILE  */
+  YYSYMBOL_TOKEN_FOR = 14,                 /* TOKEN_FOR  */
+  YYSYMBOL_TOKEN_IF = 15,                  /* TOKEN_IF  */
+  YYSYMBOL_TOKEN_ELSE = 16,                /* TOKEN_ELSE  */
+  YYSYMBOL_TOKEN_RETURN = 17,              /* TOKEN_RETURN  */
+  YYSYMBOL_TOKEN_YIELD = 18,               /* TOKEN_YIELD  */
+  YYSYMBOL_TOKEN_STRUCT = 19,              /* TOKEN_STRUCT  */
+  YYSYMBOL_TOKEN_CONST = 20,               /* TOKEN_CONST  */
+  YYSYMBOL_TOKEN_SWITCH = 21,              /* TOKEN_SWITCH  */
+  YYSYMBOL_TOKEN_CASE = 22,                /* TOKEN_CASE  */
+  YYSYMBOL_TOKEN_DEFAULT = 23,             /* TOKEN_DEFAULT  */
+  YYSYMBOL_TOKEN_OP_ADD = 24,              /* TOKEN_OP_ADD  */
+  YYSYMBOL_TOKEN_OP_SUB = 25,              /* TOKEN_OP_SUB  */
+  YYSYMBOL_TOKEN_OP_MUL = 26,              /* TOKEN_OP_MUL  */
+  YYSYMBOL_TOKEN_OP_DIV = 27,              /* TOKEN_OP_DIV  */
+  YYSYMBOL_TOKEN_OP_MOD = 28,              /* TOKEN_OP_MOD  */
+  YYSYMBOL_TOKEN_OP_SHL = 29,              /* TOKEN_OP_SHL  */
+  YYSYMBOL_TOKEN_OP_SHR = 30,              /* TOKEN_OP_SHR  */
+  YYSYMBOL_TOKEN_OP_BIT_AND = 31,          /* TOKEN_OP_BIT_AND  */
+  YYSYMBOL_TOKEN_OP_BIT_OR = 32,           /* TOKEN_OP_BIT_OR  */
+  YYSYMBOL_TOKEN_OP_BIT_XOR = 33,          /* TOKEN_OP_BIT_XOR  */
+  YYSYMBOL_TOKEN_OP_AND = 34,              /* TOKEN_OP_AND  */
+  YYSYMBOL_TOKEN_OP_OR = 35,               /* TOKEN_OP_OR  */
+  YYSYMBOL_TOKEN_OP_NOT = 36,              /* TOKEN_OP_NOT  */
+  YYSYMBOL_TOKEN_OP_EQ = 37,               /* TOKEN_OP_EQ  */
+  YYSYMBOL_TOKEN_OP_LESS = 38,             /* TOKEN_OP_LESS  */
+  YYSYMBOL_TOKEN_OP_LESS_EQ = 39,          /* TOKEN_OP_LESS_EQ  */
+  YYSYMBOL_TOKEN_OP_GREATER = 40,          /* TOKEN_OP_GREATER  */
+  YYSYMBOL_TOKEN_OP_GREATER_EQ = 41,       /* TOKEN_OP_GREATER_EQ  */
+  YYSYMBOL_42_ = 42,                       /* '='  */
+  YYSYMBOL_43_ = 43,                       /* ','  */
+  YYSYMBOL_44_ = 44,                       /* '('  */
+  YYSYMBOL_45_ = 45,                       /* ')'  */
+  YYSYMBOL_46_ = 46,                       /* '['  */
+  YYSYMBOL_47_ = 47,                       /* ']'  */
+  YYSYMBOL_48_ = 48,                       /* '.'  */
+  YYSYMBOL_49_ = 49,                       /* ';'  */
+  YYSYMBOL_50_ = 50,                       /* '{'  */
+  YYSYMBOL_51_ = 51,                       /* '}'  */
+  YYSYMBOL_52_ = 52,                       /* ':'  */
+  YYSYMBOL_YYACCEPT = 53,                  /* $accept  */
+  YYSYMBOL_dash_module = 54,               /* dash_module  */
+  YYSYMBOL_type = 55,                      /* type  */
+  YYSYMBOL_identifier = 56,                /* identifier  */
+  YYSYMBOL_statement = 57,                 /* statement  */
+  YYSYMBOL_switch_case = 58,               /* switch_case  */
+  YYSYMBOL_expression = 59,                /* expression  */
+  YYSYMBOL_proc_param = 60,                /* proc_param  */
+  YYSYMBOL_proc = 61,                      /* proc  */
+  YYSYMBOL_global_decl = 62,               /* global_decl  */
+  YYSYMBOL_struct_decl = 63,               /* struct_decl  */
+  YYSYMBOL_statement_block = 64,           /* statement_block  */
+  YYSYMBOL_expression_list = 65,           /* expression_list  */
+  YYSYMBOL_type_list = 66,                 /* type_list  */
+  YYSYMBOL_switch_case_list = 67,          /* switch_case_list  */
+  YYSYMBOL_proc_param_list = 68,           /* proc_param_list  */
+  YYSYMBOL_nonempty_statement_block = 69,  /* nonempty_statement_block  */
+  YYSYMBOL_nonempty_expression_list = 70,  /* nonempty_expression_list  */
+  YYSYMBOL_nonempty_type_list = 71,        /* nonempty_type_list  */
+  YYSYMBOL_nonempty_proc_param_list = 72,  /* nonempty_proc_param_list  */
+  YYSYMBOL_field_path = 73,                /* field_path  */
+  YYSYMBOL_nonempty_identifier_list = 74,  /* nonempty_identifier_list  */
+  YYSYMBOL_nonempty_proc_list = 75         /* nonempty_proc_list  */
 };
+typedef enum yysymbol_kind_t yysymbol_kind_t;
 
-typedef union YYSTYPE YYSTYPE;
-# define YYSTYPE_IS_TRIVIAL 1
-# define YYSTYPE_IS_DECLARED 1
-#endif
-
-/* Location type.  */
-#if ! defined YYLTYPE && ! defined YYLTYPE_IS_DECLARED
-typedef struct YYLTYPE YYLTYPE;
-struct YYLTYPE
-{
-  int first_line;
-  int first_column;
-  int last_line;
-  int last_column;
-};
-# define YYLTYPE_IS_DECLARED 1
-# define YYLTYPE_IS_TRIVIAL 1
-#endif
 
 
 
-int yyparse (dsc_parse_context *context, void *scanner);
+#ifdef short
+# undef short
+#endif
 
-#endif /* !YY_YY_PARSER_H_INCLUDED  */
+/* On compilers that do not define __PTRDIFF_MAX__ etc., make sure
+   <limits.h> and (if available) <stdint.h> are included
+   so that the code can choose integer types of a good width.  */
 
-/* Copy the second part of user declarations.  */
+#ifndef __PTRDIFF_MAX__
+# include <limits.h> /* INFRINGES ON USER NAME SPACE */
+# if defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
+#  include <stdint.h> /* INFRINGES ON USER NAME SPACE */
+#  define YY_STDINT_H
+# endif
+#endif
 
-#line 188 "parser.c" /* yacc.c:358  */
+/* Narrow types that promote to a signed type and that can represent a
+   signed or unsigned integer of at least N bits.  In tables they can
+   save space and decrease cache pressure.  Promoting to a signed type
+   helps avoid bugs in integer arithmetic.  */
 
-#ifdef short
-# undef short
+#ifdef __INT_LEAST8_MAX__
+typedef __INT_LEAST8_TYPE__ yytype_int8;
+#elif defined YY_STDINT_H
+typedef int_least8_t yytype_int8;
+#else
+typedef signed char yytype_int8;
 #endif
 
-#ifdef YYTYPE_UINT8
-typedef YYTYPE_UINT8 yytype_uint8;
+#ifdef __INT_LEAST16_MAX__
+typedef __INT_LEAST16_TYPE__ yytype_int16;
+#elif defined YY_STDINT_H
+typedef int_least16_t yytype_int16;
 #else
-typedef unsigned char yytype_uint8;
+typedef short yytype_int16;
 #endif
 
-#ifdef YYTYPE_INT8
-typedef YYTYPE_INT8 yytype_int8;
-#else
-typedef signed char yytype_int8;
+/* Work around bug in HP-UX 11.23, which defines these macros
+   incorrectly for preprocessor constants.  This workaround can likely
+   be removed in 2023, as HPE has promised support for HP-UX 11.23
+   (aka HP-UX 11i v2) only through the end of 2022; see Table 2 of
+   <https://h20195.www2.hpe.com/V2/getpdf.aspx/4AA4-7673ENW.pdf>.  */
+#ifdef __hpux
+# undef UINT_LEAST8_MAX
+# undef UINT_LEAST16_MAX
+# define UINT_LEAST8_MAX 255
+# define UINT_LEAST16_MAX 65535
 #endif
 
-#ifdef YYTYPE_UINT16
-typedef YYTYPE_UINT16 yytype_uint16;
+#if defined __UINT_LEAST8_MAX__ && __UINT_LEAST8_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST8_TYPE__ yytype_uint8;
+#elif (!defined __UINT_LEAST8_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST8_MAX <= INT_MAX)
+typedef uint_least8_t yytype_uint8;
+#elif !defined __UINT_LEAST8_MAX__ && UCHAR_MAX <= INT_MAX
+typedef unsigned char yytype_uint8;
 #else
-typedef unsigned short int yytype_uint16;
+typedef short yytype_uint8;
 #endif
 
-#ifdef YYTYPE_INT16
-typedef YYTYPE_INT16 yytype_int16;
+#if defined __UINT_LEAST16_MAX__ && __UINT_LEAST16_MAX__ <= __INT_MAX__
+typedef __UINT_LEAST16_TYPE__ yytype_uint16;
+#elif (!defined __UINT_LEAST16_MAX__ && defined YY_STDINT_H \
+       && UINT_LEAST16_MAX <= INT_MAX)
+typedef uint_least16_t yytype_uint16;
+#elif !defined __UINT_LEAST16_MAX__ && USHRT_MAX <= INT_MAX
+typedef unsigned short yytype_uint16;
 #else
-typedef short int yytype_int16;
+typedef int yytype_uint16;
+#endif
+
+#ifndef YYPTRDIFF_T
+# if defined __PTRDIFF_TYPE__ && defined __PTRDIFF_MAX__
+#  define YYPTRDIFF_T __PTRDIFF_TYPE__
+#  define YYPTRDIFF_MAXIMUM __PTRDIFF_MAX__
+# elif defined PTRDIFF_MAX
+#  ifndef ptrdiff_t
+#   include <stddef.h> /* INFRINGES ON USER NAME SPACE */
+#  endif
+#  define YYPTRDIFF_T ptrdiff_t
+#  define YYPTRDIFF_MAXIMUM PTRDIFF_MAX
+# else
+#  define YYPTRDIFF_T long
+#  define YYPTRDIFF_MAXIMUM LONG_MAX
+# endif
 #endif
 
 #ifndef YYSIZE_T
@@ -219,15 +280,28 @@ typedef short int yytype_int16;
 #  define YYSIZE_T __SIZE_TYPE__
 # elif defined size_t
 #  define YYSIZE_T size_t
-# elif ! defined YYSIZE_T
+# elif defined __STDC_VERSION__ && 199901 <= __STDC_VERSION__
 #  include <stddef.h> /* INFRINGES ON USER NAME SPACE */
 #  define YYSIZE_T size_t
 # else
-#  define YYSIZE_T unsigned int
+#  define YYSIZE_T unsigned
 # endif
 #endif
 
-#define YYSIZE_MAXIMUM ((YYSIZE_T) -1)
+#define YYSIZE_MAXIMUM                                  \
+  YY_CAST (YYPTRDIFF_T,                                 \
+           (YYPTRDIFF_MAXIMUM < YY_CAST (YYSIZE_T, -1)  \
+            ? YYPTRDIFF_MAXIMUM                         \
+            : YY_CAST (YYSIZE_T, -1)))
+
+#define YYSIZEOF(X) YY_CAST (YYPTRDIFF_T, sizeof (X))
+
+
+/* Stored state numbers (used for stacks). */
+typedef yytype_uint8 yy_state_t;
+
+/* State numbers in computations.  */
+typedef int yy_state_fast_t;
 
 #ifndef YY_
 # if defined YYENABLE_NLS && YYENABLE_NLS
@@ -241,47 +315,43 @@ typedef short int yytype_int16;
 # endif
 #endif
 
-#ifndef YY_ATTRIBUTE
-# if (defined __GNUC__                                               \
-      && (2 < __GNUC__ || (__GNUC__ == 2 && 96 <= __GNUC_MINOR__)))  \
-     || defined __SUNPRO_C && 0x5110 <= __SUNPRO_C
-#  define YY_ATTRIBUTE(Spec) __attribute__(Spec)
-# else
-#  define YY_ATTRIBUTE(Spec) /* empty */
-# endif
-#endif
 
 #ifndef YY_ATTRIBUTE_PURE
-# define YY_ATTRIBUTE_PURE   YY_ATTRIBUTE ((__pure__))
+# if defined __GNUC__ && 2 < __GNUC__ + (96 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_PURE __attribute__ ((__pure__))
+# else
+#  define YY_ATTRIBUTE_PURE
+# endif
 #endif
 
 #ifndef YY_ATTRIBUTE_UNUSED
-# define YY_ATTRIBUTE_UNUSED YY_ATTRIBUTE ((__unused__))
-#endif
-
-#if !defined _Noreturn \
-     && (!defined __STDC_VERSION__ || __STDC_VERSION__ < 201112)
-# if defined _MSC_VER && 1200 <= _MSC_VER
-#  define _Noreturn __declspec (noreturn)
+# if defined __GNUC__ && 2 < __GNUC__ + (7 <= __GNUC_MINOR__)
+#  define YY_ATTRIBUTE_UNUSED __attribute__ ((__unused__))
 # else
-#  define _Noreturn YY_ATTRIBUTE ((__noreturn__))
+#  define YY_ATTRIBUTE_UNUSED
 # endif
 #endif
 
 /* Suppress unused-variable warnings by "using" E.  */
 #if ! defined lint || defined __GNUC__
-# define YYUSE(E) ((void) (E))
+# define YY_USE(E) ((void) (E))
 #else
-# define YYUSE(E) /* empty */
+# define YY_USE(E) /* empty */
 #endif
 
-#if defined __GNUC__ && 407 <= __GNUC__ * 100 + __GNUC_MINOR__
 /* Suppress an incorrect diagnostic about yylval being uninitialized.  */
-# define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN \
-    _Pragma ("GCC diagnostic push") \
-    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")\
+#if defined __GNUC__ && ! defined __ICC && 406 <= __GNUC__ * 100 + __GNUC_MINOR__
+# if __GNUC__ * 100 + __GNUC_MINOR__ < 407
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")
+# else
+#  define YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN                           \
+    _Pragma ("GCC diagnostic push")                                     \
+    _Pragma ("GCC diagnostic ignored \"-Wuninitialized\"")              \
     _Pragma ("GCC diagnostic ignored \"-Wmaybe-uninitialized\"")
-# define YY_IGNORE_MAYBE_UNINITIALIZED_END \
+# endif
+# define YY_IGNORE_MAYBE_UNINITIALIZED_END      \
     _Pragma ("GCC diagnostic pop")
 #else
 # define YY_INITIAL_VALUE(Value) Value
@@ -294,8 +364,22 @@ typedef short int yytype_int16;
 # define YY_INITIAL_VALUE(Value) /* Nothing. */
 #endif
 
+#if defined __cplusplus && defined __GNUC__ && ! defined __ICC && 6 <= __GNUC__
+# define YY_IGNORE_USELESS_CAST_BEGIN                          \
+    _Pragma ("GCC diagnostic push")                            \
+    _Pragma ("GCC diagnostic ignored \"-Wuseless-cast\"")
+# define YY_IGNORE_USELESS_CAST_END            \
+    _Pragma ("GCC diagnostic pop")
+#endif
+#ifndef YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_BEGIN
+# define YY_IGNORE_USELESS_CAST_END
+#endif
+
+
+#define YY_ASSERT(E) ((void) (0 && (E)))
 
-#if ! defined yyoverflow || YYERROR_VERBOSE
+#if !defined yyoverflow
 
 /* The parser invokes alloca or malloc; define the necessary symbols.  */
 
@@ -360,8 +444,7 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 #   endif
 #  endif
 # endif
-#endif /* ! defined yyoverflow || YYERROR_VERBOSE */
-
+#endif /* !defined yyoverflow */
 
 #if (! defined yyoverflow \
      && (! defined __cplusplus \
@@ -371,18 +454,19 @@ void free (void *); /* INFRINGES ON USER NAME SPACE */
 /* A type that is properly aligned for any stack member.  */
 union yyalloc
 {
-  yytype_int16 yyss_alloc;
+  yy_state_t yyss_alloc;
   YYSTYPE yyvs_alloc;
   YYLTYPE yyls_alloc;
 };
 
 /* The size of the maximum gap between one aligned stack and the next.  */
-# define YYSTACK_GAP_MAXIMUM (sizeof (union yyalloc) - 1)
+# define YYSTACK_GAP_MAXIMUM (YYSIZEOF (union yyalloc) - 1)
 
 /* The size of an array large to enough to hold all stacks, each with
    N elements.  */
 # define YYSTACK_BYTES(N) \
-     ((N) * (sizeof (yytype_int16) + sizeof (YYSTYPE) + sizeof (YYLTYPE)) \
+     ((N) * (YYSIZEOF (yy_state_t) + YYSIZEOF (YYSTYPE) \
+             + YYSIZEOF (YYLTYPE)) \
       + 2 * YYSTACK_GAP_MAXIMUM)
 
 # define YYCOPY_NEEDED 1
@@ -395,11 +479,11 @@ union yyalloc
 # define YYSTACK_RELOCATE(Stack_alloc, Stack)                           \
     do                                                                  \
       {                                                                 \
-        YYSIZE_T yynewbytes;                                            \
+        YYPTRDIFF_T yynewbytes;                                         \
         YYCOPY (&yyptr->Stack_alloc, Stack, yysize);                    \
         Stack = &yyptr->Stack_alloc;                                    \
-        yynewbytes = yystacksize * sizeof (*Stack) + YYSTACK_GAP_MAXIMUM; \
-        yyptr += yynewbytes / sizeof (*yyptr);                          \
+        yynewbytes = yystacksize * YYSIZEOF (*Stack) + YYSTACK_GAP_MAXIMUM; \
+        yyptr += yynewbytes / YYSIZEOF (*yyptr);                        \
       }                                                                 \
     while (0)
 
@@ -411,12 +495,12 @@ union yyalloc
 # ifndef YYCOPY
 #  if defined __GNUC__ && 1 < __GNUC__
 #   define YYCOPY(Dst, Src, Count) \
-      __builtin_memcpy (Dst, Src, (Count) * sizeof (*(Src)))
+      __builtin_memcpy (Dst, Src, YY_CAST (YYSIZE_T, (Count)) * sizeof (*(Src)))
 #  else
 #   define YYCOPY(Dst, Src, Count)              \
       do                                        \
         {                                       \
-          YYSIZE_T yyi;                         \
+          YYPTRDIFF_T yyi;                      \
           for (yyi = 0; yyi < (Count); yyi++)   \
             (Dst)[yyi] = (Src)[yyi];            \
         }                                       \
@@ -426,44 +510,47 @@ union yyalloc
 #endif /* !YYCOPY_NEEDED */
 
 /* YYFINAL -- State number of the termination state.  */
-#define YYFINAL  7
+#define YYFINAL  15
 /* YYLAST -- Last index in YYTABLE.  */
-#define YYLAST   169
+#define YYLAST   648
 
 /* YYNTOKENS -- Number of terminals.  */
-#define YYNTOKENS  34
+#define YYNTOKENS  53
 /* YYNNTS -- Number of nonterminals.  */
-#define YYNNTS  18
+#define YYNNTS  23
 /* YYNRULES -- Number of rules.  */
-#define YYNRULES  52
+#define YYNRULES  85
 /* YYNSTATES -- Number of states.  */
-#define YYNSTATES  109
+#define YYNSTATES  198
+
+/* YYMAXUTOK -- Last valid token kind.  */
+#define YYMAXUTOK   296
 
-/* YYTRANSLATE[YYX] -- Symbol number corresponding to YYX as returned
-   by yylex, with out-of-bounds checking.  */
-#define YYUNDEFTOK  2
-#define YYMAXUTOK   280
 
-#define YYTRANSLATE(YYX)                                                \
-  ((unsigned int) (YYX) <= YYMAXUTOK ? yytranslate[YYX] : YYUNDEFTOK)
+/* YYTRANSLATE(TOKEN-NUM) -- Symbol number corresponding to TOKEN-NUM
+   as returned by yylex, with out-of-bounds checking.  */
+#define YYTRANSLATE(YYX)                                \
+  (0 <= (YYX) && (YYX) <= YYMAXUTOK                     \
+   ? YY_CAST (yysymbol_kind_t, yytranslate[YYX])        \
+   : YYSYMBOL_YYUNDEF)
 
 /* YYTRANSLATE[TOKEN-NUM] -- Symbol number corresponding to TOKEN-NUM
-   as returned by yylex, without out-of-bounds checking.  */
-static const yytype_uint8 yytranslate[] =
+   as returned by yylex.  */
+static const yytype_int8 yytranslate[] =
 {
        0,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-      28,    29,     2,     2,    27,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,    31,    30,
-       2,    26,     2,     2,     2,     2,     2,     2,     2,     2,
+      44,    45,     2,     2,    43,     2,    48,     2,     2,     2,
+       2,     2,     2,     2,     2,     2,     2,     2,    52,    49,
+       2,    42,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
+       2,    46,     2,    47,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
-       2,     2,     2,    32,     2,    33,     2,     2,     2,     2,
+       2,     2,     2,    50,     2,    51,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
        2,     2,     2,     2,     2,     2,     2,     2,     2,     2,
@@ -479,232 +566,373 @@ static const yytype_uint8 yytranslate[] =
        2,     2,     2,     2,     2,     2,     1,     2,     3,     4,
        5,     6,     7,     8,     9,    10,    11,    12,    13,    14,
       15,    16,    17,    18,    19,    20,    21,    22,    23,    24,
-      25
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    36,    37,    38,    39,    40,    41
 };
 
 #if YYDEBUG
-  /* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
-static const yytype_uint8 yyrline[] =
+/* YYRLINE[YYN] -- Source line where rule number YYN was defined.  */
+static const yytype_int16 yyrline[] =
 {
-       0,    91,    91,    94,    97,   100,   104,   108,   112,   116,
-     120,   124,   128,   134,   135,   136,   138,   139,   140,   141,
-     143,   144,   145,   146,   147,   148,   149,   150,   152,   153,
-     154,   157,   160,   166,   167,   170,   171,   174,   175,   178,
-     179,   182,   183,   186,   187,   190,   191,   194,   195,   198,
-     199,   202,   203
+       0,   125,   125,   128,   129,   141,   153,   156,   160,   164,
+     168,   172,   176,   180,   184,   188,   192,   196,   200,   204,
+     210,   211,   214,   215,   216,   217,   218,   219,   221,   222,
+     223,   224,   225,   227,   228,   229,   230,   231,   233,   234,
+     235,   236,   237,   238,   239,   240,   242,   243,   244,   245,
+     246,   247,   250,   253,   260,   264,   268,   274,   307,   308,
+     311,   312,   315,   316,   319,   320,   323,   324,   327,   328,
+     331,   332,   335,   336,   339,   340,   343,   344,   347,   348,
+     351,   352,   353,   354,   355,   356
 };
 #endif
 
-#if YYDEBUG || YYERROR_VERBOSE || 0
+/** Accessing symbol of state STATE.  */
+#define YY_ACCESSING_SYMBOL(State) YY_CAST (yysymbol_kind_t, yystos[State])
+
+#if YYDEBUG || 0
+/* The user-facing name of the symbol whose (internal) number is
+   YYSYMBOL.  No bounds checking.  */
+static const char *yysymbol_name (yysymbol_kind_t yysymbol) YY_ATTRIBUTE_UNUSED;
+
 /* YYTNAME[SYMBOL-NUM] -- String name of the symbol SYMBOL-NUM.
    First, the terminals, then, starting at YYNTOKENS, nonterminals.  */
 static const char *const yytname[] =
 {
-  "$end", "error", "$undefined", "TOKEN_INTEGER", "TOKEN_REAL",
-  "TOKEN_IDENTIFIER", "TOKEN_TYPE", "TOKEN_DEF", "TOKEN_ARROW",
-  "TOKEN_LET", "TOKEN_WHILE", "TOKEN_IF", "TOKEN_ELSE", "TOKEN_RETURN",
-  "TOKEN_OP_ADD", "TOKEN_OP_SUB", "TOKEN_OP_MUL", "TOKEN_OP_DIV",
-  "TOKEN_OP_AND", "TOKEN_OP_OR", "TOKEN_OP_NOT", "TOKEN_OP_EQ",
-  "TOKEN_OP_LESS", "TOKEN_OP_LESS_EQ", "TOKEN_OP_GREATER",
-  "TOKEN_OP_GREATER_EQ", "'='", "','", "'('", "')'", "';'", "':'", "'{'",
-  "'}'", "$accept", "dash_module", "type", "identifier", "statement",
-  "expression", "proc_param", "proc", "statement_block", "expression_list",
-  "type_list", "proc_param_list", "nonempty_statement_block",
-  "nonempty_expression_list", "nonempty_type_list",
-  "nonempty_proc_param_list", "nonempty_identifier_list",
-  "nonempty_proc_list", YY_NULLPTR
+  "\"end of file\"", "error", "\"invalid token\"", "TOKEN_INTEGER",
+  "TOKEN_REAL", "TOKEN_LONG", "TOKEN_DOUBLE", "TOKEN_IDENTIFIER",
+  "TOKEN_STRING", "TOKEN_TYPE", "TOKEN_DEF", "TOKEN_ARROW", "TOKEN_LET",
+  "TOKEN_WHILE", "TOKEN_FOR", "TOKEN_IF", "TOKEN_ELSE", "TOKEN_RETURN",
+  "TOKEN_YIELD", "TOKEN_STRUCT", "TOKEN_CONST", "TOKEN_SWITCH",
+  "TOKEN_CASE", "TOKEN_DEFAULT", "TOKEN_OP_ADD", "TOKEN_OP_SUB",
+  "TOKEN_OP_MUL", "TOKEN_OP_DIV", "TOKEN_OP_MOD", "TOKEN_OP_SHL",
+  "TOKEN_OP_SHR", "TOKEN_OP_BIT_AND", "TOKEN_OP_BIT_OR",
+  "TOKEN_OP_BIT_XOR", "TOKEN_OP_AND", "TOKEN_OP_OR", "TOKEN_OP_NOT",
+  "TOKEN_OP_EQ", "TOKEN_OP_LESS", "TOKEN_OP_LESS_EQ", "TOKEN_OP_GREATER",
+  "TOKEN_OP_GREATER_EQ", "'='", "','", "'('", "')'", "'['", "']'", "'.'",
+  "';'", "'{'", "'}'", "':'", "$accept", "dash_module", "type",
+  "identifier", "statement", "switch_case", "expression", "proc_param",
+  "proc", "global_decl", "struct_decl", "statement_block",
+  "expression_list", "type_list", "switch_case_list", "proc_param_list",
+  "nonempty_statement_block", "nonempty_expression_list",
+  "nonempty_type_list", "nonempty_proc_param_list", "field_path",
+  "nonempty_identifier_list", "nonempty_proc_list", YY_NULLPTR
 };
-#endif
 
-# ifdef YYPRINT
-/* YYTOKNUM[NUM] -- (External) token number corresponding to the
-   (internal) symbol number NUM (which must be that of a token).  */
-static const yytype_uint16 yytoknum[] =
+static const char *
+yysymbol_name (yysymbol_kind_t yysymbol)
 {
-       0,   256,   257,   258,   259,   260,   261,   262,   263,   264,
-     265,   266,   267,   268,   269,   270,   271,   272,   273,   274,
-     275,   276,   277,   278,   279,   280,    61,    44,    40,    41,
-      59,    58,   123,   125
-};
-# endif
+  return yytname[yysymbol];
+}
+#endif
 
-#define YYPACT_NINF -53
+#define YYPACT_NINF (-134)
 
-#define yypact_value_is_default(Yystate) \
-  (!!((Yystate) == (-53)))
+#define yypact_value_is_default(Yyn) \
+  ((Yyn) == YYPACT_NINF)
 
-#define YYTABLE_NINF -1
+#define YYTABLE_NINF (-1)
 
-#define yytable_value_is_error(Yytable_value) \
+#define yytable_value_is_error(Yyn) \
   0
 
-  /* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
-     STATE-NUM.  */
+/* YYPACT[STATE-NUM] -- Index in YYTABLE of the portion describing
+   STATE-NUM.  */
 static const yytype_int16 yypact[] =
 {
-       8,    14,    23,   -53,     8,   -53,    -5,   -53,   -53,     1,
-      14,    24,   -53,     3,    32,    83,    84,    14,   -53,   -53,
-      85,   -53,    83,   -53,    70,    87,    65,    83,    14,    94,
-     100,    30,    51,   101,   -53,   -53,    39,   -53,   -53,    46,
-      30,    30,   -53,   -53,    30,     0,   110,   134,    82,   103,
-     -53,   -53,    58,    30,    30,    14,    30,    86,   102,    71,
-     115,   118,    30,    30,    30,    30,    30,    30,    30,    30,
-      30,    30,    30,    30,   -53,    30,   -53,   -53,   116,   -19,
-     -53,    -6,    65,    65,    30,   -53,   117,    63,    63,   -53,
-     -53,    79,    71,   146,   146,   146,   146,   146,   134,   124,
-     -53,   -53,   -53,   154,   -53,   -53,   -53,    65,   -53
+     169,    11,    11,    11,    11,    25,  -134,  -134,  -134,   169,
+    -134,   -24,   -33,    10,    22,  -134,  -134,  -134,  -134,    21,
+     147,    82,    11,   147,    11,  -134,  -134,  -134,  -134,  -134,
+      27,   147,   163,    34,   184,    39,    50,  -134,    36,  -134,
+     -21,   210,    57,    60,   147,   575,   -39,   288,   147,   147,
+     147,   147,   147,   147,   147,   147,   147,   147,   147,   147,
+     147,   147,   147,   147,   147,   147,   147,    11,  -134,    58,
+    -134,    82,    11,  -134,  -134,    99,   313,   147,  -134,   513,
+      66,    75,    80,    80,    46,    46,    46,   150,   150,   600,
+     564,   589,   550,   575,   538,   538,   538,   538,   538,   338,
+    -134,  -134,  -134,  -134,    76,  -134,    46,  -134,   147,  -134,
+      82,   513,  -134,    79,    78,   123,    82,    11,    81,    85,
+      87,   147,    97,   103,    62,   113,  -134,  -134,   -32,  -134,
+    -134,   -10,   147,    11,   147,   111,  -134,   147,  -134,  -134,
+      83,   147,   147,    11,    15,   147,    11,   147,   363,   106,
+     388,  -134,   413,  -134,  -134,   137,   438,  -134,   147,    11,
+      18,  -134,    38,   123,   147,   123,   134,   136,   144,   236,
+    -134,  -134,  -134,  -134,   463,   171,  -134,  -134,   147,  -134,
+     147,   123,     4,   262,   488,  -134,   147,   141,  -134,  -134,
+    -134,   123,    16,   123,  -134,   123,  -134,  -134
 };
 
-  /* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
-     Performed when YYTABLE does not specify something else to do.  Zero
-     means the default is an error.  */
-static const yytype_uint8 yydefact[] =
+/* YYDEFACT[STATE-NUM] -- Default reduction number in state STATE-NUM.
+   Performed when YYTABLE does not specify something else to do.  Zero
+   means the default is an error.  */
+static const yytype_int8 yydefact[] =
 {
-       0,     0,     0,    51,     2,     4,     0,     1,    52,     0,
-      39,     0,    47,     0,    40,     0,     0,     0,     3,    31,
-       0,    48,    37,    45,     0,    38,     0,     0,     0,     0,
-       0,    35,     0,    49,    32,     8,     0,    46,    49,     0,
-       0,     0,    13,    14,     0,     0,    15,    43,     0,    36,
-      33,    41,     0,    35,     0,     0,     0,     0,     0,    22,
-       0,     0,    35,     0,     0,     0,     0,     0,     0,     0,
-       0,     0,     0,     0,    12,     0,    34,    42,     0,     0,
-      50,     0,     0,     0,     0,    30,     0,    16,    17,    18,
-      19,    20,    21,    23,    24,    25,    26,    27,    44,     0,
-       6,     5,    11,    10,    29,    28,     7,     0,     9
+       0,     0,     0,     0,     0,     0,    80,    82,    81,     2,
+       6,     0,     0,     0,     0,     1,    83,    85,    84,     0,
+       0,     0,     0,     0,    66,    22,    23,    24,    25,    26,
+       0,     0,     0,    27,     0,     3,     0,     4,     0,    74,
+       0,     0,     0,    67,     0,    40,     0,     0,    60,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,     0,     0,     0,     0,     0,     0,     0,    54,     0,
+      55,     0,     0,    57,    56,     0,     0,     0,    51,    70,
+       0,    61,    28,    29,    30,    31,    32,    33,    34,    35,
+      36,    37,    38,    39,    41,    42,    43,    44,    45,     0,
+      49,     5,    52,    75,     0,    47,    50,    46,     0,    48,
+      62,    71,    72,     0,    63,     0,     0,     0,     0,     0,
+       0,    60,     0,     0,     0,    78,    53,    12,     0,    73,
+      78,     0,     0,     0,     0,     0,    18,     0,    58,    68,
+       0,    60,     0,     0,     0,     0,     0,     0,     0,     0,
+       0,    17,     0,    59,    69,     0,     0,    76,     0,     0,
+       0,    79,     0,     0,     0,     0,     0,     0,     0,     0,
+      77,     8,     7,    15,     0,    14,    64,     9,     0,    11,
+       0,     0,     0,     0,     0,    13,     0,     0,    19,    65,
+      10,     0,     0,     0,    16,     0,    21,    20
 };
 
-  /* YYPGOTO[NTERM-NUM].  */
+/* YYPGOTO[NTERM-NUM].  */
 static const yytype_int16 yypgoto[] =
 {
-     -53,   -53,   -15,    -1,   -30,   -27,   150,   164,   -53,   -52,
-     -53,   -53,   -53,    -7,   -53,   -53,   141,   -53
+    -134,  -134,   -58,    -1,  -109,  -134,   -15,   125,   186,   191,
+     192,  -134,  -117,  -134,  -134,  -134,  -134,  -133,  -134,   178,
+    -134,    86,  -134
 };
 
-  /* YYDEFGOTO[NTERM-NUM].  */
-static const yytype_int8 yydefgoto[] =
+/* YYDEFGOTO[NTERM-NUM].  */
+static const yytype_uint8 yydefgoto[] =
 {
-      -1,     2,    19,    46,    34,    47,    12,     3,    35,    48,
-      24,    13,    52,    49,    25,    14,    36,     4
+       0,     5,    36,    33,   126,   189,    79,    39,     6,     7,
+       8,   127,    80,   113,   182,    42,   140,    81,   114,    40,
+     144,   128,     9
 };
 
-  /* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
-     positive, shift that token.  If negative, reduce the rule whose
-     number is the opposite.  If YYTABLE_NINF, syntax error.  */
+/* YYTABLE[YYPACT[STATE-NUM]] -- What to do in state STATE-NUM.  If
+   positive, shift that token.  If negative, reduce the rule whose
+   number is the opposite.  If YYTABLE_NINF, syntax error.  */
 static const yytype_uint8 yytable[] =
 {
-       6,    78,    51,    42,    43,     5,    18,    23,    75,    11,
-      86,   100,    37,    57,    58,     1,    11,    59,    61,     5,
-      44,    75,    77,     7,   101,    33,     9,    38,    45,    10,
-      60,    33,    16,    42,    43,     5,    87,    88,    89,    90,
-      91,    92,    93,    94,    95,    96,    97,    79,    98,    81,
-      44,    33,   102,   103,    80,    15,     5,   104,    45,    17,
-      28,    29,    30,     5,    31,    54,    55,    28,    29,    30,
-       5,    31,    56,    55,    28,    29,    30,   108,    31,    65,
-      66,    33,    33,    32,    50,    63,    64,    65,    66,    18,
-      32,    76,    20,    63,    64,    65,    66,    32,    68,    26,
-      63,    64,    65,    66,    67,    68,    33,    69,    70,    71,
-      72,    73,    74,    22,    27,    82,    63,    64,    65,    66,
-      67,    68,    40,    69,    70,    71,    72,    73,    41,    53,
-      75,    83,    63,    64,    65,    66,    67,    68,    62,    69,
-      70,    71,    72,    73,    84,    99,   105,    85,    63,    64,
-      65,    66,    67,    68,   106,    69,    70,    71,    72,    73,
-      63,    64,    65,    66,    67,    68,   107,    21,     8,    39
+      11,    12,    13,    14,   135,    34,    77,    44,    41,    20,
+     145,   146,   160,   102,   162,   139,    45,    47,    10,    21,
+      37,    38,    72,    38,   155,    15,   186,   187,    19,    76,
+      73,   154,   147,   146,    82,    83,    84,    85,    86,    87,
+      88,    89,    90,    91,    92,    93,    94,    95,    96,    97,
+      98,    99,   112,   192,   173,   188,   175,   158,   129,   108,
+      22,   108,   106,   159,    23,    24,   100,   171,   195,    10,
+      37,    38,   185,    44,   117,   118,   119,   120,    48,   121,
+     122,   108,   194,   123,   196,    69,   197,   172,    71,    10,
+      10,    35,    66,   111,    67,   117,   118,   119,   120,    70,
+     121,   122,    75,    72,   123,   101,    51,    52,    53,    37,
+     104,   107,   124,   138,   125,    37,   130,   148,   108,   150,
+     110,   116,   152,   125,   115,   132,    66,   156,    67,   133,
+      10,   134,   149,   124,   153,   117,   118,   119,   120,   125,
+     121,   122,   157,   169,   123,   161,   136,   137,   164,   174,
+      25,    26,    27,    28,    10,    29,    30,   141,   170,   142,
+     151,   143,   125,   183,   125,   184,    25,    26,    27,    28,
+      10,    29,    46,   124,    49,    50,    51,    52,    53,     1,
+     125,     2,   167,    31,   176,   177,   178,   181,     3,     4,
+     125,    32,   125,   193,   125,    16,    66,   103,    67,    31,
+      17,    18,    43,   131,     0,     0,     0,    32,    49,    50,
+      51,    52,    53,    54,    55,    56,    57,    58,    59,    60,
+       0,    61,    62,    63,    64,    65,     0,     0,     0,     0,
+      66,     0,    67,    68,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,    59,    60,     0,    61,    62,    63,
+      64,    65,     0,     0,     0,     0,    66,     0,    67,    74,
+      49,    50,    51,    52,    53,    54,    55,    56,    57,    58,
+      59,    60,     0,    61,    62,    63,    64,    65,     0,     0,
+       0,     0,    66,     0,    67,   179,    49,    50,    51,    52,
+      53,    54,    55,    56,    57,    58,    59,    60,     0,    61,
+      62,    63,    64,    65,     0,     0,     0,     0,    66,     0,
+      67,   190,    49,    50,    51,    52,    53,    54,    55,    56,
+      57,    58,    59,    60,     0,    61,    62,    63,    64,    65,
+       0,     0,     0,    78,    66,     0,    67,    49,    50,    51,
+      52,    53,    54,    55,    56,    57,    58,    59,    60,     0,
+      61,    62,    63,    64,    65,     0,     0,     0,     0,    66,
+     105,    67,    49,    50,    51,    52,    53,    54,    55,    56,
+      57,    58,    59,    60,     0,    61,    62,    63,    64,    65,
+       0,     0,     0,     0,    66,   109,    67,    49,    50,    51,
+      52,    53,    54,    55,    56,    57,    58,    59,    60,     0,
+      61,    62,    63,    64,    65,     0,     0,     0,   163,    66,
+       0,    67,    49,    50,    51,    52,    53,    54,    55,    56,
+      57,    58,    59,    60,     0,    61,    62,    63,    64,    65,
+       0,     0,     0,   165,    66,     0,    67,    49,    50,    51,
+      52,    53,    54,    55,    56,    57,    58,    59,    60,     0,
+      61,    62,    63,    64,    65,     0,     0,     0,   166,    66,
+       0,    67,    49,    50,    51,    52,    53,    54,    55,    56,
+      57,    58,    59,    60,     0,    61,    62,    63,    64,    65,
+       0,     0,     0,     0,    66,   168,    67,    49,    50,    51,
+      52,    53,    54,    55,    56,    57,    58,    59,    60,     0,
+      61,    62,    63,    64,    65,     0,   180,     0,     0,    66,
+       0,    67,    49,    50,    51,    52,    53,    54,    55,    56,
+      57,    58,    59,    60,     0,    61,    62,    63,    64,    65,
+       0,     0,     0,   191,    66,     0,    67,    49,    50,    51,
+      52,    53,    54,    55,    56,    57,    58,    59,    60,     0,
+      61,    62,    63,    64,    65,     0,     0,     0,     0,    66,
+       0,    67,    49,    50,    51,    52,    53,    54,    55,    56,
+      57,    58,    59,    60,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,    66,    60,    67,     0,    49,    50,
+      51,    52,    53,    54,    55,    56,    66,    58,    67,    49,
+      50,    51,    52,    53,    54,    55,    56,    57,    58,     0,
+      66,     0,    67,    49,    50,    51,    52,    53,    54,    55,
+      56,    66,     0,    67,    49,    50,    51,    52,    53,    54,
+      55,     0,     0,     0,     0,    66,     0,    67,     0,     0,
+       0,     0,     0,     0,     0,     0,    66,     0,    67
 };
 
-static const yytype_uint8 yycheck[] =
+static const yytype_int16 yycheck[] =
 {
-       1,    53,    32,     3,     4,     5,     6,    22,    27,    10,
-      62,    30,    27,    40,    41,     7,    17,    44,    45,     5,
-      20,    27,    52,     0,    30,    26,    31,    28,    28,    28,
-      45,    32,    29,     3,     4,     5,    63,    64,    65,    66,
-      67,    68,    69,    70,    71,    72,    73,    54,    75,    56,
-      20,    52,    82,    83,    55,    31,     5,    84,    28,    27,
-       9,    10,    11,     5,    13,    26,    27,     9,    10,    11,
-       5,    13,    26,    27,     9,    10,    11,   107,    13,    16,
-      17,    82,    83,    32,    33,    14,    15,    16,    17,     6,
-      32,    33,     8,    14,    15,    16,    17,    32,    19,    29,
-      14,    15,    16,    17,    18,    19,   107,    21,    22,    23,
-      24,    25,    30,    28,    27,    29,    14,    15,    16,    17,
-      18,    19,    28,    21,    22,    23,    24,    25,    28,    28,
-      27,    29,    14,    15,    16,    17,    18,    19,    28,    21,
-      22,    23,    24,    25,    29,    29,    29,    29,    14,    15,
-      16,    17,    18,    19,    30,    21,    22,    23,    24,    25,
-      14,    15,    16,    17,    18,    19,    12,    17,     4,    28
+       1,     2,     3,     4,   121,    20,    45,    46,    23,    42,
+      42,    43,   145,    71,   147,   124,    31,    32,     7,    52,
+      21,    22,    43,    24,   141,     0,    22,    23,    52,    44,
+      51,   140,    42,    43,    49,    50,    51,    52,    53,    54,
+      55,    56,    57,    58,    59,    60,    61,    62,    63,    64,
+      65,    66,   110,   186,   163,    51,   165,    42,   116,    43,
+      50,    43,    77,    48,    42,    44,    67,    49,    52,     7,
+      71,    72,   181,    46,    12,    13,    14,    15,    44,    17,
+      18,    43,   191,    21,   193,    46,   195,    49,    52,     7,
+       7,     9,    46,   108,    48,    12,    13,    14,    15,    49,
+      17,    18,    45,    43,    21,    47,    26,    27,    28,   110,
+      11,    45,    50,    51,   115,   116,   117,   132,    43,   134,
+      44,    43,   137,   124,    45,    44,    46,   142,    48,    44,
+       7,    44,   133,    50,    51,    12,    13,    14,    15,   140,
+      17,    18,   143,   158,    21,   146,    49,    44,    42,   164,
+       3,     4,     5,     6,     7,     8,     9,    44,   159,    46,
+      49,    48,   163,   178,   165,   180,     3,     4,     5,     6,
+       7,     8,     9,    50,    24,    25,    26,    27,    28,    10,
+     181,    12,    45,    36,    50,    49,    42,    16,    19,    20,
+     191,    44,   193,    52,   195,     9,    46,    72,    48,    36,
+       9,     9,    24,   117,    -1,    -1,    -1,    44,    24,    25,
+      26,    27,    28,    29,    30,    31,    32,    33,    34,    35,
+      -1,    37,    38,    39,    40,    41,    -1,    -1,    -1,    -1,
+      46,    -1,    48,    49,    24,    25,    26,    27,    28,    29,
+      30,    31,    32,    33,    34,    35,    -1,    37,    38,    39,
+      40,    41,    -1,    -1,    -1,    -1,    46,    -1,    48,    49,
+      24,    25,    26,    27,    28,    29,    30,    31,    32,    33,
+      34,    35,    -1,    37,    38,    39,    40,    41,    -1,    -1,
+      -1,    -1,    46,    -1,    48,    49,    24,    25,    26,    27,
+      28,    29,    30,    31,    32,    33,    34,    35,    -1,    37,
+      38,    39,    40,    41,    -1,    -1,    -1,    -1,    46,    -1,
+      48,    49,    24,    25,    26,    27,    28,    29,    30,    31,
+      32,    33,    34,    35,    -1,    37,    38,    39,    40,    41,
+      -1,    -1,    -1,    45,    46,    -1,    48,    24,    25,    26,
+      27,    28,    29,    30,    31,    32,    33,    34,    35,    -1,
+      37,    38,    39,    40,    41,    -1,    -1,    -1,    -1,    46,
+      47,    48,    24,    25,    26,    27,    28,    29,    30,    31,
+      32,    33,    34,    35,    -1,    37,    38,    39,    40,    41,
+      -1,    -1,    -1,    -1,    46,    47,    48,    24,    25,    26,
+      27,    28,    29,    30,    31,    32,    33,    34,    35,    -1,
+      37,    38,    39,    40,    41,    -1,    -1,    -1,    45,    46,
+      -1,    48,    24,    25,    26,    27,    28,    29,    30,    31,
+      32,    33,    34,    35,    -1,    37,    38,    39,    40,    41,
+      -1,    -1,    -1,    45,    46,    -1,    48,    24,    25,    26,
+      27,    28,    29,    30,    31,    32,    33,    34,    35,    -1,
+      37,    38,    39,    40,    41,    -1,    -1,    -1,    45,    46,
+      -1,    48,    24,    25,    26,    27,    28,    29,    30,    31,
+      32,    33,    34,    35,    -1,    37,    38,    39,    40,    41,
+      -1,    -1,    -1,    -1,    46,    47,    48,    24,    25,    26,
+      27,    28,    29,    30,    31,    32,    33,    34,    35,    -1,
+      37,    38,    39,    40,    41,    -1,    43,    -1,    -1,    46,
+      -1,    48,    24,    25,    26,    27,    28,    29,    30,    31,
+      32,    33,    34,    35,    -1,    37,    38,    39,    40,    41,
+      -1,    -1,    -1,    45,    46,    -1,    48,    24,    25,    26,
+      27,    28,    29,    30,    31,    32,    33,    34,    35,    -1,
+      37,    38,    39,    40,    41,    -1,    -1,    -1,    -1,    46,
+      -1,    48,    24,    25,    26,    27,    28,    29,    30,    31,
+      32,    33,    34,    35,    24,    25,    26,    27,    28,    29,
+      30,    31,    32,    33,    46,    35,    48,    -1,    24,    25,
+      26,    27,    28,    29,    30,    31,    46,    33,    48,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    -1,
+      46,    -1,    48,    24,    25,    26,    27,    28,    29,    30,
+      31,    46,    -1,    48,    24,    25,    26,    27,    28,    29,
+      30,    -1,    -1,    -1,    -1,    46,    -1,    48,    -1,    -1,
+      -1,    -1,    -1,    -1,    -1,    -1,    46,    -1,    48
 };
 
-  /* YYSTOS[STATE-NUM] -- The (internal number of the) accessing
-     symbol of state STATE-NUM.  */
-static const yytype_uint8 yystos[] =
+/* YYSTOS[STATE-NUM] -- The symbol kind of the accessing symbol of
+   state STATE-NUM.  */
+static const yytype_int8 yystos[] =
 {
-       0,     7,    35,    41,    51,     5,    37,     0,    41,    31,
-      28,    37,    40,    45,    49,    31,    29,    27,     6,    36,
-       8,    40,    28,    36,    44,    48,    29,    27,     9,    10,
-      11,    13,    32,    37,    38,    42,    50,    36,    37,    50,
-      28,    28,     3,     4,    20,    28,    37,    39,    43,    47,
-      33,    38,    46,    28,    26,    27,    26,    39,    39,    39,
-      36,    39,    28,    14,    15,    16,    17,    18,    19,    21,
-      22,    23,    24,    25,    30,    27,    33,    38,    43,    47,
-      37,    47,    29,    29,    29,    29,    43,    39,    39,    39,
-      39,    39,    39,    39,    39,    39,    39,    39,    39,    29,
-      30,    30,    38,    38,    39,    29,    30,    12,    38
+       0,    10,    12,    19,    20,    54,    61,    62,    63,    75,
+       7,    56,    56,    56,    56,     0,    61,    62,    63,    52,
+      42,    52,    50,    42,    44,     3,     4,     5,     6,     8,
+       9,    36,    44,    56,    59,     9,    55,    56,    56,    60,
+      72,    59,    68,    72,    46,    59,     9,    59,    44,    24,
+      25,    26,    27,    28,    29,    30,    31,    32,    33,    34,
+      35,    37,    38,    39,    40,    41,    46,    48,    49,    46,
+      49,    52,    43,    51,    49,    45,    59,    45,    45,    59,
+      65,    70,    59,    59,    59,    59,    59,    59,    59,    59,
+      59,    59,    59,    59,    59,    59,    59,    59,    59,    59,
+      56,    47,    55,    60,    11,    47,    59,    45,    43,    47,
+      44,    59,    55,    66,    71,    45,    43,    12,    13,    14,
+      15,    17,    18,    21,    50,    56,    57,    64,    74,    55,
+      56,    74,    44,    44,    44,    65,    49,    44,    51,    57,
+      69,    44,    46,    48,    73,    42,    43,    42,    59,    56,
+      59,    49,    59,    51,    57,    65,    59,    56,    42,    48,
+      70,    56,    70,    45,    42,    45,    45,    45,    47,    59,
+      56,    49,    49,    57,    59,    57,    50,    49,    42,    49,
+      43,    16,    67,    59,    59,    57,    22,    23,    51,    58,
+      49,    45,    70,    52,    57,    52,    57,    57
 };
 
-  /* YYR1[YYN] -- Symbol number of symbol that rule YYN derives.  */
-static const yytype_uint8 yyr1[] =
+/* YYR1[RULE-NUM] -- Symbol kind of the left-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr1[] =
 {
-       0,    34,    35,    36,    37,    38,    38,    38,    38,    38,
-      38,    38,    38,    39,    39,    39,    39,    39,    39,    39,
-      39,    39,    39,    39,    39,    39,    39,    39,    39,    39,
-      39,    40,    41,    42,    42,    43,    43,    44,    44,    45,
-      45,    46,    46,    47,    47,    48,    48,    49,    49,    50,
-      50,    51,    51
+       0,    53,    54,    55,    55,    55,    56,    57,    57,    57,
+      57,    57,    57,    57,    57,    57,    57,    57,    57,    57,
+      58,    58,    59,    59,    59,    59,    59,    59,    59,    59,
+      59,    59,    59,    59,    59,    59,    59,    59,    59,    59,
+      59,    59,    59,    59,    59,    59,    59,    59,    59,    59,
+      59,    59,    60,    61,    62,    62,    62,    63,    64,    64,
+      65,    65,    66,    66,    67,    67,    68,    68,    69,    69,
+      70,    70,    71,    71,    72,    72,    73,    73,    74,    74,
+      75,    75,    75,    75,    75,    75
 };
 
-  /* YYR2[YYN] -- Number of symbols on the right hand side of rule YYN.  */
-static const yytype_uint8 yyr2[] =
+/* YYR2[RULE-NUM] -- Number of symbols on the right-hand side of rule RULE-NUM.  */
+static const yytype_int8 yyr2[] =
 {
-       0,     2,     1,     1,     1,     5,     4,     5,     1,     7,
-       5,     5,     3,     1,     1,     1,     3,     3,     3,     3,
-       3,     3,     2,     3,     3,     3,     3,     3,     4,     4,
-       3,     3,    11,     2,     3,     0,     1,     0,     1,     0,
-       1,     1,     2,     1,     3,     1,     3,     1,     3,     1,
-       3,     1,     2
+       0,     2,     1,     1,     1,     3,     1,     5,     4,     5,
+       7,     5,     1,     7,     5,     5,     9,     3,     2,     7,
+       4,     3,     1,     1,     1,     1,     1,     1,     3,     3,
+       3,     3,     3,     3,     3,     3,     3,     3,     3,     3,
+       2,     3,     3,     3,     3,     3,     4,     4,     4,     3,
+       4,     3,     3,    11,     5,     5,     5,     5,     2,     3,
+       0,     1,     0,     1,     0,     2,     0,     1,     1,     2,
+       1,     3,     1,     3,     1,     3,     2,     3,     1,     3,
+       1,     1,     1,     2,     2,     2
 };
 
 
+enum { YYENOMEM = -2 };
+
 #define yyerrok         (yyerrstatus = 0)
 #define yyclearin       (yychar = YYEMPTY)
-#define YYEMPTY         (-2)
-#define YYEOF           0
 
 #define YYACCEPT        goto yyacceptlab
 #define YYABORT         goto yyabortlab
 #define YYERROR         goto yyerrorlab
+#define YYNOMEM         goto yyexhaustedlab
 
 
 #define YYRECOVERING()  (!!yyerrstatus)
 
-#define YYBACKUP(Token, Value)                                  \
-do                                                              \
-  if (yychar == YYEMPTY)                                        \
-    {                                                           \
-      yychar = (Token);                                         \
-      yylval = (Value);                                         \
-      YYPOPSTACK (yylen);                                       \
-      yystate = *yyssp;                                         \
-      goto yybackup;                                            \
-    }                                                           \
-  else                                                          \
-    {                                                           \
-      yyerror (&yylloc, context, scanner, YY_("syntax error: cannot back up")); \
-      YYERROR;                                                  \
-    }                                                           \
-while (0)
-
-/* Error token number */
-#define YYTERROR        1
-#define YYERRCODE       256
-
+#define YYBACKUP(Token, Value)                                    \
+  do                                                              \
+    if (yychar == YYEMPTY)                                        \
+      {                                                           \
+        yychar = (Token);                                         \
+        yylval = (Value);                                         \
+        YYPOPSTACK (yylen);                                       \
+        yystate = *yyssp;                                         \
+        goto yybackup;                                            \
+      }                                                           \
+    else                                                          \
+      {                                                           \
+        yyerror (&yylloc, context, scanner, YY_("syntax error: cannot back up")); \
+        YYERROR;                                                  \
+      }                                                           \
+  while (0)
+
+/* Backward compatibility with an undocumented macro.
+   Use YYerror or YYUNDEF. */
+#define YYERRCODE YYUNDEF
 
 /* YYLLOC_DEFAULT -- Set CURRENT to span from RHS[1] to RHS[N].
    If N is 0, then set CURRENT to the empty location which ends
@@ -748,20 +976,27 @@ do {                                            \
 } while (0)
 
 
-/* YY_LOCATION_PRINT -- Print the location on the stream.
+/* YYLOCATION_PRINT -- Print the location on the stream.
    This macro was not mandated originally: define only if we know
    we won't break user code: when these are the locations we know.  */
 
-#ifndef YY_LOCATION_PRINT
-# if defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
+# ifndef YYLOCATION_PRINT
+
+#  if defined YY_LOCATION_PRINT
+
+   /* Temporary convenience wrapper in case some people defined the
+      undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YYLOCATION_PRINT(File, Loc)  YY_LOCATION_PRINT(File, *(Loc))
+
+#  elif defined YYLTYPE_IS_TRIVIAL && YYLTYPE_IS_TRIVIAL
 
 /* Print *YYLOCP on YYO.  Private, do not rely on its existence. */
 
 YY_ATTRIBUTE_UNUSED
-static unsigned
+static int
 yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
 {
-  unsigned res = 0;
+  int res = 0;
   int end_col = 0 != yylocp->last_column ? yylocp->last_column - 1 : 0;
   if (0 <= yylocp->first_line)
     {
@@ -781,65 +1016,73 @@ yy_location_print_ (FILE *yyo, YYLTYPE const * const yylocp)
         res += YYFPRINTF (yyo, "-%d", end_col);
     }
   return res;
- }
+}
 
-#  define YY_LOCATION_PRINT(File, Loc)          \
-  yy_location_print_ (File, &(Loc))
+#   define YYLOCATION_PRINT  yy_location_print_
 
-# else
-#  define YY_LOCATION_PRINT(File, Loc) ((void) 0)
-# endif
-#endif
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT(File, Loc)  YYLOCATION_PRINT(File, &(Loc))
+
+#  else
+
+#   define YYLOCATION_PRINT(File, Loc) ((void) 0)
+    /* Temporary convenience wrapper in case some people defined the
+       undocumented and private YY_LOCATION_PRINT macros.  */
+#   define YY_LOCATION_PRINT  YYLOCATION_PRINT
+
+#  endif
+# endif /* !defined YYLOCATION_PRINT */
 
 
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)                    \
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)                    \
 do {                                                                      \
   if (yydebug)                                                            \
     {                                                                     \
       YYFPRINTF (stderr, "%s ", Title);                                   \
       yy_symbol_print (stderr,                                            \
-                  Type, Value, Location, context, scanner); \
+                  Kind, Value, Location, context, scanner); \
       YYFPRINTF (stderr, "\n");                                           \
     }                                                                     \
 } while (0)
 
 
-/*----------------------------------------.
-| Print this symbol's value on YYOUTPUT.  |
-`----------------------------------------*/
+/*-----------------------------------.
+| Print this symbol's value on YYO.  |
+`-----------------------------------*/
 
 static void
-yy_symbol_value_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, dsc_parse_context *context, void *scanner)
+yy_symbol_value_print (FILE *yyo,
+                       yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, dsc_parse_context *context, struct dsc_scanner *scanner)
 {
-  FILE *yyo = yyoutput;
-  YYUSE (yyo);
-  YYUSE (yylocationp);
-  YYUSE (context);
-  YYUSE (scanner);
+  FILE *yyoutput = yyo;
+  YY_USE (yyoutput);
+  YY_USE (yylocationp);
+  YY_USE (context);
+  YY_USE (scanner);
   if (!yyvaluep)
     return;
-# ifdef YYPRINT
-  if (yytype < YYNTOKENS)
-    YYPRINT (yyoutput, yytoknum[yytype], *yyvaluep);
-# endif
-  YYUSE (yytype);
+  YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
+  YY_USE (yykind);
+  YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
-/*--------------------------------.
-| Print this symbol on YYOUTPUT.  |
-`--------------------------------*/
+/*---------------------------.
+| Print this symbol on YYO.  |
+`---------------------------*/
 
 static void
-yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, dsc_parse_context *context, void *scanner)
+yy_symbol_print (FILE *yyo,
+                 yysymbol_kind_t yykind, YYSTYPE const * const yyvaluep, YYLTYPE const * const yylocationp, dsc_parse_context *context, struct dsc_scanner *scanner)
 {
-  YYFPRINTF (yyoutput, "%s %s (",
-             yytype < YYNTOKENS ? "token" : "nterm", yytname[yytype]);
+  YYFPRINTF (yyo, "%s %s (",
+             yykind < YYNTOKENS ? "token" : "nterm", yysymbol_name (yykind));
 
-  YY_LOCATION_PRINT (yyoutput, *yylocationp);
-  YYFPRINTF (yyoutput, ": ");
-  yy_symbol_value_print (yyoutput, yytype, yyvaluep, yylocationp, context, scanner);
-  YYFPRINTF (yyoutput, ")");
+  YYLOCATION_PRINT (yyo, yylocationp);
+  YYFPRINTF (yyo, ": ");
+  yy_symbol_value_print (yyo, yykind, yyvaluep, yylocationp, context, scanner);
+  YYFPRINTF (yyo, ")");
 }
 
 /*------------------------------------------------------------------.
@@ -848,7 +1091,7 @@ yy_symbol_print (FILE *yyoutput, int yytype, YYSTYPE const * const yyvaluep, YYL
 `------------------------------------------------------------------*/
 
 static void
-yy_stack_print (yytype_int16 *yybottom, yytype_int16 *yytop)
+yy_stack_print (yy_state_t *yybottom, yy_state_t *yytop)
 {
   YYFPRINTF (stderr, "Stack now");
   for (; yybottom <= yytop; yybottom++)
@@ -871,21 +1114,22 @@ do {                                                            \
 `------------------------------------------------*/
 
 static void
-yy_reduce_print (yytype_int16 *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp, int yyrule, dsc_parse_context *context, void *scanner)
+yy_reduce_print (yy_state_t *yyssp, YYSTYPE *yyvsp, YYLTYPE *yylsp,
+                 int yyrule, dsc_parse_context *context, struct dsc_scanner *scanner)
 {
-  unsigned long int yylno = yyrline[yyrule];
+  int yylno = yyrline[yyrule];
   int yynrhs = yyr2[yyrule];
   int yyi;
-  YYFPRINTF (stderr, "Reducing stack by rule %d (line %lu):\n",
+  YYFPRINTF (stderr, "Reducing stack by rule %d (line %d):\n",
              yyrule - 1, yylno);
   /* The symbols being reduced.  */
   for (yyi = 0; yyi < yynrhs; yyi++)
     {
       YYFPRINTF (stderr, "   $%d = ", yyi + 1);
       yy_symbol_print (stderr,
-                       yystos[yyssp[yyi + 1 - yynrhs]],
-                       &(yyvsp[(yyi + 1) - (yynrhs)])
-                       , &(yylsp[(yyi + 1) - (yynrhs)])                       , context, scanner);
+                       YY_ACCESSING_SYMBOL (+yyssp[yyi + 1 - yynrhs]),
+                       &yyvsp[(yyi + 1) - (yynrhs)],
+                       &(yylsp[(yyi + 1) - (yynrhs)]), context, scanner);
       YYFPRINTF (stderr, "\n");
     }
 }
@@ -900,8 +1144,8 @@ do {                                    \
    multiple parsers can coexist.  */
 int yydebug;
 #else /* !YYDEBUG */
-# define YYDPRINTF(Args)
-# define YY_SYMBOL_PRINT(Title, Type, Value, Location)
+# define YYDPRINTF(Args) ((void) 0)
+# define YY_SYMBOL_PRINT(Title, Kind, Value, Location)
 # define YY_STACK_PRINT(Bottom, Top)
 # define YY_REDUCE_PRINT(Rule)
 #endif /* !YYDEBUG */
@@ -924,259 +1168,44 @@ int yydebug;
 #endif
 
 
-#if YYERROR_VERBOSE
-
-# ifndef yystrlen
-#  if defined __GLIBC__ && defined _STRING_H
-#   define yystrlen strlen
-#  else
-/* Return the length of YYSTR.  */
-static YYSIZE_T
-yystrlen (const char *yystr)
-{
-  YYSIZE_T yylen;
-  for (yylen = 0; yystr[yylen]; yylen++)
-    continue;
-  return yylen;
-}
-#  endif
-# endif
-
-# ifndef yystpcpy
-#  if defined __GLIBC__ && defined _STRING_H && defined _GNU_SOURCE
-#   define yystpcpy stpcpy
-#  else
-/* Copy YYSRC to YYDEST, returning the address of the terminating '\0' in
-   YYDEST.  */
-static char *
-yystpcpy (char *yydest, const char *yysrc)
-{
-  char *yyd = yydest;
-  const char *yys = yysrc;
-
-  while ((*yyd++ = *yys++) != '\0')
-    continue;
 
-  return yyd - 1;
-}
-#  endif
-# endif
 
-# ifndef yytnamerr
-/* Copy to YYRES the contents of YYSTR after stripping away unnecessary
-   quotes and backslashes, so that it's suitable for yyerror.  The
-   heuristic is that double-quoting is unnecessary unless the string
-   contains an apostrophe, a comma, or backslash (other than
-   backslash-backslash).  YYSTR is taken from yytname.  If YYRES is
-   null, do not copy; instead, return the length of what the result
-   would have been.  */
-static YYSIZE_T
-yytnamerr (char *yyres, const char *yystr)
-{
-  if (*yystr == '"')
-    {
-      YYSIZE_T yyn = 0;
-      char const *yyp = yystr;
-
-      for (;;)
-        switch (*++yyp)
-          {
-          case '\'':
-          case ',':
-            goto do_not_strip_quotes;
-
-          case '\\':
-            if (*++yyp != '\\')
-              goto do_not_strip_quotes;
-            /* Fall through.  */
-          default:
-            if (yyres)
-              yyres[yyn] = *yyp;
-            yyn++;
-            break;
-
-          case '"':
-            if (yyres)
-              yyres[yyn] = '\0';
-            return yyn;
-          }
-    do_not_strip_quotes: ;
-    }
-
-  if (! yyres)
-    return yystrlen (yystr);
 
-  return yystpcpy (yyres, yystr) - yyres;
-}
-# endif
-
-/* Copy into *YYMSG, which is of size *YYMSG_ALLOC, an error message
-   about the unexpected token YYTOKEN for the state stack whose top is
-   YYSSP.
-
-   Return 0 if *YYMSG was successfully written.  Return 1 if *YYMSG is
-   not large enough to hold the message.  In that case, also set
-   *YYMSG_ALLOC to the required number of bytes.  Return 2 if the
-   required number of bytes is too large to store.  */
-static int
-yysyntax_error (YYSIZE_T *yymsg_alloc, char **yymsg,
-                yytype_int16 *yyssp, int yytoken)
-{
-  YYSIZE_T yysize0 = yytnamerr (YY_NULLPTR, yytname[yytoken]);
-  YYSIZE_T yysize = yysize0;
-  enum { YYERROR_VERBOSE_ARGS_MAXIMUM = 5 };
-  /* Internationalized format string. */
-  const char *yyformat = YY_NULLPTR;
-  /* Arguments of yyformat. */
-  char const *yyarg[YYERROR_VERBOSE_ARGS_MAXIMUM];
-  /* Number of reported tokens (one for the "unexpected", one per
-     "expected"). */
-  int yycount = 0;
-
-  /* There are many possibilities here to consider:
-     - If this state is a consistent state with a default action, then
-       the only way this function was invoked is if the default action
-       is an error action.  In that case, don't check for expected
-       tokens because there are none.
-     - The only way there can be no lookahead present (in yychar) is if
-       this state is a consistent state with a default action.  Thus,
-       detecting the absence of a lookahead is sufficient to determine
-       that there is no unexpected or expected token to report.  In that
-       case, just report a simple "syntax error".
-     - Don't assume there isn't a lookahead just because this state is a
-       consistent state with a default action.  There might have been a
-       previous inconsistent state, consistent state with a non-default
-       action, or user semantic action that manipulated yychar.
-     - Of course, the expected token list depends on states to have
-       correct lookahead information, and it depends on the parser not
-       to perform extra reductions after fetching a lookahead from the
-       scanner and before detecting a syntax error.  Thus, state merging
-       (from LALR or IELR) and default reductions corrupt the expected
-       token list.  However, the list is correct for canonical LR with
-       one exception: it will still contain any token that will not be
-       accepted due to an error action in a later state.
-  */
-  if (yytoken != YYEMPTY)
-    {
-      int yyn = yypact[*yyssp];
-      yyarg[yycount++] = yytname[yytoken];
-      if (!yypact_value_is_default (yyn))
-        {
-          /* Start YYX at -YYN if negative to avoid negative indexes in
-             YYCHECK.  In other words, skip the first -YYN actions for
-             this state because they are default actions.  */
-          int yyxbegin = yyn < 0 ? -yyn : 0;
-          /* Stay within bounds of both yycheck and yytname.  */
-          int yychecklim = YYLAST - yyn + 1;
-          int yyxend = yychecklim < YYNTOKENS ? yychecklim : YYNTOKENS;
-          int yyx;
-
-          for (yyx = yyxbegin; yyx < yyxend; ++yyx)
-            if (yycheck[yyx + yyn] == yyx && yyx != YYTERROR
-                && !yytable_value_is_error (yytable[yyx + yyn]))
-              {
-                if (yycount == YYERROR_VERBOSE_ARGS_MAXIMUM)
-                  {
-                    yycount = 1;
-                    yysize = yysize0;
-                    break;
-                  }
-                yyarg[yycount++] = yytname[yyx];
-                {
-                  YYSIZE_T yysize1 = yysize + yytnamerr (YY_NULLPTR, yytname[yyx]);
-                  if (! (yysize <= yysize1
-                         && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-                    return 2;
-                  yysize = yysize1;
-                }
-              }
-        }
-    }
-
-  switch (yycount)
-    {
-# define YYCASE_(N, S)                      \
-      case N:                               \
-        yyformat = S;                       \
-      break
-      YYCASE_(0, YY_("syntax error"));
-      YYCASE_(1, YY_("syntax error, unexpected %s"));
-      YYCASE_(2, YY_("syntax error, unexpected %s, expecting %s"));
-      YYCASE_(3, YY_("syntax error, unexpected %s, expecting %s or %s"));
-      YYCASE_(4, YY_("syntax error, unexpected %s, expecting %s or %s or %s"));
-      YYCASE_(5, YY_("syntax error, unexpected %s, expecting %s or %s or %s or %s"));
-# undef YYCASE_
-    }
-
-  {
-    YYSIZE_T yysize1 = yysize + yystrlen (yyformat);
-    if (! (yysize <= yysize1 && yysize1 <= YYSTACK_ALLOC_MAXIMUM))
-      return 2;
-    yysize = yysize1;
-  }
-
-  if (*yymsg_alloc < yysize)
-    {
-      *yymsg_alloc = 2 * yysize;
-      if (! (yysize <= *yymsg_alloc
-             && *yymsg_alloc <= YYSTACK_ALLOC_MAXIMUM))
-        *yymsg_alloc = YYSTACK_ALLOC_MAXIMUM;
-      return 1;
-    }
-
-  /* Avoid sprintf, as that infringes on the user's name space.
-     Don't have undefined behavior even if the translation
-     produced a string with the wrong number of "%s"s.  */
-  {
-    char *yyp = *yymsg;
-    int yyi = 0;
-    while ((*yyp = *yyformat) != '\0')
-      if (*yyp == '%' && yyformat[1] == 's' && yyi < yycount)
-        {
-          yyp += yytnamerr (yyp, yyarg[yyi++]);
-          yyformat += 2;
-        }
-      else
-        {
-          yyp++;
-          yyformat++;
-        }
-  }
-  return 0;
-}
-#endif /* YYERROR_VERBOSE */
 
 /*-----------------------------------------------.
 | Release the memory associated to this symbol.  |
 `-----------------------------------------------*/
 
 static void
-yydestruct (const char *yymsg, int yytype, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, dsc_parse_context *context, void *scanner)
+yydestruct (const char *yymsg,
+            yysymbol_kind_t yykind, YYSTYPE *yyvaluep, YYLTYPE *yylocationp, dsc_parse_context *context, struct dsc_scanner *scanner)
 {
-  YYUSE (yyvaluep);
-  YYUSE (yylocationp);
-  YYUSE (context);
-  YYUSE (scanner);
+  YY_USE (yyvaluep);
+  YY_USE (yylocationp);
+  YY_USE (context);
+  YY_USE (scanner);
   if (!yymsg)
     yymsg = "Deleting";
-  YY_SYMBOL_PRINT (yymsg, yytype, yyvaluep, yylocationp);
+  YY_SYMBOL_PRINT (yymsg, yykind, yyvaluep, yylocationp);
 
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
-  YYUSE (yytype);
+  YY_USE (yykind);
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 }
 
 
 
 
+
+
 /*----------.
 | yyparse.  |
 `----------*/
 
 int
-yyparse (dsc_parse_context *context, void *scanner)
+yyparse (dsc_parse_context *context, struct dsc_scanner *scanner)
 {
-/* The lookahead symbol.  */
+/* Lookahead token kind.  */
 int yychar;
 
 
@@ -1195,55 +1224,47 @@ static YYLTYPE yyloc_default
 YYLTYPE yylloc = yyloc_default;
 
     /* Number of syntax errors so far.  */
-    int yynerrs;
+    int yynerrs = 0;
 
-    int yystate;
+    yy_state_fast_t yystate = 0;
     /* Number of tokens to shift before error messages enabled.  */
-    int yyerrstatus;
-
-    /* The stacks and their tools:
-       'yyss': related to states.
-       'yyvs': related to semantic values.
-       'yyls': related to locations.
+    int yyerrstatus = 0;
 
-       Refer to the stacks through separate pointers, to allow yyoverflow
+    /* Refer to the stacks through separate pointers, to allow yyoverflow
        to reallocate them elsewhere.  */
 
-    /* The state stack.  */
-    yytype_int16 yyssa[YYINITDEPTH];
-    yytype_int16 *yyss;
-    yytype_int16 *yyssp;
+    /* Their size.  */
+    YYPTRDIFF_T yystacksize = YYINITDEPTH;
 
-    /* The semantic value stack.  */
+    /* The state stack: array, bottom, top.  */
+    yy_state_t yyssa[YYINITDEPTH];
+    yy_state_t *yyss = yyssa;
+    yy_state_t *yyssp = yyss;
+
+    /* The semantic value stack: array, bottom, top.  */
     YYSTYPE yyvsa[YYINITDEPTH];
-    YYSTYPE *yyvs;
-    YYSTYPE *yyvsp;
+    YYSTYPE *yyvs = yyvsa;
+    YYSTYPE *yyvsp = yyvs;
 
-    /* The location stack.  */
+    /* The location stack: array, bottom, top.  */
     YYLTYPE yylsa[YYINITDEPTH];
-    YYLTYPE *yyls;
-    YYLTYPE *yylsp;
-
-    /* The locations where the error started and ended.  */
-    YYLTYPE yyerror_range[3];
-
-    YYSIZE_T yystacksize;
+    YYLTYPE *yyls = yylsa;
+    YYLTYPE *yylsp = yyls;
 
   int yyn;
+  /* The return value of yyparse.  */
   int yyresult;
-  /* Lookahead token as an internal (translated) token number.  */
-  int yytoken = 0;
+  /* Lookahead symbol kind.  */
+  yysymbol_kind_t yytoken = YYSYMBOL_YYEMPTY;
   /* The variables used to return semantic value and location from the
      action routines.  */
   YYSTYPE yyval;
   YYLTYPE yyloc;
 
-#if YYERROR_VERBOSE
-  /* Buffer for error messages, and its allocated size.  */
-  char yymsgbuf[128];
-  char *yymsg = yymsgbuf;
-  YYSIZE_T yymsg_alloc = sizeof yymsgbuf;
-#endif
+  /* The locations where the error started and ended.  */
+  YYLTYPE yyerror_range[3];
+
+
 
 #define YYPOPSTACK(N)   (yyvsp -= (N), yyssp -= (N), yylsp -= (N))
 
@@ -1251,43 +1272,49 @@ YYLTYPE yylloc = yyloc_default;
      Keep to zero when no symbol should be popped.  */
   int yylen = 0;
 
-  yyssp = yyss = yyssa;
-  yyvsp = yyvs = yyvsa;
-  yylsp = yyls = yylsa;
-  yystacksize = YYINITDEPTH;
-
   YYDPRINTF ((stderr, "Starting parse\n"));
 
-  yystate = 0;
-  yyerrstatus = 0;
-  yynerrs = 0;
   yychar = YYEMPTY; /* Cause a token to be read.  */
+
   yylsp[0] = yylloc;
   goto yysetstate;
 
+
 /*------------------------------------------------------------.
-| yynewstate -- Push a new state, which is found in yystate.  |
+| yynewstate -- push a new state, which is found in yystate.  |
 `------------------------------------------------------------*/
- yynewstate:
+yynewstate:
   /* In all cases, when you get here, the value and location stacks
      have just been pushed.  So pushing a state here evens the stacks.  */
   yyssp++;
 
- yysetstate:
-  *yyssp = yystate;
+
+/*--------------------------------------------------------------------.
+| yysetstate -- set current state (the top of the stack) to yystate.  |
+`--------------------------------------------------------------------*/
+yysetstate:
+  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
+  YY_ASSERT (0 <= yystate && yystate < YYNSTATES);
+  YY_IGNORE_USELESS_CAST_BEGIN
+  *yyssp = YY_CAST (yy_state_t, yystate);
+  YY_IGNORE_USELESS_CAST_END
+  YY_STACK_PRINT (yyss, yyssp);
 
   if (yyss + yystacksize - 1 <= yyssp)
+#if !defined yyoverflow && !defined YYSTACK_RELOCATE
+    YYNOMEM;
+#else
     {
       /* Get the current used size of the three stacks, in elements.  */
-      YYSIZE_T yysize = yyssp - yyss + 1;
+      YYPTRDIFF_T yysize = yyssp - yyss + 1;
 
-#ifdef yyoverflow
+# if defined yyoverflow
       {
         /* Give user a chance to reallocate the stack.  Use copies of
            these so that the &'s don't force the real ones into
            memory.  */
+        yy_state_t *yyss1 = yyss;
         YYSTYPE *yyvs1 = yyvs;
-        yytype_int16 *yyss1 = yyss;
         YYLTYPE *yyls1 = yyls;
 
         /* Each stack pointer address is followed by the size of the
@@ -1295,32 +1322,29 @@ YYLTYPE yylloc = yyloc_default;
            conditional around just the two extra args, but that might
            be undefined if yyoverflow is a macro.  */
         yyoverflow (YY_("memory exhausted"),
-                    &yyss1, yysize * sizeof (*yyssp),
-                    &yyvs1, yysize * sizeof (*yyvsp),
-                    &yyls1, yysize * sizeof (*yylsp),
+                    &yyss1, yysize * YYSIZEOF (*yyssp),
+                    &yyvs1, yysize * YYSIZEOF (*yyvsp),
+                    &yyls1, yysize * YYSIZEOF (*yylsp),
                     &yystacksize);
-
-        yyls = yyls1;
         yyss = yyss1;
         yyvs = yyvs1;
+        yyls = yyls1;
       }
-#else /* no yyoverflow */
-# ifndef YYSTACK_RELOCATE
-      goto yyexhaustedlab;
-# else
+# else /* defined YYSTACK_RELOCATE */
       /* Extend the stack our own way.  */
       if (YYMAXDEPTH <= yystacksize)
-        goto yyexhaustedlab;
+        YYNOMEM;
       yystacksize *= 2;
       if (YYMAXDEPTH < yystacksize)
         yystacksize = YYMAXDEPTH;
 
       {
-        yytype_int16 *yyss1 = yyss;
+        yy_state_t *yyss1 = yyss;
         union yyalloc *yyptr =
-          (union yyalloc *) YYSTACK_ALLOC (YYSTACK_BYTES (yystacksize));
+          YY_CAST (union yyalloc *,
+                   YYSTACK_ALLOC (YY_CAST (YYSIZE_T, YYSTACK_BYTES (yystacksize))));
         if (! yyptr)
-          goto yyexhaustedlab;
+          YYNOMEM;
         YYSTACK_RELOCATE (yyss_alloc, yyss);
         YYSTACK_RELOCATE (yyvs_alloc, yyvs);
         YYSTACK_RELOCATE (yyls_alloc, yyls);
@@ -1329,31 +1353,32 @@ YYLTYPE yylloc = yyloc_default;
           YYSTACK_FREE (yyss1);
       }
 # endif
-#endif /* no yyoverflow */
 
       yyssp = yyss + yysize - 1;
       yyvsp = yyvs + yysize - 1;
       yylsp = yyls + yysize - 1;
 
-      YYDPRINTF ((stderr, "Stack size increased to %lu\n",
-                  (unsigned long int) yystacksize));
+      YY_IGNORE_USELESS_CAST_BEGIN
+      YYDPRINTF ((stderr, "Stack size increased to %ld\n",
+                  YY_CAST (long, yystacksize)));
+      YY_IGNORE_USELESS_CAST_END
 
       if (yyss + yystacksize - 1 <= yyssp)
         YYABORT;
     }
+#endif /* !defined yyoverflow && !defined YYSTACK_RELOCATE */
 
-  YYDPRINTF ((stderr, "Entering state %d\n", yystate));
 
   if (yystate == YYFINAL)
     YYACCEPT;
 
   goto yybackup;
 
+
 /*-----------.
 | yybackup.  |
 `-----------*/
 yybackup:
-
   /* Do appropriate processing given the current state.  Read a
      lookahead token if we need one and don't already have one.  */
 
@@ -1364,18 +1389,30 @@ yybackup:
 
   /* Not known => get a lookahead token if don't already have one.  */
 
-  /* YYCHAR is either YYEMPTY or YYEOF or a valid lookahead symbol.  */
+  /* YYCHAR is either empty, or end-of-input, or a valid lookahead.  */
   if (yychar == YYEMPTY)
     {
-      YYDPRINTF ((stderr, "Reading a token: "));
+      YYDPRINTF ((stderr, "Reading a token\n"));
       yychar = yylex (&yylval, &yylloc, scanner);
     }
 
   if (yychar <= YYEOF)
     {
-      yychar = yytoken = YYEOF;
+      yychar = YYEOF;
+      yytoken = YYSYMBOL_YYEOF;
       YYDPRINTF ((stderr, "Now at end of input.\n"));
     }
+  else if (yychar == YYerror)
+    {
+      /* The scanner already issued an error message, process directly
+         to error recovery.  But do not keep the error token as
+         lookahead, it is too special and may lead us to an endless
+         loop in error recovery. */
+      yychar = YYUNDEF;
+      yytoken = YYSYMBOL_YYerror;
+      yyerror_range[1] = yylloc;
+      goto yyerrlab1;
+    }
   else
     {
       yytoken = YYTRANSLATE (yychar);
@@ -1403,15 +1440,14 @@ yybackup:
 
   /* Shift the lookahead token.  */
   YY_SYMBOL_PRINT ("Shifting", yytoken, &yylval, &yylloc);
-
-  /* Discard the shifted token.  */
-  yychar = YYEMPTY;
-
   yystate = yyn;
   YY_IGNORE_MAYBE_UNINITIALIZED_BEGIN
   *++yyvsp = yylval;
   YY_IGNORE_MAYBE_UNINITIALIZED_END
   *++yylsp = yylloc;
+
+  /* Discard the shifted token.  */
+  yychar = YYEMPTY;
   goto yynewstate;
 
 
@@ -1426,7 +1462,7 @@ yydefault:
 
 
 /*-----------------------------.
-| yyreduce -- Do a reduction.  |
+| yyreduce -- do a reduction.  |
 `-----------------------------*/
 yyreduce:
   /* yyn is the number of a rule to reduce with.  */
@@ -1442,337 +1478,601 @@ yyreduce:
      GCC warning that YYVAL may be used uninitialized.  */
   yyval = yyvsp[1-yylen];
 
-  /* Default location.  */
+  /* Default location. */
   YYLLOC_DEFAULT (yyloc, (yylsp - yylen), yylen);
+  yyerror_range[1] = yyloc;
   YY_REDUCE_PRINT (yyn);
   switch (yyn)
     {
-        case 2:
-#line 91 "parser.y" /* yacc.c:1646  */
-    { context->parsed_module = (yyvsp[0].proc_list); }
-#line 1454 "parser.c" /* yacc.c:1646  */
+  case 2: /* dash_module: nonempty_proc_list  */
+#line 125 "parser.y"
+                           { context->parsed_module = (yyvsp[0].proc_list); }
+#line 1491 "parser.c"
+    break;
+
+  case 3: /* type: TOKEN_TYPE  */
+#line 128 "parser.y"
+                                        { (yyval.type) = (yyvsp[0].type); }
+#line 1497 "parser.c"
     break;
 
-  case 3:
-#line 94 "parser.y" /* yacc.c:1646  */
-    { (yyval.type) = (yyvsp[0].type); }
-#line 1460 "parser.c" /* yacc.c:1646  */
+  case 4: /* type: identifier  */
+#line 130 "parser.y"
+        {
+		dst_struct *value = dst_find_struct((yyvsp[0].identifier), &context->structs);
+
+		if (value == NULL)
+		{
+			dsc_error("unknown type %s, on line: %d", (yyvsp[0].identifier)->text, (yylsp[0]).first_line);
+			YYERROR;
+		}
+
+		(yyval.type) = value->type;
+	}
+#line 1513 "parser.c"
     break;
 
-  case 4:
-#line 97 "parser.y" /* yacc.c:1646  */
-    { (yyval.identifier) = (yyvsp[0].string); }
-#line 1466 "parser.c" /* yacc.c:1646  */
+  case 5: /* type: TOKEN_TYPE '[' ']'  */
+#line 142 "parser.y"
+        {
+		if ((yyvsp[-2].type) != dst_type_integer && (yyvsp[-2].type) != dst_type_real)
+		{
+			dsc_error("arrays can only hold integers or reals, on line: %d", (yylsp[-2]).first_line);
+			YYERROR;
+		}
+
+		(yyval.type) = dst_type_array_of((yyvsp[-2].type));
+	}
+#line 1527 "parser.c"
     break;
 
-  case 5:
-#line 101 "parser.y" /* yacc.c:1646  */
-    {
+  case 6: /* identifier: TOKEN_IDENTIFIER  */
+#line 153 "parser.y"
+                         { (yyval.identifier) = (yyvsp[0].atom); }
+#line 1533 "parser.c"
+    break;
+
+  case 7: /* statement: TOKEN_LET nonempty_identifier_list '=' nonempty_expression_list ';'  */
+#line 157 "parser.y"
+        {
 		(yyval.statement) = dst_create_statement_definition((yyvsp[-3].identifier_list), (yyvsp[-1].expression_list), context->memory);
 	}
-#line 1474 "parser.c" /* yacc.c:1646  */
+#line 1541 "parser.c"
     break;
 
-  case 6:
-#line 105 "parser.y" /* yacc.c:1646  */
-    {
+  case 8: /* statement: nonempty_identifier_list '=' nonempty_expression_list ';'  */
+#line 161 "parser.y"
+        {
 		(yyval.statement) = dst_create_statement_assignment((yyvsp[-3].identifier_list), (yyvsp[-1].expression_list), context->memory);
 	}
-#line 1482 "parser.c" /* yacc.c:1646  */
+#line 1549 "parser.c"
     break;
 
-  case 7:
-#line 109 "parser.y" /* yacc.c:1646  */
-    {
-		(yyval.statement) = dst_create_statement_call((yyvsp[-4].identifier), (yyvsp[-2].expression_list), context->memory);
+  case 9: /* statement: identifier '(' expression_list ')' ';'  */
+#line 165 "parser.y"
+        {
+		(yyval.statement) = dst_create_statement_call((yyvsp[-4].identifier), (yyvsp[-2].expression_list), context->site_count++, context->memory);
 	}
-#line 1490 "parser.c" /* yacc.c:1646  */
+#line 1557 "parser.c"
     break;
 
-  case 8:
-#line 113 "parser.y" /* yacc.c:1646  */
-    {
+  case 10: /* statement: identifier '[' expression ']' '=' expression ';'  */
+#line 169 "parser.y"
+        {
+		(yyval.statement) = dst_create_statement_store((yyvsp[-6].identifier), (yyvsp[-4].expression), (yyvsp[-1].expression), context->memory);
+	}
+#line 1565 "parser.c"
+    break;
+
+  case 11: /* statement: identifier field_path '=' expression ';'  */
+#line 173 "parser.y"
+        {
+		(yyval.statement) = dst_create_statement_field_store((yyvsp[-4].identifier), (yyvsp[-3].identifier_list), (yyvsp[-1].expression), context->memory);
+	}
+#line 1573 "parser.c"
+    break;
+
+  case 12: /* statement: statement_block  */
+#line 177 "parser.y"
+        {
 		(yyval.statement) = dst_create_statement_block((yyvsp[0].statement_list), context->memory);
 	}
-#line 1498 "parser.c" /* yacc.c:1646  */
+#line 1581 "parser.c"
     break;
 
-  case 9:
-#line 117 "parser.y" /* yacc.c:1646  */
-    {
-		(yyval.statement) = dst_create_statement_if((yyvsp[-4].expression), (yyvsp[-2].statement), (yyvsp[0].statement), context->memory);
+  case 13: /* statement: TOKEN_IF '(' expression ')' statement TOKEN_ELSE statement  */
+#line 181 "parser.y"
+        {
+		(yyval.statement) = dst_create_statement_if((yyvsp[-4].expression), (yyvsp[-2].statement), (yyvsp[0].statement), context->site_count++, context->memory);
 	}
-#line 1506 "parser.c" /* yacc.c:1646  */
+#line 1589 "parser.c"
     break;
 
-  case 10:
-#line 121 "parser.y" /* yacc.c:1646  */
-    {
-		(yyval.statement) = dst_create_statement_if((yyvsp[-2].expression), (yyvsp[0].statement), NULL, context->memory);
+  case 14: /* statement: TOKEN_IF '(' expression ')' statement  */
+#line 185 "parser.y"
+        {
+		(yyval.statement) = dst_create_statement_if((yyvsp[-2].expression), (yyvsp[0].statement), NULL, context->site_count++, context->memory);
 	}
-#line 1514 "parser.c" /* yacc.c:1646  */
+#line 1597 "parser.c"
     break;
 
-  case 11:
-#line 125 "parser.y" /* yacc.c:1646  */
-    {
+  case 15: /* statement: TOKEN_WHILE '(' expression ')' statement  */
+#line 189 "parser.y"
+        {
 		(yyval.statement) = dst_create_statement_while((yyvsp[-2].expression), (yyvsp[0].statement), context->memory);
 	}
-#line 1522 "parser.c" /* yacc.c:1646  */
+#line 1605 "parser.c"
     break;
 
-  case 12:
-#line 129 "parser.y" /* yacc.c:1646  */
-    {
+  case 16: /* statement: TOKEN_FOR '(' identifier '=' expression ',' expression ')' statement  */
+#line 193 "parser.y"
+        {
+		(yyval.statement) = dst_create_statement_for((yyvsp[-6].identifier), (yyvsp[-4].expression), (yyvsp[-2].expression), (yyvsp[0].statement), context->memory);
+	}
+#line 1613 "parser.c"
+    break;
+
+  case 17: /* statement: TOKEN_RETURN expression_list ';'  */
+#line 197 "parser.y"
+        {
 		(yyval.statement) = dst_create_statement_return((yyvsp[-1].expression_list), context->memory);
 	}
-#line 1530 "parser.c" /* yacc.c:1646  */
+#line 1621 "parser.c"
     break;
 
-  case 13:
-#line 134 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_int((yyvsp[0].integer), context->memory); }
-#line 1536 "parser.c" /* yacc.c:1646  */
+  case 18: /* statement: TOKEN_YIELD ';'  */
+#line 201 "parser.y"
+        {
+		(yyval.statement) = dst_create_statement_yield(context->memory);
+	}
+#line 1629 "parser.c"
     break;
 
-  case 14:
-#line 135 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_real((yyvsp[0].real), context->memory); }
-#line 1542 "parser.c" /* yacc.c:1646  */
+  case 19: /* statement: TOKEN_SWITCH '(' expression ')' '{' switch_case_list '}'  */
+#line 205 "parser.y"
+        {
+		(yyval.statement) = dst_create_statement_switch((yyvsp[-4].expression), (yyvsp[-1].switch_case_list), context->memory);
+	}
+#line 1637 "parser.c"
     break;
 
-  case 15:
-#line 136 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_var((yyvsp[0].identifier), context->memory); }
-#line 1548 "parser.c" /* yacc.c:1646  */
+  case 20: /* switch_case: TOKEN_CASE nonempty_expression_list ':' statement  */
+#line 210 "parser.y"
+                                                                { (yyval.switch_case) = dst_create_switch_case((yyvsp[-2].expression_list), (yyvsp[0].statement), context->memory); }
+#line 1643 "parser.c"
     break;
 
-  case 16:
-#line 138 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_addition, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1554 "parser.c" /* yacc.c:1646  */
+  case 21: /* switch_case: TOKEN_DEFAULT ':' statement  */
+#line 211 "parser.y"
+                                                                                        { (yyval.switch_case) = dst_create_switch_case(NULL, (yyvsp[0].statement), context->memory); }
+#line 1649 "parser.c"
     break;
 
-  case 17:
-#line 139 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_subtraction, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1560 "parser.c" /* yacc.c:1646  */
+  case 22: /* expression: TOKEN_INTEGER  */
+#line 214 "parser.y"
+                                                                                        { (yyval.expression) = dst_create_exp_int((yyvsp[0].integer), context->memory); }
+#line 1655 "parser.c"
     break;
 
-  case 18:
-#line 140 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_multiplication, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1566 "parser.c" /* yacc.c:1646  */
+  case 23: /* expression: TOKEN_REAL  */
+#line 215 "parser.y"
+                                                                                                { (yyval.expression) = dst_create_exp_real((yyvsp[0].real), context->memory); }
+#line 1661 "parser.c"
     break;
 
-  case 19:
-#line 141 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_division, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1572 "parser.c" /* yacc.c:1646  */
+  case 24: /* expression: TOKEN_LONG  */
+#line 216 "parser.y"
+                                                                                                { (yyval.expression) = dst_create_exp_long((yyvsp[0].long_integer), context->memory); }
+#line 1667 "parser.c"
     break;
 
-  case 20:
-#line 143 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_and, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1578 "parser.c" /* yacc.c:1646  */
+  case 25: /* expression: TOKEN_DOUBLE  */
+#line 217 "parser.y"
+                                                                                        { (yyval.expression) = dst_create_exp_double((yyvsp[0].double_real), context->memory); }
+#line 1673 "parser.c"
     break;
 
-  case 21:
-#line 144 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_or, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1584 "parser.c" /* yacc.c:1646  */
+  case 26: /* expression: TOKEN_STRING  */
+#line 218 "parser.y"
+                                                                                        { (yyval.expression) = dst_create_exp_string((yyvsp[0].atom), context->memory); }
+#line 1679 "parser.c"
     break;
 
-  case 22:
-#line 145 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_unary(dst_exp_type_not, (yyvsp[0].expression), context->memory); }
-#line 1590 "parser.c" /* yacc.c:1646  */
+  case 27: /* expression: identifier  */
+#line 219 "parser.y"
+                                                                                                { (yyval.expression) = dst_create_exp_var((yyvsp[0].identifier), context->memory); }
+#line 1685 "parser.c"
     break;
 
-  case 23:
-#line 146 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_eq, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1596 "parser.c" /* yacc.c:1646  */
+  case 28: /* expression: expression TOKEN_OP_ADD expression  */
+#line 221 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_addition, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1691 "parser.c"
     break;
 
-  case 24:
-#line 147 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_less, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1602 "parser.c" /* yacc.c:1646  */
+  case 29: /* expression: expression TOKEN_OP_SUB expression  */
+#line 222 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_subtraction, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1697 "parser.c"
     break;
 
-  case 25:
-#line 148 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_less_eq, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1608 "parser.c" /* yacc.c:1646  */
+  case 30: /* expression: expression TOKEN_OP_MUL expression  */
+#line 223 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_multiplication, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1703 "parser.c"
     break;
 
-  case 26:
-#line 149 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_greater, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1614 "parser.c" /* yacc.c:1646  */
+  case 31: /* expression: expression TOKEN_OP_DIV expression  */
+#line 224 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_division, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1709 "parser.c"
     break;
 
-  case 27:
-#line 150 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_binary(dst_exp_type_greater_eq, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
-#line 1620 "parser.c" /* yacc.c:1646  */
+  case 32: /* expression: expression TOKEN_OP_MOD expression  */
+#line 225 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_modulo, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1715 "parser.c"
     break;
 
-  case 28:
-#line 152 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_call((yyvsp[-3].identifier), (yyvsp[-1].expression_list), context->memory); }
-#line 1626 "parser.c" /* yacc.c:1646  */
+  case 33: /* expression: expression TOKEN_OP_SHL expression  */
+#line 227 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_shift_left, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1721 "parser.c"
     break;
 
-  case 29:
-#line 153 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = dst_create_exp_cast((yyvsp[-2].type), (yyvsp[0].expression), context->memory); }
-#line 1632 "parser.c" /* yacc.c:1646  */
+  case 34: /* expression: expression TOKEN_OP_SHR expression  */
+#line 228 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_shift_right, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1727 "parser.c"
     break;
 
-  case 30:
-#line 154 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression) = (yyvsp[-1].expression); }
-#line 1638 "parser.c" /* yacc.c:1646  */
+  case 35: /* expression: expression TOKEN_OP_BIT_AND expression  */
+#line 229 "parser.y"
+                                                                { (yyval.expression) = dst_create_exp_binary(dst_exp_type_bit_and, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1733 "parser.c"
     break;
 
-  case 31:
-#line 157 "parser.y" /* yacc.c:1646  */
-    { (yyval.proc_param) = dst_create_proc_param((yyvsp[-2].identifier), (yyvsp[0].type), context->memory); }
-#line 1644 "parser.c" /* yacc.c:1646  */
+  case 36: /* expression: expression TOKEN_OP_BIT_OR expression  */
+#line 230 "parser.y"
+                                                                { (yyval.expression) = dst_create_exp_binary(dst_exp_type_bit_or, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1739 "parser.c"
     break;
 
-  case 32:
-#line 161 "parser.y" /* yacc.c:1646  */
-    {
-		(yyval.proc) = dst_create_proc((yyvsp[-9].identifier), (yyvsp[-6].proc_param_list), (yyvsp[-2].type_list), (yyvsp[0].statement), context->memory);
+  case 37: /* expression: expression TOKEN_OP_BIT_XOR expression  */
+#line 231 "parser.y"
+                                                                { (yyval.expression) = dst_create_exp_binary(dst_exp_type_bit_xor, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1745 "parser.c"
+    break;
+
+  case 38: /* expression: expression TOKEN_OP_AND expression  */
+#line 233 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_and, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1751 "parser.c"
+    break;
+
+  case 39: /* expression: expression TOKEN_OP_OR expression  */
+#line 234 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_or, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1757 "parser.c"
+    break;
+
+  case 40: /* expression: TOKEN_OP_NOT expression  */
+#line 235 "parser.y"
+                                                                                { (yyval.expression) = dst_create_exp_unary(dst_exp_type_not, (yyvsp[0].expression), context->memory); }
+#line 1763 "parser.c"
+    break;
+
+  case 41: /* expression: expression TOKEN_OP_EQ expression  */
+#line 236 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_eq, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1769 "parser.c"
+    break;
+
+  case 42: /* expression: expression TOKEN_OP_LESS expression  */
+#line 237 "parser.y"
+                                                                        { (yyval.expression) = dst_create_exp_binary(dst_exp_type_less, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1775 "parser.c"
+    break;
+
+  case 43: /* expression: expression TOKEN_OP_LESS_EQ expression  */
+#line 238 "parser.y"
+                                                                { (yyval.expression) = dst_create_exp_binary(dst_exp_type_less_eq, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1781 "parser.c"
+    break;
+
+  case 44: /* expression: expression TOKEN_OP_GREATER expression  */
+#line 239 "parser.y"
+                                                                { (yyval.expression) = dst_create_exp_binary(dst_exp_type_greater, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1787 "parser.c"
+    break;
+
+  case 45: /* expression: expression TOKEN_OP_GREATER_EQ expression  */
+#line 240 "parser.y"
+                                                                { (yyval.expression) = dst_create_exp_binary(dst_exp_type_greater_eq, (yyvsp[-2].expression), (yyvsp[0].expression), context->memory); }
+#line 1793 "parser.c"
+    break;
+
+  case 46: /* expression: identifier '(' expression_list ')'  */
+#line 242 "parser.y"
+                                                { (yyval.expression) = dst_create_exp_call((yyvsp[-3].identifier), (yyvsp[-1].expression_list), context->site_count++, context->memory); }
+#line 1799 "parser.c"
+    break;
+
+  case 47: /* expression: TOKEN_TYPE '[' expression ']'  */
+#line 243 "parser.y"
+                                                { (yyval.expression) = dst_create_exp_array((yyvsp[-3].type), (yyvsp[-1].expression), context->memory); }
+#line 1805 "parser.c"
+    break;
+
+  case 48: /* expression: expression '[' expression ']'  */
+#line 244 "parser.y"
+                                                { (yyval.expression) = dst_create_exp_index((yyvsp[-3].expression), (yyvsp[-1].expression), context->memory); }
+#line 1811 "parser.c"
+    break;
+
+  case 49: /* expression: expression '.' identifier  */
+#line 245 "parser.y"
+                                                        { (yyval.expression) = dst_create_exp_field((yyvsp[-2].expression), (yyvsp[0].identifier), context->memory); }
+#line 1817 "parser.c"
+    break;
+
+  case 50: /* expression: '(' TOKEN_TYPE ')' expression  */
+#line 246 "parser.y"
+                                                { (yyval.expression) = dst_create_exp_cast((yyvsp[-2].type), (yyvsp[0].expression), context->memory); }
+#line 1823 "parser.c"
+    break;
+
+  case 51: /* expression: '(' expression ')'  */
+#line 247 "parser.y"
+                                                                { (yyval.expression) = (yyvsp[-1].expression); }
+#line 1829 "parser.c"
+    break;
+
+  case 52: /* proc_param: identifier ':' type  */
+#line 250 "parser.y"
+                            { (yyval.proc_param) = dst_create_proc_param((yyvsp[-2].identifier), (yyvsp[0].type), context->memory); }
+#line 1835 "parser.c"
+    break;
+
+  case 53: /* proc: TOKEN_DEF identifier ':' '(' proc_param_list ')' TOKEN_ARROW '(' type_list ')' statement  */
+#line 254 "parser.y"
+        {
+		(yyval.proc) = dst_create_proc((yyvsp[-9].identifier), (yyvsp[-6].proc_param_list), (yyvsp[-2].type_list), (yyvsp[0].statement), context->first_site, context->memory);
+		context->first_site = context->site_count;
 	}
-#line 1652 "parser.c" /* yacc.c:1646  */
+#line 1844 "parser.c"
     break;
 
-  case 33:
-#line 166 "parser.y" /* yacc.c:1646  */
-    { (yyval.statement_list) = NULL; }
-#line 1658 "parser.c" /* yacc.c:1646  */
+  case 54: /* global_decl: TOKEN_LET identifier '=' expression ';'  */
+#line 261 "parser.y"
+        {
+		context->globals = dst_append_global_list(context->globals, dst_create_global((yyvsp[-3].identifier), dst_type_integer, (yyvsp[-1].expression), 0, context->memory), context->memory);
+	}
+#line 1852 "parser.c"
     break;
 
-  case 34:
-#line 167 "parser.y" /* yacc.c:1646  */
-    { (yyval.statement_list) = (yyvsp[-1].statement_list); }
-#line 1664 "parser.c" /* yacc.c:1646  */
+  case 55: /* global_decl: TOKEN_LET identifier ':' type ';'  */
+#line 265 "parser.y"
+        {
+		context->globals = dst_append_global_list(context->globals, dst_create_global((yyvsp[-3].identifier), (yyvsp[-1].type), NULL, 0, context->memory), context->memory);
+	}
+#line 1860 "parser.c"
     break;
 
-  case 35:
-#line 170 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression_list) = NULL; }
-#line 1670 "parser.c" /* yacc.c:1646  */
+  case 56: /* global_decl: TOKEN_CONST identifier '=' expression ';'  */
+#line 269 "parser.y"
+        {
+		context->globals = dst_append_global_list(context->globals, dst_create_global((yyvsp[-3].identifier), dst_type_integer, (yyvsp[-1].expression), 1, context->memory), context->memory);
+	}
+#line 1868 "parser.c"
     break;
 
-  case 36:
-#line 171 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression_list) = (yyvsp[0].expression_list); }
-#line 1676 "parser.c" /* yacc.c:1646  */
+  case 57: /* struct_decl: TOKEN_STRUCT identifier '{' nonempty_proc_param_list '}'  */
+#line 275 "parser.y"
+        {
+		if (dst_find_struct((yyvsp[-3].identifier), &context->structs) != NULL)
+		{
+			dsc_error("struct %s is already declared, on line: %d", (yyvsp[-3].identifier)->text, (yylsp[-3]).first_line);
+			YYERROR;
+		}
+
+		dst_proc_param_list *field = (yyvsp[-1].proc_param_list);
+
+		do
+		{
+			for (dst_proc_param_list *other = field->next; other != (yyvsp[-1].proc_param_list); other = other->next)
+			{
+				if (other->value->id == field->value->id)
+				{
+					dsc_error("struct %s has more than one field named %s, on line: %d", (yyvsp[-3].identifier)->text, field->value->id->text, (yylsp[-3]).first_line);
+					YYERROR;
+				}
+			}
+
+			field = field->next;
+
+		} while (field != (yyvsp[-1].proc_param_list));
+
+		if (dst_create_struct((yyvsp[-3].identifier), (yyvsp[-1].proc_param_list), &context->structs, context->memory) == NULL)
+		{
+			dsc_error_oom();
+			YYABORT;
+		}
+	}
+#line 1903 "parser.c"
     break;
 
-  case 37:
-#line 174 "parser.y" /* yacc.c:1646  */
-    { (yyval.type_list) = NULL; }
-#line 1682 "parser.c" /* yacc.c:1646  */
+  case 58: /* statement_block: '{' '}'  */
+#line 307 "parser.y"
+                                                                        { (yyval.statement_list) = NULL; }
+#line 1909 "parser.c"
     break;
 
-  case 38:
-#line 175 "parser.y" /* yacc.c:1646  */
-    { (yyval.type_list) = (yyvsp[0].type_list); }
-#line 1688 "parser.c" /* yacc.c:1646  */
+  case 59: /* statement_block: '{' nonempty_statement_block '}'  */
+#line 308 "parser.y"
+                                                { (yyval.statement_list) = (yyvsp[-1].statement_list); }
+#line 1915 "parser.c"
     break;
 
-  case 39:
-#line 178 "parser.y" /* yacc.c:1646  */
-    { (yyval.proc_param_list) = NULL; }
-#line 1694 "parser.c" /* yacc.c:1646  */
+  case 60: /* expression_list: %empty  */
+#line 311 "parser.y"
+                                                        { (yyval.expression_list) = NULL; }
+#line 1921 "parser.c"
     break;
 
-  case 40:
-#line 179 "parser.y" /* yacc.c:1646  */
-    { (yyval.proc_param_list) = (yyvsp[0].proc_param_list); }
-#line 1700 "parser.c" /* yacc.c:1646  */
+  case 61: /* expression_list: nonempty_expression_list  */
+#line 312 "parser.y"
+                                        { (yyval.expression_list) = (yyvsp[0].expression_list); }
+#line 1927 "parser.c"
     break;
 
-  case 41:
-#line 182 "parser.y" /* yacc.c:1646  */
-    { (yyval.statement_list) = dst_append_statement_list(NULL, (yyvsp[0].statement), context->memory); }
-#line 1706 "parser.c" /* yacc.c:1646  */
+  case 62: /* type_list: %empty  */
+#line 315 "parser.y"
+                                        { (yyval.type_list) = NULL; }
+#line 1933 "parser.c"
     break;
 
-  case 42:
-#line 183 "parser.y" /* yacc.c:1646  */
-    { (yyval.statement_list) = dst_append_statement_list((yyvsp[-1].statement_list), (yyvsp[0].statement), context->memory); }
-#line 1712 "parser.c" /* yacc.c:1646  */
+  case 63: /* type_list: nonempty_type_list  */
+#line 316 "parser.y"
+                                { (yyval.type_list) = (yyvsp[0].type_list); }
+#line 1939 "parser.c"
     break;
 
-  case 43:
-#line 186 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression_list) = dst_append_exp_list(NULL, (yyvsp[0].expression), context->memory); }
-#line 1718 "parser.c" /* yacc.c:1646  */
+  case 64: /* switch_case_list: %empty  */
+#line 319 "parser.y"
+                                                                        { (yyval.switch_case_list) = NULL; }
+#line 1945 "parser.c"
     break;
 
-  case 44:
-#line 187 "parser.y" /* yacc.c:1646  */
-    { (yyval.expression_list) = dst_append_exp_list((yyvsp[-2].expression_list), (yyvsp[0].expression), context->memory); }
-#line 1724 "parser.c" /* yacc.c:1646  */
+  case 65: /* switch_case_list: switch_case_list switch_case  */
+#line 320 "parser.y"
+                                                { (yyval.switch_case_list) = dst_append_switch_case_list((yyvsp[-1].switch_case_list), (yyvsp[0].switch_case), context->memory); }
+#line 1951 "parser.c"
     break;
 
-  case 45:
-#line 190 "parser.y" /* yacc.c:1646  */
-    { (yyval.type_list) = dst_append_type_list(NULL, (yyvsp[0].type), context->memory); }
-#line 1730 "parser.c" /* yacc.c:1646  */
+  case 66: /* proc_param_list: %empty  */
+#line 323 "parser.y"
+                                                        { (yyval.proc_param_list) = NULL; }
+#line 1957 "parser.c"
     break;
 
-  case 46:
-#line 191 "parser.y" /* yacc.c:1646  */
-    { (yyval.type_list) = dst_append_type_list((yyvsp[-2].type_list), (yyvsp[0].type), context->memory); }
-#line 1736 "parser.c" /* yacc.c:1646  */
+  case 67: /* proc_param_list: nonempty_proc_param_list  */
+#line 324 "parser.y"
+                                        { (yyval.proc_param_list) = (yyvsp[0].proc_param_list); }
+#line 1963 "parser.c"
     break;
 
-  case 47:
-#line 194 "parser.y" /* yacc.c:1646  */
-    { (yyval.proc_param_list) = dst_append_func_param_list(NULL, (yyvsp[0].proc_param), context->memory); }
-#line 1742 "parser.c" /* yacc.c:1646  */
+  case 68: /* nonempty_statement_block: statement  */
+#line 327 "parser.y"
+                                                                                { (yyval.statement_list) = dst_append_statement_list(NULL, (yyvsp[0].statement), context->memory); }
+#line 1969 "parser.c"
     break;
 
-  case 48:
-#line 195 "parser.y" /* yacc.c:1646  */
-    { (yyval.proc_param_list) = dst_append_func_param_list((yyvsp[-2].proc_param_list), (yyvsp[0].proc_param), context->memory); }
-#line 1748 "parser.c" /* yacc.c:1646  */
+  case 69: /* nonempty_statement_block: nonempty_statement_block statement  */
+#line 328 "parser.y"
+                                                        { (yyval.statement_list) = dst_append_statement_list((yyvsp[-1].statement_list), (yyvsp[0].statement), context->memory); }
+#line 1975 "parser.c"
     break;
 
-  case 49:
-#line 198 "parser.y" /* yacc.c:1646  */
-    { (yyval.identifier_list) = dst_append_id_list(NULL, (yyvsp[0].identifier), context->memory); }
-#line 1754 "parser.c" /* yacc.c:1646  */
+  case 70: /* nonempty_expression_list: expression  */
+#line 331 "parser.y"
+                                                                                { (yyval.expression_list) = dst_append_exp_list(NULL, (yyvsp[0].expression), context->memory); }
+#line 1981 "parser.c"
     break;
 
-  case 50:
-#line 199 "parser.y" /* yacc.c:1646  */
-    { (yyval.identifier_list) = dst_append_id_list((yyvsp[-2].identifier_list), (yyvsp[0].identifier), context->memory); }
-#line 1760 "parser.c" /* yacc.c:1646  */
+  case 71: /* nonempty_expression_list: nonempty_expression_list ',' expression  */
+#line 332 "parser.y"
+                                                { (yyval.expression_list) = dst_append_exp_list((yyvsp[-2].expression_list), (yyvsp[0].expression), context->memory); }
+#line 1987 "parser.c"
     break;
 
-  case 51:
-#line 202 "parser.y" /* yacc.c:1646  */
-    { (yyval.proc_list) = dst_append_func_list(NULL, (yyvsp[0].proc), context->memory); }
-#line 1766 "parser.c" /* yacc.c:1646  */
+  case 72: /* nonempty_type_list: type  */
+#line 335 "parser.y"
+                                                        { (yyval.type_list) = dst_append_type_list(NULL, (yyvsp[0].type), context->memory); }
+#line 1993 "parser.c"
     break;
 
-  case 52:
-#line 203 "parser.y" /* yacc.c:1646  */
-    { (yyval.proc_list) = dst_append_func_list((yyvsp[-1].proc_list), (yyvsp[0].proc), context->memory); }
-#line 1772 "parser.c" /* yacc.c:1646  */
+  case 73: /* nonempty_type_list: nonempty_type_list ',' type  */
+#line 336 "parser.y"
+                                    { (yyval.type_list) = dst_append_type_list((yyvsp[-2].type_list), (yyvsp[0].type), context->memory); }
+#line 1999 "parser.c"
     break;
 
+  case 74: /* nonempty_proc_param_list: proc_param  */
+#line 339 "parser.y"
+                                                                                        { (yyval.proc_param_list) = dst_append_func_param_list(NULL, (yyvsp[0].proc_param), context->memory); }
+#line 2005 "parser.c"
+    break;
+
+  case 75: /* nonempty_proc_param_list: nonempty_proc_param_list ',' proc_param  */
+#line 340 "parser.y"
+                                                        { (yyval.proc_param_list) = dst_append_func_param_list((yyvsp[-2].proc_param_list), (yyvsp[0].proc_param), context->memory); }
+#line 2011 "parser.c"
+    break;
+
+  case 76: /* field_path: '.' identifier  */
+#line 343 "parser.y"
+                                                { (yyval.identifier_list) = dst_append_id_list(NULL, (yyvsp[0].identifier), context->memory); }
+#line 2017 "parser.c"
+    break;
+
+  case 77: /* field_path: field_path '.' identifier  */
+#line 344 "parser.y"
+                                        { (yyval.identifier_list) = dst_append_id_list((yyvsp[-2].identifier_list), (yyvsp[0].identifier), context->memory); }
+#line 2023 "parser.c"
+    break;
+
+  case 78: /* nonempty_identifier_list: identifier  */
+#line 347 "parser.y"
+                                                                                { (yyval.identifier_list) = dst_append_id_list(NULL, (yyvsp[0].identifier), context->memory); }
+#line 2029 "parser.c"
+    break;
+
+  case 79: /* nonempty_identifier_list: nonempty_identifier_list ',' identifier  */
+#line 348 "parser.y"
+                                                { (yyval.identifier_list) = dst_append_id_list((yyvsp[-2].identifier_list), (yyvsp[0].identifier), context->memory); }
+#line 2035 "parser.c"
+    break;
+
+  case 80: /* nonempty_proc_list: proc  */
+#line 351 "parser.y"
+                                                                { (yyval.proc_list) = dst_append_func_list(NULL, (yyvsp[0].proc), context->memory); }
+#line 2041 "parser.c"
+    break;
+
+  case 81: /* nonempty_proc_list: struct_decl  */
+#line 352 "parser.y"
+                                                                { (yyval.proc_list) = NULL; }
+#line 2047 "parser.c"
+    break;
+
+  case 82: /* nonempty_proc_list: global_decl  */
+#line 353 "parser.y"
+                                                                { (yyval.proc_list) = NULL; }
+#line 2053 "parser.c"
+    break;
+
+  case 83: /* nonempty_proc_list: nonempty_proc_list proc  */
+#line 354 "parser.y"
+                                                { (yyval.proc_list) = dst_append_func_list((yyvsp[-1].proc_list), (yyvsp[0].proc), context->memory); }
+#line 2059 "parser.c"
+    break;
+
+  case 84: /* nonempty_proc_list: nonempty_proc_list struct_decl  */
+#line 355 "parser.y"
+                                        { (yyval.proc_list) = (yyvsp[-1].proc_list); }
+#line 2065 "parser.c"
+    break;
+
+  case 85: /* nonempty_proc_list: nonempty_proc_list global_decl  */
+#line 356 "parser.y"
+                                        { (yyval.proc_list) = (yyvsp[-1].proc_list); }
+#line 2071 "parser.c"
+    break;
+
+
+#line 2075 "parser.c"
 
-#line 1776 "parser.c" /* yacc.c:1646  */
       default: break;
     }
   /* User semantic actions sometimes alter yychar, and that requires
@@ -1786,11 +2086,10 @@ yyreduce:
      case of YYERROR or YYBACKUP, subsequent parser actions might lead
      to an incorrect destructor call or verbose syntax error message
      before the lookahead is translated.  */
-  YY_SYMBOL_PRINT ("-> $$ =", yyr1[yyn], &yyval, &yyloc);
+  YY_SYMBOL_PRINT ("-> $$ =", YY_CAST (yysymbol_kind_t, yyr1[yyn]), &yyval, &yyloc);
 
   YYPOPSTACK (yylen);
   yylen = 0;
-  YY_STACK_PRINT (yyss, yyssp);
 
   *++yyvsp = yyval;
   *++yylsp = yyloc;
@@ -1798,14 +2097,13 @@ yyreduce:
   /* Now 'shift' the result of the reduction.  Determine what state
      that goes to, based on the state we popped back to and the rule
      number reduced by.  */
-
-  yyn = yyr1[yyn];
-
-  yystate = yypgoto[yyn - YYNTOKENS] + *yyssp;
-  if (0 <= yystate && yystate <= YYLAST && yycheck[yystate] == *yyssp)
-    yystate = yytable[yystate];
-  else
-    yystate = yydefgoto[yyn - YYNTOKENS];
+  {
+    const int yylhs = yyr1[yyn] - YYNTOKENS;
+    const int yyi = yypgoto[yylhs] + *yyssp;
+    yystate = (0 <= yyi && yyi <= YYLAST && yycheck[yyi] == *yyssp
+               ? yytable[yyi]
+               : yydefgoto[yylhs]);
+  }
 
   goto yynewstate;
 
@@ -1816,50 +2114,15 @@ yyreduce:
 yyerrlab:
   /* Make sure we have latest lookahead translation.  See comments at
      user semantic actions for why this is necessary.  */
-  yytoken = yychar == YYEMPTY ? YYEMPTY : YYTRANSLATE (yychar);
-
+  yytoken = yychar == YYEMPTY ? YYSYMBOL_YYEMPTY : YYTRANSLATE (yychar);
   /* If not already recovering from an error, report this error.  */
   if (!yyerrstatus)
     {
       ++yynerrs;
-#if ! YYERROR_VERBOSE
       yyerror (&yylloc, context, scanner, YY_("syntax error"));
-#else
-# define YYSYNTAX_ERROR yysyntax_error (&yymsg_alloc, &yymsg, \
-                                        yyssp, yytoken)
-      {
-        char const *yymsgp = YY_("syntax error");
-        int yysyntax_error_status;
-        yysyntax_error_status = YYSYNTAX_ERROR;
-        if (yysyntax_error_status == 0)
-          yymsgp = yymsg;
-        else if (yysyntax_error_status == 1)
-          {
-            if (yymsg != yymsgbuf)
-              YYSTACK_FREE (yymsg);
-            yymsg = (char *) YYSTACK_ALLOC (yymsg_alloc);
-            if (!yymsg)
-              {
-                yymsg = yymsgbuf;
-                yymsg_alloc = sizeof yymsgbuf;
-                yysyntax_error_status = 2;
-              }
-            else
-              {
-                yysyntax_error_status = YYSYNTAX_ERROR;
-                yymsgp = yymsg;
-              }
-          }
-        yyerror (&yylloc, context, scanner, yymsgp);
-        if (yysyntax_error_status == 2)
-          goto yyexhaustedlab;
-      }
-# undef YYSYNTAX_ERROR
-#endif
     }
 
   yyerror_range[1] = yylloc;
-
   if (yyerrstatus == 3)
     {
       /* If just tried and failed to reuse lookahead token after an
@@ -1888,14 +2151,12 @@ yyerrlab:
 | yyerrorlab -- error raised explicitly by YYERROR.  |
 `---------------------------------------------------*/
 yyerrorlab:
+  /* Pacify compilers when the user code never invokes YYERROR and the
+     label yyerrorlab therefore never appears in user code.  */
+  if (0)
+    YYERROR;
+  ++yynerrs;
 
-  /* Pacify compilers like GCC when the user code never invokes
-     YYERROR and the label yyerrorlab therefore never appears in user
-     code.  */
-  if (/*CONSTCOND*/ 0)
-     goto yyerrorlab;
-
-  yyerror_range[1] = yylsp[1-yylen];
   /* Do not reclaim the symbols of the rule whose action triggered
      this YYERROR.  */
   YYPOPSTACK (yylen);
@@ -1911,13 +2172,14 @@ yyerrorlab:
 yyerrlab1:
   yyerrstatus = 3;      /* Each real token shifted decrements this.  */
 
+  /* Pop stack until we find a state that shifts the error token.  */
   for (;;)
     {
       yyn = yypact[yystate];
       if (!yypact_value_is_default (yyn))
         {
-          yyn += YYTERROR;
-          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYTERROR)
+          yyn += YYSYMBOL_YYerror;
+          if (0 <= yyn && yyn <= YYLAST && yycheck[yyn] == YYSYMBOL_YYerror)
             {
               yyn = yytable[yyn];
               if (0 < yyn)
@@ -1931,7 +2193,7 @@ yyerrlab1:
 
       yyerror_range[1] = *yylsp;
       yydestruct ("Error: popping",
-                  yystos[yystate], yyvsp, yylsp, context, scanner);
+                  YY_ACCESSING_SYMBOL (yystate), yyvsp, yylsp, context, scanner);
       YYPOPSTACK (1);
       yystate = *yyssp;
       YY_STACK_PRINT (yyss, yyssp);
@@ -1942,13 +2204,11 @@ yyerrlab1:
   YY_IGNORE_MAYBE_UNINITIALIZED_END
 
   yyerror_range[2] = yylloc;
-  /* Using YYLLOC is tempting, but would change the location of
-     the lookahead.  YYLOC is available though.  */
-  YYLLOC_DEFAULT (yyloc, yyerror_range, 2);
-  *++yylsp = yyloc;
+  ++yylsp;
+  YYLLOC_DEFAULT (*yylsp, yyerror_range, 2);
 
   /* Shift the error token.  */
-  YY_SYMBOL_PRINT ("Shifting", yystos[yyn], yyvsp, yylsp);
+  YY_SYMBOL_PRINT ("Shifting", YY_ACCESSING_SYMBOL (yyn), yyvsp, yylsp);
 
   yystate = yyn;
   goto yynewstate;
@@ -1959,26 +2219,30 @@ yyerrlab1:
 `-------------------------------------*/
 yyacceptlab:
   yyresult = 0;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
 /*-----------------------------------.
 | yyabortlab -- YYABORT comes here.  |
 `-----------------------------------*/
 yyabortlab:
   yyresult = 1;
-  goto yyreturn;
+  goto yyreturnlab;
+
 
-#if !defined yyoverflow || YYERROR_VERBOSE
-/*-------------------------------------------------.
-| yyexhaustedlab -- memory exhaustion comes here.  |
-`-------------------------------------------------*/
+/*-----------------------------------------------------------.
+| yyexhaustedlab -- YYNOMEM (memory exhaustion) comes here.  |
+`-----------------------------------------------------------*/
 yyexhaustedlab:
   yyerror (&yylloc, context, scanner, YY_("memory exhausted"));
   yyresult = 2;
-  /* Fall through.  */
-#endif
+  goto yyreturnlab;
+
 
-yyreturn:
+/*----------------------------------------------------------.
+| yyreturnlab -- parsing is finished, clean up and return.  |
+`----------------------------------------------------------*/
+yyreturnlab:
   if (yychar != YYEMPTY)
     {
       /* Make sure we have latest lookahead translation.  See comments at
@@ -1994,25 +2258,21 @@ yyreturn:
   while (yyssp != yyss)
     {
       yydestruct ("Cleanup: popping",
-                  yystos[*yyssp], yyvsp, yylsp, context, scanner);
+                  YY_ACCESSING_SYMBOL (+*yyssp), yyvsp, yylsp, context, scanner);
       YYPOPSTACK (1);
     }
 #ifndef yyoverflow
   if (yyss != yyssa)
     YYSTACK_FREE (yyss);
 #endif
-#if YYERROR_VERBOSE
-  if (yymsg != yymsgbuf)
-    YYSTACK_FREE (yymsg);
-#endif
+
   return yyresult;
 }
-#line 205 "parser.y" /* yacc.c:1906  */
 
+#line 358 "parser.y"
 
-#include <stdio.h>
 
-int yyerror(struct YYLTYPE *yylloc_param, dsc_parse_context *context, void *scanner, const char *msg)
+int yyerror(struct YYLTYPE *yylloc_param, dsc_parse_context *context, struct dsc_scanner *scanner, const char *msg)
 {
 	dsc_error("syntax error on line: %d", yylloc_param->first_line);
 
@@ -1,8 +1,9 @@
-/* A Bison parser, made by GNU Bison 3.0.4.  */
+/* A Bison parser, made by GNU Bison 3.8.2.  */
 
 /* Bison interface for Yacc-like parsers in C
 
-   Copyright (C) 1984, 1989-1990, 2000-2015 Free Software Foundation, Inc.
+   Copyright (C) 1984, 1989-1990, 2000-2015, 2018-2021 Free Software Foundation,
+   Inc.
 
    This program is free software: you can redistribute it and/or modify
    it under the terms of the GNU General Public License as published by
@@ -15,7 +16,7 @@
    GNU General Public License for more details.
 
    You should have received a copy of the GNU General Public License
-   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+   along with this program.  If not, see <https://www.gnu.org/licenses/>.  */
 
 /* As a special exception, you may create a larger work that contains
    part or all of the Bison parser skeleton and distribute that work
@@ -30,6 +31,10 @@
    This special exception was added by the Free Software Foundation in
    version 2.2 of Bison.  */
 
+/* DO NOT RELY ON FEATURES THAT ARE NOT DOCUMENTED in the manual,
+   especially those whose name start with YY_ or yy_.  They are
+   private implementation details that can be changed or removed.  */
+
 #ifndef YY_YY_PARSER_H_INCLUDED
 # define YY_YY_PARSER_H_INCLUDED
 /* Debug traces.  */
@@ -39,48 +44,73 @@
 #if YYDEBUG
 extern int yydebug;
 #endif
+/* "%code requires" blocks.  */
+#line 12 "parser.y"
+ struct dsc_scanner; 
+
+#line 52 "parser.h"
 
-/* Token type.  */
+/* Token kinds.  */
 #ifndef YYTOKENTYPE
 # define YYTOKENTYPE
   enum yytokentype
   {
-    TOKEN_INTEGER = 258,
-    TOKEN_REAL = 259,
-    TOKEN_IDENTIFIER = 260,
-    TOKEN_TYPE = 261,
-    TOKEN_DEF = 262,
-    TOKEN_ARROW = 263,
-    TOKEN_LET = 264,
-    TOKEN_WHILE = 265,
-    TOKEN_IF = 266,
-    TOKEN_ELSE = 267,
-    TOKEN_RETURN = 268,
-    TOKEN_OP_ADD = 269,
-    TOKEN_OP_SUB = 270,
-    TOKEN_OP_MUL = 271,
-    TOKEN_OP_DIV = 272,
-    TOKEN_OP_AND = 273,
-    TOKEN_OP_OR = 274,
-    TOKEN_OP_NOT = 275,
-    TOKEN_OP_EQ = 276,
-    TOKEN_OP_LESS = 277,
-    TOKEN_OP_LESS_EQ = 278,
-    TOKEN_OP_GREATER = 279,
-    TOKEN_OP_GREATER_EQ = 280
+    YYEMPTY = -2,
+    YYEOF = 0,                     /* "end of file"  */
+    YYerror = 256,                 /* error  */
+    YYUNDEF = 257,                 /* "invalid token"  */
+    TOKEN_INTEGER = 258,           /* TOKEN_INTEGER  */
+    TOKEN_REAL = 259,              /* TOKEN_REAL  */
+    TOKEN_LONG = 260,              /* TOKEN_LONG  */
+    TOKEN_DOUBLE = 261,            /* TOKEN_DOUBLE  */
+    TOKEN_IDENTIFIER = 262,        /* TOKEN_IDENTIFIER  */
+    TOKEN_STRING = 263,            /* TOKEN_STRING  */
+    TOKEN_TYPE = 264,              /* TOKEN_TYPE  */
+    TOKEN_DEF = 265,               /* TOKEN_DEF  */
+    TOKEN_ARROW = 266,             /* TOKEN_ARROW  */
+    TOKEN_LET = 267,               /* TOKEN_LET  */
+    TOKEN_WHILE = 268,             /* TOKEN_WHILE  */
+    TOKEN_FOR = 269,               /* TOKEN_FOR  */
+    TOKEN_IF = 270,                /* TOKEN_IF  */
+    TOKEN_ELSE = 271,              /* TOKEN_ELSE  */
+    TOKEN_RETURN = 272,            /* TOKEN_RETURN  */
+    TOKEN_YIELD = 273,             /* TOKEN_YIELD  */
+    TOKEN_STRUCT = 274,            /* TOKEN_STRUCT  */
+    TOKEN_CONST = 275,             /* TOKEN_CONST  */
+    TOKEN_SWITCH = 276,            /* TOKEN_SWITCH  */
+    TOKEN_CASE = 277,              /* TOKEN_CASE  */
+    TOKEN_DEFAULT = 278,           /* TOKEN_DEFAULT  */
+    TOKEN_OP_ADD = 279,            /* TOKEN_OP_ADD  */
+    TOKEN_OP_SUB = 280,            /* TOKEN_OP_SUB  */
+    TOKEN_OP_MUL = 281,            /* TOKEN_OP_MUL  */
+    TOKEN_OP_DIV = 282,            /* TOKEN_OP_DIV  */
+    TOKEN_OP_MOD = 283,            /* TOKEN_OP_MOD  */
+    TOKEN_OP_SHL = 284,            /* TOKEN_OP_SHL  */
+    TOKEN_OP_SHR = 285,            /* TOKEN_OP_SHR  */
+    TOKEN_OP_BIT_AND = 286,        /* TOKEN_OP_BIT_AND  */
+    TOKEN_OP_BIT_OR = 287,         /* TOKEN_OP_BIT_OR  */
+    TOKEN_OP_BIT_XOR = 288,        /* TOKEN_OP_BIT_XOR  */
+    TOKEN_OP_AND = 289,            /* TOKEN_OP_AND  */
+    TOKEN_OP_OR = 290,             /* TOKEN_OP_OR  */
+    TOKEN_OP_NOT = 291,            /* TOKEN_OP_NOT  */
+    TOKEN_OP_EQ = 292,             /* TOKEN_OP_EQ  */
+    TOKEN_OP_LESS = 293,           /* TOKEN_OP_LESS  */
+    TOKEN_OP_LESS_EQ = 294,        /* TOKEN_OP_LESS_EQ  */
+    TOKEN_OP_GREATER = 295,        /* TOKEN_OP_GREATER  */
+    TOKEN_OP_GREATER_EQ = 296      /* TOKEN_OP_GREATER_EQ  */
   };
+  typedef enum yytokentype yytoken_kind_t;
 #endif
 
 /* Value type.  */
 #if ! defined YYSTYPE && ! defined YYSTYPE_IS_DECLARED
-
 union YYSTYPE
 {
-#line 17 "parser.y" /* yacc.c:1909  */
+#line 23 "parser.y"
 
 	dst_type			 type;
 	dst_type_list		*type_list;
-	char				*identifier;
+	dsc_atom			*identifier;
 	dst_id_list			*identifier_list;
 	dst_statement		*statement;
 	dst_statement_list	*statement_list;
@@ -90,14 +120,18 @@ union YYSTYPE
 	dst_proc_param_list	*proc_param_list;
 	dst_proc			*proc; 
 	dst_proc_list		*proc_list;
+	dst_switch_case		*switch_case;
+	dst_switch_case_list *switch_case_list;
 
 	int			 integer;
 	float		 real;
-	char		*string;
+	int64_t		 long_integer;
+	double		 double_real;
+	dsc_atom	*atom;
 
-#line 99 "parser.h" /* yacc.c:1909  */
-};
+#line 133 "parser.h"
 
+};
 typedef union YYSTYPE YYSTYPE;
 # define YYSTYPE_IS_TRIVIAL 1
 # define YYSTYPE_IS_DECLARED 1
@@ -119,6 +153,8 @@ struct YYLTYPE
 
 
 
-int yyparse (dsc_parse_context *context, void *scanner);
+
+int yyparse (dsc_parse_context *context, struct dsc_scanner *scanner);
+
 
 #endif /* !YY_YY_PARSER_H_INCLUDED  */
@@ -1,15 +1,21 @@
 %{
 	#include "../common.h"
+	#include "scanner.h"
 
-	int yylex (union YYSTYPE *yyval_param, struct YYLTYPE *yylloc_param, void *yyscanner);
-	int yyerror(struct YYLTYPE *yylloc_param, dsc_parse_context *context, void *scanner, const char *msg);
+	#include <stdio.h>
+
+	#define yylex dsc_lex
+
+	int yyerror(struct YYLTYPE *yylloc_param, dsc_parse_context *context, struct dsc_scanner *scanner, const char *msg);
 %}
 
+%code requires { struct dsc_scanner; }
+
 %output  "parser.c"
 %defines "parser.h"
 
 %parse-param { dsc_parse_context *context }
-%param { void *scanner }
+%param { struct dsc_scanner *scanner }
 
 %define api.pure full
 %locations
@@ -17,7 +23,7 @@
 %union {
 	dst_type			 type;
 	dst_type_list		*type_list;
-	char				*identifier;
+	dsc_atom			*identifier;
 	dst_id_list			*identifier_list;
 	dst_statement		*statement;
 	dst_statement_list	*statement_list;
@@ -27,29 +33,49 @@
 	dst_proc_param_list	*proc_param_list;
 	dst_proc			*proc; 
 	dst_proc_list		*proc_list;
+	dst_switch_case		*switch_case;
+	dst_switch_case_list *switch_case_list;
 
 	int			 integer;
 	float		 real;
-	char		*string;
+	int64_t		 long_integer;
+	double		 double_real;
+	dsc_atom	*atom;
 }
 
 %token <integer> TOKEN_INTEGER		
 %token <real> TOKEN_REAL			
-%token <string> TOKEN_IDENTIFIER	
+%token <long_integer> TOKEN_LONG
+%token <double_real> TOKEN_DOUBLE
+%token <atom> TOKEN_IDENTIFIER	
+%token <atom> TOKEN_STRING
 %token <type> TOKEN_TYPE			
 
 %token TOKEN_DEF					
 %token TOKEN_ARROW					
 %token TOKEN_LET					
 %token TOKEN_WHILE					
+%token TOKEN_FOR
 %token TOKEN_IF						
 %token TOKEN_ELSE
 %token TOKEN_RETURN
+%token TOKEN_YIELD
+%token TOKEN_STRUCT
+%token TOKEN_CONST
+%token TOKEN_SWITCH
+%token TOKEN_CASE
+%token TOKEN_DEFAULT
 
 %token TOKEN_OP_ADD
 %token TOKEN_OP_SUB
 %token TOKEN_OP_MUL
 %token TOKEN_OP_DIV
+%token TOKEN_OP_MOD
+%token TOKEN_OP_SHL
+%token TOKEN_OP_SHR
+%token TOKEN_OP_BIT_AND
+%token TOKEN_OP_BIT_OR
+%token TOKEN_OP_BIT_XOR
 %token TOKEN_OP_AND
 %token TOKEN_OP_OR
 %token TOKEN_OP_NOT
@@ -65,15 +91,21 @@
 %left TOKEN_OP_AND
 %left TOKEN_OP_OR
 %left TOKEN_OP_NOT
+%left TOKEN_OP_BIT_OR
+%left TOKEN_OP_BIT_XOR
+%left TOKEN_OP_BIT_AND
+%left TOKEN_OP_SHL TOKEN_OP_SHR
 %left TOKEN_OP_ADD TOKEN_OP_SUB
-%left TOKEN_OP_MUL TOKEN_OP_DIV
+%left TOKEN_OP_MUL TOKEN_OP_DIV TOKEN_OP_MOD
 %precedence '(' ')'
+%precedence '[' ']'
+%precedence '.'
 %precedence TOKEN_ELSE
 
 %type <type>				type
 %type <type_list>			type_list nonempty_type_list
 %type <identifier>			identifier
-%type <identifier_list>		nonempty_identifier_list
+%type <identifier_list>		nonempty_identifier_list field_path
 %type <statement>			statement
 %type <statement_list>		statement_block nonempty_statement_block
 %type <expression>			expression
@@ -82,6 +114,8 @@
 %type <proc_param_list>		nonempty_proc_param_list proc_param_list
 %type <proc>				proc
 %type <proc_list>			dash_module nonempty_proc_list
+%type <switch_case>			switch_case
+%type <switch_case_list>	switch_case_list
 
 %start dash_module
 
@@ -91,7 +125,29 @@ dash_module:
 	nonempty_proc_list { context->parsed_module = $1; }
 
 type:
-	TOKEN_TYPE { $$ = $1; }
+	TOKEN_TYPE			{ $$ = $1; } |
+	identifier
+	{
+		dst_struct *value = dst_find_struct($1, &context->structs);
+
+		if (value == NULL)
+		{
+			dsc_error("unknown type %s, on line: %d", $1->text, @1.first_line);
+			YYERROR;
+		}
+
+		$$ = value->type;
+	} |
+	TOKEN_TYPE '[' ']'
+	{
+		if ($1 != dst_type_integer && $1 != dst_type_real)
+		{
+			dsc_error("arrays can only hold integers or reals, on line: %d", @1.first_line);
+			YYERROR;
+		}
+
+		$$ = dst_type_array_of($1);
+	}
 	
 identifier:
 	TOKEN_IDENTIFIER { $$ = $1; }
@@ -107,7 +163,15 @@ statement:
 	} |
 	identifier '(' expression_list ')' ';'
 	{
-		$$ = dst_create_statement_call($1, $3, context->memory);
+		$$ = dst_create_statement_call($1, $3, context->site_count++, context->memory);
+	} |
+	identifier '[' expression ']' '=' expression ';'
+	{
+		$$ = dst_create_statement_store($1, $3, $6, context->memory);
+	} |
+	identifier field_path '=' expression ';'
+	{
+		$$ = dst_create_statement_field_store($1, $2, $4, context->memory);
 	} |
 	statement_block
 	{
@@ -115,30 +179,56 @@ statement:
 	} |
 	TOKEN_IF '(' expression ')' statement TOKEN_ELSE statement
 	{
-		$$ = dst_create_statement_if($3, $5, $7, context->memory);
+		$$ = dst_create_statement_if($3, $5, $7, context->site_count++, context->memory);
 	} |
 	TOKEN_IF '(' expression ')' statement
 	{
-		$$ = dst_create_statement_if($3, $5, NULL, context->memory);
+		$$ = dst_create_statement_if($3, $5, NULL, context->site_count++, context->memory);
 	} |
 	TOKEN_WHILE '(' expression ')' statement
 	{
 		$$ = dst_create_statement_while($3, $5, context->memory);
 	} |
+	TOKEN_FOR '(' identifier '=' expression ',' expression ')' statement
+	{
+		$$ = dst_create_statement_for($3, $5, $7, $9, context->memory);
+	} |
 	TOKEN_RETURN expression_list ';'
 	{
 		$$ = dst_create_statement_return($2, context->memory);
+	} |
+	TOKEN_YIELD ';'
+	{
+		$$ = dst_create_statement_yield(context->memory);
+	} |
+	TOKEN_SWITCH '(' expression ')' '{' switch_case_list '}'
+	{
+		$$ = dst_create_statement_switch($3, $6, context->memory);
 	}
 
+switch_case:
+	TOKEN_CASE nonempty_expression_list ':' statement	{ $$ = dst_create_switch_case($2, $4, context->memory); } |
+	TOKEN_DEFAULT ':' statement							{ $$ = dst_create_switch_case(NULL, $3, context->memory); }
+
 expression:
 	TOKEN_INTEGER									{ $$ = dst_create_exp_int($1, context->memory); } |
 	TOKEN_REAL										{ $$ = dst_create_exp_real($1, context->memory); } |
+	TOKEN_LONG										{ $$ = dst_create_exp_long($1, context->memory); } |
+	TOKEN_DOUBLE									{ $$ = dst_create_exp_double($1, context->memory); } |
+	TOKEN_STRING									{ $$ = dst_create_exp_string($1, context->memory); } |
 	identifier										{ $$ = dst_create_exp_var($1, context->memory); } |
 
 	expression TOKEN_OP_ADD expression				{ $$ = dst_create_exp_binary(dst_exp_type_addition, $1, $3, context->memory); } |
 	expression TOKEN_OP_SUB expression				{ $$ = dst_create_exp_binary(dst_exp_type_subtraction, $1, $3, context->memory); } |
 	expression TOKEN_OP_MUL expression				{ $$ = dst_create_exp_binary(dst_exp_type_multiplication, $1, $3, context->memory); } |
 	expression TOKEN_OP_DIV expression				{ $$ = dst_create_exp_binary(dst_exp_type_division, $1, $3, context->memory); } |
+	expression TOKEN_OP_MOD expression				{ $$ = dst_create_exp_binary(dst_exp_type_modulo, $1, $3, context->memory); } |
+	
+	expression TOKEN_OP_SHL expression				{ $$ = dst_create_exp_binary(dst_exp_type_shift_left, $1, $3, context->memory); } |
+	expression TOKEN_OP_SHR expression				{ $$ = dst_create_exp_binary(dst_exp_type_shift_right, $1, $3, context->memory); } |
+	expression TOKEN_OP_BIT_AND expression			{ $$ = dst_create_exp_binary(dst_exp_type_bit_and, $1, $3, context->memory); } |
+	expression TOKEN_OP_BIT_OR expression			{ $$ = dst_create_exp_binary(dst_exp_type_bit_or, $1, $3, context->memory); } |
+	expression TOKEN_OP_BIT_XOR expression			{ $$ = dst_create_exp_binary(dst_exp_type_bit_xor, $1, $3, context->memory); } |
 	
 	expression TOKEN_OP_AND expression				{ $$ = dst_create_exp_binary(dst_exp_type_and, $1, $3, context->memory); } |
 	expression TOKEN_OP_OR expression				{ $$ = dst_create_exp_binary(dst_exp_type_or, $1, $3, context->memory); } |
@@ -149,8 +239,11 @@ expression:
 	expression TOKEN_OP_GREATER expression			{ $$ = dst_create_exp_binary(dst_exp_type_greater, $1, $3, context->memory); } |
 	expression TOKEN_OP_GREATER_EQ expression		{ $$ = dst_create_exp_binary(dst_exp_type_greater_eq, $1, $3, context->memory); } |
 	
-	identifier '(' expression_list ')'	{ $$ = dst_create_exp_call($1, $3, context->memory); } |
-	'(' type ')' expression				{ $$ = dst_create_exp_cast($2, $4, context->memory); } |
+	identifier '(' expression_list ')'	{ $$ = dst_create_exp_call($1, $3, context->site_count++, context->memory); } |
+	TOKEN_TYPE '[' expression ']'		{ $$ = dst_create_exp_array($1, $3, context->memory); } |
+	expression '[' expression ']'		{ $$ = dst_create_exp_index($1, $3, context->memory); } |
+	expression '.' identifier			{ $$ = dst_create_exp_field($1, $3, context->memory); } |
+	'(' TOKEN_TYPE ')' expression		{ $$ = dst_create_exp_cast($2, $4, context->memory); } |
 	'(' expression ')'					{ $$ = $2; }
 		
 proc_param:
@@ -159,7 +252,55 @@ proc_param:
 proc:
 	TOKEN_DEF identifier ':' '(' proc_param_list ')' TOKEN_ARROW '(' type_list ')' statement
 	{
-		$$ = dst_create_proc($2, $5, $9, $11, context->memory);
+		$$ = dst_create_proc($2, $5, $9, $11, context->first_site, context->memory);
+		context->first_site = context->site_count;
+	}
+
+global_decl:
+	TOKEN_LET identifier '=' expression ';'
+	{
+		context->globals = dst_append_global_list(context->globals, dst_create_global($2, dst_type_integer, $4, 0, context->memory), context->memory);
+	} |
+	TOKEN_LET identifier ':' type ';'
+	{
+		context->globals = dst_append_global_list(context->globals, dst_create_global($2, $4, NULL, 0, context->memory), context->memory);
+	} |
+	TOKEN_CONST identifier '=' expression ';'
+	{
+		context->globals = dst_append_global_list(context->globals, dst_create_global($2, dst_type_integer, $4, 1, context->memory), context->memory);
+	}
+
+struct_decl:
+	TOKEN_STRUCT identifier '{' nonempty_proc_param_list '}'
+	{
+		if (dst_find_struct($2, &context->structs) != NULL)
+		{
+			dsc_error("struct %s is already declared, on line: %d", $2->text, @2.first_line);
+			YYERROR;
+		}
+
+		dst_proc_param_list *field = $4;
+
+		do
+		{
+			for (dst_proc_param_list *other = field->next; other != $4; other = other->next)
+			{
+				if (other->value->id == field->value->id)
+				{
+					dsc_error("struct %s has more than one field named %s, on line: %d", $2->text, field->value->id->text, @2.first_line);
+					YYERROR;
+				}
+			}
+
+			field = field->next;
+
+		} while (field != $4);
+
+		if (dst_create_struct($2, $4, &context->structs, context->memory) == NULL)
+		{
+			dsc_error_oom();
+			YYABORT;
+		}
 	}
 		
 statement_block:
@@ -174,6 +315,10 @@ type_list:
 	%empty				{ $$ = NULL; } |
 	nonempty_type_list	{ $$ = $1; }
 	
+switch_case_list:
+	%empty								{ $$ = NULL; } |
+	switch_case_list switch_case		{ $$ = dst_append_switch_case_list($1, $2, context->memory); }
+
 proc_param_list:
 	%empty						{ $$ = NULL; } |
 	nonempty_proc_param_list	{ $$ = $1; }
@@ -194,19 +339,25 @@ nonempty_proc_param_list:
 	proc_param									{ $$ = dst_append_func_param_list(NULL, $1, context->memory); } |
 	nonempty_proc_param_list ',' proc_param		{ $$ = dst_append_func_param_list($1, $3, context->memory); }
 
+field_path:
+	'.' identifier				{ $$ = dst_append_id_list(NULL, $2, context->memory); } |
+	field_path '.' identifier	{ $$ = dst_append_id_list($1, $3, context->memory); }
+
 nonempty_identifier_list:
 	identifier								{ $$ = dst_append_id_list(NULL, $1, context->memory); } |
 	nonempty_identifier_list ',' identifier { $$ = dst_append_id_list($1, $3, context->memory); }
 	
 nonempty_proc_list:
-	proc						{ $$ = dst_append_func_list(NULL, $1, context->memory); } |
-	nonempty_proc_list proc		{ $$ = dst_append_func_list($1, $2, context->memory); }
+	proc							{ $$ = dst_append_func_list(NULL, $1, context->memory); } |
+	struct_decl						{ $$ = NULL; } |
+	global_decl						{ $$ = NULL; } |
+	nonempty_proc_list proc			{ $$ = dst_append_func_list($1, $2, context->memory); } |
+	nonempty_proc_list struct_decl	{ $$ = $1; } |
+	nonempty_proc_list global_decl	{ $$ = $1; }
 
 %%
 
-#include <stdio.h>
-
-int yyerror(struct YYLTYPE *yylloc_param, dsc_parse_context *context, void *scanner, const char *msg)
+int yyerror(struct YYLTYPE *yylloc_param, dsc_parse_context *context, struct dsc_scanner *scanner, const char *msg)
 {
 	dsc_error("syntax error on line: %d", yylloc_param->first_line);
 
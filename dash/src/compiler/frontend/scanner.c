@@ -0,0 +1,516 @@
+#include "../common.h"
+#include "parser.h"
+#include "scanner.h"
+#include "../../vm_internal.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Keyword lookup uses a perfect hash of the first character, the last character and the length.
+// If a keyword is added the multipliers (and table size) need to be found again so nothing collides.
+
+#define DSC_KEYWORD_TABLE_SIZE 64
+#define DSC_KEYWORD_FIRST_MUL 1
+#define DSC_KEYWORD_LAST_MUL 11
+
+#define dsc_keyword_hash(text, length) \
+	((((unsigned char)(text)[0]) * DSC_KEYWORD_FIRST_MUL + ((unsigned char)(text)[(length) - 1]) * DSC_KEYWORD_LAST_MUL + (length)) & (DSC_KEYWORD_TABLE_SIZE - 1))
+
+struct dsc_keyword
+{
+	const char	*text;
+	size_t		 length;
+	int			 token;
+	dst_type	 type;
+};
+
+// Only type names use their type, the rest are given the first one so every field is initialized
+
+#define DSC_KEYWORD(text, token) { text, sizeof(text) - 1, token, dst_type_real }
+#define DSC_TYPE_KEYWORD(text, type) { text, sizeof(text) - 1, TOKEN_TYPE, type }
+#define DSC_NO_KEYWORD { NULL, 0, 0, dst_type_real }
+
+static const struct dsc_keyword dsc_keywords[DSC_KEYWORD_TABLE_SIZE] =
+{
+	/*  0 */ DSC_KEYWORD("else",		TOKEN_ELSE),
+	/*  1 */ DSC_TYPE_KEYWORD("double",	dst_type_double),
+	/*  2 */ DSC_NO_KEYWORD,
+	/*  3 */ DSC_NO_KEYWORD,
+	/*  4 */ DSC_NO_KEYWORD,
+	/*  5 */ DSC_NO_KEYWORD,
+	/*  6 */ DSC_NO_KEYWORD,
+	/*  7 */ DSC_NO_KEYWORD,
+	/*  8 */ DSC_NO_KEYWORD,
+	/*  9 */ DSC_KEYWORD("def",		TOKEN_DEF),
+	/* 10 */ DSC_KEYWORD("yield",	TOKEN_YIELD),
+	/* 11 */ DSC_NO_KEYWORD,
+	/* 12 */ DSC_NO_KEYWORD,
+	/* 13 */ DSC_KEYWORD("if",		TOKEN_IF),
+	/* 14 */ DSC_NO_KEYWORD,
+	/* 15 */ DSC_KEYWORD("for",		TOKEN_FOR),
+	/* 16 */ DSC_NO_KEYWORD,
+	/* 17 */ DSC_NO_KEYWORD,
+	/* 18 */ DSC_NO_KEYWORD,
+	/* 19 */ DSC_KEYWORD("while",	TOKEN_WHILE),
+	/* 20 */ DSC_NO_KEYWORD,
+	/* 21 */ DSC_NO_KEYWORD,
+	/* 22 */ DSC_TYPE_KEYWORD("integer",	dst_type_integer),
+	/* 23 */ DSC_KEYWORD("or",		TOKEN_OP_OR),
+	/* 24 */ DSC_NO_KEYWORD,
+	/* 25 */ DSC_NO_KEYWORD,
+	/* 26 */ DSC_TYPE_KEYWORD("real",		dst_type_real),
+	/* 27 */ DSC_NO_KEYWORD,
+	/* 28 */ DSC_NO_KEYWORD,
+	/* 29 */ DSC_TYPE_KEYWORD("long",		dst_type_long),
+	/* 30 */ DSC_NO_KEYWORD,
+	/* 31 */ DSC_NO_KEYWORD,
+	/* 32 */ DSC_NO_KEYWORD,
+	/* 33 */ DSC_NO_KEYWORD,
+	/* 34 */ DSC_NO_KEYWORD,
+	/* 35 */ DSC_NO_KEYWORD,
+	/* 36 */ DSC_KEYWORD("const",	TOKEN_CONST),
+	/* 37 */ DSC_NO_KEYWORD,
+	/* 38 */ DSC_TYPE_KEYWORD("string",	dst_type_string),
+	/* 39 */ DSC_KEYWORD("default",	TOKEN_DEFAULT),
+	/* 40 */ DSC_NO_KEYWORD,
+	/* 41 */ DSC_NO_KEYWORD,
+	/* 42 */ DSC_NO_KEYWORD,
+	/* 43 */ DSC_KEYWORD("let",		TOKEN_LET),
+	/* 44 */ DSC_NO_KEYWORD,
+	/* 45 */ DSC_KEYWORD("not",		TOKEN_OP_NOT),
+	/* 46 */ DSC_NO_KEYWORD,
+	/* 47 */ DSC_NO_KEYWORD,
+	/* 48 */ DSC_KEYWORD("and",		TOKEN_OP_AND),
+	/* 49 */ DSC_KEYWORD("switch",	TOKEN_SWITCH),
+	/* 50 */ DSC_KEYWORD("return",	TOKEN_RETURN),
+	/* 51 */ DSC_NO_KEYWORD,
+	/* 52 */ DSC_NO_KEYWORD,
+	/* 53 */ DSC_KEYWORD("struct",	TOKEN_STRUCT),
+	/* 54 */ DSC_NO_KEYWORD,
+	/* 55 */ DSC_NO_KEYWORD,
+	/* 56 */ DSC_NO_KEYWORD,
+	/* 57 */ DSC_NO_KEYWORD,
+	/* 58 */ DSC_NO_KEYWORD,
+	/* 59 */ DSC_NO_KEYWORD,
+	/* 60 */ DSC_NO_KEYWORD,
+	/* 61 */ DSC_NO_KEYWORD,
+	/* 62 */ DSC_KEYWORD("case",		TOKEN_CASE),
+	/* 63 */ DSC_NO_KEYWORD,
+};
+
+// Powers of ten that are exactly representable as a float
+
+static const float dsc_float_pow10[] =
+{
+	1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+#define dsc_is_digit(c) ((unsigned)((c) - '0') < 10)
+#define dsc_is_id_start(c) (((unsigned)(((c) | 0x20) - 'a') < 26) || (c) == '_')
+#define dsc_is_id_char(c) (dsc_is_id_start(c) || dsc_is_digit(c))
+
+void dsc_scanner_init(const char *source, size_t length, dsc_intern_table *atoms, dsc_scanner *scanner)
+{
+	scanner->cursor = source;
+	scanner->end = source + length;
+	scanner->line = 1;
+	scanner->column = 0;
+	scanner->atoms = atoms;
+	scanner->stats = NULL;
+	scanner->allocations = 0;
+}
+
+double dsc_parse_double(const char *start, const char *end)
+{
+	char buffer[128] = { 0 };
+	size_t length = (size_t)(end - start);
+
+	if (length < sizeof(buffer))
+	{
+		memcpy(buffer, start, length);
+		buffer[length] = 0;
+
+		return strtod(buffer, NULL);
+	}
+
+	char *heap_buffer = (char *)malloc(length + 1);
+
+	if (heap_buffer == NULL)
+		return 0.0;
+
+	memcpy(heap_buffer, start, length);
+	heap_buffer[length] = 0;
+
+	double value = strtod(heap_buffer, NULL);
+
+	free(heap_buffer);
+
+	return value;
+}
+
+int dsc_lex_number(const char *start, union YYSTYPE *yylval, dsc_scanner *scanner)
+{
+	const char *cur = start;
+	const char *end = scanner->end;
+
+	int negative = 0;
+
+	if (*cur == '-')
+	{
+		negative = 1;
+		++cur;
+	}
+
+	// Integer part, overflow wraps the same way for every literal
+
+	uint64_t mantissa = 0;
+	size_t digits = 0;
+
+	while (cur < end && dsc_is_digit(*cur))
+	{
+		mantissa = mantissa * 10 + (uint64_t)(*cur - '0');
+		++digits;
+		++cur;
+	}
+
+	if (cur == end || *cur != '.')
+	{
+		// An 'l' suffix makes a long literal, a 'd' suffix a double
+
+		if (cur < end && (*cur == 'l' || *cur == 'L'))
+		{
+			scanner->cursor = cur + 1;
+
+			yylval->long_integer = (int64_t)(negative ? 0u - mantissa : mantissa);
+			return TOKEN_LONG;
+		}
+		if (cur < end && (*cur == 'd' || *cur == 'D'))
+		{
+			scanner->cursor = cur + 1;
+
+			yylval->double_real = dsc_parse_double(start, cur);
+			return TOKEN_DOUBLE;
+		}
+
+		scanner->cursor = cur;
+
+		yylval->integer = (int)(uint32_t)(negative ? 0u - mantissa : mantissa);
+		return TOKEN_INTEGER;
+	}
+
+	++cur;
+
+	size_t fraction_digits = 0;
+
+	while (cur < end && dsc_is_digit(*cur))
+	{
+		mantissa = mantissa * 10 + (uint64_t)(*cur - '0');
+		++fraction_digits;
+		++cur;
+	}
+
+	if (cur < end && (*cur == 'd' || *cur == 'D'))
+	{
+		scanner->cursor = cur + 1;
+
+		yylval->double_real = dsc_parse_double(start, cur);
+		return TOKEN_DOUBLE;
+	}
+
+	scanner->cursor = cur;
+
+	// When the digits fit in a float's mantissa and the scale is an exact power of ten,
+	// a single division is correctly rounded. Anything else goes through strtof.
+
+	if (digits + fraction_digits <= 9 && mantissa < (1u << 24) && fraction_digits <= 10)
+	{
+		float value = (float)mantissa / dsc_float_pow10[fraction_digits];
+
+		yylval->real = negative ? -value : value;
+		return TOKEN_REAL;
+	}
+
+	char buffer[128] = { 0 };
+	size_t length = (size_t)(cur - start);
+
+	if (length < sizeof(buffer))
+	{
+		memcpy(buffer, start, length);
+		buffer[length] = 0;
+
+		yylval->real = strtof(buffer, NULL);
+	}
+	else
+	{
+		char *heap_buffer = (char *)malloc(length + 1);
+
+		if (heap_buffer == NULL)
+		{
+			yylval->real = 0.0f;
+			return TOKEN_REAL;
+		}
+
+		memcpy(heap_buffer, start, length);
+		heap_buffer[length] = 0;
+
+		yylval->real = strtof(heap_buffer, NULL);
+
+		free(heap_buffer);
+	}
+
+	return TOKEN_REAL;
+}
+
+// Strings can't span lines, escapes are \n, \t, \\ and \" and anything else stands for itself
+
+int dsc_lex_string(const char *start, union YYSTYPE *yylval, dsc_scanner *scanner)
+{
+	const char *cur = start + 1;
+	const char *end = scanner->end;
+	size_t length = 0;
+
+	while (cur < end && *cur != '"' && *cur != '\n')
+	{
+		if (*cur == '\\' && cur + 1 < end && cur[1] != '\n')
+			++cur;
+
+		++length;
+		++cur;
+	}
+
+	if (cur == end || *cur != '"')
+	{
+		// Unterminated, the lone quote is a syntax error
+
+		scanner->cursor = start + 1;
+		return '"';
+	}
+
+	scanner->cursor = cur + 1;
+
+	char buffer[128] = { 0 };
+	char *text = length < sizeof(buffer) ? buffer : (char *)malloc(length + 1);
+
+	if (text == NULL)
+	{
+		yylval->atom = NULL;
+		return TOKEN_STRING;
+	}
+
+	size_t i = 0;
+
+	for (cur = start + 1; *cur != '"'; ++cur)
+	{
+		if (*cur == '\\')
+		{
+			++cur;
+
+			switch (*cur)
+			{
+			case 'n': text[i++] = '\n'; break;
+			case 't': text[i++] = '\t'; break;
+			default: text[i++] = *cur; break;
+			}
+		}
+		else
+		{
+			text[i++] = *cur;
+		}
+	}
+
+	text[i] = 0;
+
+	yylval->atom = dsc_intern(text, i, scanner->atoms);
+
+	if (text != buffer)
+		free(text);
+
+	return TOKEN_STRING;
+}
+
+static int dsc_scan(union YYSTYPE *yylval, struct YYLTYPE *yylloc, dsc_scanner *scanner)
+{
+	const char *cur = scanner->cursor;
+	const char *end = scanner->end;
+
+	// Skip whitespace, keeping track of lines
+
+	while (cur < end)
+	{
+		char c = *cur;
+
+		if (c == '\n')
+		{
+			++scanner->line;
+			scanner->column = 0;
+		}
+		else if (c == ' ' || c == '\t' || c == '\r')
+		{
+			++scanner->column;
+		}
+		else
+		{
+			break;
+		}
+
+		++cur;
+	}
+
+	if (cur == end)
+	{
+		scanner->cursor = cur;
+		return 0;
+	}
+
+	const char *start = cur;
+	char c = *cur++;
+	int token;
+
+	if (dsc_is_id_start(c))
+	{
+		while (cur < end && dsc_is_id_char(*cur))
+			++cur;
+
+		size_t length = (size_t)(cur - start);
+		const struct dsc_keyword *keyword = &dsc_keywords[dsc_keyword_hash(start, length)];
+
+		scanner->cursor = cur;
+
+		if (keyword->text != NULL &&
+			keyword->length == length &&
+			memcmp(keyword->text, start, length) == 0)
+		{
+			if (keyword->token == TOKEN_TYPE)
+			{
+				yylval->type = keyword->type;
+			}
+
+			token = keyword->token;
+		}
+		else
+		{
+			yylval->atom = dsc_intern(start, length, scanner->atoms);
+			token = TOKEN_IDENTIFIER;
+		}
+	}
+	else if (dsc_is_digit(c) || (c == '-' && cur < end && dsc_is_digit(*cur)))
+	{
+		token = dsc_lex_number(start, yylval, scanner);
+	}
+	else if (c == '"')
+	{
+		token = dsc_lex_string(start, yylval, scanner);
+	}
+	else
+	{
+		char next = cur < end ? *cur : 0;
+
+		switch (c)
+		{
+		case '-':
+			if (next == '>')
+			{
+				++cur;
+				token = TOKEN_ARROW;
+			}
+			else
+			{
+				token = TOKEN_OP_SUB;
+			}
+			break;
+
+		case '=':
+			if (next == '=')
+			{
+				++cur;
+				token = TOKEN_OP_EQ;
+			}
+			else
+			{
+				token = '=';
+			}
+			break;
+
+		case '<':
+			if (next == '=')
+			{
+				++cur;
+				token = TOKEN_OP_LESS_EQ;
+			}
+			else if (next == '<')
+			{
+				++cur;
+				token = TOKEN_OP_SHL;
+			}
+			else
+			{
+				token = TOKEN_OP_LESS;
+			}
+			break;
+
+		case '>':
+			if (next == '=')
+			{
+				++cur;
+				token = TOKEN_OP_GREATER_EQ;
+			}
+			else if (next == '>')
+			{
+				++cur;
+				token = TOKEN_OP_SHR;
+			}
+			else
+			{
+				token = TOKEN_OP_GREATER;
+			}
+			break;
+
+		case '+': token = TOKEN_OP_ADD; break;
+		case '*': token = TOKEN_OP_MUL; break;
+		case '/': token = TOKEN_OP_DIV; break;
+		case '%': token = TOKEN_OP_MOD; break;
+		case '&': token = TOKEN_OP_BIT_AND; break;
+		case '|': token = TOKEN_OP_BIT_OR; break;
+		case '^': token = TOKEN_OP_BIT_XOR; break;
+
+		default:
+			token = (unsigned char)c;
+			break;
+		}
+
+		scanner->cursor = cur;
+	}
+
+	int length = (int)(scanner->cursor - start);
+
+	yylloc->first_line = scanner->line;
+	yylloc->last_line = scanner->line;
+	yylloc->first_column = scanner->column;
+	yylloc->last_column = scanner->column + length;
+
+	scanner->column += length;
+
+	return token;
+}
+
+// The parser pulls every token through here, only a scanner with stats pays for the timing
+
+int dsc_lex(union YYSTYPE *yylval, struct YYLTYPE *yylloc, dsc_scanner *scanner)
+{
+	if (scanner->stats == NULL)
+		return dsc_scan(yylval, yylloc, scanner);
+
+	double start = dvm_now();
+	size_t allocations = scanner->atoms->mem->allocations;
+
+	int token = dsc_scan(yylval, yylloc, scanner);
+
+	scanner->stats->lex_time += dvm_now() - start;
+	scanner->allocations += scanner->atoms->mem->allocations - allocations;
+
+	if (token != 0)
+		++scanner->stats->tokens;
+
+	return token;
+}
@@ -0,0 +1,39 @@
+#ifndef dash_compiler_frontend_scanner_h
+#define dash_compiler_frontend_scanner_h
+
+#include <stddef.h>
+
+#include "../intern.h"
+
+union YYSTYPE;
+struct YYLTYPE;
+struct dvm_import_stats;
+
+/*
+ * A hand written scanner over an in-memory source buffer.
+ *
+ * Scans straight out of the buffer, without going through stdio. The buffer must stay alive until parsing is done, but
+ * identifiers are interned so nothing refers back to it after that.
+ */
+struct dsc_scanner
+{
+	const char *cursor;
+	const char *end;
+
+	int line;
+	int column;
+
+	dsc_intern_table *atoms;
+
+	// Set to have tokens counted and timed, the arena allocations made while lexing are counted so they can be told apart from the AST's
+
+	struct dvm_import_stats *stats;
+	size_t allocations;
+};
+typedef struct dsc_scanner dsc_scanner;
+
+void dsc_scanner_init(const char *source, size_t length, dsc_intern_table *atoms, dsc_scanner *scanner);
+
+int dsc_lex(union YYSTYPE *yylval_param, struct YYLTYPE *yylloc_param, dsc_scanner *scanner);
+
+#endif
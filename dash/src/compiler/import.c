@@ -1,141 +1,301 @@
 #include "common.h"
+#include "frontend/scanner.h"
 #include "frontend/parser.h"
 #include "backend/codegen.h"
+#include "../hash.h"
+#include "../vm_internal.h"
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-typedef void *yyscan_t;
-int yylex_init(yyscan_t * ptr_yy_globals);
-int yylex(union YYSTYPE *yyval_param, struct YYLTYPE *yylloc_param, yyscan_t yyscanner);
-int yylex_destroy(yyscan_t yyscanner);
-void yyset_in(FILE *in, yyscan_t yyscanner);
-void yyset_extra(dsc_memory *memory, yyscan_t yyscanner);
+dst_type dsc_native_type(uint8_t type)
+{
+	switch ((enum dvm_type)type)
+	{
+	case dvm_type_integer:
+		return dst_type_integer;
+	case dvm_type_real_array:
+		return dst_type_real_array;
+	case dvm_type_integer_array:
+		return dst_type_integer_array;
+	case dvm_type_long:
+		return dst_type_long;
+	case dvm_type_double:
+		return dst_type_double;
+	case dvm_type_string:
+		return dst_type_string;
+	default:
+		return dst_type_real;
+	}
+}
 
-dcg_proc_decl_list *import_stdlib_decls(dsc_memory *mem)
+dcg_proc_decl_table *import_native_decls(dvm_context *context, dsc_intern_table *atoms, dsc_memory *mem)
 {
-	dcg_proc_decl_list *stdlib = NULL;
-
-	stdlib = dcg_append_proc_decl_list(
-		stdlib,
-		dcg_create_proc_decl("print_c",
-			dst_append_func_param_list(NULL, dst_create_proc_param("val", dst_type_integer, mem), mem),
-			NULL,
-			0, mem),
-		mem
-		);
-
-	stdlib = dcg_append_proc_decl_list(
-		stdlib,
-		dcg_create_proc_decl("print_i",
-			dst_append_func_param_list(NULL, dst_create_proc_param("val", dst_type_integer, mem), mem),
-			NULL,
-			1, mem),
-		mem
-		);
-
-	stdlib = dcg_append_proc_decl_list(
-		stdlib,
-		dcg_create_proc_decl("print_r",
-			dst_append_func_param_list(NULL, dst_create_proc_param("val", dst_type_real, mem), mem),
-			NULL,
-			2, mem),
-		mem
-		);
-
-	stdlib = dcg_append_proc_decl_list(
-		stdlib,
-		dcg_create_proc_decl("sin",
-			dst_append_func_param_list(NULL, dst_create_proc_param("x", dst_type_real, mem), mem),
-			dst_append_type_list(NULL, dst_type_real, mem),
-			3, mem),
-		mem
-		);
-
-	stdlib = dcg_append_proc_decl_list(
-		stdlib,
-		dcg_create_proc_decl("cos",
-			dst_append_func_param_list(NULL, dst_create_proc_param("x", dst_type_real, mem), mem),
-			dst_append_type_list(NULL, dst_type_real, mem),
-			4, mem),
-		mem
-		);
-
-	stdlib = dcg_append_proc_decl_list(
-		stdlib,
-		dcg_create_proc_decl("tan",
-			dst_append_func_param_list(NULL, dst_create_proc_param("x", dst_type_real, mem), mem),
-			dst_append_type_list(NULL, dst_type_real, mem),
-			5, mem),
-		mem
-		);
-
-	stdlib = dcg_append_proc_decl_list(
-		stdlib,
-		dcg_create_proc_decl("pow",
-			dst_append_func_param_list(
-				dst_append_func_param_list(NULL, dst_create_proc_param("x", dst_type_real, mem), mem),
-				dst_create_proc_param("y", dst_type_real, mem), mem),
-			dst_append_type_list(NULL, dst_type_real, mem),
-			6, mem),
-		mem
-		);
-
-	return stdlib;
+	dcg_proc_decl_table *natives = dcg_create_proc_decl_table(context->native_count, mem);
+
+	if (natives == NULL || !dcg_intern_intrinsics(atoms, natives))
+		return NULL;
+
+	// Native parameters are unnamed, calls only check their types
+
+	dsc_atom *param_id = dsc_intern_str("in", atoms);
+
+	if (param_id == NULL)
+		return NULL;
+
+	for (uint32_t i = 0; i < context->native_count; ++i)
+	{
+		dvm_native *native = &context->native[i];
+
+		dst_proc_param_list *in_params = NULL;
+		dst_type_list *out_types = NULL;
+
+		for (uint8_t j = 0; j < native->in_count; ++j)
+		{
+			in_params = dst_append_func_param_list(in_params, dst_create_proc_param(param_id, dsc_native_type(native->types[j]), mem), mem);
+		}
+
+		for (uint8_t j = 0; j < native->out_count; ++j)
+		{
+			out_types = dst_append_type_list(out_types, dsc_native_type(native->types[native->in_count + j]), mem);
+		}
+
+		dsc_atom *id = dsc_intern_str(native->name, atoms);
+
+		if (id == NULL)
+			return NULL;
+
+		dcg_proc_decl *decl = dcg_create_proc_decl(id, in_params, out_types, native->function_index, mem);
+
+		if (decl == NULL || !dcg_proc_decl_table_insert(decl, natives))
+			return NULL;
+	}
+
+	return natives;
 }
 
-int dvm_import_source(FILE *source_file, struct dvm_context *context)
+uint64_t dsc_source_key(const char *source, size_t length, dvm_context *context)
+{
+	uint32_t version = DSC_COMPILER_VERSION;
+	uint32_t options = DSC_COMPILER_OPTIONS;
+
+	uint64_t key = DSH_HASH64_SEED;
+	key = dsh_hash64_n(key, &version, sizeof(uint32_t));
+	key = dsh_hash64_n(key, &options, sizeof(uint32_t));
+
+	// Calls into natives are compiled to their indices, so the natives are part of the key
+
+	for (uint32_t i = 0; i < context->native_count; ++i)
+	{
+		dvm_native *native = &context->native[i];
+
+		key = dsh_hash64_n(key, native->name, strlen(native->name) + 1);
+		key = dsh_hash64_n(key, &native->function_index, sizeof(uint32_t));
+		key = dsh_hash64_n(key, &native->in_count, sizeof(uint8_t));
+		key = dsh_hash64_n(key, &native->out_count, sizeof(uint8_t));
+		key = dsh_hash64_n(key, native->types, native->in_count + native->out_count);
+	}
+
+	key = dsh_hash64_n(key, source, length);
+
+	return key;
+}
+
+// Counts what every phase left behind, the times are filled in as the phases end
+
+static void dsc_count_import(double start_time, uint32_t function_base, uint32_t bytecode_base, size_t arena_bytes, dvm_context *context)
+{
+	struct dvm_import_stats *stats = &context->import_stats;
+
+	stats->bytecode_words = context->bytecode_count - bytecode_base;
+	stats->procedures = context->function_count - function_base;
+	stats->arena_bytes = arena_bytes;
+	stats->total_time = dvm_now() - start_time;
+}
+
+int dvm_import_source_text(const char *source, size_t length, struct dvm_context *context)
 {
 	srand((unsigned int)time(NULL));
 
-	yyscan_t scanner;
-	if (yylex_init(&scanner) != 0)
+	// Stats are only gathered while they're enabled, the scanner and the context add to them as they go
+
+	struct dvm_import_stats *stats = context->import_timing ? &context->import_stats : NULL;
+	double start_time = 0.0;
+
+	if (stats != NULL)
 	{
-		dsc_error_internal();
-		return 0;
+		memset(stats, 0, sizeof(struct dvm_import_stats));
+		start_time = dvm_now();
 	}
 
-	yyset_in(source_file, scanner);
+	// A cached image skips lexing, parsing and codegen entirely
+
+	uint64_t key = 0;
+	uint32_t function_base = context->function_count;
+	uint32_t bytecode_base = context->bytecode_count;
+	uint32_t global_base = context->global_count;
+
+	// Code compiled under a profile depends on more than the source, and a recorded profile needs its sites numbered
+
+	int use_cache = context->cache.directory != NULL && !context->profile.recording && context->profile.guide == NULL;
+
+	if (use_cache)
+	{
+		key = dsc_source_key(source, length, context);
+
+		if (dvm_cache_load(key, context))
+		{
+			if (stats != NULL)
+			{
+				stats->cache_hit = 1;
+				dsc_count_import(start_time, function_base, bytecode_base, 0, context);
+			}
+
+			return 1;
+		}
+	}
 
 	dsc_memory mem;
 	if (!dsc_create(0, &mem))
 	{
-		yylex_destroy(scanner);
+		dsc_error_oom();
+		return 0;
+	}
+
+	dsc_intern_table atoms;
+	dcg_proc_decl_table *natives = NULL;
+
+	if (dsc_create_intern_table(0, &atoms, &mem))
+	{
+		natives = import_native_decls(context, &atoms, &mem);
+	}
+
+	if (natives == NULL)
+	{
+		dsc_destroy(&mem);
 
 		dsc_error_oom();
 		return 0;
 	}
 
-	dcg_proc_decl_list *stdlib = import_stdlib_decls(&mem);
-		
+	dsc_scanner scanner;
+	dsc_scanner_init(source, length, &atoms, &scanner);
+	scanner.stats = stats;
+
 	dsc_parse_context parse;
 	parse.memory = &mem;
+	parse.atoms = &atoms;
 	parse.parsed_module = NULL;
+	parse.globals = NULL;
+	parse.structs.count = 0;
+	parse.structs.capacity = 0;
+	parse.structs.structs = NULL;
+	parse.site_count = 0;
+	parse.first_site = 0;
+
+	// Every allocation the parser makes that the scanner didn't is a node of the tree
+
+	double phase_start = stats != NULL ? dvm_now() : 0.0;
+	size_t parse_allocations = mem.allocations;
+
+	int parsed = yyparse(&parse, &scanner) == 0;
+
+	if (stats != NULL)
+	{
+		stats->parse_time = dvm_now() - phase_start - stats->lex_time;
+		stats->ast_nodes = (uint32_t)(mem.allocations - parse_allocations - scanner.allocations);
+	}
 
-	yyset_extra(&mem, scanner);
+	int result = 0;
 
-	if (yyparse(&parse, scanner) == 0)
+	if (parsed)
 	{
-		if (!dcg_import_procedure_list(parse.parsed_module, stdlib, context, &mem))
+		natives->structs = &parse.structs;
+		natives->vm = context;
+
+		phase_start = stats != NULL ? dvm_now() : 0.0;
+
+		result = dcg_import_global_list(parse.globals, natives, context, &mem) &&
+			dcg_import_procedure_list(parse.parsed_module, natives, context, &mem);
+
+		if (stats != NULL)
 		{
-			dsc_destroy(&mem);
+			stats->codegen_time = dvm_now() - phase_start;
+		}
+	}
+
+	size_t arena_bytes = mem.bytes_allocated;
+
+	dsc_destroy(&mem);
+
+	// Images are stored before they're linked, so they only hold plain calls and are proven again wherever they're loaded
+
+	if (result && use_cache)
+		dvm_cache_store(key, function_base, bytecode_base, global_base, context);
+
+	// Calls can only be linked once every procedure they can reach is in the context.
+	// What a failed import did add is linked too, so every procedure in the context has its target.
+
+	dvm_context_link(function_base, context);
+
+	if (stats != NULL)
+	{
+		dsc_count_import(start_time, function_base, bytecode_base, arena_bytes, context);
+	}
+
+	return result;
+}
+
+int dvm_import_source(FILE *source_file, struct dvm_context *context)
+{
+	// Read the whole source in, the scanner works over a single buffer
+
+	size_t capacity = 1024 * 16;
+	size_t length = 0;
+	char *source = (char *)malloc(capacity);
+
+	if (source == NULL)
+	{
+		dsc_error_oom();
+		return 0;
+	}
+
+	while (1)
+	{
+		length += fread(source + length, 1, capacity - length, source_file);
 
-			yylex_destroy(scanner);
+		if (length < capacity)
+			break;
 
+		char *new_source = (char *)malloc(capacity * 2);
+
+		if (new_source == NULL)
+		{
+			free(source);
+
+			dsc_error_oom();
 			return 0;
 		}
-		else
-		{
-			dsc_destroy(&mem);
 
-			yylex_destroy(scanner);
+		memcpy(new_source, source, length);
+		free(source);
 
-			return 1;
-		}
+		source = new_source;
+		capacity *= 2;
 	}
 
-	dsc_destroy(&mem);
+	if (ferror(source_file))
+	{
+		free(source);
+
+		dsc_error("couldn't read the source file.");
+		return 0;
+	}
 
-	yylex_destroy(scanner);
-	
-	return 0;
-}
\ No newline at end of file
+	int result = dvm_import_source_text(source, length, context);
+
+	free(source);
+
+	return result;
+}
@@ -0,0 +1,111 @@
+#include "intern.h"
+#include "../hash.h"
+
+#include <string.h>
+
+int dsc_create_intern_table(size_t initial_bucket_count, dsc_intern_table *table, dsc_memory *mem)
+{
+	size_t bucket_count = 64;
+	while (bucket_count < initial_bucket_count)
+		bucket_count *= 2;
+
+	table->count = 0;
+	table->bucket_count = bucket_count;
+	table->buckets = (dsc_atom **)dsc_alloc(sizeof(dsc_atom *) * bucket_count, mem);
+	table->mem = mem;
+
+	if (table->buckets == NULL)
+	{
+		return 0;
+	}
+
+	memset(table->buckets, 0, sizeof(dsc_atom *) * bucket_count);
+
+	return 1;
+}
+
+int dsc_grow_intern_table(dsc_intern_table *table)
+{
+	size_t new_bucket_count = table->bucket_count * 2;
+
+	dsc_atom **new_buckets = (dsc_atom **)dsc_alloc(sizeof(dsc_atom *) * new_bucket_count, table->mem);
+
+	if (new_buckets == NULL)
+	{
+		return 0;
+	}
+
+	memset(new_buckets, 0, sizeof(dsc_atom *) * new_bucket_count);
+
+	for (size_t i = 0; i < table->bucket_count; ++i)
+	{
+		dsc_atom *current = table->buckets[i];
+
+		while (current != NULL)
+		{
+			dsc_atom *next = current->next_in_bucket;
+			size_t bucket = current->hash & (new_bucket_count - 1);
+
+			current->next_in_bucket = new_buckets[bucket];
+			new_buckets[bucket] = current;
+
+			current = next;
+		}
+	}
+
+	table->bucket_count = new_bucket_count;
+	table->buckets = new_buckets;
+
+	return 1;
+}
+
+dsc_atom *dsc_intern(const char *text, size_t length, dsc_intern_table *table)
+{
+	uint32_t hash = dsh_hash_n(text, length);
+
+	dsc_atom *current = table->buckets[hash & (table->bucket_count - 1)];
+
+	while (current != NULL)
+	{
+		if (current->hash == hash &&
+			current->length == length &&
+			memcmp(current->text, text, length) == 0)
+		{
+			return current;
+		}
+
+		current = current->next_in_bucket;
+	}
+
+	// First time we've seen this identifier, copy it into the arena
+
+	if (table->count >= table->bucket_count && !dsc_grow_intern_table(table))
+	{
+		return NULL;
+	}
+
+	dsc_atom *atom = (dsc_atom *)dsc_alloc(sizeof(dsc_atom) + length, table->mem);
+
+	if (atom == NULL)
+	{
+		return NULL;
+	}
+
+	size_t bucket = hash & (table->bucket_count - 1);
+
+	atom->hash = hash;
+	atom->length = (uint32_t)length;
+	memcpy(atom->text, text, length);
+	atom->text[length] = 0;
+
+	atom->next_in_bucket = table->buckets[bucket];
+	table->buckets[bucket] = atom;
+
+	++table->count;
+
+	return atom;
+}
+dsc_atom *dsc_intern_str(const char *text, dsc_intern_table *table)
+{
+	return dsc_intern(text, strlen(text), table);
+}
@@ -0,0 +1,39 @@
+#ifndef dash_compiler_intern_h
+#define dash_compiler_intern_h
+
+#include <stdint.h>
+#include "memory.h"
+
+/*
+ * An interned identifier.
+ *
+ * Every occurrence of the same identifier in a compilation shares one atom,
+ * so atoms can be compared by pointer and carry their dsh_hash with them.
+ */
+struct dsc_atom
+{
+	uint32_t		 hash;
+	uint32_t		 length;
+
+	struct dsc_atom *next_in_bucket;
+
+	char			 text[1];
+};
+typedef struct dsc_atom dsc_atom;
+
+struct dsc_intern_table
+{
+	size_t		 count;
+	size_t		 bucket_count;
+	dsc_atom	**buckets;
+
+	dsc_memory	*mem;
+};
+typedef struct dsc_intern_table dsc_intern_table;
+
+int dsc_create_intern_table(size_t initial_bucket_count, dsc_intern_table *table, dsc_memory *mem);
+
+dsc_atom *dsc_intern(const char *text, size_t length, dsc_intern_table *table);
+dsc_atom *dsc_intern_str(const char *text, dsc_intern_table *table);
+
+#endif
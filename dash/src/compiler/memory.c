@@ -4,6 +4,29 @@
 #include <string.h>
 #include <stdio.h>
 
+#define DSC_BLOCK_HEADER ((sizeof(char *) + 7) & ~7)
+
+int dsc_push_block(size_t size, dsc_memory *mem)
+{
+	if (size < mem->block_size)
+		size = mem->block_size;
+
+	char *block = malloc(DSC_BLOCK_HEADER + size);
+
+	if (block == NULL)
+	{
+		return 0;
+	}
+
+	*(char **)block = mem->stack_begin;
+
+	mem->stack_begin = block;
+	mem->stack_top = block + DSC_BLOCK_HEADER;
+	mem->stack_end = block + DSC_BLOCK_HEADER + size;
+
+	return 1;
+}
+
 void *dsc_alloc(size_t size, dsc_memory *mem)
 {
 	uintptr_t base = ((uintptr_t)mem->stack_top + 3) & ~3;
@@ -11,16 +34,36 @@ void *dsc_alloc(size_t size, dsc_memory *mem)
 
 	if (new_top > (uintptr_t)mem->stack_end)
 	{
-		fprintf(stderr, "ran out of memory!");
-		return NULL;
+		if (!dsc_push_block(size + 4, mem))
+		{
+			fprintf(stderr, "ran out of memory!");
+			return NULL;
+		}
+
+		base = ((uintptr_t)mem->stack_top + 3) & ~3;
+		new_top = base + size;
 	}
 
 	mem->stack_top = (char *)new_top;
+
+	++mem->allocations;
+	mem->bytes_allocated += size;
+
 	return (char *)base;
 }
 void dsc_clear(dsc_memory *mem)
 {
-	mem->stack_top = mem->stack_begin;
+	// Free every block but the first one
+
+	while (*(char **)mem->stack_begin != NULL)
+	{
+		char *prev = *(char **)mem->stack_begin;
+		free(mem->stack_begin);
+		mem->stack_begin = prev;
+	}
+
+	mem->stack_top = mem->stack_begin + DSC_BLOCK_HEADER;
+	mem->stack_end = mem->stack_begin + DSC_BLOCK_HEADER + mem->block_size;
 }
 
 char *dsc_strdup(const char *string, dsc_memory *mem)
@@ -39,23 +82,21 @@ int dsc_create(size_t size, dsc_memory *mem)
 	if (size == 0)
 		size = 1024 * 8;
 
-	mem->stack_begin = malloc(size);
+	mem->stack_begin = NULL;
+	mem->stack_top = NULL;
+	mem->stack_end = NULL;
+	mem->block_size = size;
+	mem->allocations = 0;
+	mem->bytes_allocated = 0;
 
-	if (!mem->stack_begin)
-	{
-		return 0;
-	}
-
-	mem->stack_top = mem->stack_begin;
-	mem->stack_end = mem->stack_begin + size;
-
-	return 1;
+	return dsc_push_block(size, mem);
 }
 void dsc_destroy(dsc_memory *mem)
 {
-	if (mem->stack_begin)
+	while (mem->stack_begin)
 	{
+		char *prev = *(char **)mem->stack_begin;
 		free(mem->stack_begin);
-		mem->stack_begin = NULL;
+		mem->stack_begin = prev;
 	}
-}
\ No newline at end of file
+}
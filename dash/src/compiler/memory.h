@@ -3,11 +3,25 @@
 
 #include <stdlib.h>
 
+/*
+ * A growable arena for compiler allocations.
+ *
+ * Memory is bumped out of the current block, when a block fills up a new one
+ * is chained on in front of it. The first word of every block points to the
+ * block before it, so that destroying the arena can walk back and free them all.
+ */
 struct dsc_memory
 {
 	char *stack_begin;
 	char *stack_top;
 	char *stack_end;
+
+	size_t block_size;
+
+	// Totals since the arena was created, for the import stats
+
+	size_t allocations;
+	size_t bytes_allocated;
 };
 typedef struct dsc_memory dsc_memory;
 
@@ -19,4 +33,4 @@ char *dsc_strdup(const char *string, dsc_memory *mem);
 int dsc_create(size_t size, dsc_memory *mem);
 void dsc_destroy(dsc_memory *mem);
 
-#endif
\ No newline at end of file
+#endif
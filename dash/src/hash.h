@@ -2,6 +2,7 @@
 #define dash_hash_h
 
 #include <stdint.h>
+#include <stddef.h>
 
 // default values recommended by http://isthe.com/chongo/tech/comp/fnv/
 #define DSH_HASH_PRIME 0x01000193 //   16777619
@@ -15,4 +16,25 @@ inline uint32_t dsh_hash(const char* text)
 	return hash;
 }
 
-#endif
\ No newline at end of file
+// same as dsh_hash, for text that isn't null terminated
+inline uint32_t dsh_hash_n(const char* text, size_t length)
+{
+	uint32_t hash = DSH_HASH_SEED;
+	while (length--)
+		hash = (((unsigned char)*text++) ^ hash) * DSH_HASH_PRIME;
+	return hash;
+}
+
+// 64 bit variant, for keys that need to be unlikely to collide (the compilation cache)
+#define DSH_HASH64_PRIME 0x00000100000001B3ull
+#define DSH_HASH64_SEED 0xCBF29CE484222325ull
+
+inline uint64_t dsh_hash64_n(uint64_t hash, const void* data, size_t length)
+{
+	const unsigned char *bytes = (const unsigned char *)data;
+	while (length--)
+		hash = ((uint64_t)*bytes++ ^ hash) * DSH_HASH64_PRIME;
+	return hash;
+}
+
+#endif
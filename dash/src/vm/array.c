@@ -0,0 +1,587 @@
+#include "../vm_internal.h"
+
+#include "simd.h"
+#include "fastmath.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// interface
+
+static dvm_array *dvm_alloc_array(enum dvm_type element_type, size_t length)
+{
+	if (element_type != dvm_type_integer && element_type != dvm_type_real)
+	{
+		fprintf(stderr, "invalid array element type.\n");
+		return NULL;
+	}
+
+	if (length > UINT32_MAX)
+	{
+		fprintf(stderr, "array is too large.\n");
+		return NULL;
+	}
+
+	// The header and the elements share one allocation
+
+	dvm_array *array = (dvm_array *)malloc(sizeof(dvm_array) + DVM_ARRAY_ALIGNMENT - 1 + sizeof(uint32_t) * length);
+
+	if (array == NULL)
+	{
+		return NULL;
+	}
+
+	uintptr_t data = ((uintptr_t)(array + 1) + DVM_ARRAY_ALIGNMENT - 1) & ~(uintptr_t)(DVM_ARRAY_ALIGNMENT - 1);
+
+	array->data = (void *)data;
+	array->length = (uint32_t)length;
+	array->element_type = (uint8_t)element_type;
+	array->held = 0;
+	array->marked = 0;
+
+	memset(array->data, 0, sizeof(uint32_t) * length);
+
+	return array;
+}
+static size_t dvm_array_bytes(const dvm_array *array)
+{
+	return sizeof(dvm_array) + DVM_ARRAY_ALIGNMENT - 1 + sizeof(uint32_t) * array->length;
+}
+static void dvm_link_array(dvm_array *array, dvm_array **list)
+{
+	array->prev = NULL;
+	array->next = *list;
+
+	if (*list != NULL)
+		(*list)->prev = array;
+
+	*list = array;
+}
+static void dvm_unlink_array(dvm_array *array, dvm_array **list)
+{
+	if (array->prev != NULL)
+		array->prev->next = array->next;
+	else
+		*list = array->next;
+
+	if (array->next != NULL)
+		array->next->prev = array->prev;
+}
+
+dvm_array *dvm_create_array(enum dvm_type element_type, size_t length, dvm_context *context)
+{
+	dvm_array *array = dvm_alloc_array(element_type, length);
+
+	if (array == NULL)
+	{
+		return NULL;
+	}
+
+	array->held = 1;
+
+	dvm_link_array(array, &context->arrays);
+
+	return array;
+}
+void dvm_destroy_array(dvm_array *array, dvm_context *context)
+{
+	if (array == NULL)
+		return;
+
+	if (array->held)
+	{
+		dvm_unlink_array(array, &context->arrays);
+	}
+	else
+	{
+		dvm_unlink_array(array, &context->script_arrays);
+		context->script_array_bytes -= dvm_array_bytes(array);
+	}
+
+	free(array);
+}
+static void dvm_free_array_list(dvm_array *current)
+{
+	while (current != NULL)
+	{
+		dvm_array *next = current->next;
+		free(current);
+		current = next;
+	}
+}
+void dvm_destroy_arrays(dvm_context *context)
+{
+	dvm_free_array_list(context->arrays);
+	dvm_free_array_list(context->script_arrays);
+
+	free(context->array_marks);
+
+	context->arrays = NULL;
+	context->script_arrays = NULL;
+	context->script_array_bytes = 0;
+	context->array_marks = NULL;
+	context->array_mark_capacity = 0;
+}
+
+void *dvm_array_data(dvm_array *array)
+{
+	return array != NULL ? array->data : NULL;
+}
+size_t dvm_array_length(dvm_array *array)
+{
+	return array != NULL ? array->length : 0;
+}
+
+// collection, the script arrays are sorted by address so a register can be looked up without knowing its type
+
+dvm_array *dvm_create_script_array(enum dvm_type element_type, size_t length, dvm_context *context)
+{
+	dvm_array *array = dvm_alloc_array(element_type, length);
+
+	if (array == NULL)
+	{
+		return NULL;
+	}
+
+	dvm_link_array(array, &context->script_arrays);
+	context->script_array_bytes += dvm_array_bytes(array);
+
+	return array;
+}
+
+static int dvm_compare_array_marks(const void *a, const void *b)
+{
+	uintptr_t left = (uintptr_t)*(dvm_array *const *)a;
+	uintptr_t right = (uintptr_t)*(dvm_array *const *)b;
+
+	return left < right ? -1 : left > right;
+}
+
+int dvm_begin_array_marks(dvm_context *context)
+{
+	uint32_t count = 0;
+
+	for (dvm_array *current = context->script_arrays; current != NULL; current = current->next)
+		++count;
+
+	if (count > context->array_mark_capacity)
+	{
+		uint32_t new_capacity = context->array_mark_capacity == 0 ? 64 : context->array_mark_capacity;
+
+		while (new_capacity < count)
+			new_capacity *= 2;
+
+		dvm_array **new_marks = (dvm_array **)malloc(sizeof(dvm_array *) * new_capacity);
+
+		if (new_marks == NULL)
+		{
+			return 0;
+		}
+
+		free(context->array_marks);
+
+		context->array_marks = new_marks;
+		context->array_mark_capacity = new_capacity;
+	}
+
+	count = 0;
+
+	for (dvm_array *current = context->script_arrays; current != NULL; current = current->next)
+	{
+		current->marked = 0;
+		context->array_marks[count++] = current;
+	}
+
+	qsort(context->array_marks, count, sizeof(dvm_array *), dvm_compare_array_marks);
+
+	context->array_mark_count = count;
+
+	return 1;
+}
+dvm_array *dvm_find_script_array(const dvm_var *value, dvm_context *context)
+{
+	dvm_array *key = value->a;
+	dvm_array **found = (dvm_array **)bsearch(&key, context->array_marks, context->array_mark_count, sizeof(dvm_array *), dvm_compare_array_marks);
+
+	return found != NULL ? *found : NULL;
+}
+void dvm_mark_arrays(const dvm_var *begin, const dvm_var *end, dvm_context *context)
+{
+	for (const dvm_var *value = begin; value < end; ++value)
+	{
+		dvm_array *array = dvm_find_script_array(value, context);
+
+		if (array != NULL)
+			array->marked = 1;
+	}
+}
+void dvm_hold_array(dvm_array *array, dvm_context *context)
+{
+	if (array->held)
+		return;
+
+	dvm_unlink_array(array, &context->script_arrays);
+	context->script_array_bytes -= dvm_array_bytes(array);
+
+	array->held = 1;
+
+	dvm_link_array(array, &context->arrays);
+}
+void dvm_sweep_arrays(dvm_context *context)
+{
+	dvm_array *current = context->script_arrays;
+
+	while (current != NULL)
+	{
+		dvm_array *next = current->next;
+
+		if (!current->marked)
+		{
+			dvm_unlink_array(current, &context->script_arrays);
+			context->script_array_bytes -= dvm_array_bytes(current);
+
+			free(current);
+		}
+
+		current = next;
+	}
+
+	context->array_mark_count = 0;
+	context->script_array_limit = context->script_array_bytes * 2 > DVM_ARRAY_COLLECT_BYTES ? context->script_array_bytes * 2 : DVM_ARRAY_COLLECT_BYTES;
+}
+
+// kernels, arrays of different lengths are worked over their common prefix.
+// Integer kernels stay on SSE2, 256 bit integer math needs AVX2.
+
+static uint32_t dvm_array_common_length(const dvm_array *a, const dvm_array *b)
+{
+	if (a == NULL || b == NULL)
+		return 0;
+
+	return a->length < b->length ? a->length : b->length;
+}
+
+void dvm_stdlib_sum_r(const dvm_var *in, dvm_var *out)
+{
+	uint32_t length = dvm_array_length(in[0].a);
+	const float *data = (const float *)dvm_array_data(in[0].a);
+
+	float sum = 0.0f;
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	dvm_vf acc0 = dvm_vf_zero();
+	dvm_vf acc1 = dvm_vf_zero();
+
+	for (; i + DVM_VF_WIDTH * 2 <= length; i += DVM_VF_WIDTH * 2)
+	{
+		acc0 = dvm_vf_add(acc0, dvm_vf_load(data + i));
+		acc1 = dvm_vf_add(acc1, dvm_vf_load(data + i + DVM_VF_WIDTH));
+	}
+
+	sum = dvm_vf_hsum(dvm_vf_add(acc0, acc1));
+#endif
+
+	for (; i < length; ++i)
+		sum += data[i];
+
+	out[0].f = sum;
+}
+void dvm_stdlib_sum_i(const dvm_var *in, dvm_var *out)
+{
+	uint32_t length = dvm_array_length(in[0].a);
+	const int32_t *data = (const int32_t *)dvm_array_data(in[0].a);
+
+	int32_t sum = 0;
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	__m128i acc = _mm_setzero_si128();
+
+	for (; i + 4 <= length; i += 4)
+		acc = _mm_add_epi32(acc, _mm_load_si128((const __m128i *)(data + i)));
+
+	int32_t lanes[4];
+	_mm_storeu_si128((__m128i *)lanes, acc);
+
+	sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+
+	for (; i < length; ++i)
+		sum += data[i];
+
+	out[0].i = sum;
+}
+void dvm_stdlib_dot_r(const dvm_var *in, dvm_var *out)
+{
+	uint32_t length = dvm_array_common_length(in[0].a, in[1].a);
+	const float *a = (const float *)dvm_array_data(in[0].a);
+	const float *b = (const float *)dvm_array_data(in[1].a);
+
+	float sum = 0.0f;
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	dvm_vf acc0 = dvm_vf_zero();
+	dvm_vf acc1 = dvm_vf_zero();
+
+	for (; i + DVM_VF_WIDTH * 2 <= length; i += DVM_VF_WIDTH * 2)
+	{
+		acc0 = dvm_vf_add(acc0, dvm_vf_mul(dvm_vf_load(a + i), dvm_vf_load(b + i)));
+		acc1 = dvm_vf_add(acc1, dvm_vf_mul(dvm_vf_load(a + i + DVM_VF_WIDTH), dvm_vf_load(b + i + DVM_VF_WIDTH)));
+	}
+
+	sum = dvm_vf_hsum(dvm_vf_add(acc0, acc1));
+#endif
+
+	for (; i < length; ++i)
+		sum += a[i] * b[i];
+
+	out[0].f = sum;
+}
+void dvm_stdlib_scale_r(const dvm_var *in, dvm_var *out)
+{
+	uint32_t length = dvm_array_length(in[0].a);
+	float *data = (float *)dvm_array_data(in[0].a);
+	float scale = in[1].f;
+
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	dvm_vf scale_v = dvm_vf_set1(scale);
+
+	for (; i + DVM_VF_WIDTH <= length; i += DVM_VF_WIDTH)
+		dvm_vf_store(data + i, dvm_vf_mul(dvm_vf_load(data + i), scale_v));
+#endif
+
+	for (; i < length; ++i)
+		data[i] *= scale;
+}
+void dvm_stdlib_add_r(const dvm_var *in, dvm_var *out)
+{
+	uint32_t length = dvm_array_common_length(in[0].a, in[1].a);
+	uint32_t length_b = dvm_array_common_length(in[0].a, in[2].a);
+
+	if (length_b < length)
+		length = length_b;
+
+	float *dest = (float *)dvm_array_data(in[0].a);
+	const float *a = (const float *)dvm_array_data(in[1].a);
+	const float *b = (const float *)dvm_array_data(in[2].a);
+
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	for (; i + DVM_VF_WIDTH <= length; i += DVM_VF_WIDTH)
+		dvm_vf_store(dest + i, dvm_vf_add(dvm_vf_load(a + i), dvm_vf_load(b + i)));
+#endif
+
+	for (; i < length; ++i)
+		dest[i] = a[i] + b[i];
+}
+void dvm_stdlib_add_i(const dvm_var *in, dvm_var *out)
+{
+	uint32_t length = dvm_array_common_length(in[0].a, in[1].a);
+	uint32_t length_b = dvm_array_common_length(in[0].a, in[2].a);
+
+	if (length_b < length)
+		length = length_b;
+
+	int32_t *dest = (int32_t *)dvm_array_data(in[0].a);
+	const int32_t *a = (const int32_t *)dvm_array_data(in[1].a);
+	const int32_t *b = (const int32_t *)dvm_array_data(in[2].a);
+
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	for (; i + 4 <= length; i += 4)
+	{
+		_mm_store_si128((__m128i *)(dest + i), _mm_add_epi32(
+			_mm_load_si128((const __m128i *)(a + i)),
+			_mm_load_si128((const __m128i *)(b + i))));
+	}
+#endif
+
+	for (; i < length; ++i)
+		dest[i] = a[i] + b[i];
+}
+void dvm_stdlib_axpy_r(const dvm_var *in, dvm_var *out)
+{
+	// y = y + a * x
+
+	uint32_t length = dvm_array_common_length(in[0].a, in[2].a);
+	float *y = (float *)dvm_array_data(in[0].a);
+	float a = in[1].f;
+	const float *x = (const float *)dvm_array_data(in[2].a);
+
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	dvm_vf a_v = dvm_vf_set1(a);
+
+	for (; i + DVM_VF_WIDTH <= length; i += DVM_VF_WIDTH)
+		dvm_vf_store(y + i, dvm_vf_add(dvm_vf_load(y + i), dvm_vf_mul(a_v, dvm_vf_load(x + i))));
+#endif
+
+	for (; i < length; ++i)
+		y[i] += a * x[i];
+}
+void dvm_stdlib_fill_r(const dvm_var *in, dvm_var *out)
+{
+	uint32_t length = dvm_array_length(in[0].a);
+	float *data = (float *)dvm_array_data(in[0].a);
+	float value = in[1].f;
+
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	dvm_vf value_v = dvm_vf_set1(value);
+
+	for (; i + DVM_VF_WIDTH <= length; i += DVM_VF_WIDTH)
+		dvm_vf_store(data + i, value_v);
+#endif
+
+	for (; i < length; ++i)
+		data[i] = value;
+}
+void dvm_stdlib_fill_i(const dvm_var *in, dvm_var *out)
+{
+	uint32_t length = dvm_array_length(in[0].a);
+	int32_t *data = (int32_t *)dvm_array_data(in[0].a);
+	int32_t value = in[1].i;
+
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	__m128i value_v = _mm_set1_epi32(value);
+
+	for (; i + 4 <= length; i += 4)
+		_mm_store_si128((__m128i *)(data + i), value_v);
+#endif
+
+	for (; i < length; ++i)
+		data[i] = value;
+}
+void dvm_stdlib_ramp_r(const dvm_var *in, dvm_var *out)
+{
+	// data[i] = start + i * step
+
+	uint32_t length = dvm_array_length(in[0].a);
+	float *data = (float *)dvm_array_data(in[0].a);
+	float start = in[1].f;
+	float step = in[2].f;
+
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	float lanes[DVM_VF_WIDTH];
+
+	for (int j = 0; j < DVM_VF_WIDTH; ++j)
+		lanes[j] = (float)j;
+
+	dvm_vf index_v = dvm_vf_loadu(lanes);
+
+	dvm_vf start_v = dvm_vf_set1(start);
+	dvm_vf step_v = dvm_vf_set1(step);
+	dvm_vf width_v = dvm_vf_set1((float)DVM_VF_WIDTH);
+
+	for (; i + DVM_VF_WIDTH <= length; i += DVM_VF_WIDTH)
+	{
+		dvm_vf_store(data + i, dvm_vf_add(start_v, dvm_vf_mul(index_v, step_v)));
+		index_v = dvm_vf_add(index_v, width_v);
+	}
+#endif
+
+	for (; i < length; ++i)
+		data[i] = start + (float)i * step;
+}
+void dvm_stdlib_ramp_i(const dvm_var *in, dvm_var *out)
+{
+	uint32_t length = dvm_array_length(in[0].a);
+	int32_t *data = (int32_t *)dvm_array_data(in[0].a);
+	int32_t start = in[1].i;
+	int32_t step = in[2].i;
+
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	__m128i value_v = _mm_setr_epi32(start, start + step, start + step * 2, start + step * 3);
+	__m128i step_v = _mm_set1_epi32(step * 4);
+
+	for (; i + 4 <= length; i += 4)
+	{
+		_mm_store_si128((__m128i *)(data + i), value_v);
+		value_v = _mm_add_epi32(value_v, step_v);
+	}
+#endif
+
+	for (; i < length; ++i)
+		data[i] = start + (int32_t)i * step;
+}
+
+void dvm_stdlib_sin_r(const dvm_var *in, dvm_var *out)
+{
+	// dest[i] = sin(src[i]), by polynomial approximation
+
+	uint32_t length = dvm_array_common_length(in[0].a, in[1].a);
+	float *dest = (float *)dvm_array_data(in[0].a);
+	const float *src = (const float *)dvm_array_data(in[1].a);
+
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	for (; i + DVM_VF_WIDTH <= length; i += DVM_VF_WIDTH)
+		dvm_vf_store(dest + i, dvm_fast_sin_vf(dvm_vf_load(src + i)));
+#endif
+
+	for (; i < length; ++i)
+		dest[i] = dvm_fast_sinf(src[i]);
+}
+void dvm_stdlib_cos_r(const dvm_var *in, dvm_var *out)
+{
+	uint32_t length = dvm_array_common_length(in[0].a, in[1].a);
+	float *dest = (float *)dvm_array_data(in[0].a);
+	const float *src = (const float *)dvm_array_data(in[1].a);
+
+	uint32_t i = 0;
+
+#if defined(DVM_SIMD_SSE)
+	for (; i + DVM_VF_WIDTH <= length; i += DVM_VF_WIDTH)
+		dvm_vf_store(dest + i, dvm_fast_cos_vf(dvm_vf_load(src + i)));
+#endif
+
+	for (; i < length; ++i)
+		dest[i] = dvm_fast_cosf(src[i]);
+}
+
+int dvm_create_array_stdlib(dvm_context *context)
+{
+	const enum dvm_type integer[] = { dvm_type_integer };
+	const enum dvm_type real[] = { dvm_type_real };
+	const enum dvm_type integers[] = { dvm_type_integer_array };
+	const enum dvm_type reals[] = { dvm_type_real_array };
+	const enum dvm_type reals_reals[] = { dvm_type_real_array, dvm_type_real_array };
+	const enum dvm_type reals_real[] = { dvm_type_real_array, dvm_type_real };
+	const enum dvm_type integers_integer[] = { dvm_type_integer_array, dvm_type_integer };
+	const enum dvm_type reals_3[] = { dvm_type_real_array, dvm_type_real_array, dvm_type_real_array };
+	const enum dvm_type integers_3[] = { dvm_type_integer_array, dvm_type_integer_array, dvm_type_integer_array };
+	const enum dvm_type reals_real_reals[] = { dvm_type_real_array, dvm_type_real, dvm_type_real_array };
+	const enum dvm_type reals_real_real[] = { dvm_type_real_array, dvm_type_real, dvm_type_real };
+	const enum dvm_type integers_integer_integer[] = { dvm_type_integer_array, dvm_type_integer, dvm_type_integer };
+
+	return
+		dvm_register_native("sum_r", dvm_stdlib_sum_r, reals, 1, real, 1, context) &&
+		dvm_register_native("sum_i", dvm_stdlib_sum_i, integers, 1, integer, 1, context) &&
+		dvm_register_native("dot_r", dvm_stdlib_dot_r, reals_reals, 2, real, 1, context) &&
+		dvm_register_native("scale_r", dvm_stdlib_scale_r, reals_real, 2, NULL, 0, context) &&
+		dvm_register_native("add_r", dvm_stdlib_add_r, reals_3, 3, NULL, 0, context) &&
+		dvm_register_native("add_i", dvm_stdlib_add_i, integers_3, 3, NULL, 0, context) &&
+		dvm_register_native("axpy_r", dvm_stdlib_axpy_r, reals_real_reals, 3, NULL, 0, context) &&
+		dvm_register_native("fill_r", dvm_stdlib_fill_r, reals_real, 2, NULL, 0, context) &&
+		dvm_register_native("fill_i", dvm_stdlib_fill_i, integers_integer, 2, NULL, 0, context) &&
+		dvm_register_native("ramp_r", dvm_stdlib_ramp_r, reals_real_real, 3, NULL, 0, context) &&
+		dvm_register_native("ramp_i", dvm_stdlib_ramp_i, integers_integer_integer, 3, NULL, 0, context) &&
+		dvm_register_native("sin_r", dvm_stdlib_sin_r, reals_reals, 2, NULL, 0, context) &&
+		dvm_register_native("cos_r", dvm_stdlib_cos_r, reals_reals, 2, NULL, 0, context);
+}
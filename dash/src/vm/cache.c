@@ -0,0 +1,677 @@
+#include "../vm_internal.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+	#include <windows.h>
+	#include <process.h>
+
+	#define dvm_cache_pid() ((unsigned long)_getpid())
+#else
+	#include <unistd.h>
+
+	#define dvm_cache_pid() ((unsigned long)getpid())
+#endif
+
+// The cache is a directory of compiled images, one per source key, plus an
+// index file that records each image's size and when it was last used so the
+// least recently used images can be evicted once the limits are exceeded.
+//
+// Several processes can share a directory. Files are written under a name of their own
+// and renamed into place, so nothing ever reads one half written. The index is read,
+// updated and replaced without a lock, when two processes race one's update is lost,
+// which at worst leaves an image out of the eviction order until it's next loaded.
+
+#define DVM_CACHE_IMAGE_MAGIC	0x43485344u	// 'DSHC'
+#define DVM_CACHE_INDEX_MAGIC	0x49485344u	// 'DSHI'
+#define DVM_CACHE_VERSION		5u
+
+#define DVM_CACHE_PATH_LENGTH	1024
+
+struct dvm_cache_entry
+{
+	uint64_t key;
+	uint64_t size;
+	uint64_t last_used;
+};
+typedef struct dvm_cache_entry dvm_cache_entry;
+
+struct dvm_cache_index
+{
+	uint32_t		 count;
+	uint64_t		 clock;
+	dvm_cache_entry	*entries;
+};
+typedef struct dvm_cache_index dvm_cache_index;
+
+static int dvm_cache_image_path(char *path, uint64_t key, dvm_context *context)
+{
+	int length = snprintf(path, DVM_CACHE_PATH_LENGTH, "%s/%016llx.dshc", context->cache.directory, (unsigned long long)key);
+
+	return length > 0 && length < DVM_CACHE_PATH_LENGTH;
+}
+static int dvm_cache_index_path(char *path, dvm_context *context)
+{
+	int length = snprintf(path, DVM_CACHE_PATH_LENGTH, "%s/index.dshi", context->cache.directory);
+
+	return length > 0 && length < DVM_CACHE_PATH_LENGTH;
+}
+
+// Names the file a process writes before it's renamed over path, unique to the process and the context
+
+static int dvm_cache_temp_path(char *temp_path, const char *path, dvm_context *context)
+{
+	int length = snprintf(temp_path, DVM_CACHE_PATH_LENGTH, "%s.%lu.%llx.tmp", path, dvm_cache_pid(), (unsigned long long)(uintptr_t)context);
+
+	return length > 0 && length < DVM_CACHE_PATH_LENGTH;
+}
+
+// Puts a finished file in place, replacing whatever was there, or removes it if it can't be
+
+static int dvm_cache_replace(const char *temp_path, const char *path)
+{
+#if defined(_WIN32)
+	int replaced = MoveFileExA(temp_path, path, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+	int replaced = rename(temp_path, path) == 0;
+#endif
+
+	if (!replaced)
+		remove(temp_path);
+
+	return replaced;
+}
+
+// index
+
+static int dvm_cache_read_index(dvm_cache_index *index, dvm_context *context)
+{
+	index->count = 0;
+	index->clock = 0;
+	index->entries = NULL;
+
+	char path[DVM_CACHE_PATH_LENGTH];
+	if (!dvm_cache_index_path(path, context))
+		return 0;
+
+	FILE *index_file = fopen(path, "rb");
+
+	// A missing or unreadable index is treated as empty
+
+	if (index_file == NULL)
+		return 1;
+
+	uint32_t magic = 0;
+	uint32_t count = 0;
+	uint64_t clock = 0;
+
+	if (fread(&magic, sizeof(uint32_t), 1, index_file) != 1 ||
+		fread(&count, sizeof(uint32_t), 1, index_file) != 1 ||
+		fread(&clock, sizeof(uint64_t), 1, index_file) != 1 ||
+		magic != DVM_CACHE_INDEX_MAGIC)
+	{
+		fclose(index_file);
+		return 1;
+	}
+
+	if (count > 0)
+	{
+		index->entries = (dvm_cache_entry *)malloc(sizeof(dvm_cache_entry) * count);
+
+		if (index->entries == NULL)
+		{
+			fclose(index_file);
+			return 0;
+		}
+
+		if (fread(index->entries, sizeof(dvm_cache_entry), count, index_file) != count)
+		{
+			free(index->entries);
+			index->entries = NULL;
+
+			fclose(index_file);
+			return 1;
+		}
+	}
+
+	index->count = count;
+	index->clock = clock;
+
+	fclose(index_file);
+	return 1;
+}
+static void dvm_cache_write_index(const dvm_cache_index *index, dvm_context *context)
+{
+	char path[DVM_CACHE_PATH_LENGTH];
+	char temp_path[DVM_CACHE_PATH_LENGTH];
+
+	if (!dvm_cache_index_path(path, context) || !dvm_cache_temp_path(temp_path, path, context))
+		return;
+
+	FILE *index_file = fopen(temp_path, "wb");
+
+	if (index_file == NULL)
+		return;
+
+	uint32_t magic = DVM_CACHE_INDEX_MAGIC;
+
+	fwrite(&magic, sizeof(uint32_t), 1, index_file);
+	fwrite(&index->count, sizeof(uint32_t), 1, index_file);
+	fwrite(&index->clock, sizeof(uint64_t), 1, index_file);
+	fwrite(index->entries, sizeof(dvm_cache_entry), index->count, index_file);
+
+	int failed = ferror(index_file);
+
+	if (fclose(index_file) != 0 || failed)
+	{
+		remove(temp_path);
+		return;
+	}
+
+	dvm_cache_replace(temp_path, path);
+}
+
+// Marks the image as most recently used, adding it to the index if needed,
+// then evicts the least recently used images until the limits are met.
+static void dvm_cache_touch(uint64_t key, uint64_t size, dvm_context *context)
+{
+	dvm_cache_index index;
+
+	if (!dvm_cache_read_index(&index, context))
+		return;
+
+	uint32_t found = index.count;
+
+	for (uint32_t i = 0; i < index.count; ++i)
+	{
+		if (index.entries[i].key == key)
+		{
+			found = i;
+			break;
+		}
+	}
+
+	if (found == index.count)
+	{
+		dvm_cache_entry *new_entries = (dvm_cache_entry *)malloc(sizeof(dvm_cache_entry) * (index.count + 1));
+
+		if (new_entries == NULL)
+		{
+			free(index.entries);
+			return;
+		}
+
+		if (index.count > 0)
+			memcpy(new_entries, index.entries, sizeof(dvm_cache_entry) * index.count);
+		free(index.entries);
+
+		index.entries = new_entries;
+		index.entries[found].key = key;
+		++index.count;
+	}
+
+	index.entries[found].size = size;
+	index.entries[found].last_used = ++index.clock;
+
+	uint64_t total_bytes = 0;
+	for (uint32_t i = 0; i < index.count; ++i)
+		total_bytes += index.entries[i].size;
+
+	while (index.count > 1 &&
+		((context->cache.max_entries != 0 && index.count > context->cache.max_entries) ||
+		 (context->cache.max_bytes != 0 && total_bytes > context->cache.max_bytes)))
+	{
+		uint32_t oldest = 0;
+
+		for (uint32_t i = 1; i < index.count; ++i)
+		{
+			if (index.entries[i].last_used < index.entries[oldest].last_used)
+				oldest = i;
+		}
+
+		char path[DVM_CACHE_PATH_LENGTH];
+		if (dvm_cache_image_path(path, index.entries[oldest].key, context))
+			remove(path);
+
+		total_bytes -= index.entries[oldest].size;
+		index.entries[oldest] = index.entries[--index.count];
+
+		++context->cache.stats.evictions;
+	}
+
+	dvm_cache_write_index(&index, context);
+
+	free(index.entries);
+}
+
+// images
+
+int dvm_cache_load(uint64_t key, dvm_context *context)
+{
+	if (context->cache.directory == NULL)
+		return 0;
+
+	char path[DVM_CACHE_PATH_LENGTH];
+	if (!dvm_cache_image_path(path, key, context))
+		return 0;
+
+	FILE *image_file = fopen(path, "rb");
+
+	if (image_file == NULL)
+	{
+		++context->cache.stats.misses;
+		return 0;
+	}
+
+	// Read the image header
+
+	uint32_t image_magic = 0;
+	uint32_t image_version = 0;
+	uint64_t image_key = 0;
+	uint32_t image_function_base = 0;
+	uint32_t image_function_count = 0;
+	uint32_t image_bytecode_count = 0;
+	uint32_t image_global_base = 0;
+	uint32_t image_global_count = 0;
+
+	if (fread(&image_magic, sizeof(uint32_t), 1, image_file) != 1 ||
+		fread(&image_version, sizeof(uint32_t), 1, image_file) != 1 ||
+		fread(&image_key, sizeof(uint64_t), 1, image_file) != 1 ||
+		fread(&image_function_base, sizeof(uint32_t), 1, image_file) != 1 ||
+		fread(&image_function_count, sizeof(uint32_t), 1, image_file) != 1 ||
+		fread(&image_bytecode_count, sizeof(uint32_t), 1, image_file) != 1 ||
+		fread(&image_global_base, sizeof(uint32_t), 1, image_file) != 1 ||
+		fread(&image_global_count, sizeof(uint32_t), 1, image_file) != 1 ||
+		image_magic != DVM_CACHE_IMAGE_MAGIC ||
+		image_version != DVM_CACHE_VERSION ||
+		image_key != key)
+	{
+		fclose(image_file);
+
+		++context->cache.stats.misses;
+		return 0;
+	}
+
+	uint32_t func_base = context->function_count;
+	uint32_t bc_base = context->bytecode_count;
+	uint32_t global_base = context->global_count;
+
+	if (dvm_context_push_procedure(image_function_count, context) == NULL)
+	{
+		fclose(image_file);
+
+		++context->cache.stats.misses;
+		return 0;
+	}
+
+	if (dvm_context_push_bytecode(image_bytecode_count, context) == NULL)
+	{
+		dvm_context_pop_procedure(image_function_count, context);
+		fclose(image_file);
+
+		++context->cache.stats.misses;
+		return 0;
+	}
+
+	if (image_global_count > 0 && dvm_context_push_globals(image_global_count, context) == NULL)
+	{
+		dvm_context_pop_bytecode(image_bytecode_count, context);
+		dvm_context_pop_procedure(image_function_count, context);
+		fclose(image_file);
+
+		++context->cache.stats.misses;
+		return 0;
+	}
+
+	// Read in the function table, relative to the bytecode base.
+	// An image that's damaged isn't valid, a good one that doesn't fit this context isn't relocatable and is left for others.
+
+	int valid = 1;
+	int relocatable = 1;
+
+	for (uint32_t i = 0; i < image_function_count && valid; ++i)
+	{
+		dvm_procedure *cur = &context->function[func_base + i];
+
+		valid =
+			fread(&cur->hashed_name, sizeof(uint32_t), 1, image_file) == 1 &&
+			fread(&cur->bytecode_start, sizeof(uint32_t), 1, image_file) == 1 &&
+			fread(&cur->bytecode_end, sizeof(uint32_t), 1, image_file) == 1 &&
+			fread(&cur->reg_count_in, sizeof(uint8_t), 1, image_file) == 1 &&
+			fread(&cur->reg_count_use, sizeof(uint8_t), 1, image_file) == 1 &&
+			fread(&cur->reg_count_out, sizeof(uint8_t), 1, image_file) == 1 &&
+			cur->bytecode_start < cur->bytecode_end &&
+			cur->bytecode_end <= image_bytecode_count;
+
+		cur->c_function = NULL;
+		cur->bytecode_start += bc_base;
+		cur->bytecode_end += bc_base;
+	}
+
+	// Read in the bytecode and the initial values of the globals, then relocate the calls and globals into the image
+
+	if (valid)
+	{
+		valid = fread(context->bytecode + bc_base, sizeof(dvm_bc), image_bytecode_count, image_file) == image_bytecode_count;
+	}
+
+	if (valid && image_global_count > 0)
+	{
+		valid = fread(context->globals + global_base, sizeof(dvm_var), image_global_count, image_file) == image_global_count;
+	}
+
+	// Strings are interned again by their text, sload indices are remapped to this context's table
+
+	uint32_t	 image_string_count = 0;
+	uint32_t	*image_strings = NULL;
+
+	if (valid)
+	{
+		valid = fread(&image_string_count, sizeof(uint32_t), 1, image_file) == 1 && image_string_count <= DVM_MAX_STRINGS;
+	}
+
+	if (valid && image_string_count > 0)
+	{
+		image_strings = (uint32_t *)malloc(sizeof(uint32_t) * 2 * image_string_count);
+		relocatable = image_strings != NULL;
+	}
+
+	for (uint32_t i = 0; i < image_string_count && valid && relocatable; ++i)
+	{
+		uint32_t length = 0;
+
+		valid =
+			fread(&image_strings[i * 2], sizeof(uint32_t), 1, image_file) == 1 &&
+			fread(&length, sizeof(uint32_t), 1, image_file) == 1;
+
+		if (!valid)
+			break;
+
+		// Running out of memory says nothing about the image
+
+		char *text = (char *)malloc(length + 1);
+
+		if (text == NULL)
+		{
+			relocatable = 0;
+			break;
+		}
+
+		dvm_string *string = NULL;
+
+		valid = fread(text, 1, length, image_file) == length;
+
+		if (valid)
+		{
+			string = dvm_intern_string(text, length, context);
+			relocatable = string != NULL;
+		}
+
+		free(text);
+
+		if (string == NULL)
+			break;
+
+		image_strings[i * 2 + 1] = string->index;
+	}
+
+	for (uint32_t i = bc_base; i < context->bytecode_count && valid && relocatable; ++i)
+	{
+		dvm_bc *current = &context->bytecode[i];
+
+		if (dvm_bc_immediate_count(*current) != 0)
+		{
+			i += dvm_bc_immediate_count(*current);
+		}
+		else if (dvm_bc_is_call(*current))
+		{
+			// Calls are linked again once they're relocated
+
+			current->opcode = dvm_opcode_call;
+
+			if (current->a >= image_function_base)
+			{
+				uint32_t relocated = current->a - image_function_base + func_base;
+
+				// The call operand can only address the first 256 procedures, which depends on what was imported first
+
+				valid = relocated < context->function_count;
+				relocatable = relocated <= 0xFF;
+				current->a = relocated;
+			}
+			else
+			{
+				// Natives are called where they were registered, this context may not have the same ones
+
+				relocatable = current->a < func_base && context->function[current->a].c_function != NULL;
+			}
+		}
+		else if (dvm_bc_is_global(*current))
+		{
+			uint32_t index = dvm_bc_global_index(*current);
+			uint32_t relocated = index - image_global_base + global_base;
+
+			valid = index >= image_global_base && index - image_global_base < image_global_count;
+			relocatable = relocated <= 0xFFFF;
+
+			current->a = relocated & 0xFF;
+			current->b = relocated >> 8;
+		}
+		else if (current->opcode == dvm_opcode_sload)
+		{
+			uint32_t index = dvm_bc_string_index(*current);
+			uint32_t j = 0;
+
+			while (j < image_string_count && image_strings[j * 2] != index)
+				++j;
+
+			valid = j < image_string_count;
+
+			if (valid)
+			{
+				current->a = image_strings[j * 2 + 1] & 0xFF;
+				current->b = image_strings[j * 2 + 1] >> 8;
+			}
+		}
+	}
+
+	free(image_strings);
+
+	// A damaged image is caught by the same checks a freshly compiled procedure goes through
+
+	for (uint32_t i = 0; i < image_function_count && valid && relocatable; ++i)
+	{
+		dvm_procedure *cur = &context->function[func_base + i];
+
+		valid = dvm_context_validate_proc(cur->bytecode_start, cur->bytecode_end - cur->bytecode_start, cur->reg_count_in, cur->reg_count_use, cur->reg_count_out, context);
+	}
+
+	long size = ftell(image_file);
+
+	fclose(image_file);
+
+	if (!valid || !relocatable)
+	{
+		dvm_context_pop_globals(image_global_count, context);
+		dvm_context_pop_bytecode(image_bytecode_count, context);
+		dvm_context_pop_procedure(image_function_count, context);
+
+		if (!valid)
+			remove(path);
+
+		++context->cache.stats.misses;
+		return 0;
+	}
+
+	dvm_context_link(func_base, context);
+
+	++context->cache.stats.hits;
+
+	dvm_cache_touch(key, (uint64_t)size, context);
+
+	return 1;
+}
+
+void dvm_cache_store(uint64_t key, uint32_t function_base, uint32_t bytecode_base, uint32_t global_base, dvm_context *context)
+{
+	if (context->cache.directory == NULL)
+		return;
+
+	uint32_t image_function_count = context->function_count - function_base;
+	uint32_t image_bytecode_count = context->bytecode_count - bytecode_base;
+	uint32_t image_global_count = context->global_count - global_base;
+
+	// Only images that call into themselves or natives, and only use their own globals, can be relocated
+
+	for (uint32_t i = bytecode_base; i < context->bytecode_count; ++i)
+	{
+		dvm_bc current = context->bytecode[i];
+
+		if (dvm_bc_immediate_count(current) != 0)
+		{
+			i += dvm_bc_immediate_count(current);
+		}
+		else if (dvm_bc_is_call(current))
+		{
+			if (current.a < function_base && context->function[current.a].c_function == NULL)
+				return;
+		}
+		else if (dvm_bc_is_global(current))
+		{
+			if (dvm_bc_global_index(current) < global_base)
+				return;
+		}
+	}
+
+	char path[DVM_CACHE_PATH_LENGTH];
+	char temp_path[DVM_CACHE_PATH_LENGTH];
+
+	if (!dvm_cache_image_path(path, key, context) || !dvm_cache_temp_path(temp_path, path, context))
+		return;
+
+	FILE *image_file = fopen(temp_path, "wb");
+
+	if (image_file == NULL)
+		return;
+
+	uint32_t image_magic = DVM_CACHE_IMAGE_MAGIC;
+	uint32_t image_version = DVM_CACHE_VERSION;
+
+	fwrite(&image_magic, sizeof(uint32_t), 1, image_file);
+	fwrite(&image_version, sizeof(uint32_t), 1, image_file);
+	fwrite(&key, sizeof(uint64_t), 1, image_file);
+	fwrite(&function_base, sizeof(uint32_t), 1, image_file);
+	fwrite(&image_function_count, sizeof(uint32_t), 1, image_file);
+	fwrite(&image_bytecode_count, sizeof(uint32_t), 1, image_file);
+	fwrite(&global_base, sizeof(uint32_t), 1, image_file);
+	fwrite(&image_global_count, sizeof(uint32_t), 1, image_file);
+
+	for (uint32_t i = function_base; i < context->function_count; ++i)
+	{
+		dvm_procedure *cur = &context->function[i];
+
+		uint32_t bytecode_start = cur->bytecode_start - bytecode_base;
+		uint32_t bytecode_end = cur->bytecode_end - bytecode_base;
+
+		fwrite(&cur->hashed_name, sizeof(uint32_t), 1, image_file);
+		fwrite(&bytecode_start, sizeof(uint32_t), 1, image_file);
+		fwrite(&bytecode_end, sizeof(uint32_t), 1, image_file);
+		fwrite(&cur->reg_count_in, sizeof(uint8_t), 1, image_file);
+		fwrite(&cur->reg_count_use, sizeof(uint8_t), 1, image_file);
+		fwrite(&cur->reg_count_out, sizeof(uint8_t), 1, image_file);
+	}
+
+	fwrite(context->bytecode + bytecode_base, sizeof(dvm_bc), image_bytecode_count, image_file);
+	fwrite(context->globals + global_base, sizeof(dvm_var), image_global_count, image_file);
+
+	// The text of every string the image loads, indices are only meaningful in this context
+
+	uint8_t *string_used = context->string_count > 0 ? (uint8_t *)calloc(context->string_count, 1) : NULL;
+	uint32_t image_string_count = 0;
+
+	if (context->string_count > 0 && string_used == NULL)
+	{
+		fclose(image_file);
+		remove(temp_path);
+		return;
+	}
+
+	for (uint32_t i = bytecode_base; i < context->bytecode_count; ++i)
+	{
+		dvm_bc current = context->bytecode[i];
+
+		if (dvm_bc_immediate_count(current) != 0)
+		{
+			i += dvm_bc_immediate_count(current);
+		}
+		else if (current.opcode == dvm_opcode_sload && !string_used[dvm_bc_string_index(current)])
+		{
+			string_used[dvm_bc_string_index(current)] = 1;
+			++image_string_count;
+		}
+	}
+
+	fwrite(&image_string_count, sizeof(uint32_t), 1, image_file);
+
+	for (uint32_t i = 0; i < context->string_count; ++i)
+	{
+		if (!string_used[i])
+			continue;
+
+		fwrite(&context->strings[i]->index, sizeof(uint32_t), 1, image_file);
+		fwrite(&context->strings[i]->length, sizeof(uint32_t), 1, image_file);
+		fwrite(context->strings[i]->text, 1, context->strings[i]->length, image_file);
+	}
+
+	free(string_used);
+
+	int failed = ferror(image_file);
+	long size = ftell(image_file);
+
+	if (fclose(image_file) != 0 || failed)
+	{
+		remove(temp_path);
+		return;
+	}
+
+	if (!dvm_cache_replace(temp_path, path))
+		return;
+
+	++context->cache.stats.stores;
+
+	dvm_cache_touch(key, (uint64_t)size, context);
+}
+
+// interface
+
+int dvm_enable_cache(const char *directory, size_t max_entries, size_t max_bytes, dvm_context *context)
+{
+	if (context->cache.directory != NULL)
+	{
+		free(context->cache.directory);
+		context->cache.directory = NULL;
+	}
+
+	if (directory == NULL)
+		return 1;
+
+	size_t length = strlen(directory);
+
+	context->cache.directory = (char *)malloc(length + 1);
+
+	if (context->cache.directory == NULL)
+		return 0;
+
+	memcpy(context->cache.directory, directory, length + 1);
+
+	context->cache.max_entries = max_entries;
+	context->cache.max_bytes = max_bytes;
+
+	return 1;
+}
+void dvm_get_cache_stats(struct dvm_cache_stats *stats, dvm_context *context)
+{
+	*stats = context->cache.stats;
+}
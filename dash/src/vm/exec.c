@@ -2,51 +2,221 @@
 #include "../hash.h"
 
 #include "stack.h"
+#include "fastmath.h"
 
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 
-int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters, dvm_var *func_results, struct dvm_context *context)
+// Fast math swaps the C library's sin, cos and tan for polynomial approximations
+
+#if defined(DVM_FAST_MATH)
+	#define dvm_sinf dvm_fast_sinf
+	#define dvm_cosf dvm_fast_cosf
+	#define dvm_tanf dvm_fast_tanf
+#else
+	#define dvm_sinf sinf
+	#define dvm_cosf cosf
+	#define dvm_tanf tanf
+#endif
+
+// Instructions are counted a basic block at a time, when control leaves the straight run that began at block_start.
+// Immediates are inside the run, so the instructions that carry them move block_start past them instead.
+
+#define DVM_RETIRE_BLOCK() (stats.instructions += cur_pc - block_start + 1)
+
+// Fuel is measured in instructions and only checked where execution can come back around, on backward jumps and calls.
+// A slice can run past its budget by one straight run, the checks are only ever made at the start of a block.
+
+#define DVM_CHECK_FUEL() if (stats.instructions >= fuel_limit) goto execution_suspended
+
+// Every jump, call, return and yield that's taken starts a block here, which is the only place a trace is written
+
+#define DVM_ENTER_BLOCK(pc) \
+	do \
+	{ \
+		block_start = (pc); \
+		if (trace.records != NULL) \
+			dvm_trace_push(trace, cur_func_index, block_start - cur_func->bytecode_start, instruction.opcode); \
+	} while (0)
+
+// Registers in an execution's stack
+
+#define DVM_STACK_SIZE 128
+
+// A run nested for a call hands back to its caller's run with this when the callee returns, it never leaves dvm_run
+
+#define DVM_EXEC_STATUS_RETURNED ((enum dvm_exec_status)(dvm_exec_status_yielded + 1))
+
+// The state of an execution between slices, dvm_run keeps all of it in locals while it runs
+
+struct dvm_execution
 {
-	if (function == NULL)
+	struct dvm_context		*context;
+
+	uint32_t				 entry_index;
+	uint32_t				 func_index;
+	uint32_t				 pc;
+	uint32_t				 frame_size;
+	uint32_t				 depth;
+
+	// With a profiler attached each call is run by a dvm_run of its own, which hands back once depth drops below this
+
+	uint32_t				 run_base;
+
+	struct dvm_stack		 stack;
+	struct dvm_exec_stats	 stats;
+
+	// Traced executions write into a ring set up before they start, their own unless dvm_exec_proc lends them the context's
+
+	dvm_trace				 trace;
+	int						 owns_trace;
+
+	enum dvm_exec_status	 status;
+
+	// Linked into the context's executions until it can't run any more
+
+	int						 live;
+	struct dvm_execution	*prev_live;
+	struct dvm_execution	*next_live;
+};
+
+static void dvm_link_execution(struct dvm_execution *execution)
+{
+	struct dvm_context *context = execution->context;
+
+	execution->live = 1;
+	execution->prev_live = NULL;
+	execution->next_live = context->executions;
+
+	if (context->executions != NULL)
+		context->executions->prev_live = execution;
+
+	context->executions = execution;
+}
+static void dvm_unlink_execution(struct dvm_execution *execution)
+{
+	struct dvm_context *context = execution->context;
+
+	if (!execution->live)
+		return;
+
+	if (execution->prev_live != NULL)
+		execution->prev_live->next_live = execution->next_live;
+	else
+		context->executions = execution->next_live;
+
+	if (execution->next_live != NULL)
+		execution->next_live->prev_live = execution->prev_live;
+
+	execution->live = 0;
+}
+
+// Frees the arrays scripts made that no global or live execution refers to. Arrays in the results are handed to the
+// host first, so they're its to destroy from then on. Everything below a live execution's frame can be reached
+// when its callers return, the registers above it can't.
+
+static void dvm_collect_arrays(const dvm_var *results, size_t result_count, struct dvm_context *context)
+{
+	if (context->script_arrays == NULL || !dvm_begin_array_marks(context))
 	{
-		fprintf(stderr, "invalid function.\n");
-		return 0;
+		return;
+	}
+
+	for (size_t i = 0; i < result_count; ++i)
+	{
+		dvm_array *array = dvm_find_script_array(&results[i], context);
+
+		if (array != NULL)
+			dvm_hold_array(array, context);
 	}
 
-	// Execution variables 
+	dvm_mark_arrays(context->globals, context->globals + context->global_count, context);
 
-	uint32_t					 cur_func_index = function - context->function;
-	struct dvm_procedure		*cur_func = &context->function[cur_func_index];
-	uint32_t					 cur_pc = cur_func->bytecode_start;
-	uint32_t					 cur_frame_size = cur_func->reg_count_in + cur_func->reg_count_use;
+	for (struct dvm_execution *execution = context->executions; execution != NULL; execution = execution->next_live)
+	{
+		dvm_mark_arrays(execution->stack.reg_begin, execution->stack.reg_current + execution->frame_size, context);
+	}
+
+	dvm_sweep_arrays(context);
+}
+
+static int dvm_init_execution(struct dvm_execution *execution, struct dvm_procedure *function, const dvm_var *func_parameters, struct dvm_trace_record *trace_records, struct dvm_context *context)
+{
+	memset(execution, 0, sizeof(struct dvm_execution));
+
+	if (trace_records != NULL)
+	{
+		execution->trace.records = trace_records;
+		execution->trace.mask = context->exec_trace.mask;
+
+		dvm_trace_push(execution->trace, (uint32_t)(function - context->function), 0, dvm_opcode_nop);
+	}
+
+	execution->context = context;
+	execution->entry_index = function - context->function;
+	execution->func_index = execution->entry_index;
+	execution->pc = function->bytecode_start;
+	execution->frame_size = function->reg_count_in + function->reg_count_use;
+	execution->depth = 1;
+	execution->stats.max_depth = 1;
 
-	// Allocate the stack for use in executing this function
+	// A new execution hasn't been given any fuel yet
 
-	struct dvm_stack stack;
-	memset(&stack, 0, sizeof(stack));
+	execution->status = dvm_exec_status_budget_exhausted;
 
-	if (!dvm_stack_alloc(&stack, 128))
+	// Allocate the stack for use in executing this function, a frame can have no registers so there are as many frames
+
+	if (!dvm_stack_alloc(&execution->stack, DVM_STACK_SIZE, DVM_STACK_SIZE))
 	{
 		fprintf(stderr, "error creating a dash stack.\n");
 		return 0;
 	}
-	
-	// Push the first function's registers, and parameters over
 
-	if (!dvm_stack_push(&stack, cur_frame_size))
+	// The first function's registers start the stack, copy the parameters over
+
+	if (execution->frame_size > DVM_STACK_SIZE)
 	{
 		fprintf(stderr, "stack overflow error.\n");
+		dvm_stack_dealloc(&execution->stack);
 		return 0;
 	}
 
 	memcpy(
-		stack.reg_current,
+		execution->stack.reg_current,
 		func_parameters,
-		sizeof(dvm_var) * cur_func->reg_count_in
+		sizeof(dvm_var) * function->reg_count_in
 		);
 
+	return 1;
+}
+
+// Runs an execution until it returns, fails or uses up its fuel, a fuel of zero is unlimited
+
+static enum dvm_exec_status dvm_run(struct dvm_execution *execution, uint64_t fuel, dvm_var *func_results)
+{
+	struct dvm_context			*context = execution->context;
+	enum dvm_exec_status		 status;
+
+	// Execution variables, written back to the execution when it's suspended
+
+	uint32_t					 cur_func_index = execution->func_index;
+	struct dvm_procedure		*cur_func = &context->function[cur_func_index];
+	uint32_t					 cur_pc = execution->pc;
+	uint32_t					 cur_frame_size = execution->frame_size;
+
+	uint32_t					 block_start = cur_pc;
+	uint32_t					 depth = execution->depth;
+	uint32_t					 run_base = execution->run_base;
+
+	struct dvm_stack			 stack = execution->stack;
+	struct dvm_exec_stats		 stats = execution->stats;
+	dvm_trace					 trace = execution->trace;
+
+	uint64_t					 fuel_limit = fuel == 0 || fuel > UINT64_MAX - stats.instructions ? UINT64_MAX : stats.instructions + fuel;
+	double						 start_time = context->exec_timing ? dvm_now() : 0.0;
+
 	// Bytecode execution main loop
 
 	while (1)
@@ -87,51 +257,53 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 				goto execution_error;
 			}
 
-			// Grab the pointer for where to get the parameters, before we push an activation record
-
-			dvm_var *reg_in_start = &stack.reg_current[instruction.b];
-
 			if (next_func->c_function != NULL)
 			{
-				dvm_var *reg_out_start = &stack.reg_current[instruction.c];
+				next_func->c_function(&stack.reg_current[instruction.b], &stack.reg_current[instruction.c]);
 
-				next_func->c_function(reg_in_start, reg_out_start);
+				++stats.native_calls;
 			}
 			else
 			{
-				// Push space for an activation record
+				// The callee's registers start at the parameters, so they're already in place
+
+				uint32_t next_frame_size = next_func->reg_count_in + next_func->reg_count_use;
 
-				if (!dvm_stack_push(&stack, 4))
+				struct dvm_frame *frame = dvm_stack_push(&stack, instruction.b, next_frame_size);
+
+				if (frame == NULL)
 				{
 					fprintf(stderr, "stack overflow error.\n");
 					goto execution_error;
 				}
 
-				stack.reg_current[0].u = cur_frame_size;
-				stack.reg_current[1].u = cur_func_index;
-				stack.reg_current[2].u = instruction.c;
-				stack.reg_current[3].u = cur_pc;
+				frame->func_index = cur_func_index;
+				frame->pc = cur_pc;
+				frame->frame_size = cur_frame_size;
 
 				// Switch to the new function
 
+				DVM_RETIRE_BLOCK();
+
 				cur_func_index = instruction.a;
 				cur_func = next_func;
 				cur_pc = next_func->bytecode_start;
-				cur_frame_size = next_func->reg_count_in + next_func->reg_count_use;
+				DVM_ENTER_BLOCK(cur_pc);
 
-				if (!dvm_stack_push(&stack, cur_frame_size))
+				++stats.calls;
+
+				if (++depth > stats.max_depth)
 				{
-					fprintf(stderr, "stack overflow error.\n");
-					goto execution_error;
+					stats.max_depth = depth;
 				}
+				cur_frame_size = next_frame_size;
 
-				// Copy the parameters over
+				DVM_CHECK_FUEL();
 
-				memcpy(
-					stack.reg_current,
-					reg_in_start,
-					sizeof(dvm_var) * cur_func->reg_count_in
-					);
+				if (context->perf.modes != 0)
+				{
+					goto execution_perf_call;
+				}
 
 				// Skip over the pc increment and continue on
 
@@ -140,33 +312,76 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 
 			break;
 		}
-		case dvm_opcode_ret:
+		case dvm_opcode_callr:
 		{
-			// Validate the operands (instruction.a = reg_out_start)
+			// Linked when its registers were proven to fit both frames, the callee's target has all it needs
 
-			if (instruction.a >= cur_frame_size ||
-				(uint32_t)(instruction.a + cur_func->reg_count_out) > (uint32_t)(cur_frame_size))
+			const dvm_call_target *target = &context->call_targets[instruction.a];
+
+			struct dvm_frame *frame = dvm_stack_push(&stack, instruction.b, target->frame_size);
+
+			if (frame == NULL)
 			{
-				fprintf(stderr, "invalid register range for result registers.\n");
+				fprintf(stderr, "stack overflow error.\n");
 				goto execution_error;
 			}
 
-			// Grab an pointer to the source for return data
+			frame->func_index = cur_func_index;
+			frame->pc = cur_pc;
+			frame->frame_size = cur_frame_size;
 
-			dvm_var *reg_out_start = &stack.reg_current[instruction.a];
+			DVM_RETIRE_BLOCK();
+
+			cur_func_index = instruction.a;
+			cur_func = &context->function[cur_func_index];
+			cur_pc = target->bytecode_start;
+			DVM_ENTER_BLOCK(cur_pc);
+
+			++stats.calls;
+
+			if (++depth > stats.max_depth)
+			{
+				stats.max_depth = depth;
+			}
+			cur_frame_size = target->frame_size;
+
+			DVM_CHECK_FUEL();
+
+			if (context->perf.modes != 0)
+			{
+				goto execution_perf_call;
+			}
+
+			continue;
+		}
+		case dvm_opcode_calln:
+		{
+			context->call_targets[instruction.a].c_function(&stack.reg_current[instruction.b], &stack.reg_current[instruction.c]);
+
+			++stats.native_calls;
 
-			// Pop this function's registers off the stack
+			break;
+		}
+		case dvm_opcode_ret:
+		{
+			// Validate the operands (instruction.a = reg_out_start), a procedure without results can return from past its frame
 
-			if (!dvm_stack_pop(&stack, cur_frame_size))
+			if ((uint32_t)(instruction.a + cur_func->reg_count_out) > (uint32_t)(cur_frame_size))
 			{
-				fprintf(stderr, "stack underflow error.\n");
+				fprintf(stderr, "invalid register range for result registers.\n");
 				goto execution_error;
 			}
 
-			// If there is no activation record after this, then
+			// Grab an pointer to the source for return data
+
+			dvm_var *reg_out_start = &stack.reg_current[instruction.a];
+
+			// Go back to the caller's registers, if there's no caller then
 			// we have reached the end of the execution.
 
-			if (stack.reg_current == stack.reg_bottom)
+			struct dvm_frame *frame = dvm_stack_pop(&stack);
+
+			if (frame == NULL)
 			{
 				memcpy(
 					func_results,
@@ -177,36 +392,54 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 				goto execution_over;
 			}
 
-			// We need to return back to our previous function,
-			// grab the activation record from the stack and pop past it
+			// The results go where the call said, they're only copied when they aren't there already.
+			// The callee's registers overlap the caller's, so they can overlap where they go.
 
-			dvm_var returning_func_frame_size = stack.reg_current[0];
-			dvm_var returning_func_index = stack.reg_current[1];
-			dvm_var returning_func_result_dest = stack.reg_current[2];
-			dvm_var returning_cur_pc = stack.reg_current[3];
+			dvm_var *reg_result_dest = &stack.reg_current[context->bytecode[frame->pc].c];
 
-			if (!dvm_stack_pop(&stack, 4))
+			if (reg_result_dest != reg_out_start)
 			{
-				fprintf(stderr, "stack underflow error.\n");
-				goto execution_error;
+				memmove(
+					reg_result_dest,
+					reg_out_start,
+					sizeof(dvm_var) * cur_func->reg_count_out
+					);
 			}
 
-			// The stack is now back to where it was, now we just
-			// need to copy the result, and move the variables back.
+			cur_func_index = frame->func_index;
+			cur_func = &context->function[cur_func_index];
+			cur_frame_size = frame->frame_size;
+			DVM_RETIRE_BLOCK();
 
-			memcpy(
-				stack.reg_current + returning_func_result_dest.u,
-				reg_out_start,
-				sizeof(dvm_var) * cur_func->reg_count_out
-				);
+			cur_pc = frame->pc;
+			DVM_ENTER_BLOCK(cur_pc + 1);
 
-			cur_func_index = returning_func_index.u;
-			cur_func = &context->function[cur_func_index];
-			cur_frame_size = returning_func_frame_size.u;
-			cur_pc = returning_cur_pc.u;
+			--depth;
+
+			if (depth < run_base)
+			{
+				goto execution_returned;
+			}
 
 			break;
 		}
+		case dvm_opcode_yield:
+		{
+			// Hands control back to the host, the execution carries on from the next instruction when it's resumed
+
+			if (cur_pc + 1 == cur_func->bytecode_end)
+			{
+				fprintf(stderr, "reached the end of function without ret instruction.\n");
+				goto execution_error;
+			}
+
+			DVM_RETIRE_BLOCK();
+
+			++cur_pc;
+			DVM_ENTER_BLOCK(cur_pc);
+
+			goto execution_yielded;
+		}
 		case dvm_opcode_mov:
 		{
 			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
@@ -219,6 +452,21 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 
 			break;
 		}
+		case dvm_opcode_movn:
+		{
+			// Copies a window of instruction.b registers, used to move whole structs
+
+			if ((uint32_t)(instruction.a + instruction.b) > (uint32_t)(cur_frame_size) ||
+				(uint32_t)(instruction.c + instruction.b) > (uint32_t)(cur_frame_size))
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			memmove(&stack.reg_current[instruction.c], &stack.reg_current[instruction.a], sizeof(dvm_var) * instruction.b);
+
+			break;
+		}
 		case dvm_opcode_stor:
 		{
 			if (instruction.c >= cur_frame_size)
@@ -228,6 +476,7 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 			}
 
 			cur_pc++;
+			block_start++;
 
 			if (cur_pc == cur_func->bytecode_end)
 			{
@@ -240,6 +489,37 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 			break;
 		}
 
+		case dvm_opcode_gload:
+		{
+			uint32_t index = dvm_bc_global_index(instruction);
+
+			if (instruction.c >= cur_frame_size || index >= context->global_count)
+			{
+				fprintf(stderr, "global out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c] = context->globals[index];
+
+			break;
+		}
+		case dvm_opcode_gstor:
+		{
+			// instruction.c is the source register
+
+			uint32_t index = dvm_bc_global_index(instruction);
+
+			if (instruction.c >= cur_frame_size || index >= context->global_count)
+			{
+				fprintf(stderr, "global out of bounds error.\n");
+				goto execution_error;
+			}
+
+			context->globals[index] = stack.reg_current[instruction.c];
+
+			break;
+		}
+
 		case dvm_opcode_and:
 		{
 			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
@@ -365,14 +645,24 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 			{
 				uint8_t offset = instruction.c;
 
-				cur_pc += *(int8_t *)&offset;
+				uint32_t target = cur_pc + *(int8_t *)&offset;
 
-				if (cur_pc >= cur_func->bytecode_end || cur_pc < cur_func->bytecode_start)
+				if (target >= cur_func->bytecode_end || target < cur_func->bytecode_start)
 				{
 					fprintf(stderr, "jmp to outside of the current function.\n");
 					goto execution_error;
 				}
 
+				DVM_RETIRE_BLOCK();
+
+				cur_pc = target;
+				DVM_ENTER_BLOCK(cur_pc);
+
+				if (*(int8_t *)&offset <= 0)
+				{
+					DVM_CHECK_FUEL();
+				}
+
 				// Skip the normal increment
 
 				continue;
@@ -392,14 +682,24 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 			{
 				uint8_t offset = instruction.c;
 
-				cur_pc += *(int8_t *)&offset;
+				uint32_t target = cur_pc + *(int8_t *)&offset;
 
-				if (cur_pc >= cur_func->bytecode_end || cur_pc < cur_func->bytecode_start)
+				if (target >= cur_func->bytecode_end || target < cur_func->bytecode_start)
 				{
 					fprintf(stderr, "jmp to outside of the current function.\n");
 					goto execution_error;
 				}
 
+				DVM_RETIRE_BLOCK();
+
+				cur_pc = target;
+				DVM_ENTER_BLOCK(cur_pc);
+
+				if (*(int8_t *)&offset <= 0)
+				{
+					DVM_CHECK_FUEL();
+				}
+
 				// Skip the normal increment
 
 				continue;
@@ -411,127 +711,301 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 		{
 			uint8_t offset = instruction.c;
 
-			cur_pc += *(int8_t *)&offset;
+			uint32_t target = cur_pc + *(int8_t *)&offset;
 
-			if (cur_pc >= cur_func->bytecode_end || cur_pc < cur_func->bytecode_start)
+			if (target >= cur_func->bytecode_end || target < cur_func->bytecode_start)
 			{
 				fprintf(stderr, "jmp to outside of the current function.\n");
 				goto execution_error;
 			}
 
+			DVM_RETIRE_BLOCK();
+
+			cur_pc = target;
+			DVM_ENTER_BLOCK(cur_pc);
+
+			if (*(int8_t *)&offset <= 0)
+			{
+				DVM_CHECK_FUEL();
+			}
+
 			// Skip the normal increment
 
 			continue;
 		}
 
-		case dvm_opcode_addi:
+		case dvm_opcode_jmp_l:
 		{
-			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			// The offset is a full 32 bits, for jumps further than jmpu can reach
+
+			if (cur_pc + 1 >= cur_func->bytecode_end)
 			{
-				fprintf(stderr, "register out of bounds error.\n");
+				fprintf(stderr, "reached the end of function without ret instruction.\n");
 				goto execution_error;
 			}
 
-			stack.reg_current[instruction.c].i =
-				stack.reg_current[instruction.a].i +
-				stack.reg_current[instruction.b].i;
+			int32_t offset = *(int32_t *)(context->bytecode + cur_pc + 1);
 
-			break;
-		}
-		
-		case dvm_opcode_addf:
-		{
-			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			uint32_t target = cur_pc + offset;
+
+			if (target >= cur_func->bytecode_end || target < cur_func->bytecode_start)
 			{
-				fprintf(stderr, "register out of bounds error.\n");
+				fprintf(stderr, "jmp to outside of the current function.\n");
 				goto execution_error;
 			}
 
-			stack.reg_current[instruction.c].f =
-				stack.reg_current[instruction.a].f +
-				stack.reg_current[instruction.b].f;
+			DVM_RETIRE_BLOCK();
 
-			break;
-		}
+			cur_pc = target;
+			DVM_ENTER_BLOCK(cur_pc);
 
-		case dvm_opcode_subi:
-		{
-			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			if (offset <= 0)
 			{
-				fprintf(stderr, "register out of bounds error.\n");
-				goto execution_error;
+				DVM_CHECK_FUEL();
 			}
 
-			stack.reg_current[instruction.c].i =
-				stack.reg_current[instruction.a].i -
-				stack.reg_current[instruction.b].i;
+			// Skip the normal increment
 
-			break;
+			continue;
 		}
-		
-		case dvm_opcode_subf:
+		case dvm_opcode_jmp_t:
 		{
-			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			// Jumps through the table entry instruction.a selects, or the default when it's past the end of the table
+
+			if (instruction.a >= cur_frame_size)
 			{
 				fprintf(stderr, "register out of bounds error.\n");
 				goto execution_error;
 			}
 
-			stack.reg_current[instruction.c].f =
-				stack.reg_current[instruction.a].f -
-				stack.reg_current[instruction.b].f;
+			if (cur_pc + 1 + instruction.b >= cur_func->bytecode_end)
+			{
+				fprintf(stderr, "reached the end of function without ret instruction.\n");
+				goto execution_error;
+			}
 
-			break;
-		}
+			uint32_t entry = stack.reg_current[instruction.a].u;
+			uint32_t slot = entry < instruction.b ? entry + 2 : 1;
 
-		case dvm_opcode_muli:
-		{
-			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			int32_t offset = *(int32_t *)(context->bytecode + cur_pc + slot);
+
+			uint32_t target = cur_pc + offset;
+
+			if (target >= cur_func->bytecode_end || target < cur_func->bytecode_start)
 			{
-				fprintf(stderr, "register out of bounds error.\n");
+				fprintf(stderr, "jmp to outside of the current function.\n");
 				goto execution_error;
 			}
 
-			stack.reg_current[instruction.c].i =
-				stack.reg_current[instruction.a].i *
-				stack.reg_current[instruction.b].i;
+			DVM_RETIRE_BLOCK();
 
-			break;
-		}
-		
-		case dvm_opcode_mulf:
-		{
-			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			cur_pc = target;
+			DVM_ENTER_BLOCK(cur_pc);
+
+			if (offset <= 0)
 			{
-				fprintf(stderr, "register out of bounds error.\n");
-				goto execution_error;
+				DVM_CHECK_FUEL();
 			}
 
-			stack.reg_current[instruction.c].f =
-				stack.reg_current[instruction.a].f *
-				stack.reg_current[instruction.b].f;
+			// Skip the normal increment
 
-			break;
+			continue;
 		}
 
-		case dvm_opcode_divi:
+		case dvm_opcode_inci:
 		{
-			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			if (instruction.a >= cur_frame_size)
 			{
 				fprintf(stderr, "register out of bounds error.\n");
 				goto execution_error;
 			}
 
-			stack.reg_current[instruction.c].i =
-				stack.reg_current[instruction.a].i /
-				stack.reg_current[instruction.b].i;
+			++stack.reg_current[instruction.a].i;
 
 			break;
 		}
-		
-		case dvm_opcode_divf:
+
+		case dvm_opcode_loop:
 		{
-			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			// The back edge of a counted loop, increment then branch while below the limit
+
+			if (++stack.reg_current[instruction.a].i < stack.reg_current[instruction.b].i)
+			{
+				uint8_t offset = instruction.c;
+
+				uint32_t target = cur_pc + *(int8_t *)&offset;
+
+				if (target >= cur_func->bytecode_end || target < cur_func->bytecode_start)
+				{
+					fprintf(stderr, "jmp to outside of the current function.\n");
+					goto execution_error;
+				}
+
+				DVM_RETIRE_BLOCK();
+
+				cur_pc = target;
+				DVM_ENTER_BLOCK(cur_pc);
+
+				if (*(int8_t *)&offset <= 0)
+				{
+					DVM_CHECK_FUEL();
+				}
+
+				// Skip the normal increment
+
+				continue;
+			}
+
+			break;
+		}
+
+		case dvm_opcode_select:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			// Blend through a mask so a data dependent condition can't mispredict
+
+			int64_t mask = -(int64_t)(stack.reg_current[instruction.a].i != 0);
+
+			stack.reg_current[instruction.c].l =
+				(stack.reg_current[instruction.b].l & mask) |
+				(stack.reg_current[instruction.c].l & ~mask);
+
+			break;
+		}
+		
+		case dvm_opcode_addi:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i =
+				stack.reg_current[instruction.a].i +
+				stack.reg_current[instruction.b].i;
+
+			break;
+		}
+		
+		case dvm_opcode_addf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f =
+				stack.reg_current[instruction.a].f +
+				stack.reg_current[instruction.b].f;
+
+			break;
+		}
+
+		case dvm_opcode_subi:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i =
+				stack.reg_current[instruction.a].i -
+				stack.reg_current[instruction.b].i;
+
+			break;
+		}
+		
+		case dvm_opcode_subf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f =
+				stack.reg_current[instruction.a].f -
+				stack.reg_current[instruction.b].f;
+
+			break;
+		}
+
+		case dvm_opcode_muli:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i =
+				stack.reg_current[instruction.a].i *
+				stack.reg_current[instruction.b].i;
+
+			break;
+		}
+		
+		case dvm_opcode_mulf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f =
+				stack.reg_current[instruction.a].f *
+				stack.reg_current[instruction.b].f;
+
+			break;
+		}
+
+		case dvm_opcode_divi:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			// Dividing by zero and the smallest value by -1 both trap in hardware
+
+			if (stack.reg_current[instruction.b].i == 0)
+			{
+				fprintf(stderr, "division by zero error.\n");
+				goto execution_error;
+			}
+
+			if (stack.reg_current[instruction.a].i == INT32_MIN && stack.reg_current[instruction.b].i == -1)
+			{
+				fprintf(stderr, "division overflow error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i =
+				stack.reg_current[instruction.a].i /
+				stack.reg_current[instruction.b].i;
+
+			break;
+		}
+		
+		case dvm_opcode_divf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
 			{
 				fprintf(stderr, "register out of bounds error.\n");
 				goto execution_error;
@@ -544,7 +1018,711 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 			break;
 		}
 
-		case dvm_opcode_casti:
+		case dvm_opcode_modi:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			if (stack.reg_current[instruction.b].i == 0)
+			{
+				fprintf(stderr, "division by zero error.\n");
+				goto execution_error;
+			}
+
+			if (stack.reg_current[instruction.a].i == INT32_MIN && stack.reg_current[instruction.b].i == -1)
+			{
+				fprintf(stderr, "division overflow error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].i % stack.reg_current[instruction.b].i;
+
+			break;
+		}
+
+		// Shift counts are integers and wrap to the width of the operand, like the hardware does
+
+		case dvm_opcode_shli:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = (int32_t)((uint32_t)stack.reg_current[instruction.a].i << (stack.reg_current[instruction.b].i & 31));
+
+			break;
+		}
+
+		case dvm_opcode_shri:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].i >> (stack.reg_current[instruction.b].i & 31);
+
+			break;
+		}
+
+		case dvm_opcode_bandi:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].i & stack.reg_current[instruction.b].i;
+
+			break;
+		}
+
+		case dvm_opcode_bori:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].i | stack.reg_current[instruction.b].i;
+
+			break;
+		}
+
+		case dvm_opcode_bxori:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].i ^ stack.reg_current[instruction.b].i;
+
+			break;
+		}
+
+		case dvm_opcode_casti:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = (int32_t)stack.reg_current[instruction.a].f;
+
+			break;
+		}
+
+		case dvm_opcode_castf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = (float)stack.reg_current[instruction.a].i;
+
+			break;
+		}
+
+		case dvm_opcode_storl:
+		{
+			if (instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			if (cur_pc + 2 >= cur_func->bytecode_end)
+			{
+				fprintf(stderr, "reached the end of function without ret instruction.\n");
+				goto execution_error;
+			}
+
+			memcpy(&stack.reg_current[instruction.c].l, context->bytecode + cur_pc + 1, sizeof(int64_t));
+
+			cur_pc += 2;
+			block_start += 2;
+
+			break;
+		}
+
+		case dvm_opcode_cmpl_e:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].l == stack.reg_current[instruction.b].l;
+
+			break;
+		}
+		case dvm_opcode_cmpd_e:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].d == stack.reg_current[instruction.b].d;
+
+			break;
+		}
+
+		case dvm_opcode_cmpl_l:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].l < stack.reg_current[instruction.b].l;
+
+			break;
+		}
+		case dvm_opcode_cmpd_l:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].d < stack.reg_current[instruction.b].d;
+
+			break;
+		}
+
+		case dvm_opcode_cmpl_le:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].l <= stack.reg_current[instruction.b].l;
+
+			break;
+		}
+		case dvm_opcode_cmpd_le:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].d <= stack.reg_current[instruction.b].d;
+
+			break;
+		}
+
+		case dvm_opcode_addl:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l =
+				stack.reg_current[instruction.a].l +
+				stack.reg_current[instruction.b].l;
+
+			break;
+		}
+
+		case dvm_opcode_addd:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].d =
+				stack.reg_current[instruction.a].d +
+				stack.reg_current[instruction.b].d;
+
+			break;
+		}
+
+		case dvm_opcode_subl:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l =
+				stack.reg_current[instruction.a].l -
+				stack.reg_current[instruction.b].l;
+
+			break;
+		}
+
+		case dvm_opcode_subd:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].d =
+				stack.reg_current[instruction.a].d -
+				stack.reg_current[instruction.b].d;
+
+			break;
+		}
+
+		case dvm_opcode_mull:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l =
+				stack.reg_current[instruction.a].l *
+				stack.reg_current[instruction.b].l;
+
+			break;
+		}
+
+		case dvm_opcode_muld:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].d =
+				stack.reg_current[instruction.a].d *
+				stack.reg_current[instruction.b].d;
+
+			break;
+		}
+
+		case dvm_opcode_divl:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			if (stack.reg_current[instruction.b].l == 0)
+			{
+				fprintf(stderr, "division by zero error.\n");
+				goto execution_error;
+			}
+
+			if (stack.reg_current[instruction.a].l == INT64_MIN && stack.reg_current[instruction.b].l == -1)
+			{
+				fprintf(stderr, "division overflow error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l =
+				stack.reg_current[instruction.a].l /
+				stack.reg_current[instruction.b].l;
+
+			break;
+		}
+
+		case dvm_opcode_divd:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].d =
+				stack.reg_current[instruction.a].d /
+				stack.reg_current[instruction.b].d;
+
+			break;
+		}
+
+		case dvm_opcode_modl:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			if (stack.reg_current[instruction.b].l == 0)
+			{
+				fprintf(stderr, "division by zero error.\n");
+				goto execution_error;
+			}
+
+			if (stack.reg_current[instruction.a].l == INT64_MIN && stack.reg_current[instruction.b].l == -1)
+			{
+				fprintf(stderr, "division overflow error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l = stack.reg_current[instruction.a].l % stack.reg_current[instruction.b].l;
+
+			break;
+		}
+
+		case dvm_opcode_shll:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l = (int64_t)((uint64_t)stack.reg_current[instruction.a].l << (stack.reg_current[instruction.b].i & 63));
+
+			break;
+		}
+
+		case dvm_opcode_shrl:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l = stack.reg_current[instruction.a].l >> (stack.reg_current[instruction.b].i & 63);
+
+			break;
+		}
+
+		case dvm_opcode_bandl:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l = stack.reg_current[instruction.a].l & stack.reg_current[instruction.b].l;
+
+			break;
+		}
+
+		case dvm_opcode_borl:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l = stack.reg_current[instruction.a].l | stack.reg_current[instruction.b].l;
+
+			break;
+		}
+
+		case dvm_opcode_bxorl:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l = stack.reg_current[instruction.a].l ^ stack.reg_current[instruction.b].l;
+
+			break;
+		}
+
+		case dvm_opcode_castil:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l = (int64_t)stack.reg_current[instruction.a].i;
+
+			break;
+		}
+
+		case dvm_opcode_castli:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = (int32_t)stack.reg_current[instruction.a].l;
+
+			break;
+		}
+
+		case dvm_opcode_castfd:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].d = (double)stack.reg_current[instruction.a].f;
+
+			break;
+		}
+
+		case dvm_opcode_castdf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = (float)stack.reg_current[instruction.a].d;
+
+			break;
+		}
+
+		case dvm_opcode_castld:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].d = (double)stack.reg_current[instruction.a].l;
+
+			break;
+		}
+
+		case dvm_opcode_castdl:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l = (int64_t)stack.reg_current[instruction.a].d;
+
+			break;
+		}
+
+		case dvm_opcode_castfl:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].l = (int64_t)stack.reg_current[instruction.a].f;
+
+			break;
+		}
+
+		case dvm_opcode_castlf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = (float)stack.reg_current[instruction.a].l;
+
+			break;
+		}
+
+		case dvm_opcode_castid:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].d = (double)stack.reg_current[instruction.a].i;
+
+			break;
+		}
+
+		case dvm_opcode_castdi:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = (int32_t)stack.reg_current[instruction.a].d;
+
+			break;
+		}
+
+		case dvm_opcode_anew:
+		{
+			// instruction.b holds the element type
+
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			if (stack.reg_current[instruction.a].i < 0)
+			{
+				fprintf(stderr, "negative array length error.\n");
+				goto execution_error;
+			}
+
+			// Collecting looks through this execution's registers, which are only kept in locals while it runs
+
+			if (context->script_array_bytes >= context->script_array_limit)
+			{
+				execution->stack = stack;
+				execution->frame_size = cur_frame_size;
+
+				dvm_collect_arrays(NULL, 0, context);
+			}
+
+			dvm_array *array = dvm_create_script_array((enum dvm_type)instruction.b, (size_t)stack.reg_current[instruction.a].i, context);
+
+			if (array == NULL)
+			{
+				fprintf(stderr, "error allocating an array.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].a = array;
+
+			break;
+		}
+		case dvm_opcode_alen:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			dvm_array *array = stack.reg_current[instruction.a].a;
+
+			stack.reg_current[instruction.c].i = array != NULL ? (int32_t)array->length : 0;
+
+			break;
+		}
+		case dvm_opcode_aload:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			dvm_array *array = stack.reg_current[instruction.a].a;
+			uint32_t index = stack.reg_current[instruction.b].u;
+
+			if (array == NULL || index >= array->length)
+			{
+				fprintf(stderr, "array index out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].u = ((uint32_t *)array->data)[index];
+
+			break;
+		}
+		case dvm_opcode_astor:
+		{
+			// instruction.c is the source register
+
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			dvm_array *array = stack.reg_current[instruction.a].a;
+			uint32_t index = stack.reg_current[instruction.b].u;
+
+			if (array == NULL || index >= array->length)
+			{
+				fprintf(stderr, "array index out of bounds error.\n");
+				goto execution_error;
+			}
+
+			((uint32_t *)array->data)[index] = stack.reg_current[instruction.c].u;
+
+			break;
+		}
+
+		case dvm_opcode_sload:
+		{
+			uint32_t index = dvm_bc_string_index(instruction);
+
+			if (instruction.c >= cur_frame_size || index >= context->string_count)
+			{
+				fprintf(stderr, "string out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].s = context->strings[index];
+
+			break;
+		}
+		case dvm_opcode_cmps_e:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			// Interned, so equal strings are the same string
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].s == stack.reg_current[instruction.b].s;
+
+			break;
+		}
+		case dvm_opcode_shash:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].u = dvm_string_hash(stack.reg_current[instruction.a].s);
+
+			break;
+		}
+		case dvm_opcode_slen:
 		{
 			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
 			{
@@ -552,12 +1730,12 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 				goto execution_error;
 			}
 
-			stack.reg_current[instruction.c].i = (int32_t)stack.reg_current[instruction.a].f;
+			stack.reg_current[instruction.c].i = (int32_t)dvm_string_length(stack.reg_current[instruction.a].s);
 
 			break;
 		}
 
-		case dvm_opcode_castf:
+		case dvm_opcode_sqrtf:
 		{
 			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
 			{
@@ -565,7 +1743,156 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 				goto execution_error;
 			}
 
-			stack.reg_current[instruction.c].f = (float)stack.reg_current[instruction.a].i;
+			stack.reg_current[instruction.c].f = sqrtf(stack.reg_current[instruction.a].f);
+
+			break;
+		}
+		case dvm_opcode_sinf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = dvm_sinf(stack.reg_current[instruction.a].f);
+
+			break;
+		}
+		case dvm_opcode_cosf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = dvm_cosf(stack.reg_current[instruction.a].f);
+
+			break;
+		}
+		case dvm_opcode_tanf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = dvm_tanf(stack.reg_current[instruction.a].f);
+
+			break;
+		}
+		case dvm_opcode_floorf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = floorf(stack.reg_current[instruction.a].f);
+
+			break;
+		}
+		case dvm_opcode_absi:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = abs(stack.reg_current[instruction.a].i);
+
+			break;
+		}
+		case dvm_opcode_absf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = fabsf(stack.reg_current[instruction.a].f);
+
+			break;
+		}
+		case dvm_opcode_powf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = powf(stack.reg_current[instruction.a].f, stack.reg_current[instruction.b].f);
+
+			break;
+		}
+		case dvm_opcode_mini:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].i < stack.reg_current[instruction.b].i ? stack.reg_current[instruction.a].i : stack.reg_current[instruction.b].i;
+
+			break;
+		}
+		case dvm_opcode_minf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = fminf(stack.reg_current[instruction.a].f, stack.reg_current[instruction.b].f);
+
+			break;
+		}
+		case dvm_opcode_maxi:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].i = stack.reg_current[instruction.a].i > stack.reg_current[instruction.b].i ? stack.reg_current[instruction.a].i : stack.reg_current[instruction.b].i;
+
+			break;
+		}
+		case dvm_opcode_maxf:
+		{
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = fmaxf(stack.reg_current[instruction.a].f, stack.reg_current[instruction.b].f);
+
+			break;
+		}
+		case dvm_opcode_fmaf:
+		{
+			// Accumulates into instruction.c
+
+			if (instruction.a >= cur_frame_size || instruction.b >= cur_frame_size || instruction.c >= cur_frame_size)
+			{
+				fprintf(stderr, "register out of bounds error.\n");
+				goto execution_error;
+			}
+
+			stack.reg_current[instruction.c].f = fmaf(
+				stack.reg_current[instruction.a].f,
+				stack.reg_current[instruction.b].f,
+				stack.reg_current[instruction.c].f);
 
 			break;
 		}
@@ -575,6 +1902,8 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 			goto execution_error;
 		}
 
+execution_next:
+
 		++cur_pc;
 
 		if (cur_pc == cur_func->bytecode_end)
@@ -584,15 +1913,256 @@ int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters
 		}
 	}
 
+execution_perf_call:
+
+	// The callee is already set up, it's run by a dvm_run entered through its trampoline so the samples taken while
+	// it's interpreted are under it. That run has written everything back when it hands over, unless it returned.
+
+	execution->func_index = cur_func_index;
+	execution->pc = cur_pc;
+	execution->frame_size = cur_frame_size;
+	execution->depth = depth;
+	execution->run_base = depth;
+
+	stats.wall_time += context->exec_timing ? dvm_now() - start_time : 0.0;
+
+	execution->stack = stack;
+	execution->stats = stats;
+	execution->trace = trace;
+
+	status = dvm_perf_trampoline(cur_func_index, dvm_run, context)(execution, fuel_limit == UINT64_MAX ? 0 : fuel_limit - stats.instructions, func_results);
+
+	if (status != DVM_EXEC_STATUS_RETURNED)
+	{
+		return status;
+	}
+
+	// Back at the call, the callee's block was retired when it returned
+
+	cur_func_index = execution->func_index;
+	cur_func = &context->function[cur_func_index];
+	cur_pc = execution->pc;
+	cur_frame_size = execution->frame_size;
+	block_start = cur_pc + 1;
+	depth = execution->depth;
+
+	stack = execution->stack;
+	stats = execution->stats;
+	trace = execution->trace;
+
+	start_time = context->exec_timing ? dvm_now() : 0.0;
+
+	goto execution_next;
+
+execution_returned:
+
+	status = DVM_EXEC_STATUS_RETURNED;
+	goto execution_save;
+
+execution_yielded:
+
+	status = dvm_exec_status_yielded;
+	goto execution_save;
+
+execution_suspended:
+
+	status = dvm_exec_status_budget_exhausted;
+
+execution_save:
+
+	// Suspended at the start of a block, or returned from one that's been retired, so nothing is left to retire
+
+	execution->func_index = cur_func_index;
+	execution->pc = cur_pc;
+	execution->frame_size = cur_frame_size;
+	execution->depth = depth;
+
+	goto execution_exit;
+
 execution_over:
 
-	dvm_stack_dealloc(&stack);
+	DVM_RETIRE_BLOCK();
 
-	return 1;
+	status = dvm_exec_status_done;
+	goto execution_exit;
 
 execution_error:
 
-	dvm_stack_dealloc(&stack);
+	DVM_RETIRE_BLOCK();
+
+	status = dvm_exec_status_error;
+
+execution_exit:
+
+	stats.wall_time += context->exec_timing ? dvm_now() - start_time : 0.0;
+
+	execution->stack = stack;
+	execution->stats = stats;
+	execution->trace = trace;
+	execution->status = status;
+
+	return status;
+}
+
+// With a profiler attached every slice is run from the trampoline of the procedure it starts in, and every call
+// after from the callee's, so the samples in dvm_run are found under the procedure running
+
+static enum dvm_exec_status dvm_enter(struct dvm_execution *execution, uint64_t fuel, dvm_var *func_results)
+{
+	execution->run_base = 0;
+
+	if (execution->context->perf.modes != 0)
+	{
+		return dvm_perf_trampoline(execution->func_index, dvm_run, execution->context)(execution, fuel, func_results);
+	}
+
+	return dvm_run(execution, fuel, func_results);
+}
+
+int dvm_exec_proc(struct dvm_procedure *function, const dvm_var *func_parameters, dvm_var *func_results, struct dvm_context *context)
+{
+	if (function == NULL)
+	{
+		fprintf(stderr, "invalid function.\n");
+		return 0;
+	}
+
+	// Natives run directly over the caller's registers
+
+	if (function->c_function != NULL)
+	{
+		double start_time = context->exec_timing ? dvm_now() : 0.0;
+
+		function->c_function(func_parameters, func_results);
+
+		memset(&context->exec_stats, 0, sizeof(context->exec_stats));
+
+		context->exec_stats.native_calls = 1;
+		context->exec_stats.wall_time = context->exec_timing ? dvm_now() - start_time : 0.0;
+		context->exec_trace.count = 0;
+
+		return 1;
+	}
+
+	// Runs to completion without any fuel limit, so the execution can live on the host's stack.
+	// There's no host to hand control to, a yield carries straight on.
+
+	struct dvm_execution execution;
+
+	if (!dvm_init_execution(&execution, function, func_parameters, context->exec_trace.records, context))
+	{
+		return 0;
+	}
+
+	enum dvm_exec_status status;
+
+	dvm_link_execution(&execution);
+
+	while ((status = dvm_enter(&execution, 0, func_results)) == dvm_exec_status_yielded)
+	{
+	}
+
+	dvm_unlink_execution(&execution);
+
+	context->exec_stats = execution.stats;
+	context->exec_trace.count = execution.trace.count;
+
+	dvm_stack_dealloc(&execution.stack);
+
+	dvm_collect_arrays(func_results, status == dvm_exec_status_done ? function->reg_count_out : 0, context);
+
+	return status == dvm_exec_status_done;
+}
+
+struct dvm_execution *dvm_create_execution(struct dvm_procedure *function, const dvm_var *in_registers, struct dvm_context *context)
+{
+	if (function == NULL || function->c_function != NULL)
+	{
+		fprintf(stderr, "invalid function.\n");
+		return NULL;
+	}
+
+	struct dvm_execution *execution = (struct dvm_execution *)malloc(sizeof(struct dvm_execution));
+
+	if (execution == NULL)
+	{
+		return NULL;
+	}
+
+	// The ring is allocated up front, so tracing never allocates while it runs
+
+	struct dvm_trace_record *trace_records = NULL;
+
+	if (context->exec_trace.records != NULL)
+	{
+		trace_records = (struct dvm_trace_record *)malloc(sizeof(struct dvm_trace_record) * ((size_t)context->exec_trace.mask + 1));
+
+		if (trace_records == NULL)
+		{
+			free(execution);
+			return NULL;
+		}
+	}
+
+	if (!dvm_init_execution(execution, function, in_registers, trace_records, context))
+	{
+		free(trace_records);
+		free(execution);
+		return NULL;
+	}
+
+	execution->owns_trace = trace_records != NULL;
+
+	dvm_link_execution(execution);
+
+	return execution;
+}
+
+enum dvm_exec_status dvm_resume_execution(struct dvm_execution *execution, uint64_t fuel, dvm_var *out_registers)
+{
+	if (execution->status != dvm_exec_status_budget_exhausted && execution->status != dvm_exec_status_yielded)
+	{
+		fprintf(stderr, "execution has already ended.\n");
+		return dvm_exec_status_error;
+	}
+
+	enum dvm_exec_status status = dvm_enter(execution, fuel, out_registers);
+
+	if (status == dvm_exec_status_done || status == dvm_exec_status_error)
+	{
+		struct dvm_context *context = execution->context;
+
+		dvm_unlink_execution(execution);
+		dvm_collect_arrays(out_registers, status == dvm_exec_status_done ? context->function[execution->entry_index].reg_count_out : 0, context);
+	}
+
+	return status;
+}
+
+void dvm_get_execution_stats(struct dvm_exec_stats *stats, struct dvm_execution *execution)
+{
+	*stats = execution->stats;
+}
+
+size_t dvm_get_execution_trace(struct dvm_trace_record *records, size_t max_records, struct dvm_execution *execution)
+{
+	return dvm_trace_copy(records, max_records, &execution->trace);
+}
+
+void dvm_destroy_execution(struct dvm_execution *execution)
+{
+	if (execution == NULL)
+	{
+		return;
+	}
+
+	if (execution->owns_trace)
+	{
+		free(execution->trace.records);
+	}
+
+	dvm_unlink_execution(execution);
 
-	return 0;
+	dvm_stack_dealloc(&execution->stack);
+	free(execution);
 }
\ No newline at end of file
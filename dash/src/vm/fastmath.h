@@ -0,0 +1,105 @@
+#ifndef dash_fastmath_h
+#define dash_fastmath_h
+
+#include <math.h>
+
+#include "simd.h"
+
+/*
+ * Polynomial approximations of sin and cos, accurate to a few ulp over a
+ * moderate range. The argument is reduced to [-pi, pi] and reflected into
+ * [-pi/2, pi/2] without branches, so the vector and scalar versions match.
+ * Both round the multiple of 2 pi to nearest even, the vector conversion's default.
+ * Arguments are clamped to where the reduction is still exact, past it the
+ * result is still in [-1, 1] but no longer near sin x.
+ *
+ * The math opcodes use these over the C library when built with DVM_FAST_MATH,
+ * the bulk array built-ins always use the vector versions.
+ */
+
+#define DVM_FAST_INV_2PI	0.15915494309189533577f
+#define DVM_FAST_2PI_HI		6.28125f
+#define DVM_FAST_2PI_LO		0.0019353071795864769f
+#define DVM_FAST_PI			3.14159265358979323846f
+#define DVM_FAST_PI_2		1.57079632679489661923f
+
+// k * DVM_FAST_2PI_HI is exact while k fits in 16 bits
+#define DVM_FAST_MAX_ARG	4.0e5f
+
+#define DVM_FAST_SIN_3		-1.6666666666666667e-1f
+#define DVM_FAST_SIN_5		8.3333333333333333e-3f
+#define DVM_FAST_SIN_7		-1.9841269841269841e-4f
+#define DVM_FAST_SIN_9		2.7557319223985891e-6f
+#define DVM_FAST_SIN_11		-2.5052108385441719e-8f
+
+static inline float dvm_fast_sinf(float x)
+{
+	// Written the way the vector min and max compare, so a NaN goes through
+
+	x = DVM_FAST_MAX_ARG < x ? DVM_FAST_MAX_ARG : x;
+	x = -DVM_FAST_MAX_ARG > x ? -DVM_FAST_MAX_ARG : x;
+
+	// The vector rounding goes through an integer, which has no negative zero
+
+	float k = nearbyintf(x * DVM_FAST_INV_2PI) + 0.0f;
+	float r = (x - k * DVM_FAST_2PI_HI) - k * DVM_FAST_2PI_LO;
+
+	float abs_r = fabsf(r);
+
+	if (abs_r > DVM_FAST_PI_2)
+		r = copysignf(DVM_FAST_PI - abs_r, r);
+
+	float r2 = r * r;
+
+	return r * (1.0f + r2 * (DVM_FAST_SIN_3 + r2 * (DVM_FAST_SIN_5 + r2 * (DVM_FAST_SIN_7 + r2 * (DVM_FAST_SIN_9 + r2 * DVM_FAST_SIN_11)))));
+}
+static inline float dvm_fast_cosf(float x)
+{
+	return dvm_fast_sinf(x + DVM_FAST_PI_2);
+}
+static inline float dvm_fast_tanf(float x)
+{
+	return dvm_fast_sinf(x) / dvm_fast_cosf(x);
+}
+
+#if defined(DVM_SIMD_SSE)
+static inline dvm_vf dvm_fast_sin_vf(dvm_vf x)
+{
+	const dvm_vf sign_mask = dvm_vf_set1(-0.0f);
+
+	x = dvm_vf_min(dvm_vf_set1(DVM_FAST_MAX_ARG), x);
+	x = dvm_vf_max(dvm_vf_set1(-DVM_FAST_MAX_ARG), x);
+
+	dvm_vf k = dvm_vf_round(dvm_vf_mul(x, dvm_vf_set1(DVM_FAST_INV_2PI)));
+	dvm_vf r = dvm_vf_sub(dvm_vf_sub(x, dvm_vf_mul(k, dvm_vf_set1(DVM_FAST_2PI_HI))), dvm_vf_mul(k, dvm_vf_set1(DVM_FAST_2PI_LO)));
+
+	// Reflect |r| > pi/2 about pi/2, keeping the sign
+
+	dvm_vf sign = dvm_vf_and(r, sign_mask);
+	dvm_vf abs_r = dvm_vf_andnot(sign_mask, r);
+	dvm_vf reflect = dvm_vf_cmpgt(abs_r, dvm_vf_set1(DVM_FAST_PI_2));
+
+	abs_r = dvm_vf_or(
+		dvm_vf_and(reflect, dvm_vf_sub(dvm_vf_set1(DVM_FAST_PI), abs_r)),
+		dvm_vf_andnot(reflect, abs_r));
+
+	r = dvm_vf_or(abs_r, sign);
+
+	dvm_vf r2 = dvm_vf_mul(r, r);
+	dvm_vf p = dvm_vf_set1(DVM_FAST_SIN_11);
+
+	p = dvm_vf_add(dvm_vf_mul(p, r2), dvm_vf_set1(DVM_FAST_SIN_9));
+	p = dvm_vf_add(dvm_vf_mul(p, r2), dvm_vf_set1(DVM_FAST_SIN_7));
+	p = dvm_vf_add(dvm_vf_mul(p, r2), dvm_vf_set1(DVM_FAST_SIN_5));
+	p = dvm_vf_add(dvm_vf_mul(p, r2), dvm_vf_set1(DVM_FAST_SIN_3));
+	p = dvm_vf_add(dvm_vf_mul(p, r2), dvm_vf_set1(1.0f));
+
+	return dvm_vf_mul(p, r);
+}
+static inline dvm_vf dvm_fast_cos_vf(dvm_vf x)
+{
+	return dvm_fast_sin_vf(dvm_vf_add(x, dvm_vf_set1(DVM_FAST_PI_2)));
+}
+#endif
+
+#endif
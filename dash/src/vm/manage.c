@@ -5,10 +5,13 @@
 #include <string.h>
 #include <stdio.h>
 #include <math.h>
+#include <time.h>
 
 // stdlib
 
 int dvm_create_stdlib(dvm_context *context);
+int dvm_create_array_stdlib(dvm_context *context);
+int dvm_create_string_stdlib(dvm_context *context);
 
 // interface
 
@@ -18,12 +21,48 @@ int		dvm_create_context(dvm_context **context, size_t initial_function_capacity,
 
 	if (result == NULL)
 		return 0;
+
+	result->native_capacity = 0;
+	result->native_count = 0;
+	result->native = NULL;
+
+	result->global_capacity = 0;
+	result->global_count = 0;
+	result->globals = NULL;
+
+	result->arrays = NULL;
+	result->script_arrays = NULL;
+	result->script_array_bytes = 0;
+	result->script_array_limit = DVM_ARRAY_COLLECT_BYTES;
+	result->array_mark_capacity = 0;
+	result->array_mark_count = 0;
+	result->array_marks = NULL;
+	result->executions = NULL;
+
+	result->string_capacity = 0;
+	result->string_count = 0;
+	result->strings = NULL;
+	result->string_bucket_count = 0;
+	result->string_buckets = NULL;
+
+	memset(&result->cache, 0, sizeof(result->cache));
+
+	result->exec_timing = 0;
+	memset(&result->exec_stats, 0, sizeof(result->exec_stats));
+
+	result->import_timing = 0;
+	memset(&result->import_stats, 0, sizeof(result->import_stats));
+
+	memset(&result->exec_trace, 0, sizeof(result->exec_trace));
+	memset(&result->profile, 0, sizeof(result->profile));
+	memset(&result->perf, 0, sizeof(result->perf));
 	
 	result->function_capacity = initial_function_capacity + 7;
 	result->function_count = 0;
 	result->function = (dvm_procedure *)malloc(sizeof(dvm_procedure) * result->function_capacity);
+	result->call_targets = (dvm_call_target *)malloc(sizeof(dvm_call_target) * result->function_capacity);
 
-	if (result->function == NULL)
+	if (result->function == NULL || result->call_targets == NULL)
 	{
 		dvm_destroy_context(result);
 		return 0;
@@ -51,6 +90,33 @@ int		dvm_create_context(dvm_context **context, size_t initial_function_capacity,
 }
 void	dvm_destroy_context(dvm_context *context)
 {
+	if (context->cache.directory != NULL)
+	{
+		free(context->cache.directory);
+		context->cache.directory = NULL;
+	}
+	dvm_destroy_arrays(context);
+	dvm_destroy_strings(context);
+
+	free(context->exec_trace.records);
+	dvm_destroy_profile(context);
+	dvm_destroy_perf(context);
+
+	if (context->native != NULL)
+	{
+		for (uint32_t i = 0; i < context->native_count; ++i)
+		{
+			free(context->native[i].name);
+		}
+
+		free(context->native);
+		context->native = NULL;
+	}
+	if (context->globals != NULL)
+	{
+		free(context->globals);
+		context->globals = NULL;
+	}
 	if (context->bytecode != NULL)
 	{
 		free(context->bytecode);
@@ -61,6 +127,7 @@ void	dvm_destroy_context(dvm_context *context)
 		free(context->function);
 		context->function = NULL;
 	}
+	free(context->call_targets);
 	free(context);
 }
 
@@ -79,10 +146,33 @@ dvm_procedure	*dvm_find_proc(const char *name, size_t in_registers, size_t out_r
 	return NULL;
 }
 
+void dvm_enable_exec_timing(int enabled, dvm_context *context)
+{
+	context->exec_timing = enabled;
+}
+
+void dvm_get_exec_stats(struct dvm_exec_stats *stats, dvm_context *context)
+{
+	*stats = context->exec_stats;
+}
+
+void dvm_enable_import_stats(int enabled, dvm_context *context)
+{
+	context->import_timing = enabled;
+}
+
+void dvm_get_import_stats(struct dvm_import_stats *stats, dvm_context *context)
+{
+	*stats = context->import_stats;
+}
+
 void			 dvm_dissasm_module(FILE *out, struct dvm_context *context)
 {
-	for (uint32_t i = 7; i < context->function_count; ++i)
+	for (uint32_t i = 0; i < context->function_count; ++i)
 	{
+		if (context->function[i].c_function != NULL)
+			continue;
+
 		dvm_dissasm_proc(&context->function[i], out, context);
 		printf("\n");
 	}
@@ -102,145 +192,471 @@ void			 dvm_dissasm_proc(dvm_procedure *function, FILE *out, dvm_context *contex
 
 	while (cur_pc < function->bytecode_end)
 	{
-		dvm_bc bc = context->bytecode[cur_pc];
+		cur_pc = dvm_dissasm_instruction(cur_pc, out, context);
+	}
+}
 
-		switch (bc.opcode)
-		{
-		case dvm_opcode_nop:
-			fprintf(out, "nop\n");
-			break;
+// Prints one instruction and returns the pc of the next, past any immediates
 
-		case dvm_opcode_call:
-			fprintf(out, "call  func[%u] r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+size_t			 dvm_dissasm_instruction(size_t cur_pc, FILE *out, dvm_context *context)
+{
+	dvm_bc bc = context->bytecode[cur_pc];
 
-		case dvm_opcode_ret:
-			fprintf(out, "ret   o%u\n", bc.a);
-			break;
+	switch (bc.opcode)
+	{
+	case dvm_opcode_nop:
+		fprintf(out, "nop\n");
+		break;
 
-		case dvm_opcode_mov:
-			fprintf(out, "mov   r%u -> r%u\n", bc.a, bc.c);
-			break;
+	case dvm_opcode_call:
+		fprintf(out, "call  func[%u] r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
 
-		case dvm_opcode_stor:
-			++cur_pc;
-			fprintf(out, "stor  %i or %f -> r%u\n",
-				*(int32_t *)(&context->bytecode[cur_pc]),
-				*(float *)(&context->bytecode[cur_pc]),
-				bc.c);
-			break;
+	case dvm_opcode_callr:
+		fprintf(out, "callr func[%u] r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
 
-		case dvm_opcode_and:
-			fprintf(out, "and  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_calln:
+		fprintf(out, "calln func[%u] r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
 
-		case dvm_opcode_or:
-			fprintf(out, "or  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_ret:
+		fprintf(out, "ret   o%u\n", bc.a);
+		break;
 
-		case dvm_opcode_not:
-			fprintf(out, "not  r%u -> r%u\n", bc.a, bc.c);
-			break;
-			
-		case dvm_opcode_cmpi_e:
-			fprintf(out, "cmpi  r%u = r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_yield:
+		fprintf(out, "yield\n");
+		break;
 
-		case dvm_opcode_cmpf_e:
-			fprintf(out, "cmpi  r%u = r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_mov:
+		fprintf(out, "mov   r%u -> r%u\n", bc.a, bc.c);
+		break;
 
-		case dvm_opcode_cmpi_l:
-			fprintf(out, "cmpi  r%u < r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_movn:
+		fprintf(out, "movn  r%u..r%u -> r%u\n", bc.a, bc.a + bc.b - 1, bc.c);
+		break;
 
-		case dvm_opcode_cmpf_l:
-			fprintf(out, "cmpf  r%u < r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_stor:
+		++cur_pc;
+		fprintf(out, "stor  %i or %f -> r%u\n",
+			*(int32_t *)(&context->bytecode[cur_pc]),
+			*(float *)(&context->bytecode[cur_pc]),
+			bc.c);
+		break;
+
+	case dvm_opcode_gload:
+		fprintf(out, "gload g%u -> r%u\n", dvm_bc_global_index(bc), bc.c);
+		break;
+
+	case dvm_opcode_gstor:
+		fprintf(out, "gstor r%u -> g%u\n", bc.c, dvm_bc_global_index(bc));
+		break;
+
+	case dvm_opcode_and:
+		fprintf(out, "and  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_or:
+		fprintf(out, "or  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_not:
+		fprintf(out, "not  r%u -> r%u\n", bc.a, bc.c);
+		break;
+		
+	case dvm_opcode_cmpi_e:
+		fprintf(out, "cmpi  r%u = r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_cmpf_e:
+		fprintf(out, "cmpi  r%u = r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_cmpi_l:
+		fprintf(out, "cmpi  r%u < r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_cmpf_l:
+		fprintf(out, "cmpf  r%u < r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_cmpi_le:
+		fprintf(out, "cmpi  r%u <= r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_cmpf_le:
+		fprintf(out, "cmpf  r%u <= r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_jmp_c:
+	{
+		uint8_t offset = bc.c;
 
-		case dvm_opcode_cmpi_le:
-			fprintf(out, "cmpi  r%u <= r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+		fprintf(out, "jmpc  r%u %i\n", bc.a, *(int8_t *)&offset);
+		break;
+	}
 
-		case dvm_opcode_cmpf_le:
-			fprintf(out, "cmpf  r%u <= r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_jmp_cn:
+	{
+		uint8_t offset = bc.c;
 
-		case dvm_opcode_jmp_c:
-		{
-			uint8_t offset = bc.c;
+		fprintf(out, "jmpcn r%u %i\n", bc.a, *(int8_t *)&offset);
+		break;
+	}
 
-			fprintf(out, "jmpc  r%u %i\n", bc.a, *(int8_t *)&offset);
-			break;
-		}
+	case dvm_opcode_jmp_u:
+	{
+		uint8_t offset = bc.c;
 
-		case dvm_opcode_jmp_cn:
-		{
-			uint8_t offset = bc.c;
+		fprintf(out, "jmpu  %i\n", *(int8_t *)&offset);
+		break;
+	}
 
-			fprintf(out, "jmpcn r%u %i\n", bc.a, *(int8_t *)&offset);
-			break;
-		}
+	case dvm_opcode_jmp_l:
+		++cur_pc;
+		fprintf(out, "jmpl  %i\n", *(int32_t *)(&context->bytecode[cur_pc]));
+		break;
 
-		case dvm_opcode_jmp_u:
-		{
-			uint8_t offset = bc.c;
+	case dvm_opcode_jmp_t:
+	{
+		fprintf(out, "jmpt  r%u [%u] default %i\n", bc.a, bc.b, *(int32_t *)(&context->bytecode[cur_pc + 1]));
 
-			fprintf(out, "jmpu  %i\n", *(int8_t *)&offset);
-			break;
-		}
+		for (uint32_t i = 0; i < bc.b; ++i)
+			fprintf(out, "      %u: %i\n", i, *(int32_t *)(&context->bytecode[cur_pc + 2 + i]));
 
-		case dvm_opcode_addi:
-			fprintf(out, "addi  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+		cur_pc += bc.b + 1;
+		break;
+	}
 
-		case dvm_opcode_addf:
-			fprintf(out, "addf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_inci:
+		fprintf(out, "inci  r%u\n", bc.a);
+		break;
 
-		case dvm_opcode_subi:
-			fprintf(out, "subi  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_loop:
+	{
+		uint8_t offset = bc.c;
 
-		case dvm_opcode_subf:
-			fprintf(out, "subf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+		fprintf(out, "loop  ++r%u < r%u %i\n", bc.a, bc.b, *(int8_t *)&offset);
+		break;
+	}
 
-		case dvm_opcode_muli:
-			fprintf(out, "muli  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_select:
+		fprintf(out, "sel   r%u ? r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
 
-		case dvm_opcode_mulf:
-			fprintf(out, "mulf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_addi:
+		fprintf(out, "addi  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
 
-		case dvm_opcode_divi:
-			fprintf(out, "divi  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_addf:
+		fprintf(out, "addf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
 
-		case dvm_opcode_divf:
-			fprintf(out, "divf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
-			break;
+	case dvm_opcode_subi:
+		fprintf(out, "subi  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
 
-		case dvm_opcode_casti:
-			fprintf(out, "casti r%u -> r%u\n", bc.a, bc.c);
-			break;
+	case dvm_opcode_subf:
+		fprintf(out, "subf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
 
-		case dvm_opcode_castf:
-			fprintf(out, "castf r%u -> r%u\n", bc.a, bc.c);
-			break;
+	case dvm_opcode_muli:
+		fprintf(out, "muli  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
 
-		default:
-			fprintf(out, "unknown instruction\n");
-			break;
-		}
+	case dvm_opcode_mulf:
+		fprintf(out, "mulf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
 
-		++cur_pc;
+	case dvm_opcode_divi:
+		fprintf(out, "divi  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_divf:
+		fprintf(out, "divf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_modi:
+		fprintf(out, "modi  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_shli:
+		fprintf(out, "shli  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_shri:
+		fprintf(out, "shri  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_bandi:
+		fprintf(out, "bandi r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_bori:
+		fprintf(out, "bori  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_bxori:
+		fprintf(out, "bxori r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_casti:
+		fprintf(out, "casti r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_castf:
+		fprintf(out, "castf r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_storl:
+	{
+		int64_t immediate;
+		double immediate_double;
+
+		memcpy(&immediate, &context->bytecode[cur_pc + 1], sizeof(immediate));
+		memcpy(&immediate_double, &context->bytecode[cur_pc + 1], sizeof(immediate_double));
+		cur_pc += 2;
+
+		fprintf(out, "storl %lld or %f -> r%u\n", (long long)immediate, immediate_double, bc.c);
+		break;
+	}
+
+	case dvm_opcode_cmpl_e:
+		fprintf(out, "cmpl  r%u = r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_cmpd_e:
+		fprintf(out, "cmpd  r%u = r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_cmpl_l:
+		fprintf(out, "cmpl  r%u < r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_cmpd_l:
+		fprintf(out, "cmpd  r%u < r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_cmpl_le:
+		fprintf(out, "cmpl  r%u <= r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_cmpd_le:
+		fprintf(out, "cmpd  r%u <= r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_addl:
+		fprintf(out, "addl  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_addd:
+		fprintf(out, "addd  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_subl:
+		fprintf(out, "subl  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_subd:
+		fprintf(out, "subd  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_mull:
+		fprintf(out, "mull  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_muld:
+		fprintf(out, "muld  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_divl:
+		fprintf(out, "divl  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_divd:
+		fprintf(out, "divd  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_modl:
+		fprintf(out, "modl  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_shll:
+		fprintf(out, "shll  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_shrl:
+		fprintf(out, "shrl  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_bandl:
+		fprintf(out, "bandl r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_borl:
+		fprintf(out, "borl  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_bxorl:
+		fprintf(out, "bxorl r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_castil:
+		fprintf(out, "castil r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_castli:
+		fprintf(out, "castli r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_castfd:
+		fprintf(out, "castfd r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_castdf:
+		fprintf(out, "castdf r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_castld:
+		fprintf(out, "castld r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_castdl:
+		fprintf(out, "castdl r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_castfl:
+		fprintf(out, "castfl r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_castlf:
+		fprintf(out, "castlf r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_castid:
+		fprintf(out, "castid r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_castdi:
+		fprintf(out, "castdi r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_anew:
+		fprintf(out, "anew  %s[r%u] -> r%u\n", bc.b == dvm_type_integer ? "i" : "f", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_alen:
+		fprintf(out, "alen  r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_aload:
+		fprintf(out, "aload r%u[r%u] -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_astor:
+		fprintf(out, "astor r%u -> r%u[r%u]\n", bc.c, bc.a, bc.b);
+		break;
+
+	case dvm_opcode_sload:
+	{
+		uint32_t index = dvm_bc_string_index(bc);
+
+		fprintf(out, "sload s%u \"%s\" -> r%u\n", index, index < context->string_count ? context->strings[index]->text : "", bc.c);
+		break;
 	}
+
+	case dvm_opcode_cmps_e:
+		fprintf(out, "cmps  r%u = r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_shash:
+		fprintf(out, "shash r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_slen:
+		fprintf(out, "slen  r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_sqrtf:
+		fprintf(out, "sqrtf r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_sinf:
+		fprintf(out, "sinf  r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_cosf:
+		fprintf(out, "cosf  r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_tanf:
+		fprintf(out, "tanf  r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_floorf:
+		fprintf(out, "floorf r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_absi:
+		fprintf(out, "absi  r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_absf:
+		fprintf(out, "absf  r%u -> r%u\n", bc.a, bc.c);
+		break;
+
+	case dvm_opcode_powf:
+		fprintf(out, "powf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_mini:
+		fprintf(out, "mini  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_minf:
+		fprintf(out, "minf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_maxi:
+		fprintf(out, "maxi  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_maxf:
+		fprintf(out, "maxf  r%u, r%u -> r%u\n", bc.a, bc.b, bc.c);
+		break;
+
+	case dvm_opcode_fmaf:
+		fprintf(out, "fmaf  r%u, r%u + r%u -> r%u\n", bc.a, bc.b, bc.c, bc.c);
+		break;
+
+	default:
+		fprintf(out, "unknown instruction\n");
+		break;
+	}
+
+	return cur_pc + 1;
 }
 
 // memory management
 
+double dvm_now()
+{
+	struct timespec now;
+
+	timespec_get(&now, TIME_UTC);
+
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static void dvm_context_count_growth(double growth_start, dvm_context *context)
+{
+	if (context->import_timing)
+	{
+		context->import_stats.growth_time += dvm_now() - growth_start;
+		++context->import_stats.growths;
+	}
+}
+
 dvm_bc			*dvm_context_push_bytecode(size_t amount, dvm_context *context)
 {
 	if (context == NULL || context->bytecode == NULL)
@@ -250,7 +666,14 @@ dvm_bc			*dvm_context_push_bytecode(size_t amount, dvm_context *context)
 
 	if (context->bytecode_count + amount > context->bytecode_capacity)
 	{
-		size_t new_bc_capacity = context->bytecode_count + (amount * 2);
+		double growth_start = context->import_timing ? dvm_now() : 0.0;
+
+		// Grow geometrically, so that emitting one at a time stays linear
+
+		size_t new_bc_capacity = context->bytecode_capacity * 2;
+
+		if (new_bc_capacity < context->bytecode_count + amount)
+			new_bc_capacity = context->bytecode_count + amount;
 
 		dvm_bc *new_bc = (dvm_bc *)malloc(sizeof(dvm_bc) * new_bc_capacity);
 
@@ -260,9 +683,12 @@ dvm_bc			*dvm_context_push_bytecode(size_t amount, dvm_context *context)
 		}
 
 		memcpy(new_bc, context->bytecode, sizeof(dvm_bc) * context->bytecode_count);
+		free(context->bytecode);
 
 		context->bytecode_capacity = new_bc_capacity;
 		context->bytecode = new_bc;
+
+		dvm_context_count_growth(growth_start, context);
 	}
 
 	dvm_bc *old_top = context->bytecode + context->bytecode_count;
@@ -281,19 +707,35 @@ dvm_procedure	*dvm_context_push_procedure(size_t amount, dvm_context *context)
 
 	if (context->function_count + amount > context->function_capacity)
 	{
-		size_t new_func_capacity = context->function_count + (amount * 2);
+		double growth_start = context->import_timing ? dvm_now() : 0.0;
+
+		// Grow geometrically, so that emitting one at a time stays linear
+
+		size_t new_func_capacity = context->function_capacity * 2;
+
+		if (new_func_capacity < context->function_count + amount)
+			new_func_capacity = context->function_count + amount;
 
 		dvm_procedure *new_func = (dvm_procedure *)malloc(sizeof(dvm_procedure) * new_func_capacity);
+		dvm_call_target *new_targets = (dvm_call_target *)malloc(sizeof(dvm_call_target) * new_func_capacity);
 
-		if (new_func == NULL)
+		if (new_func == NULL || new_targets == NULL)
 		{
+			free(new_targets);
+			free(new_func);
 			return NULL;
 		}
 
 		memcpy(new_func, context->function, sizeof(dvm_procedure) * context->function_count);
+		memcpy(new_targets, context->call_targets, sizeof(dvm_call_target) * context->function_count);
+		free(context->function);
+		free(context->call_targets);
 
 		context->function_capacity = new_func_capacity;
 		context->function = new_func;
+		context->call_targets = new_targets;
+
+		dvm_context_count_growth(growth_start, context);
 	}
 
 	dvm_procedure *old_top = context->function + context->function_count;
@@ -304,6 +746,51 @@ dvm_procedure	*dvm_context_push_procedure(size_t amount, dvm_context *context)
 	return old_top;
 }
 
+dvm_var			*dvm_context_push_globals(size_t amount, dvm_context *context)
+{
+	if (context == NULL || context->global_count + amount > DVM_MAX_GLOBALS)
+	{
+		return NULL;
+	}
+
+	if (context->global_count + amount > context->global_capacity)
+	{
+		double growth_start = context->import_timing ? dvm_now() : 0.0;
+
+		// Grow geometrically, so that emitting one at a time stays linear
+
+		size_t new_global_capacity = context->global_capacity == 0 ? 16 : context->global_capacity * 2;
+
+		if (new_global_capacity < context->global_count + amount)
+			new_global_capacity = context->global_count + amount;
+
+		dvm_var *new_globals = (dvm_var *)malloc(sizeof(dvm_var) * new_global_capacity);
+
+		if (new_globals == NULL)
+		{
+			return NULL;
+		}
+
+		if (context->globals != NULL)
+		{
+			memcpy(new_globals, context->globals, sizeof(dvm_var) * context->global_count);
+			free(context->globals);
+		}
+
+		context->global_capacity = (uint32_t)new_global_capacity;
+		context->globals = new_globals;
+
+		dvm_context_count_growth(growth_start, context);
+	}
+
+	dvm_var *old_top = context->globals + context->global_count;
+	context->global_count += (uint32_t)amount;
+
+	memset(old_top, 0, sizeof(dvm_var) * amount);
+
+	return old_top;
+}
+
 void dvm_context_pop_bytecode(size_t amount, dvm_context *context)
 {
 	if (context == NULL || context->bytecode == NULL)
@@ -337,8 +824,293 @@ void dvm_context_pop_procedure(size_t amount, dvm_context *context)
 	}
 }
 
+void dvm_context_pop_globals(size_t amount, dvm_context *context)
+{
+	if (context == NULL || context->globals == NULL)
+	{
+		return;
+	}
+
+	if (amount <= context->global_count)
+	{
+		context->global_count -= amount;
+	}
+	else
+	{
+		context->global_count = 0;
+	}
+}
+
+// Checks the control flow of a procedure before it can run, every instruction's immediates are inside it
+// and every jump, including each jmpt entry, lands on the start of one of its instructions.
+// A jump can also land just past the end, the codegen leaves those behind a ret and exec reports them if they're taken.
+// Calls, linked or not, have to start their parameters and results inside the frame and a ret has to fit its results in it,
+// the same as exec checks when they're run.
+
+static int dvm_validate_jump(uint32_t pc, int64_t offset, uint32_t code_length, const uint8_t *starts)
+{
+	int64_t target = (int64_t)pc + offset;
+
+	if (target < 0 || target > code_length || !starts[target])
+	{
+		fprintf(stderr, "invalid procedure, jmp at %u doesn't land on an instruction.\n", pc);
+		return 0;
+	}
+
+	return 1;
+}
+
 int dvm_context_validate_proc(uint32_t code_start, uint32_t code_length, uint8_t reg_count_in, uint8_t reg_count_use, uint8_t reg_count_out, dvm_context *context)
 {
+	if (code_length == 0 || (uint64_t)code_start + code_length > context->bytecode_count)
+	{
+		fprintf(stderr, "invalid procedure, bytecode is out of bounds.\n");
+		return 0;
+	}
+
+	const dvm_bc *code = context->bytecode + code_start;
+	uint8_t *starts = (uint8_t *)calloc(code_length + 1, 1);
+
+	if (starts == NULL)
+	{
+		return 0;
+	}
+
+	int valid = 1;
+	uint32_t frame_size = (uint32_t)reg_count_in + reg_count_use;
+
+	starts[code_length] = 1;
+
+	for (uint32_t pc = 0; pc < code_length && valid; pc += 1 + dvm_bc_immediate_count(code[pc]))
+	{
+		starts[pc] = 1;
+
+		if ((uint64_t)pc + dvm_bc_immediate_count(code[pc]) >= code_length)
+		{
+			fprintf(stderr, "invalid procedure, instruction at %u runs past the end.\n", pc);
+			valid = 0;
+		}
+	}
+
+	for (uint32_t pc = 0; pc < code_length && valid; pc += 1 + dvm_bc_immediate_count(code[pc]))
+	{
+		dvm_bc instruction = code[pc];
+
+		switch (instruction.opcode)
+		{
+		case dvm_opcode_jmp_c:
+		case dvm_opcode_jmp_cn:
+		case dvm_opcode_jmp_u:
+		case dvm_opcode_loop:
+		{
+			uint8_t offset = instruction.c;
+
+			valid = dvm_validate_jump(pc, *(int8_t *)&offset, code_length, starts);
+			break;
+		}
+
+		case dvm_opcode_jmp_l:
+			valid = dvm_validate_jump(pc, *(const int32_t *)(code + pc + 1), code_length, starts);
+			break;
+
+		case dvm_opcode_jmp_t:
+			for (uint32_t slot = 1; slot <= (uint32_t)instruction.b + 1 && valid; ++slot)
+				valid = dvm_validate_jump(pc, *(const int32_t *)(code + pc + slot), code_length, starts);
+			break;
+
+		case dvm_opcode_call:
+		case dvm_opcode_callr:
+		case dvm_opcode_calln:
+			if (instruction.b >= frame_size || instruction.c >= frame_size)
+			{
+				fprintf(stderr, "invalid procedure, call at %u has registers outside the frame.\n", pc);
+				valid = 0;
+			}
+			break;
+
+		case dvm_opcode_ret:
+			// A procedure without results can return from past its frame, like exec allows
+
+			if (reg_count_out > 0 && (uint32_t)instruction.a + reg_count_out > frame_size)
+			{
+				fprintf(stderr, "invalid procedure, ret at %u has results outside the frame.\n", pc);
+				valid = 0;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	free(starts);
+
+	return valid;
+}
+
+// Links the calls of every procedure from function_base on, once every procedure they can call is in the context.
+// A call whose registers fit both its caller's frame and its callee is turned into a callr or calln, which go straight
+// to the callee's target. Anything else is left a call, which checks everything again and fails when it's run.
+//
+// A proof only reads the caller's frame and the callee's target, and both are fixed once a procedure is pushed.
+// Procedures are only ever appended, so later changes to the context don't invalidate linked calls:
+//	- dvm_register_native appends the native and links its target, calls to it can only come from later imports.
+//	- An import, compiled or loaded from the cache, links what it appended, succeeding or not. Images are stored
+//	  unlinked and a load turns any callr or calln in one back into a call before linking, so nothing an image holds
+//	  is trusted.
+//	- Procedures are only popped by a cache load that failed before linking them, so no linked call names an index
+//	  that's reused.
+// Anything that changed a procedure's frame or bytecode in place would have to turn the calls into it back into
+// plain calls and link their procedures again.
+
+void dvm_context_link(uint32_t function_base, dvm_context *context)
+{
+	for (uint32_t i = function_base; i < context->function_count; ++i)
+	{
+		dvm_procedure *function = &context->function[i];
+		dvm_call_target *target = &context->call_targets[i];
+
+		target->c_function = function->c_function;
+		target->bytecode_start = function->bytecode_start;
+		target->frame_size = (uint16_t)(function->reg_count_in + function->reg_count_use);
+		target->reg_count_in = function->reg_count_in;
+		target->reg_count_out = function->reg_count_out;
+	}
+
+	for (uint32_t i = function_base; i < context->function_count; ++i)
+	{
+		dvm_procedure *function = &context->function[i];
+		uint32_t frame_size = function->reg_count_in + function->reg_count_use;
+
+		if (function->c_function != NULL)
+			continue;
+
+		for (uint32_t pc = function->bytecode_start; pc < function->bytecode_end; pc += 1 + dvm_bc_immediate_count(context->bytecode[pc]))
+		{
+			dvm_bc *instruction = &context->bytecode[pc];
+
+			if (instruction->opcode != dvm_opcode_call || instruction->a >= context->function_count)
+				continue;
+
+			dvm_call_target *callee = &context->call_targets[instruction->a];
+
+			if (instruction->b < frame_size && (uint32_t)(instruction->b + callee->reg_count_in) <= frame_size &&
+				instruction->c < frame_size && (uint32_t)(instruction->c + callee->reg_count_out) <= frame_size)
+			{
+				instruction->opcode = callee->c_function != NULL ? dvm_opcode_calln : dvm_opcode_callr;
+			}
+		}
+	}
+}
+
+// natives
+
+int dvm_register_native(const char *name, dvm_native_function function, const enum dvm_type *in_types, size_t in_count, const enum dvm_type *out_types, size_t out_count, dvm_context *context)
+{
+	if (name == NULL || function == NULL || in_count > 0xFF || out_count > 0xFF)
+	{
+		fprintf(stderr, "invalid native function.\n");
+		return 0;
+	}
+
+	for (size_t i = 0; i < in_count; ++i)
+	{
+		if (in_types[i] < dvm_type_real || in_types[i] > dvm_type_string)
+		{
+			fprintf(stderr, "invalid native function parameter type.\n");
+			return 0;
+		}
+	}
+	for (size_t i = 0; i < out_count; ++i)
+	{
+		if (out_types[i] < dvm_type_real || out_types[i] > dvm_type_string)
+		{
+			fprintf(stderr, "invalid native function return type.\n");
+			return 0;
+		}
+	}
+
+	// The call instruction can only reach the first 256 procedures, a native past them could never be called
+
+	if (context->function_count > 0xFF)
+	{
+		fprintf(stderr, "native function '%s' can't be registered, calls can only reach the first 256 procedures. Register natives before importing.\n", name);
+		return 0;
+	}
+
+	// Natives are resolved by name alone, so they can't be overloaded
+
+	for (uint32_t i = 0; i < context->native_count; ++i)
+	{
+		if (strcmp(context->native[i].name, name) == 0)
+		{
+			fprintf(stderr, "native function '%s' is already registered.\n", name);
+			return 0;
+		}
+	}
+
+	if (context->native_count == context->native_capacity)
+	{
+		uint32_t new_capacity = context->native_capacity == 0 ? 8 : context->native_capacity * 2;
+
+		dvm_native *new_native = (dvm_native *)malloc(sizeof(dvm_native) * new_capacity);
+
+		if (new_native == NULL)
+		{
+			return 0;
+		}
+
+		if (context->native != NULL)
+		{
+			memcpy(new_native, context->native, sizeof(dvm_native) * context->native_count);
+			free(context->native);
+		}
+
+		context->native_capacity = new_capacity;
+		context->native = new_native;
+	}
+
+	// The name and the signature share one allocation
+
+	size_t name_length = strlen(name);
+	char *block = (char *)malloc(name_length + 1 + in_count + out_count);
+
+	if (block == NULL)
+	{
+		return 0;
+	}
+
+	dvm_procedure *proc = dvm_context_push_procedure(1, context);
+
+	if (proc == NULL)
+	{
+		free(block);
+		return 0;
+	}
+
+	proc->c_function = function;
+	proc->hashed_name = dsh_hash(name);
+	proc->reg_count_in = (uint8_t)in_count;
+	proc->reg_count_use = 0;
+	proc->reg_count_out = (uint8_t)out_count;
+
+	dvm_context_link((uint32_t)(proc - context->function), context);
+
+	dvm_native *native = &context->native[context->native_count++];
+
+	native->name = block;
+	native->function_index = (uint32_t)(proc - context->function);
+	native->in_count = (uint8_t)in_count;
+	native->out_count = (uint8_t)out_count;
+	native->types = (uint8_t *)block + name_length + 1;
+
+	memcpy(native->name, name, name_length + 1);
+
+	for (size_t i = 0; i < in_count; ++i)
+		native->types[i] = (uint8_t)in_types[i];
+	for (size_t i = 0; i < out_count; ++i)
+		native->types[in_count + i] = (uint8_t)out_types[i];
+
 	return 1;
 }
 
@@ -387,6 +1159,11 @@ dvm_procedure	*dvm_proc_emitter_finalize(const char *name, uint8_t reg_count_in,
 	proc->bytecode_start = procgen->bytecode_start;
 	proc->bytecode_end = procgen->bytecode_start + procgen->bytecode_allocated;
 
+	if (procgen->context->perf.modes != 0)
+	{
+		dvm_perf_name_proc((uint32_t)(proc - procgen->context->function), name, procgen->context);
+	}
+
 	return proc;
 }
 void			 dvm_proc_emitter_cancel(dvm_procedure_emitter *procgen)
@@ -408,6 +1185,14 @@ void dvm_stdlib_print_r(const dvm_var *in, dvm_var *out)
 {
 	fprintf(stdout, "%f\n", in[0].f);
 }
+void dvm_stdlib_print_l(const dvm_var *in, dvm_var *out)
+{
+	fprintf(stdout, "%lld\n", (long long)in[0].l);
+}
+void dvm_stdlib_print_d(const dvm_var *in, dvm_var *out)
+{
+	fprintf(stdout, "%.15g\n", in[0].d);
+}
 void dvm_stdlib_sin(const dvm_var *in, dvm_var *out)
 {
 	out[0].f = (float)sin(in[0].f);
@@ -427,47 +1212,22 @@ void dvm_stdlib_pow(const dvm_var *in, dvm_var *out)
 
 int dvm_create_stdlib(dvm_context *context)
 {
-	dvm_procedure *stdlib = dvm_context_push_procedure(7, context);
-
-	if (stdlib == NULL)
-	{
-		return 0;
-	}
-
-	stdlib[0].c_function = dvm_stdlib_print_c;
-	stdlib[0].reg_count_in = 1;
-	stdlib[0].reg_count_use = 0;
-	stdlib[0].reg_count_out = 0;
-
-	stdlib[1].c_function = dvm_stdlib_print_i;
-	stdlib[1].reg_count_in = 1;
-	stdlib[1].reg_count_use = 0;
-	stdlib[1].reg_count_out = 0;
-
-	stdlib[2].c_function = dvm_stdlib_print_r;
-	stdlib[2].reg_count_in = 1;
-	stdlib[2].reg_count_use = 0;
-	stdlib[2].reg_count_out = 0;
-
-	stdlib[3].c_function = dvm_stdlib_sin;
-	stdlib[3].reg_count_in = 1;
-	stdlib[3].reg_count_use = 0;
-	stdlib[3].reg_count_out = 1;
-
-	stdlib[4].c_function = dvm_stdlib_cos;
-	stdlib[4].reg_count_in = 1;
-	stdlib[4].reg_count_use = 0;
-	stdlib[4].reg_count_out = 1;
-
-	stdlib[5].c_function = dvm_stdlib_tan;
-	stdlib[5].reg_count_in = 1;
-	stdlib[5].reg_count_use = 0;
-	stdlib[5].reg_count_out = 1;
-
-	stdlib[6].c_function = dvm_stdlib_pow;
-	stdlib[6].reg_count_in = 2;
-	stdlib[6].reg_count_use = 0;
-	stdlib[6].reg_count_out = 1;
-
-	return 1;
-}
\ No newline at end of file
+	const enum dvm_type integer[] = { dvm_type_integer };
+	const enum dvm_type real[] = { dvm_type_real };
+	const enum dvm_type real_real[] = { dvm_type_real, dvm_type_real };
+	const enum dvm_type long_integer[] = { dvm_type_long };
+	const enum dvm_type double_real[] = { dvm_type_double };
+
+	return
+		dvm_register_native("print_c", dvm_stdlib_print_c, integer, 1, NULL, 0, context) &&
+		dvm_register_native("print_i", dvm_stdlib_print_i, integer, 1, NULL, 0, context) &&
+		dvm_register_native("print_r", dvm_stdlib_print_r, real, 1, NULL, 0, context) &&
+		dvm_register_native("print_l", dvm_stdlib_print_l, long_integer, 1, NULL, 0, context) &&
+		dvm_register_native("print_d", dvm_stdlib_print_d, double_real, 1, NULL, 0, context) &&
+		dvm_register_native("sin", dvm_stdlib_sin, real, 1, real, 1, context) &&
+		dvm_register_native("cos", dvm_stdlib_cos, real, 1, real, 1, context) &&
+		dvm_register_native("tan", dvm_stdlib_tan, real, 1, real, 1, context) &&
+		dvm_register_native("pow", dvm_stdlib_pow, real_real, 2, real, 1, context) &&
+		dvm_create_array_stdlib(context) &&
+		dvm_create_string_stdlib(context);
+}
@@ -131,9 +131,9 @@ int dvm_import_module(const char *module_filename, dvm_context *context)
 	{
 		dvm_bc *current = &context->bytecode[i];
 
-		if (current->opcode == dvm_opcode_stor)
+		if (dvm_bc_immediate_count(*current) != 0)
 		{
-			++i;
+			i += dvm_bc_immediate_count(*current);
 		}
 		else if (current->opcode == dvm_opcode_call)
 		{
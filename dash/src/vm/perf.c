@@ -0,0 +1,433 @@
+#include "../vm_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// Trampolines are generated x86-64 code and the files are where perf looks for them, so it's only on linux
+
+#if defined(__linux__) && defined(__x86_64__)
+	#define DVM_PERF_SUPPORTED
+#endif
+
+#if defined(DVM_PERF_SUPPORTED)
+
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#define DVM_PERF_PAGE_SIZE 4096
+
+// Every page starts with a link to the page before it, trampolines are laid out after it in fixed slots
+
+#define DVM_PERF_PAGE_HEADER 32
+#define DVM_PERF_SLOT_SIZE 32
+
+// push rbp; mov rbp, rsp; movabs rax, target; call rax; pop rbp; ret
+// The arguments and the result pass straight through, the frame is only there for the unwinder to find.
+
+static const uint8_t dvm_perf_stub[] =
+{
+	0x55,
+	0x48, 0x89, 0xe5,
+	0x48, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0,
+	0xff, 0xd0,
+	0x5d,
+	0xc3,
+};
+
+#define DVM_PERF_STUB_TARGET 6
+
+// jitdump, as described in tools/perf/Documentation/jitdump-specification.txt
+
+#define DVM_JITDUMP_MAGIC 0x4A695444u
+#define DVM_JITDUMP_VERSION 1
+#define DVM_JITDUMP_EM_X86_64 62
+
+enum dvm_jitdump_record
+{
+	dvm_jitdump_code_load = 0,
+	dvm_jitdump_code_close = 3,
+};
+
+struct dvm_jitdump_header
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t total_size;
+	uint32_t elf_mach;
+	uint32_t pad1;
+	uint32_t pid;
+	uint64_t timestamp;
+	uint64_t flags;
+};
+
+struct dvm_jitdump_record_header
+{
+	uint32_t id;
+	uint32_t total_size;
+	uint64_t timestamp;
+};
+
+struct dvm_jitdump_code_load
+{
+	struct dvm_jitdump_record_header header;
+
+	uint32_t pid;
+	uint32_t tid;
+	uint64_t vma;
+	uint64_t code_addr;
+	uint64_t code_size;
+	uint64_t code_index;
+};
+
+// perf inject matches the records against the samples by the monotonic clock
+
+static uint64_t dvm_perf_timestamp()
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (uint64_t)now.tv_sec * 1000000000ull + (uint64_t)now.tv_nsec;
+}
+
+static int dvm_perf_open_map(dvm_perf *perf)
+{
+	char filename[64];
+
+	snprintf(filename, sizeof(filename), "/tmp/perf-%d.map", (int)getpid());
+
+	perf->map = fopen(filename, "w");
+
+	if (perf->map == NULL)
+	{
+		fprintf(stderr, "couldn't open %s.\n", filename);
+		return 0;
+	}
+
+	return 1;
+}
+
+// perf record only notices a jitdump when the process maps it executable, the mapping is otherwise unused
+
+static int dvm_perf_open_jitdump(dvm_perf *perf)
+{
+	char filename[64];
+
+	snprintf(filename, sizeof(filename), "/tmp/jit-%d.dump", (int)getpid());
+
+	int fd = open(filename, O_CREAT | O_TRUNC | O_RDWR, 0666);
+
+	if (fd < 0)
+	{
+		fprintf(stderr, "couldn't open %s.\n", filename);
+		return 0;
+	}
+
+	perf->jitdump_marker = mmap(NULL, DVM_PERF_PAGE_SIZE, PROT_READ | PROT_EXEC, MAP_PRIVATE, fd, 0);
+
+	if (perf->jitdump_marker == MAP_FAILED)
+	{
+		perf->jitdump_marker = NULL;
+	}
+
+	perf->jitdump = fdopen(fd, "w+");
+
+	if (perf->jitdump == NULL)
+	{
+		close(fd);
+
+		fprintf(stderr, "couldn't open %s.\n", filename);
+		return 0;
+	}
+
+	struct dvm_jitdump_header header;
+
+	memset(&header, 0, sizeof(header));
+
+	header.magic = DVM_JITDUMP_MAGIC;
+	header.version = DVM_JITDUMP_VERSION;
+	header.total_size = sizeof(header);
+	header.elf_mach = DVM_JITDUMP_EM_X86_64;
+	header.pid = (uint32_t)getpid();
+	header.timestamp = dvm_perf_timestamp();
+
+	fwrite(&header, sizeof(header), 1, perf->jitdump);
+	fflush(perf->jitdump);
+
+	return 1;
+}
+
+static void dvm_perf_write_code_load(const char *name, const void *code, size_t code_size, dvm_perf *perf)
+{
+	struct dvm_jitdump_code_load record;
+
+	size_t name_size = strlen(name) + 1;
+
+	record.header.id = dvm_jitdump_code_load;
+	record.header.total_size = (uint32_t)(sizeof(record) + name_size + code_size);
+	record.header.timestamp = dvm_perf_timestamp();
+
+	record.pid = (uint32_t)getpid();
+	record.tid = (uint32_t)syscall(SYS_gettid);
+	record.vma = (uint64_t)(uintptr_t)code;
+	record.code_addr = (uint64_t)(uintptr_t)code;
+	record.code_size = code_size;
+	record.code_index = perf->code_index++;
+
+	fwrite(&record, sizeof(record), 1, perf->jitdump);
+	fwrite(name, name_size, 1, perf->jitdump);
+	fwrite(code, code_size, 1, perf->jitdump);
+	fflush(perf->jitdump);
+}
+
+// Hands out the next slot, starting a new page when the current one is full. Pages are only writable while a stub is copied in.
+
+static uint8_t *dvm_perf_alloc_slot(dvm_perf *perf)
+{
+	if (perf->page == NULL || perf->page_used + DVM_PERF_SLOT_SIZE > DVM_PERF_PAGE_SIZE)
+	{
+		void *page = mmap(NULL, DVM_PERF_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+		if (page == MAP_FAILED)
+		{
+			return NULL;
+		}
+
+		*(void **)page = perf->page;
+
+		perf->page = (uint8_t *)page;
+		perf->page_used = DVM_PERF_PAGE_HEADER;
+	}
+	else if (mprotect(perf->page, DVM_PERF_PAGE_SIZE, PROT_READ | PROT_WRITE) != 0)
+	{
+		return NULL;
+	}
+
+	uint8_t *slot = perf->page + perf->page_used;
+
+	perf->page_used += DVM_PERF_SLOT_SIZE;
+
+	return slot;
+}
+
+#endif
+
+static int dvm_perf_reserve(uint32_t count, dvm_perf *perf)
+{
+	if (count <= perf->proc_capacity)
+	{
+		return 1;
+	}
+
+	uint32_t new_capacity = perf->proc_capacity == 0 ? 64 : perf->proc_capacity;
+
+	while (new_capacity < count)
+	{
+		new_capacity *= 2;
+	}
+
+	char **new_names = (char **)calloc(new_capacity, sizeof(char *));
+	void **new_trampolines = (void **)calloc(new_capacity, sizeof(void *));
+
+	if (new_names == NULL || new_trampolines == NULL)
+	{
+		free(new_trampolines);
+		free(new_names);
+		return 0;
+	}
+
+	if (perf->proc_capacity > 0)
+	{
+		memcpy(new_names, perf->names, sizeof(char *) * perf->proc_capacity);
+		memcpy(new_trampolines, perf->trampolines, sizeof(void *) * perf->proc_capacity);
+	}
+
+	free(perf->names);
+	free(perf->trampolines);
+
+	perf->proc_capacity = new_capacity;
+	perf->names = new_names;
+	perf->trampolines = new_trampolines;
+
+	return 1;
+}
+
+int dvm_enable_perf(int modes, dvm_context *context)
+{
+	dvm_perf *perf = &context->perf;
+
+#if defined(DVM_PERF_SUPPORTED)
+
+	// Trampolines already handed out stay valid, turning a mode off only stops new ones being written down
+
+	if ((modes & dvm_perf_map) && perf->map == NULL && !dvm_perf_open_map(perf))
+	{
+		return 0;
+	}
+
+	if ((modes & dvm_perf_jitdump) && perf->jitdump == NULL && !dvm_perf_open_jitdump(perf))
+	{
+		return 0;
+	}
+
+	perf->modes = modes;
+
+	return 1;
+
+#else
+
+	if (modes != 0)
+	{
+		fprintf(stderr, "perf maps aren't supported on this platform.\n");
+		return 0;
+	}
+
+	perf->modes = 0;
+
+	return 1;
+
+#endif
+}
+
+// Procedures only keep the hash of their name, so the names are kept here while a profiler is attached
+
+void dvm_perf_name_proc(uint32_t index, const char *name, dvm_context *context)
+{
+	dvm_perf *perf = &context->perf;
+
+	if (!dvm_perf_reserve(index + 1, perf))
+	{
+		return;
+	}
+
+	free(perf->names[index]);
+
+	perf->names[index] = (char *)malloc(strlen(name) + 1);
+
+	if (perf->names[index] != NULL)
+	{
+		strcpy(perf->names[index], name);
+	}
+}
+
+dvm_perf_entry dvm_perf_trampoline(uint32_t index, dvm_perf_entry target, dvm_context *context)
+{
+#if defined(DVM_PERF_SUPPORTED)
+
+	dvm_perf *perf = &context->perf;
+
+	if (!dvm_perf_reserve(index + 1, perf))
+	{
+		return target;
+	}
+
+	if (perf->trampolines[index] != NULL)
+	{
+		return (dvm_perf_entry)perf->trampolines[index];
+	}
+
+	uint8_t *slot = dvm_perf_alloc_slot(perf);
+
+	if (slot == NULL)
+	{
+		return target;
+	}
+
+	memcpy(slot, dvm_perf_stub, sizeof(dvm_perf_stub));
+	memcpy(slot + DVM_PERF_STUB_TARGET, &target, sizeof(void *));
+
+	if (mprotect(perf->page, DVM_PERF_PAGE_SIZE, PROT_READ | PROT_EXEC) != 0)
+	{
+		return target;
+	}
+
+	perf->trampolines[index] = slot;
+
+	// Procedures the context didn't see the names of, like those from the cache, are named by their index
+
+	char fallback_name[32];
+	const char *name = perf->names[index];
+
+	if (name == NULL)
+	{
+		snprintf(fallback_name, sizeof(fallback_name), "func[%u]", index);
+		name = fallback_name;
+	}
+
+	char symbol[256];
+
+	snprintf(symbol, sizeof(symbol), "dash::%s", name);
+
+	if ((perf->modes & dvm_perf_map) && perf->map != NULL)
+	{
+		fprintf(perf->map, "%llx %llx %s\n", (unsigned long long)(uintptr_t)slot, (unsigned long long)sizeof(dvm_perf_stub), symbol);
+		fflush(perf->map);
+	}
+
+	if ((perf->modes & dvm_perf_jitdump) && perf->jitdump != NULL)
+	{
+		dvm_perf_write_code_load(symbol, slot, sizeof(dvm_perf_stub), perf);
+	}
+
+	return (dvm_perf_entry)slot;
+
+#else
+
+	return target;
+
+#endif
+}
+
+void dvm_destroy_perf(dvm_context *context)
+{
+	dvm_perf *perf = &context->perf;
+
+#if defined(DVM_PERF_SUPPORTED)
+
+	if (perf->jitdump != NULL)
+	{
+		struct dvm_jitdump_record_header close_record;
+
+		close_record.id = dvm_jitdump_code_close;
+		close_record.total_size = sizeof(close_record);
+		close_record.timestamp = dvm_perf_timestamp();
+
+		fwrite(&close_record, sizeof(close_record), 1, perf->jitdump);
+		fclose(perf->jitdump);
+	}
+
+	if (perf->jitdump_marker != NULL)
+	{
+		munmap(perf->jitdump_marker, DVM_PERF_PAGE_SIZE);
+	}
+
+	if (perf->map != NULL)
+	{
+		fclose(perf->map);
+	}
+
+	while (perf->page != NULL)
+	{
+		uint8_t *previous = *(uint8_t **)perf->page;
+
+		munmap(perf->page, DVM_PERF_PAGE_SIZE);
+
+		perf->page = previous;
+	}
+
+#endif
+
+	for (uint32_t i = 0; i < perf->proc_capacity; ++i)
+	{
+		free(perf->names[i]);
+	}
+
+	free(perf->names);
+	free(perf->trampolines);
+
+	memset(perf, 0, sizeof(dvm_perf));
+}
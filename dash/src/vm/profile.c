@@ -0,0 +1,288 @@
+#include "../vm_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define DVM_PROFILE_VERSION 1
+
+static const char *dvm_profile_kind_names[] = { "proc", "branch", "call" };
+
+int dvm_enable_profile_recording(int enabled, dvm_context *context)
+{
+	context->profile.recording = enabled;
+
+	return 1;
+}
+
+// Sites are pushed as they're compiled, with what they count starting at zero
+
+dvm_profile_site *dvm_profile_push_site(uint32_t proc_hash, uint32_t site, uint8_t kind, uint8_t inverted, uint32_t pc, dvm_context *context)
+{
+	dvm_profile *profile = &context->profile;
+
+	if (profile->site_count == profile->site_capacity)
+	{
+		uint32_t new_capacity = profile->site_capacity == 0 ? 64 : profile->site_capacity * 2;
+
+		dvm_profile_site *new_sites = (dvm_profile_site *)malloc(sizeof(dvm_profile_site) * new_capacity);
+
+		if (new_sites == NULL)
+		{
+			return NULL;
+		}
+
+		if (profile->sites != NULL)
+		{
+			memcpy(new_sites, profile->sites, sizeof(dvm_profile_site) * profile->site_count);
+			free(profile->sites);
+		}
+
+		profile->site_capacity = new_capacity;
+		profile->sites = new_sites;
+	}
+
+	dvm_profile_site *result = &profile->sites[profile->site_count++];
+
+	result->proc_hash = proc_hash;
+	result->site = site;
+	result->kind = kind;
+	result->inverted = inverted;
+	result->pc = pc;
+	result->count = 0;
+	result->else_count = 0;
+
+	return result;
+}
+
+int dvm_profile_trace(const struct dvm_trace_record *records, size_t count, dvm_context *context)
+{
+	dvm_profile *profile = &context->profile;
+
+	if (!profile->recording)
+	{
+		fprintf(stderr, "profile isn't being recorded.\n");
+		return 0;
+	}
+
+	uint32_t *hits = (uint32_t *)calloc(context->bytecode_count + 1, sizeof(uint32_t));
+	uint32_t *taken = (uint32_t *)calloc(context->bytecode_count + 1, sizeof(uint32_t));
+	uint32_t *entries = (uint32_t *)calloc(context->bytecode_count + 1, sizeof(uint32_t));
+
+	if (hits == NULL || taken == NULL || entries == NULL)
+	{
+		free(entries);
+		free(taken);
+		free(hits);
+		return 0;
+	}
+
+	dvm_trace_count(records, count, hits, taken, context);
+
+	// A procedure is entered by a call, or by starting an execution on it
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (records[i].pc == 0 && records[i].proc_index < context->function_count &&
+			(records[i].opcode == dvm_opcode_call || records[i].opcode == dvm_opcode_callr || records[i].opcode == dvm_opcode_nop))
+		{
+			++entries[context->function[records[i].proc_index].bytecode_start];
+		}
+	}
+
+	for (uint32_t i = 0; i < profile->site_count; ++i)
+	{
+		dvm_profile_site *site = &profile->sites[i];
+
+		if (site->pc >= context->bytecode_count)
+			continue;
+
+		switch (site->kind)
+		{
+		case dvm_profile_kind_proc:
+			site->count += entries[site->pc];
+			break;
+
+		case dvm_profile_kind_branch:
+			// An if jumps to its else arm, unless it was laid out the other way around and jumps to its then arm
+
+			site->count += hits[site->pc];
+			site->else_count += site->inverted ? hits[site->pc] - taken[site->pc] : taken[site->pc];
+			break;
+
+		case dvm_profile_kind_call:
+			site->count += hits[site->pc];
+			break;
+		}
+	}
+
+	free(entries);
+	free(taken);
+	free(hits);
+
+	return 1;
+}
+
+int dvm_save_profile(const char *filename, dvm_context *context)
+{
+	FILE *out = fopen(filename, "w");
+
+	if (out == NULL)
+	{
+		fprintf(stderr, "couldn't open profile %s.\n", filename);
+		return 0;
+	}
+
+	fprintf(out, "dash-profile %d\n", DVM_PROFILE_VERSION);
+
+	for (uint32_t i = 0; i < context->profile.site_count; ++i)
+	{
+		dvm_profile_site *site = &context->profile.sites[i];
+
+		fprintf(out, "%s %u %u %llu %llu\n",
+			dvm_profile_kind_names[site->kind],
+			site->proc_hash,
+			site->site,
+			(unsigned long long)site->count,
+			(unsigned long long)site->else_count);
+	}
+
+	int result = !ferror(out);
+
+	fclose(out);
+
+	return result;
+}
+
+static int dvm_profile_compare_sites(const void *left, const void *right)
+{
+	const dvm_profile_site *l = (const dvm_profile_site *)left;
+	const dvm_profile_site *r = (const dvm_profile_site *)right;
+
+	if (l->proc_hash != r->proc_hash)
+		return l->proc_hash < r->proc_hash ? -1 : 1;
+
+	if (l->kind != r->kind)
+		return l->kind < r->kind ? -1 : 1;
+
+	if (l->site != r->site)
+		return l->site < r->site ? -1 : 1;
+
+	return 0;
+}
+
+int dvm_load_profile(const char *filename, dvm_context *context)
+{
+	FILE *in = fopen(filename, "r");
+
+	if (in == NULL)
+	{
+		fprintf(stderr, "couldn't open profile %s.\n", filename);
+		return 0;
+	}
+
+	int version = 0;
+
+	if (fscanf(in, "dash-profile %d", &version) != 1 || version != DVM_PROFILE_VERSION)
+	{
+		fprintf(stderr, "invalid profile %s.\n", filename);
+		fclose(in);
+		return 0;
+	}
+
+	uint32_t capacity = 64;
+	uint32_t count = 0;
+	dvm_profile_site *sites = (dvm_profile_site *)malloc(sizeof(dvm_profile_site) * capacity);
+
+	char kind_name[16];
+	unsigned int proc_hash, site;
+	unsigned long long site_count, else_count;
+
+	while (sites != NULL && fscanf(in, "%15s %u %u %llu %llu", kind_name, &proc_hash, &site, &site_count, &else_count) == 5)
+	{
+		uint8_t kind = 0;
+
+		while (kind < 3 && strcmp(kind_name, dvm_profile_kind_names[kind]) != 0)
+			++kind;
+
+		if (kind == 3)
+		{
+			fprintf(stderr, "invalid profile %s, unknown site %s.\n", filename, kind_name);
+			free(sites);
+			fclose(in);
+			return 0;
+		}
+
+		if (count == capacity)
+		{
+			capacity *= 2;
+
+			dvm_profile_site *new_sites = (dvm_profile_site *)realloc(sites, sizeof(dvm_profile_site) * capacity);
+
+			if (new_sites == NULL)
+				free(sites);
+
+			sites = new_sites;
+
+			if (sites == NULL)
+				break;
+		}
+
+		dvm_profile_site *entry = &sites[count++];
+
+		entry->proc_hash = proc_hash;
+		entry->site = site;
+		entry->kind = kind;
+		entry->inverted = 0;
+		entry->pc = 0;
+		entry->count = site_count;
+		entry->else_count = else_count;
+	}
+
+	fclose(in);
+
+	if (sites == NULL)
+	{
+		return 0;
+	}
+
+	qsort(sites, count, sizeof(dvm_profile_site), dvm_profile_compare_sites);
+
+	free(context->profile.guide);
+
+	context->profile.guide = sites;
+	context->profile.guide_count = count;
+	context->profile.hottest_call = 0;
+
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		if (sites[i].kind == dvm_profile_kind_call && sites[i].count > context->profile.hottest_call)
+			context->profile.hottest_call = sites[i].count;
+	}
+
+	return 1;
+}
+
+const dvm_profile_site *dvm_profile_find(uint32_t proc_hash, uint32_t site, uint8_t kind, dvm_context *context)
+{
+	if (context->profile.guide == NULL)
+	{
+		return NULL;
+	}
+
+	dvm_profile_site key;
+
+	key.proc_hash = proc_hash;
+	key.site = site;
+	key.kind = kind;
+
+	return (const dvm_profile_site *)bsearch(&key, context->profile.guide, context->profile.guide_count, sizeof(dvm_profile_site), dvm_profile_compare_sites);
+}
+
+void dvm_destroy_profile(dvm_context *context)
+{
+	free(context->profile.sites);
+	free(context->profile.guide);
+
+	memset(&context->profile, 0, sizeof(context->profile));
+}
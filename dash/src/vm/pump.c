@@ -0,0 +1,137 @@
+#include "../vm_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+struct dvm_pump_entry
+{
+	struct dvm_execution	*execution;
+	void					*user_data;
+};
+
+// The executions waiting to run are a ring, taken from the front and put back at the end when they run out of fuel
+
+struct dvm_pump
+{
+	uint64_t				 fuel_per_slice;
+	dvm_pump_callback		 callback;
+
+	size_t					 capacity;
+	size_t					 first;
+	size_t					 count;
+	struct dvm_pump_entry	*entries;
+};
+
+struct dvm_pump *dvm_create_pump(uint64_t fuel_per_slice, dvm_pump_callback callback)
+{
+	if (callback == NULL)
+	{
+		fprintf(stderr, "invalid pump callback.\n");
+		return NULL;
+	}
+
+	struct dvm_pump *pump = (struct dvm_pump *)malloc(sizeof(struct dvm_pump));
+
+	if (pump == NULL)
+	{
+		return NULL;
+	}
+
+	pump->fuel_per_slice = fuel_per_slice;
+	pump->callback = callback;
+
+	pump->capacity = 0;
+	pump->first = 0;
+	pump->count = 0;
+	pump->entries = NULL;
+
+	return pump;
+}
+
+void dvm_destroy_pump(struct dvm_pump *pump)
+{
+	if (pump == NULL)
+	{
+		return;
+	}
+
+	free(pump->entries);
+	free(pump);
+}
+
+int dvm_pump_add(struct dvm_execution *execution, void *user_data, struct dvm_pump *pump)
+{
+	if (execution == NULL)
+	{
+		fprintf(stderr, "invalid execution.\n");
+		return 0;
+	}
+
+	if (pump->count == pump->capacity)
+	{
+		size_t new_capacity = pump->capacity == 0 ? 64 : pump->capacity * 2;
+
+		struct dvm_pump_entry *new_entries = (struct dvm_pump_entry *)malloc(sizeof(struct dvm_pump_entry) * new_capacity);
+
+		if (new_entries == NULL)
+		{
+			return 0;
+		}
+
+		// Unwrap the ring so it starts at the front of the new one
+
+		for (size_t i = 0; i < pump->count; ++i)
+		{
+			new_entries[i] = pump->entries[(pump->first + i) & (pump->capacity - 1)];
+		}
+
+		free(pump->entries);
+
+		pump->capacity = new_capacity;
+		pump->first = 0;
+		pump->entries = new_entries;
+	}
+
+	struct dvm_pump_entry *entry = &pump->entries[(pump->first + pump->count) & (pump->capacity - 1)];
+
+	entry->execution = execution;
+	entry->user_data = user_data;
+
+	++pump->count;
+
+	return 1;
+}
+
+// Runs up to max_slices slices and returns how many executions are still waiting to run
+
+size_t dvm_pump_run(size_t max_slices, struct dvm_pump *pump)
+{
+	// Results are only read by the callback, so one set of registers does for every execution
+
+	dvm_var out_registers[256];
+
+	for (size_t slice = 0; slice < max_slices && pump->count > 0; ++slice)
+	{
+		struct dvm_pump_entry entry = pump->entries[pump->first];
+
+		pump->first = (pump->first + 1) & (pump->capacity - 1);
+		--pump->count;
+
+		enum dvm_exec_status status = dvm_resume_execution(entry.execution, pump->fuel_per_slice, out_registers);
+
+		// The entry was just taken out, so putting it back can't need more room
+
+		if (status == dvm_exec_status_budget_exhausted)
+		{
+			pump->entries[(pump->first + pump->count) & (pump->capacity - 1)] = entry;
+			++pump->count;
+		}
+		else
+		{
+			pump->callback(entry.execution, status, out_registers, entry.user_data);
+		}
+	}
+
+	return pump->count;
+}
@@ -0,0 +1,74 @@
+#ifndef dash_simd_h
+#define dash_simd_h
+
+/*
+ * Vector kernels use AVX when the compiler targets it and SSE otherwise on x86,
+ * kernels keep a scalar path for the tail and for other targets. dvm_vf is a
+ * vector of floats, DVM_VF_WIDTH wide.
+ */
+
+#if defined(__AVX__)
+	#include <immintrin.h>
+	#define DVM_SIMD_AVX
+	#define DVM_SIMD_SSE
+#elif defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+	#include <emmintrin.h>
+	#define DVM_SIMD_SSE
+#endif
+
+#if defined(DVM_SIMD_AVX)
+	typedef __m256 dvm_vf;
+	#define DVM_VF_WIDTH		8
+	#define dvm_vf_zero			_mm256_setzero_ps
+	#define dvm_vf_set1			_mm256_set1_ps
+	#define dvm_vf_load			_mm256_load_ps
+	#define dvm_vf_loadu		_mm256_loadu_ps
+	#define dvm_vf_store		_mm256_store_ps
+	#define dvm_vf_storeu		_mm256_storeu_ps
+	#define dvm_vf_add			_mm256_add_ps
+	#define dvm_vf_sub			_mm256_sub_ps
+	#define dvm_vf_mul			_mm256_mul_ps
+	#define dvm_vf_and			_mm256_and_ps
+	#define dvm_vf_andnot		_mm256_andnot_ps
+	#define dvm_vf_or			_mm256_or_ps
+	#define dvm_vf_cmpgt(a, b)	_mm256_cmp_ps(a, b, _CMP_GT_OQ)
+	#define dvm_vf_min			_mm256_min_ps
+	#define dvm_vf_max			_mm256_max_ps
+	#define dvm_vf_round(a)		_mm256_cvtepi32_ps(_mm256_cvtps_epi32(a))
+#elif defined(DVM_SIMD_SSE)
+	typedef __m128 dvm_vf;
+	#define DVM_VF_WIDTH		4
+	#define dvm_vf_zero			_mm_setzero_ps
+	#define dvm_vf_set1			_mm_set1_ps
+	#define dvm_vf_load			_mm_load_ps
+	#define dvm_vf_loadu		_mm_loadu_ps
+	#define dvm_vf_store		_mm_store_ps
+	#define dvm_vf_storeu		_mm_storeu_ps
+	#define dvm_vf_add			_mm_add_ps
+	#define dvm_vf_sub			_mm_sub_ps
+	#define dvm_vf_mul			_mm_mul_ps
+	#define dvm_vf_and			_mm_and_ps
+	#define dvm_vf_andnot		_mm_andnot_ps
+	#define dvm_vf_or			_mm_or_ps
+	#define dvm_vf_cmpgt		_mm_cmpgt_ps
+	#define dvm_vf_min			_mm_min_ps
+	#define dvm_vf_max			_mm_max_ps
+	#define dvm_vf_round(a)		_mm_cvtepi32_ps(_mm_cvtps_epi32(a))
+#endif
+
+#if defined(DVM_SIMD_SSE)
+static inline float dvm_vf_hsum(dvm_vf v)
+{
+	float lanes[DVM_VF_WIDTH];
+	float sum = 0.0f;
+
+	dvm_vf_storeu(lanes, v);
+
+	for (int i = 0; i < DVM_VF_WIDTH; ++i)
+		sum += lanes[i];
+
+	return sum;
+}
+#endif
+
+#endif
@@ -7,56 +7,112 @@
 #include "dash/var.h"
 
 /*
- * A register stack for use in dash execution.
+ * Where a call returns to, kept apart from the registers so a call doesn't have to write
+ * anything between its caller's frame and its own.
+ */
+struct dvm_frame
+{
+	uint32_t func_index;
+	uint32_t pc;
+	uint32_t frame_size;
+	uint32_t reg_offset;
+};
+
+/*
+ * A register stack for use in dash execution, with the frames of the calls beneath the running procedure alongside it.
  *
- * reg_top corresponds with the beginning of the memory allocation.
- * reg_bottom = reg_top + size, forming the valid addresses of [reg_top, reg_bottom)
- * reg_current is the top of the dash stack. Addresses allocated for dash are in the
- *		range of [reg_current, reg_bottom). reg_current is initialized to reg_bottom,
- *		meaning that the stack initially has nothing allocated. The stack grows from
- *		reg_bottom to reg_top, or from higher addresses to lower addresses.
+ * reg_begin corresponds with the beginning of the memory allocation.
+ * reg_end = reg_begin + size, forming the valid addresses of [reg_begin, reg_end)
+ * reg_current is where the running procedure's registers start. It's initialized to reg_begin and the stack
+ *		grows from reg_begin to reg_end, or from lower addresses to higher addresses.
+ *		A callee's registers start at its caller's parameter registers, so the parameters are already in place when
+ *		it starts, and its frame runs on over the caller's registers past them. Nothing is live there, a call's
+ *		parameters are always the last registers its caller has allocated.
+ * frame_current is one past the frame of the innermost caller, the frames are in [frame_begin, frame_current).
  */
 struct dvm_stack
 {
-	dvm_var *reg_top;
+	dvm_var *reg_begin;
 	dvm_var *reg_current;
-	dvm_var *reg_bottom;
+	dvm_var *reg_end;
+
+	struct dvm_frame *frame_begin;
+	struct dvm_frame *frame_current;
+	struct dvm_frame *frame_end;
 };
 
 void dvm_stack_dealloc(struct dvm_stack *stack)
 {
-	if (stack->reg_top != NULL)
+	if (stack->reg_begin != NULL)
 	{
-		free(stack->reg_top);
+		free(stack->reg_begin);
+		free(stack->frame_begin);
 
-		stack->reg_top = NULL;
+		stack->reg_begin = NULL;
 		stack->reg_current = NULL;
-		stack->reg_bottom = NULL;
+		stack->reg_end = NULL;
+
+		stack->frame_begin = NULL;
+		stack->frame_current = NULL;
+		stack->frame_end = NULL;
 	}
 }
-int dvm_stack_alloc(struct dvm_stack *stack, size_t size)
+int dvm_stack_alloc(struct dvm_stack *stack, size_t size, size_t frame_count)
 {
 	dvm_stack_dealloc(stack);
 
-	stack->reg_top = (dvm_var *)malloc(size * sizeof(dvm_var));
+	stack->reg_begin = (dvm_var *)malloc(size * sizeof(dvm_var));
+	stack->frame_begin = (struct dvm_frame *)malloc(frame_count * sizeof(struct dvm_frame));
 
-	if (stack->reg_top == NULL)
+	if (stack->reg_begin == NULL || stack->frame_begin == NULL)
 	{
+		free(stack->reg_begin);
+		free(stack->frame_begin);
+
+		stack->reg_begin = NULL;
+		stack->frame_begin = NULL;
+
 		return 0;
 	}
 
-	stack->reg_bottom = stack->reg_top + size;
-	stack->reg_current = stack->reg_bottom;
+	stack->reg_end = stack->reg_begin + size;
+	stack->reg_current = stack->reg_begin;
+
+	stack->frame_end = stack->frame_begin + frame_count;
+	stack->frame_current = stack->frame_begin;
 
 	return 1;
 }
-int dvm_stack_push(struct dvm_stack *stack, size_t amount)
+// Starts a callee's registers at reg_start in the current frame, returning the frame for the caller to fill in
+struct dvm_frame *dvm_stack_push(struct dvm_stack *stack, size_t reg_start, size_t frame_size)
 {
-	return (stack->reg_current = stack->reg_current - amount) > stack->reg_top;
+	if (stack->frame_current == stack->frame_end ||
+		(size_t)(stack->reg_end - stack->reg_current) < reg_start + frame_size)
+	{
+		return NULL;
+	}
+
+	struct dvm_frame *frame = stack->frame_current++;
+
+	frame->reg_offset = (uint32_t)(stack->reg_current - stack->reg_begin);
+
+	stack->reg_current += reg_start;
+
+	return frame;
 }
-int dvm_stack_pop(struct dvm_stack *stack, size_t amount)
+// Goes back to the innermost caller's registers, returning its frame, or NULL when there's no caller
+struct dvm_frame *dvm_stack_pop(struct dvm_stack *stack)
 {
-	return (stack->reg_current = stack->reg_current + amount) <= stack->reg_bottom;
+	if (stack->frame_current == stack->frame_begin)
+	{
+		return NULL;
+	}
+
+	struct dvm_frame *frame = --stack->frame_current;
+
+	stack->reg_current = stack->reg_begin + frame->reg_offset;
+
+	return frame;
 }
 
 #endif
@@ -0,0 +1,166 @@
+#include "../vm_internal.h"
+#include "../hash.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+static int dvm_grow_string_buckets(dvm_context *context)
+{
+	uint32_t new_bucket_count = context->string_bucket_count == 0 ? 64 : context->string_bucket_count * 2;
+
+	dvm_string **new_buckets = (dvm_string **)malloc(sizeof(dvm_string *) * new_bucket_count);
+
+	if (new_buckets == NULL)
+		return 0;
+
+	memset(new_buckets, 0, sizeof(dvm_string *) * new_bucket_count);
+
+	// Every string is in the table, so the chains can be rebuilt from it
+
+	for (uint32_t i = 0; i < context->string_count; ++i)
+	{
+		dvm_string *string = context->strings[i];
+		uint32_t bucket = string->hash & (new_bucket_count - 1);
+
+		string->next_in_bucket = new_buckets[bucket];
+		new_buckets[bucket] = string;
+	}
+
+	free(context->string_buckets);
+
+	context->string_bucket_count = new_bucket_count;
+	context->string_buckets = new_buckets;
+
+	return 1;
+}
+
+// interface
+
+dvm_string *dvm_intern_string(const char *text, size_t length, dvm_context *context)
+{
+	if (text == NULL && length != 0)
+	{
+		fprintf(stderr, "invalid string.\n");
+		return NULL;
+	}
+
+	if (text == NULL)
+		text = "";
+
+	if (length > UINT32_MAX - sizeof(dvm_string))
+	{
+		fprintf(stderr, "string is too large.\n");
+		return NULL;
+	}
+
+	uint32_t hash = dsh_hash_n(text, length);
+
+	if (context->string_bucket_count != 0)
+	{
+		for (dvm_string *cur = context->string_buckets[hash & (context->string_bucket_count - 1)]; cur != NULL; cur = cur->next_in_bucket)
+		{
+			if (cur->hash == hash && cur->length == length && memcmp(cur->text, text, length) == 0)
+				return cur;
+		}
+	}
+
+	// Not seen before, sload can only address the first DVM_MAX_STRINGS
+
+	if (context->string_count == DVM_MAX_STRINGS)
+	{
+		fprintf(stderr, "too many strings.\n");
+		return NULL;
+	}
+
+	if (context->string_count == context->string_capacity)
+	{
+		uint32_t new_capacity = context->string_capacity == 0 ? 64 : context->string_capacity * 2;
+
+		dvm_string **new_strings = (dvm_string **)malloc(sizeof(dvm_string *) * new_capacity);
+
+		if (new_strings == NULL)
+			return NULL;
+
+		if (context->strings != NULL)
+		{
+			memcpy(new_strings, context->strings, sizeof(dvm_string *) * context->string_count);
+			free(context->strings);
+		}
+
+		context->string_capacity = new_capacity;
+		context->strings = new_strings;
+	}
+
+	// Keep the chains short, at most two strings to a bucket on average
+
+	if (context->string_count >= context->string_bucket_count * 2 && !dvm_grow_string_buckets(context))
+		return NULL;
+
+	// The header and the text share one allocation, the text is null terminated for natives
+
+	dvm_string *string = (dvm_string *)malloc(sizeof(dvm_string) + length);
+
+	if (string == NULL)
+		return NULL;
+
+	string->hash = hash;
+	string->length = (uint32_t)length;
+	string->index = context->string_count;
+
+	memcpy(string->text, text, length);
+	string->text[length] = 0;
+
+	uint32_t bucket = hash & (context->string_bucket_count - 1);
+
+	string->next_in_bucket = context->string_buckets[bucket];
+	context->string_buckets[bucket] = string;
+
+	context->strings[context->string_count++] = string;
+
+	return string;
+}
+
+const char *dvm_string_text(dvm_string *string)
+{
+	return string != NULL ? string->text : "";
+}
+size_t dvm_string_length(dvm_string *string)
+{
+	return string != NULL ? string->length : 0;
+}
+uint32_t dvm_string_hash(dvm_string *string)
+{
+	return string != NULL ? string->hash : DSH_HASH_SEED;
+}
+
+void dvm_destroy_strings(dvm_context *context)
+{
+	for (uint32_t i = 0; i < context->string_count; ++i)
+		free(context->strings[i]);
+
+	free(context->strings);
+	free(context->string_buckets);
+
+	context->string_capacity = 0;
+	context->string_count = 0;
+	context->strings = NULL;
+
+	context->string_bucket_count = 0;
+	context->string_buckets = NULL;
+}
+
+// std lib
+
+void dvm_stdlib_print_s(const dvm_var *in, dvm_var *out)
+{
+	fprintf(stdout, "%s\n", dvm_string_text(in[0].s));
+}
+
+int dvm_create_string_stdlib(dvm_context *context)
+{
+	const enum dvm_type string[] = { dvm_type_string };
+
+	return
+		dvm_register_native("print_s", dvm_stdlib_print_s, string, 1, NULL, 0, context);
+}
@@ -0,0 +1,371 @@
+#include "../vm_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+// How many of the hottest blocks are listed ahead of the procedures
+
+#define DVM_TRACE_HOT_BLOCKS 16
+
+int dvm_enable_exec_trace(size_t capacity, dvm_context *context)
+{
+	free(context->exec_trace.records);
+	memset(&context->exec_trace, 0, sizeof(context->exec_trace));
+
+	if (capacity == 0)
+	{
+		return 1;
+	}
+
+	if (capacity > 0x80000000u)
+	{
+		fprintf(stderr, "invalid trace capacity.\n");
+		return 0;
+	}
+
+	size_t rounded = 1;
+
+	while (rounded < capacity)
+	{
+		rounded *= 2;
+	}
+
+	context->exec_trace.records = (struct dvm_trace_record *)malloc(sizeof(struct dvm_trace_record) * rounded);
+
+	if (context->exec_trace.records == NULL)
+	{
+		return 0;
+	}
+
+	context->exec_trace.mask = (uint32_t)(rounded - 1);
+
+	return 1;
+}
+
+size_t dvm_trace_copy(struct dvm_trace_record *records, size_t max_records, const dvm_trace *trace)
+{
+	if (trace->records == NULL)
+	{
+		return 0;
+	}
+
+	// Once the ring has wrapped only the latest capacity records are left
+
+	uint64_t held = trace->count < (uint64_t)trace->mask + 1 ? trace->count : (uint64_t)trace->mask + 1;
+	size_t count = held < max_records ? (size_t)held : max_records;
+	uint64_t first = trace->count - count;
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		records[i] = trace->records[(first + i) & trace->mask];
+	}
+
+	return count;
+}
+
+size_t dvm_get_exec_trace(struct dvm_trace_record *records, size_t max_records, dvm_context *context)
+{
+	return dvm_trace_copy(records, max_records, &context->exec_trace);
+}
+
+// decoding
+
+static int32_t dvm_trace_jump_offset(const dvm_bc *code)
+{
+	if (code->opcode == dvm_opcode_jmp_l)
+	{
+		return *(const int32_t *)(code + 1);
+	}
+
+	uint8_t offset = code->c;
+
+	return *(int8_t *)&offset;
+}
+
+// Blocks start at the top of a procedure, wherever a jump lands and after anything that can leave the straight run
+
+static void dvm_trace_mark_leaders(dvm_procedure *function, uint8_t *leaders, dvm_context *context)
+{
+	uint32_t start = function->bytecode_start;
+	uint32_t end = function->bytecode_end;
+
+	leaders[start] = 1;
+
+	for (uint32_t pc = start; pc < end; pc += 1 + dvm_bc_immediate_count(context->bytecode[pc]))
+	{
+		dvm_bc instruction = context->bytecode[pc];
+		uint32_t next = pc + 1 + dvm_bc_immediate_count(instruction);
+
+		switch (instruction.opcode)
+		{
+		case dvm_opcode_jmp_c:
+		case dvm_opcode_jmp_cn:
+		case dvm_opcode_jmp_u:
+		case dvm_opcode_loop:
+		case dvm_opcode_jmp_l:
+		{
+			int64_t target = (int64_t)pc + dvm_trace_jump_offset(&context->bytecode[pc]);
+
+			if (target >= start && target < end)
+				leaders[target] = 1;
+
+			break;
+		}
+
+		case dvm_opcode_jmp_t:
+			for (uint32_t slot = 1; slot <= (uint32_t)instruction.b + 1; ++slot)
+			{
+				int64_t target = (int64_t)pc + *(const int32_t *)(&context->bytecode[pc + slot]);
+
+				if (target >= start && target < end)
+					leaders[target] = 1;
+			}
+			break;
+
+		case dvm_opcode_call:
+		case dvm_opcode_callr:
+		case dvm_opcode_calln:
+		case dvm_opcode_ret:
+		case dvm_opcode_yield:
+			break;
+
+		default:
+			continue;
+		}
+
+		if (next < end)
+			leaders[next] = 1;
+	}
+}
+
+// Follows the straight run a record starts, counting every instruction in it, up to the one that left it.
+// Branches that weren't taken aren't recorded, so a branch only ends the run when the next record is where it goes.
+
+static void dvm_trace_walk(const struct dvm_trace_record *record, const struct dvm_trace_record *next, uint32_t *hits, uint32_t *taken, dvm_context *context)
+{
+	if (record->proc_index >= context->function_count)
+	{
+		return;
+	}
+
+	dvm_procedure *function = &context->function[record->proc_index];
+
+	if (function->c_function != NULL)
+	{
+		return;
+	}
+
+	for (uint32_t pc = function->bytecode_start + record->pc; pc < function->bytecode_end; pc += 1 + dvm_bc_immediate_count(context->bytecode[pc]))
+	{
+		dvm_bc instruction = context->bytecode[pc];
+
+		++hits[pc];
+
+		switch (instruction.opcode)
+		{
+		case dvm_opcode_ret:
+		case dvm_opcode_yield:
+		case dvm_opcode_jmp_u:
+		case dvm_opcode_jmp_l:
+		case dvm_opcode_jmp_t:
+			return;
+
+		case dvm_opcode_callr:
+			return;
+
+		case dvm_opcode_call:
+			// Natives run inside the caller's block
+
+			if (instruction.a >= context->function_count || context->function[instruction.a].c_function == NULL)
+				return;
+			break;
+
+		case dvm_opcode_jmp_c:
+		case dvm_opcode_jmp_cn:
+		case dvm_opcode_loop:
+			if (next != NULL && next->opcode == instruction.opcode && next->proc_index == record->proc_index &&
+				(int64_t)next->pc == (int64_t)(pc - function->bytecode_start) + dvm_trace_jump_offset(&context->bytecode[pc]))
+			{
+				if (taken != NULL)
+					++taken[pc];
+
+				return;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+// Counts how many times each instruction ran and how many times each conditional jump was taken, by its pc in the context
+
+void dvm_trace_count(const struct dvm_trace_record *records, size_t count, uint32_t *hits, uint32_t *taken, dvm_context *context)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		dvm_trace_walk(&records[i], i + 1 < count ? &records[i + 1] : NULL, hits, taken, context);
+	}
+}
+
+struct dvm_trace_block
+{
+	uint32_t proc_index;
+	uint32_t start;
+	uint32_t end;
+	uint32_t hits;
+};
+
+struct dvm_trace_proc
+{
+	uint32_t proc_index;
+	uint64_t hits;
+};
+
+static int dvm_trace_compare_blocks(const void *left, const void *right)
+{
+	uint32_t left_hits = ((const struct dvm_trace_block *)left)->hits;
+	uint32_t right_hits = ((const struct dvm_trace_block *)right)->hits;
+
+	return left_hits < right_hits ? 1 : left_hits > right_hits ? -1 : 0;
+}
+
+static int dvm_trace_compare_procs(const void *left, const void *right)
+{
+	uint64_t left_hits = ((const struct dvm_trace_proc *)left)->hits;
+	uint64_t right_hits = ((const struct dvm_trace_proc *)right)->hits;
+
+	return left_hits < right_hits ? 1 : left_hits > right_hits ? -1 : 0;
+}
+
+// Lists the hottest blocks, then every procedure the trace went through, hottest first, as its disassembly
+// with how many times each instruction ran and its pc alongside
+
+void dvm_dissasm_trace(const struct dvm_trace_record *records, size_t count, FILE *out, dvm_context *context)
+{
+	uint32_t *hits = (uint32_t *)calloc(context->bytecode_count + 1, sizeof(uint32_t));
+	uint8_t *leaders = (uint8_t *)calloc(context->bytecode_count + 1, 1);
+	struct dvm_trace_proc *procs = (struct dvm_trace_proc *)calloc(context->function_count + 1, sizeof(struct dvm_trace_proc));
+
+	struct dvm_trace_block *blocks = NULL;
+
+	if (hits == NULL || leaders == NULL || procs == NULL)
+	{
+		fprintf(stderr, "out of memory decoding a trace.\n");
+		goto decode_exit;
+	}
+
+	dvm_trace_count(records, count, hits, NULL, context);
+
+	// Gather the blocks that ran and the procedures they're in
+
+	size_t block_count = 0;
+	size_t proc_count = 0;
+
+	for (uint32_t i = 0; i < context->function_count; ++i)
+	{
+		dvm_procedure *function = &context->function[i];
+
+		if (function->c_function != NULL)
+			continue;
+
+		uint64_t proc_hits = 0;
+
+		dvm_trace_mark_leaders(function, leaders, context);
+
+		for (uint32_t pc = function->bytecode_start; pc < function->bytecode_end; ++pc)
+		{
+			proc_hits += hits[pc];
+
+			if (leaders[pc] && hits[pc] > 0)
+				++block_count;
+		}
+
+		if (proc_hits > 0)
+		{
+			procs[proc_count].proc_index = i;
+			procs[proc_count].hits = proc_hits;
+			++proc_count;
+		}
+	}
+
+	blocks = (struct dvm_trace_block *)malloc(sizeof(struct dvm_trace_block) * (block_count + 1));
+
+	if (blocks == NULL)
+	{
+		fprintf(stderr, "out of memory decoding a trace.\n");
+		goto decode_exit;
+	}
+
+	block_count = 0;
+
+	for (size_t i = 0; i < proc_count; ++i)
+	{
+		dvm_procedure *function = &context->function[procs[i].proc_index];
+
+		for (uint32_t pc = function->bytecode_start; pc < function->bytecode_end; pc += 1 + dvm_bc_immediate_count(context->bytecode[pc]))
+		{
+			if (!leaders[pc])
+				continue;
+
+			// A block runs up to the next leader, its end is the pc of its last instruction
+
+			uint32_t end = pc;
+
+			for (uint32_t next = pc + 1 + dvm_bc_immediate_count(context->bytecode[pc]);
+				next < function->bytecode_end && !leaders[next];
+				next += 1 + dvm_bc_immediate_count(context->bytecode[next]))
+			{
+				end = next;
+			}
+
+			if (hits[pc] > 0)
+			{
+				struct dvm_trace_block *block = &blocks[block_count++];
+
+				block->proc_index = procs[i].proc_index;
+				block->start = pc - function->bytecode_start;
+				block->end = end - function->bytecode_start;
+				block->hits = hits[pc];
+			}
+		}
+	}
+
+	qsort(blocks, block_count, sizeof(struct dvm_trace_block), dvm_trace_compare_blocks);
+	qsort(procs, proc_count, sizeof(struct dvm_trace_proc), dvm_trace_compare_procs);
+
+	fprintf(out, "trace - records: %llu blocks: %llu\n\n", (unsigned long long)count, (unsigned long long)block_count);
+	fprintf(out, "      hits  block\n");
+
+	for (size_t i = 0; i < block_count && i < DVM_TRACE_HOT_BLOCKS; ++i)
+	{
+		fprintf(out, "%10u  func[%u] %u..%u\n", blocks[i].hits, blocks[i].proc_index, blocks[i].start, blocks[i].end);
+	}
+
+	for (size_t i = 0; i < proc_count; ++i)
+	{
+		dvm_procedure *function = &context->function[procs[i].proc_index];
+
+		fprintf(out, "\nfunc[%u] - instructions: %llu\n", procs[i].proc_index, (unsigned long long)procs[i].hits);
+		fprintf(out, "dsh-func - in: %u use: %u out: %u\n", function->reg_count_in, function->reg_count_use, function->reg_count_out);
+
+		for (size_t pc = function->bytecode_start; pc < function->bytecode_end; )
+		{
+			if (hits[pc] > 0)
+				fprintf(out, "%10u %c%5u  ", hits[pc], leaders[pc] ? '>' : ' ', (uint32_t)(pc - function->bytecode_start));
+			else
+				fprintf(out, "%10s %c%5u  ", ".", leaders[pc] ? '>' : ' ', (uint32_t)(pc - function->bytecode_start));
+
+			pc = dvm_dissasm_instruction(pc, out, context);
+		}
+	}
+
+decode_exit:
+
+	free(blocks);
+	free(procs);
+	free(leaders);
+	free(hits);
+}
@@ -11,10 +11,17 @@ enum dvm_opcode
 	dvm_opcode_nop = 0,
 
 	dvm_opcode_call,
+	dvm_opcode_callr,
+	dvm_opcode_calln,
 	dvm_opcode_ret,
+	dvm_opcode_yield,
 	dvm_opcode_mov,
+	dvm_opcode_movn,
 	dvm_opcode_stor,
 
+	dvm_opcode_gload,
+	dvm_opcode_gstor,
+
 	dvm_opcode_and,
 	dvm_opcode_or,
 	dvm_opcode_not,
@@ -31,6 +38,13 @@ enum dvm_opcode
 	dvm_opcode_jmp_c,
 	dvm_opcode_jmp_cn,
 	dvm_opcode_jmp_u,
+	dvm_opcode_jmp_l,
+	dvm_opcode_jmp_t,
+
+	dvm_opcode_inci,
+	dvm_opcode_loop,
+
+	dvm_opcode_select,
 	
 	dvm_opcode_addi,
 	dvm_opcode_addf,
@@ -44,10 +58,108 @@ enum dvm_opcode
 	dvm_opcode_divi,
 	dvm_opcode_divf,
 
+	dvm_opcode_modi,
+	dvm_opcode_shli,
+	dvm_opcode_shri,
+	dvm_opcode_bandi,
+	dvm_opcode_bori,
+	dvm_opcode_bxori,
+
 	dvm_opcode_casti,
 	dvm_opcode_castf,
+
+	dvm_opcode_anew,
+	dvm_opcode_alen,
+	dvm_opcode_aload,
+	dvm_opcode_astor,
+
+	dvm_opcode_sload,
+	dvm_opcode_cmps_e,
+	dvm_opcode_shash,
+	dvm_opcode_slen,
+
+	dvm_opcode_sqrtf,
+	dvm_opcode_sinf,
+	dvm_opcode_cosf,
+	dvm_opcode_tanf,
+	dvm_opcode_powf,
+	dvm_opcode_floorf,
+	dvm_opcode_absi,
+	dvm_opcode_absf,
+	dvm_opcode_mini,
+	dvm_opcode_minf,
+	dvm_opcode_maxi,
+	dvm_opcode_maxf,
+	dvm_opcode_fmaf,
+
+	dvm_opcode_storl,
+
+	dvm_opcode_cmpl_e,
+	dvm_opcode_cmpd_e,
+
+	dvm_opcode_cmpl_l,
+	dvm_opcode_cmpd_l,
+
+	dvm_opcode_cmpl_le,
+	dvm_opcode_cmpd_le,
+
+	dvm_opcode_addl,
+	dvm_opcode_addd,
+
+	dvm_opcode_subl,
+	dvm_opcode_subd,
+
+	dvm_opcode_mull,
+	dvm_opcode_muld,
+
+	dvm_opcode_divl,
+	dvm_opcode_divd,
+
+	dvm_opcode_modl,
+	dvm_opcode_shll,
+	dvm_opcode_shrl,
+	dvm_opcode_bandl,
+	dvm_opcode_borl,
+	dvm_opcode_bxorl,
+
+	dvm_opcode_castil,
+	dvm_opcode_castli,
+	dvm_opcode_castfd,
+	dvm_opcode_castdf,
+	dvm_opcode_castld,
+	dvm_opcode_castdl,
+	dvm_opcode_castfl,
+	dvm_opcode_castlf,
+	dvm_opcode_castid,
+	dvm_opcode_castdi,
 };
 
+// stor carries a 32 bit immediate in the following instruction slot, storl a 64 bit one in the next two.
+// jmpl carries a 32 bit offset, jmpt a default offset followed by a table of b offsets.
+
+#define dvm_bc_immediate_count(bc) \
+	((bc).opcode == dvm_opcode_stor || (bc).opcode == dvm_opcode_jmp_l ? 1 : \
+	 (bc).opcode == dvm_opcode_storl ? 2 : \
+	 (bc).opcode == dvm_opcode_jmp_t ? (bc).b + 1 : 0)
+
+// gload and gstor address a global by a 16 bit index split across a (low byte) and b (high byte)
+
+#define dvm_bc_global_index(bc) ((uint32_t)(bc).a | ((uint32_t)(bc).b << 8))
+// Calls are linked once the procedures they call are known, callr into bytecode and calln into a native.
+// Both were checked against their callee when they were linked, so they run without checking anything.
+
+#define dvm_bc_is_call(bc) ((bc).opcode == dvm_opcode_call || (bc).opcode == dvm_opcode_callr || (bc).opcode == dvm_opcode_calln)
+
+#define dvm_bc_is_global(bc) ((bc).opcode == dvm_opcode_gload || (bc).opcode == dvm_opcode_gstor)
+
+#define DVM_MAX_GLOBALS 0x10000
+
+// sload addresses the context's string table the same way
+
+#define dvm_bc_string_index(bc) ((uint32_t)(bc).a | ((uint32_t)(bc).b << 8))
+
+#define DVM_MAX_STRINGS 0x10000
+
 struct dvm_bc
 {
 	unsigned int opcode : 8;
@@ -57,7 +169,7 @@ struct dvm_bc
 };
 typedef struct dvm_bc dvm_bc;
 
-typedef void (*dvm_c_function)(const dvm_var *in_registers, dvm_var *out_registers);
+typedef dvm_native_function dvm_c_function;
 struct dvm_procedure
 {
 	uint32_t hashed_name;
@@ -73,18 +185,262 @@ struct dvm_procedure
 };
 typedef struct dvm_procedure dvm_procedure;
 
+// What a linked call needs of its callee, laid out so one is always inside a single cache line
+
+struct dvm_call_target
+{
+	dvm_c_function	c_function;
+	uint32_t		bytecode_start;
+	uint16_t		frame_size;
+	uint8_t			reg_count_in;
+	uint8_t			reg_count_out;
+};
+typedef struct dvm_call_target dvm_call_target;
+
+// Array elements are 32 bits wide, aligned for the widest vector kernels
+#define DVM_ARRAY_ALIGNMENT 32
+
+// Arrays scripts make are collected once they've made this many bytes more than twice what survived the last collection
+#define DVM_ARRAY_COLLECT_BYTES (1 << 20)
+
+struct dvm_array
+{
+	void		*data;
+	uint32_t	 length;
+	uint8_t		 element_type;
+	uint8_t		 held;		// on the context's list for the host, rather than collected with the script arrays
+	uint8_t		 marked;
+
+	struct dvm_array *prev;
+	struct dvm_array *next;
+};
+typedef struct dvm_array dvm_array;
+
+// Interned strings are never freed before the context, so they can be compared by pointer
+struct dvm_string
+{
+	uint32_t	 hash;		// dsh_hash of the text
+	uint32_t	 length;
+	uint32_t	 index;		// slot in the context's string table, what sload refers to
+
+	struct dvm_string *next_in_bucket;
+
+	char		 text[1];
+};
+typedef struct dvm_string dvm_string;
+
+struct dvm_native
+{
+	char		*name;
+	uint32_t	 function_index;
+
+	uint8_t		 in_count;
+	uint8_t		 out_count;
+	uint8_t		*types;		// in types followed by out types
+};
+typedef struct dvm_native dvm_native;
+
+struct dvm_cache
+{
+	char		*directory;
+	size_t		 max_entries;
+	size_t		 max_bytes;
+
+	struct dvm_cache_stats stats;
+};
+typedef struct dvm_cache dvm_cache;
+
+// A ring of trace records, count keeps going past the capacity so the oldest record still held can be found
+
+struct dvm_trace
+{
+	struct dvm_trace_record	*records;
+	uint32_t				 mask;
+	uint64_t				 count;
+};
+typedef struct dvm_trace dvm_trace;
+
+#define dvm_trace_push(trace, index, trace_pc, entered_by) \
+	do \
+	{ \
+		struct dvm_trace_record *record = &(trace).records[(trace).count++ & (trace).mask]; \
+		record->proc_index = (index); \
+		record->pc = (trace_pc); \
+		record->opcode = (entered_by); \
+	} while (0)
+
+size_t dvm_trace_copy(struct dvm_trace_record *records, size_t max_records, const dvm_trace *trace);
+void dvm_trace_count(const struct dvm_trace_record *records, size_t count, uint32_t *hits, uint32_t *taken, struct dvm_context *context);
+
+// A counted place in a procedure, found again by its procedure's name and its number in it.
+// Branches count how often they ran and how often the else arm was taken, pc is only known while it's recorded
+// and is DVM_PROFILE_NO_PC for a site that wasn't compiled to an instruction, which keeps the count it's given.
+
+#define DVM_PROFILE_NO_PC 0xFFFFFFFFu
+
+enum dvm_profile_kind
+{
+	dvm_profile_kind_proc,
+	dvm_profile_kind_branch,
+	dvm_profile_kind_call,
+};
+
+struct dvm_profile_site
+{
+	uint32_t proc_hash;
+	uint32_t site;
+	uint8_t	 kind;
+	uint8_t	 inverted;		// the branch jumps when its condition is true, into the then arm
+	uint32_t pc;
+	uint64_t count;
+	uint64_t else_count;
+};
+typedef struct dvm_profile_site dvm_profile_site;
+
+struct dvm_profile
+{
+	int					 recording;
+
+	uint32_t			 site_capacity;
+	uint32_t			 site_count;
+	dvm_profile_site	*sites;
+
+	// The loaded profile that guides codegen, sorted so it can be searched
+
+	uint32_t			 guide_count;
+	dvm_profile_site	*guide;
+	uint64_t			 hottest_call;
+};
+typedef struct dvm_profile dvm_profile;
+
+// A profiler attached to the process finds script procedures through trampolines, one per procedure entered,
+// written down in a perf map or a jitdump. The trampolines are laid out in executable pages linked from the last.
+
+typedef enum dvm_exec_status (*dvm_perf_entry)(struct dvm_execution *execution, uint64_t fuel, dvm_var *out_registers);
+
+struct dvm_perf
+{
+	int				 modes;
+
+	FILE			*map;
+	FILE			*jitdump;
+	void			*jitdump_marker;
+	uint64_t		 code_index;
+
+	uint32_t		 proc_capacity;
+	char			**names;
+	void			**trampolines;
+
+	uint8_t			*page;
+	size_t			 page_used;
+};
+typedef struct dvm_perf dvm_perf;
+
 struct dvm_context
 {
 	uint32_t				 function_capacity;
 	uint32_t				 function_count;
 	dvm_procedure			*function;
 
+	// Indexed the same as the procedures, filled in as they're linked
+	dvm_call_target			*call_targets;
+
 	uint32_t	 bytecode_capacity;
 	uint32_t	 bytecode_count;
 	dvm_bc		*bytecode;
+
+	uint32_t	 native_capacity;
+	uint32_t	 native_count;
+	dvm_native	*native;
+
+	// The data segment, globals of every imported module live here for the lifetime of the context
+
+	uint32_t	 global_capacity;
+	uint32_t	 global_count;
+	dvm_var		*globals;
+
+	// Arrays the host made or was handed back, and the ones scripts made, which are collected once no global or
+	// live execution's registers refer to them. Registers aren't typed, so anything that looks like one of them does.
+
+	dvm_array	*arrays;
+	dvm_array	*script_arrays;
+	size_t		 script_array_bytes;
+	size_t		 script_array_limit;
+
+	uint32_t	 array_mark_capacity;
+	uint32_t	 array_mark_count;
+	dvm_array	**array_marks;
+
+	// Executions that can still run, the ones whose registers are looked through
+
+	struct dvm_execution *executions;
+
+	// The intern pool, every string the context has seen by table index and by hash
+
+	uint32_t	 string_capacity;
+	uint32_t	 string_count;
+	dvm_string	**strings;
+
+	uint32_t	 string_bucket_count;
+	dvm_string	**string_buckets;
+
+	dvm_cache	 cache;
+
+	// What the last dvm_exec_proc did
+
+	int						 exec_timing;
+	struct dvm_exec_stats	 exec_stats;
+
+	// What the last import did, only kept while it's enabled
+
+	int						 import_timing;
+	struct dvm_import_stats	 import_stats;
+
+	// The ring dvm_exec_proc traces into, and the size executions give their own
+
+	dvm_trace				 exec_trace;
+
+	dvm_profile				 profile;
+
+	dvm_perf				 perf;
 };
 typedef struct dvm_context dvm_context;
 
+dvm_bc			*dvm_context_push_bytecode(size_t amount, dvm_context *context);
+dvm_procedure	*dvm_context_push_procedure(size_t amount, dvm_context *context);
+dvm_var			*dvm_context_push_globals(size_t amount, dvm_context *context);
+void			 dvm_context_pop_bytecode(size_t amount, dvm_context *context);
+void			 dvm_context_pop_procedure(size_t amount, dvm_context *context);
+void			 dvm_context_pop_globals(size_t amount, dvm_context *context);
+
+void			 dvm_context_link(uint32_t function_base, dvm_context *context);
+
+int dvm_context_validate_proc(uint32_t code_start, uint32_t code_length, uint8_t reg_count_in, uint8_t reg_count_use, uint8_t reg_count_out, dvm_context *context);
+
+double dvm_now();
+
+size_t dvm_dissasm_instruction(size_t pc, FILE *out, dvm_context *context);
+
+dvm_profile_site		*dvm_profile_push_site(uint32_t proc_hash, uint32_t site, uint8_t kind, uint8_t inverted, uint32_t pc, dvm_context *context);
+const dvm_profile_site	*dvm_profile_find(uint32_t proc_hash, uint32_t site, uint8_t kind, dvm_context *context);
+void					 dvm_destroy_profile(dvm_context *context);
+
+void			 dvm_perf_name_proc(uint32_t index, const char *name, dvm_context *context);
+dvm_perf_entry	 dvm_perf_trampoline(uint32_t index, dvm_perf_entry target, dvm_context *context);
+void			 dvm_destroy_perf(dvm_context *context);
+
+dvm_array	*dvm_create_script_array(enum dvm_type element_type, size_t length, dvm_context *context);
+int			 dvm_begin_array_marks(dvm_context *context);
+dvm_array	*dvm_find_script_array(const dvm_var *value, dvm_context *context);
+void		 dvm_mark_arrays(const dvm_var *begin, const dvm_var *end, dvm_context *context);
+void		 dvm_hold_array(dvm_array *array, dvm_context *context);
+void		 dvm_sweep_arrays(dvm_context *context);
+void		 dvm_destroy_arrays(dvm_context *context);
+void		 dvm_destroy_strings(dvm_context *context);
+
+int  dvm_cache_load(uint64_t key, dvm_context *context);
+void dvm_cache_store(uint64_t key, uint32_t function_base, uint32_t bytecode_base, uint32_t global_base, dvm_context *context);
+
 struct dvm_procedure_emitter
 {
 	uint32_t bytecode_start;
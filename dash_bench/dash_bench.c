@@ -0,0 +1,683 @@
+#include "dash/vm.h"
+
+#include "../dash/src/compiler/common.h"
+#include "../dash/src/compiler/frontend/scanner.h"
+#include "../dash/src/compiler/frontend/parser.h"
+
+#include "workloads.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(_WIN32)
+	#include <windows.h>
+#endif
+
+/*
+ * Compile and execution benchmarks over curated and generated dash sources.
+ */
+
+// The flex scanner generated from lexer.l, built only into the benchmark as a reference for the hand written one
+
+typedef void *yyscan_t;
+int yylex_init(yyscan_t *ptr_yy_globals);
+int yylex(union YYSTYPE *yyval_param, struct YYLTYPE *yylloc_param, yyscan_t yyscanner);
+int yylex_destroy(yyscan_t yyscanner);
+void yyset_in(FILE *in, yyscan_t yyscanner);
+void yyset_extra(dsc_intern_table *atoms, yyscan_t yyscanner);
+void *yy_scan_bytes(const char *bytes, int length, yyscan_t yyscanner);
+
+// The call instruction can only reach the first 256 procedures in a context, the natives included.
+// A module can be far larger, as long as the procedures it calls are among the first it declares.
+
+#define BENCH_MODULE_PROCEDURES 10000
+#define BENCH_CALLABLE_PROCEDURES 200
+
+void gen_procedures(FILE *out, int size)
+{
+	// Every procedure calls two spread over the callable ones, so lookups are by name through the whole table
+
+	int callable = size < BENCH_CALLABLE_PROCEDURES ? size : BENCH_CALLABLE_PROCEDURES;
+
+	for (int i = 0; i < size; ++i)
+	{
+		fprintf(out, "def p%d : (a : integer) -> (integer)\n{\n\tlet x = a + %d;\n\treturn p%d(x) + p%d(a);\n}\n\n",
+			i, i, (i * 7 + 1) % callable, callable - 1 - i % callable);
+	}
+}
+void gen_locals(FILE *out, int size)
+{
+	// Locals are spread over sibling blocks that shadow an outer set, registers are limited to 255 per frame
+
+	const int per_block = 50;
+
+	fprintf(out, "def locals : (a : integer) -> (integer)\n{\n");
+
+	for (int i = 0; i < per_block; ++i)
+	{
+		fprintf(out, "\tlet v%d = a + %d;\n", i, i);
+	}
+
+	for (int defined = per_block; defined < size; defined += per_block)
+	{
+		fprintf(out, "\t{\n");
+
+		for (int i = 0; i < per_block; ++i)
+		{
+			fprintf(out, "\t\tlet v%d = v%d + v%d;\n", i, i, (i + 1) % per_block);
+		}
+
+		fprintf(out, "\t\ta = v%d;\n\t}\n", per_block - 1);
+	}
+
+	fprintf(out, "\treturn a;\n}\n");
+}
+
+// Samples need a finer clock than clock(), which only ticks every millisecond on windows
+
+double bench_now()
+{
+#if defined(_WIN32)
+	LARGE_INTEGER frequency, counter;
+
+	QueryPerformanceFrequency(&frequency);
+	QueryPerformanceCounter(&counter);
+
+	return (double)counter.QuadPart / (double)frequency.QuadPart;
+#else
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+#endif
+}
+
+char *bench_generate(bench_generator generator, int size, size_t *out_length)
+{
+	FILE *source_file = tmpfile();
+
+	if (source_file == NULL)
+	{
+		fprintf(stderr, "couldn't create a temporary file.\n");
+		return NULL;
+	}
+
+	generator(source_file, size);
+
+	size_t length = (size_t)ftell(source_file);
+	char *source = (char *)malloc(length);
+
+	rewind(source_file);
+
+	if (source == NULL || fread(source, 1, length, source_file) != length)
+	{
+		fprintf(stderr, "couldn't read the generated source.\n");
+		free(source);
+		fclose(source_file);
+		return NULL;
+	}
+
+	fclose(source_file);
+
+	*out_length = length;
+	return source;
+}
+
+double bench_compile(const char *name, bench_generator generator, int size, int iterations)
+{
+	FILE *source = tmpfile();
+
+	if (source == NULL)
+	{
+		fprintf(stderr, "couldn't create a temporary file.\n");
+		return -1.0;
+	}
+
+	generator(source, size);
+
+	long source_size = ftell(source);
+	double total = 0.0;
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		struct dvm_context *context = NULL;
+
+		if (!dvm_create_context(&context, 4, 128))
+		{
+			fprintf(stderr, "error initializing dash.\n");
+			fclose(source);
+			return -1.0;
+		}
+
+		rewind(source);
+
+		clock_t start = clock();
+		int result = dvm_import_source(source, context);
+		clock_t end = clock();
+
+		dvm_destroy_context(context);
+
+		if (!result)
+		{
+			fprintf(stderr, "%s: compilation error.\n", name);
+			fclose(source);
+			return -1.0;
+		}
+
+		total += (double)(end - start) / CLOCKS_PER_SEC;
+	}
+
+	fclose(source);
+
+	double average = total / iterations;
+
+	printf("%-12s size: %6d  source: %8ld bytes  compile: %9.3f ms\n", name, size, source_size, average * 1000.0);
+
+	return average;
+}
+
+double bench_cache(const char *directory, bench_generator generator, int size, int iterations)
+{
+	size_t length;
+	char *source = bench_generate(generator, size, &length);
+
+	if (source == NULL)
+	{
+		return -1.0;
+	}
+
+	// The first import misses and stores the image, the rest should all hit
+
+	double cold = 0.0;
+	double warm = 0.0;
+	struct dvm_cache_stats stats = { 0 };
+
+	for (int i = 0; i <= iterations; ++i)
+	{
+		struct dvm_context *context = NULL;
+
+		if (!dvm_create_context(&context, 4, 128) ||
+			!dvm_enable_cache(directory, 0, 0, context))
+		{
+			fprintf(stderr, "error initializing dash.\n");
+			free(source);
+			return -1.0;
+		}
+
+		clock_t start = clock();
+		int result = dvm_import_source_text(source, length, context);
+		clock_t end = clock();
+
+		struct dvm_cache_stats run_stats;
+		dvm_get_cache_stats(&run_stats, context);
+
+		dvm_destroy_context(context);
+
+		if (!result)
+		{
+			fprintf(stderr, "cache: compilation error.\n");
+			free(source);
+			return -1.0;
+		}
+
+		if (i == 0)
+			cold = (double)(end - start) / CLOCKS_PER_SEC;
+		else
+			warm += (double)(end - start) / CLOCKS_PER_SEC;
+
+		stats.hits += run_stats.hits;
+		stats.misses += run_stats.misses;
+		stats.stores += run_stats.stores;
+	}
+
+	free(source);
+
+	double average = warm / iterations;
+
+	printf("%-12s size: %6d  first: %9.3f ms  cached: %9.3f ms  hits: %u misses: %u stores: %u\n",
+		"cache", size, cold * 1000.0, average * 1000.0, stats.hits, stats.misses, stats.stores);
+
+	return average;
+}
+
+enum bench_lexer
+{
+	bench_lexer_flex_file,
+	bench_lexer_flex_buffer,
+	bench_lexer_scanner,
+};
+
+size_t bench_lex_once(enum bench_lexer lexer, FILE *file, const char *source, size_t length, int *tokens, size_t max_tokens)
+{
+	dsc_memory mem;
+	dsc_intern_table atoms;
+
+	if (!dsc_create(0, &mem) || !dsc_create_intern_table(0, &atoms, &mem))
+	{
+		return 0;
+	}
+
+	YYSTYPE value;
+	YYLTYPE location;
+	size_t count = 0;
+	int token;
+
+	if (lexer == bench_lexer_scanner)
+	{
+		dsc_scanner scanner;
+		dsc_scanner_init(source, length, &atoms, &scanner);
+
+		while ((token = dsc_lex(&value, &location, &scanner)) != 0)
+		{
+			if (count < max_tokens)
+				tokens[count] = token;
+			++count;
+		}
+	}
+	else
+	{
+		yyscan_t scanner;
+		yylex_init(&scanner);
+		yyset_extra(&atoms, scanner);
+
+		if (lexer == bench_lexer_flex_file)
+		{
+			rewind(file);
+			yyset_in(file, scanner);
+		}
+		else
+		{
+			yy_scan_bytes(source, (int)length, scanner);
+		}
+
+		while ((token = yylex(&value, &location, scanner)) != 0)
+		{
+			if (count < max_tokens)
+				tokens[count] = token;
+			++count;
+		}
+
+		yylex_destroy(scanner);
+	}
+
+	dsc_destroy(&mem);
+
+	return count;
+}
+
+void bench_lexers(int size, int iterations)
+{
+	FILE *source_file = tmpfile();
+
+	if (source_file == NULL)
+	{
+		fprintf(stderr, "couldn't create a temporary file.\n");
+		return;
+	}
+
+	gen_procedures(source_file, size);
+
+	size_t length = (size_t)ftell(source_file);
+	char *source = (char *)malloc(length);
+
+	if (source == NULL)
+	{
+		fclose(source_file);
+		return;
+	}
+
+	rewind(source_file);
+	length = fread(source, 1, length, source_file);
+
+	// Check both scanners agree before timing them
+
+	size_t max_tokens = length;
+	int *reference = (int *)malloc(sizeof(int) * max_tokens);
+	int *tokens = (int *)malloc(sizeof(int) * max_tokens);
+
+	if (reference == NULL || tokens == NULL)
+	{
+		free(reference);
+		free(tokens);
+		free(source);
+		fclose(source_file);
+		return;
+	}
+
+	size_t reference_count = bench_lex_once(bench_lexer_flex_buffer, source_file, source, length, reference, max_tokens);
+	size_t token_count = bench_lex_once(bench_lexer_scanner, source_file, source, length, tokens, max_tokens);
+
+	if (reference_count != token_count || memcmp(reference, tokens, sizeof(int) * token_count) != 0)
+	{
+		fprintf(stderr, "lexer: hand written scanner disagrees with flex.\n");
+	}
+
+	const char *names[] = { "flex (FILE *)", "flex (buffer)", "scanner" };
+
+	for (int lexer = bench_lexer_flex_file; lexer <= bench_lexer_scanner; ++lexer)
+	{
+		size_t count = 0;
+		clock_t start = clock();
+
+		for (int i = 0; i < iterations; ++i)
+		{
+			count = bench_lex_once((enum bench_lexer)lexer, source_file, source, length, tokens, 0);
+		}
+
+		double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+		double megabytes = (double)length * iterations / (1024.0 * 1024.0);
+
+		printf("lexer %-14s source: %8llu bytes  tokens: %7llu  %9.1f MB/s\n",
+			names[lexer], (unsigned long long)length, (unsigned long long)count, seconds > 0.0 ? megabytes / seconds : 0.0);
+	}
+
+	free(reference);
+	free(tokens);
+	free(source);
+	fclose(source_file);
+}
+
+void bench_arrays(int size, int iterations)
+{
+	// The same reduction as a per element loop in dash and as one bulk built-in
+
+	const char *source =
+		"def loop_sum : (values : real[]) -> (real)\n"
+		"{\n"
+		"\tlet i, sum = 0, 0.;\n"
+		"\twhile (i < length(values))\n"
+		"\t{\n"
+		"\t\tsum = sum + values[i];\n"
+		"\t\ti = i + 1;\n"
+		"\t}\n"
+		"\treturn sum;\n"
+		"}\n"
+		"def bulk_sum : (values : real[]) -> (real)\n"
+		"{\n"
+		"\treturn sum_r(values);\n"
+		"}\n";
+
+	struct dvm_context *context = NULL;
+
+	if (!dvm_create_context(&context, 4, 128))
+	{
+		fprintf(stderr, "error initializing dash.\n");
+		return;
+	}
+
+	struct dvm_array *values = dvm_create_array(dvm_type_real, size, context);
+
+	if (values == NULL || !dvm_import_source_text(source, strlen(source), context))
+	{
+		fprintf(stderr, "arrays: couldn't set up the benchmark.\n");
+		dvm_destroy_context(context);
+		return;
+	}
+
+	float *data = (float *)dvm_array_data(values);
+
+	for (int i = 0; i < size; ++i)
+		data[i] = (float)(i % 16) * 0.25f;
+
+	const char *names[] = { "loop_sum", "bulk_sum" };
+
+	for (int proc = 0; proc < 2; ++proc)
+	{
+		struct dvm_procedure *function = dvm_find_proc(names[proc], 1, 1, context);
+
+		dvm_var in;
+		dvm_var out;
+
+		in.a = values;
+		out.f = 0.0f;
+
+		clock_t start = clock();
+
+		for (int i = 0; i < iterations; ++i)
+		{
+			if (!dvm_exec_proc(function, &in, &out, context))
+			{
+				fprintf(stderr, "arrays: execution error.\n");
+				break;
+			}
+		}
+
+		clock_t end = clock();
+
+		double seconds = (double)(end - start) / CLOCKS_PER_SEC / iterations;
+
+		printf("array %-8s size: %8d  result: %12.1f  time: %9.3f ms\n", names[proc], size, out.f, seconds * 1000.0);
+	}
+
+	dvm_destroy_context(context);
+}
+
+// Summaries are over every sample, the p99 of fewer than a hundred samples is the slowest one
+
+struct bench_summary
+{
+	double median;
+	double p99;
+};
+
+int bench_compare_samples(const void *left, const void *right)
+{
+	double l = *(const double *)left;
+	double r = *(const double *)right;
+
+	return (l > r) - (l < r);
+}
+
+void bench_summarize(double *samples, int count, struct bench_summary *summary)
+{
+	qsort(samples, count, sizeof(double), bench_compare_samples);
+
+	summary->median = count % 2 == 0 ? (samples[count / 2 - 1] + samples[count / 2]) * 0.5 : samples[count / 2];
+	summary->p99 = samples[(count * 99 + 99) / 100 - 1];
+}
+
+void bench_report(FILE *results, const char *name, const char *phase, int iterations, struct bench_summary *summary, uint64_t instructions)
+{
+	double per_second = summary->median > 0.0 ? (double)instructions / summary->median : 0.0;
+
+	printf("%-12s %-8s median: %9.3f ms  p99: %9.3f ms", name, phase, summary->median * 1000.0, summary->p99 * 1000.0);
+
+	if (instructions != 0)
+	{
+		printf("  instructions: %10llu  %8.1f M/s", (unsigned long long)instructions, per_second / 1e6);
+	}
+
+	printf("\n");
+
+	if (results != NULL)
+	{
+		fprintf(results, "%s,%s,%d,%.6f,%.6f,%llu,%.0f\n",
+			name, phase, iterations, summary->median * 1000.0, summary->p99 * 1000.0, (unsigned long long)instructions, per_second);
+	}
+}
+
+// Compiles into a fresh context per sample, then runs the entry over and over in one context
+
+int bench_workload(const struct bench_workload *workload, int iterations, FILE *results)
+{
+	size_t length = 0;
+	char *source = NULL;
+
+	if (workload->source != NULL)
+	{
+		length = strlen(workload->source);
+	}
+	else if ((source = bench_generate(workload->generator, workload->size, &length)) == NULL)
+	{
+		return 0;
+	}
+
+	const char *text = workload->source != NULL ? workload->source : source;
+	double *samples = (double *)malloc(sizeof(double) * iterations);
+
+	if (samples == NULL)
+	{
+		free(source);
+		return 0;
+	}
+
+	struct dvm_context *context = NULL;
+	struct bench_summary summary;
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		if (context != NULL)
+		{
+			dvm_destroy_context(context);
+			context = NULL;
+		}
+
+		if (!dvm_create_context(&context, 4, 128))
+		{
+			fprintf(stderr, "error initializing dash.\n");
+			free(samples);
+			free(source);
+			return 0;
+		}
+
+		double start = bench_now();
+		int result = dvm_import_source_text(text, length, context);
+		samples[i] = bench_now() - start;
+
+		if (!result)
+		{
+			fprintf(stderr, "%s: compilation error.\n", workload->name);
+			dvm_destroy_context(context);
+			free(samples);
+			free(source);
+			return 0;
+		}
+	}
+
+	bench_summarize(samples, iterations, &summary);
+	bench_report(results, workload->name, "compile", iterations, &summary, 0);
+
+	struct dvm_procedure *entry = dvm_find_proc(workload->entry, 1, 1, context);
+	uint64_t instructions = 0;
+
+	if (entry == NULL)
+	{
+		fprintf(stderr, "%s: couldn't find %s.\n", workload->name, workload->entry);
+		dvm_destroy_context(context);
+		free(samples);
+		free(source);
+		return 0;
+	}
+
+	for (int i = 0; i < iterations; ++i)
+	{
+		dvm_var in;
+		dvm_var out;
+
+		in.i = workload->argument;
+
+		double start = bench_now();
+		int result = dvm_exec_proc(entry, &in, &out, context);
+		samples[i] = bench_now() - start;
+
+		if (!result)
+		{
+			fprintf(stderr, "%s: execution error.\n", workload->name);
+			dvm_destroy_context(context);
+			free(samples);
+			free(source);
+			return 0;
+		}
+
+		// Every run executes the same instructions
+
+		struct dvm_exec_stats stats;
+		dvm_get_exec_stats(&stats, context);
+
+		instructions = stats.instructions;
+	}
+
+	bench_summarize(samples, iterations, &summary);
+	bench_report(results, workload->name, "exec", iterations, &summary, instructions);
+
+	dvm_destroy_context(context);
+	free(samples);
+	free(source);
+
+	return 1;
+}
+
+int main(int argc, char **argv)
+{
+	int iterations = 10;
+	const char *cache_directory = NULL;
+	const char *results_filename = NULL;
+
+	int arg = 1;
+
+	if (argc >= 3 && strcmp(argv[1], "-o") == 0)
+	{
+		results_filename = argv[2];
+		arg += 2;
+	}
+
+	if (argc > arg)
+	{
+		iterations = atoi(argv[arg]);
+	}
+
+	if (argc > arg + 1)
+	{
+		cache_directory = argv[arg + 1];
+	}
+
+	if (argc > arg + 2 || iterations <= 0)
+	{
+		printf("dash_bench\nusage:\n\tdash_bench [-o results.csv] [iterations] [cache directory]\n");
+		return 0;
+	}
+
+	// Results are written one row per workload and phase, so runs of two releases can be diffed
+
+	FILE *results = NULL;
+
+	if (results_filename != NULL)
+	{
+		results = fopen(results_filename, "w");
+
+		if (results == NULL)
+		{
+			fprintf(stderr, "couldn't open %s.\n", results_filename);
+			return 0;
+		}
+
+		fprintf(results, "workload,phase,iterations,median_ms,p99_ms,instructions,instructions_per_second\n");
+	}
+
+	for (int i = 0; i < bench_workload_count; ++i)
+	{
+		bench_workload(&bench_workloads[i], iterations, results);
+	}
+
+	if (results != NULL)
+	{
+		fclose(results);
+	}
+
+	bench_compile("procedures", gen_procedures, BENCH_MODULE_PROCEDURES, iterations);
+	bench_compile("locals", gen_locals, 500, iterations);
+
+	bench_lexers(BENCH_MODULE_PROCEDURES, iterations);
+
+	bench_arrays(1 << 20, iterations);
+
+	if (cache_directory != NULL)
+	{
+		bench_cache(cache_directory, gen_procedures, BENCH_MODULE_PROCEDURES, iterations);
+	}
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+#include "workloads.h"
+
+// Procedures past the first 256 in the context can't be called, so the entry only reaches into the start of the module.
+// The calls are split over a few procedures, a loop body can only jump so far.
+
+#define GEN_MODULE_CALLED 150
+#define GEN_MODULE_PER_CHUNK 10
+
+void gen_module(FILE *out, int size)
+{
+	int called = size < GEN_MODULE_CALLED ? size : GEN_MODULE_CALLED;
+	int chunks = (called + GEN_MODULE_PER_CHUNK - 1) / GEN_MODULE_PER_CHUNK;
+
+	fprintf(out, "def run : (n : integer) -> (integer)\n{\n\tlet total = 0;\n\n\tfor (i = 0, n)\n\t{\n");
+
+	for (int chunk = 0; chunk < chunks; ++chunk)
+	{
+		fprintf(out, "\t\ttotal = c%d(total + i);\n", chunk);
+	}
+
+	fprintf(out, "\t}\n\n\treturn total;\n}\n\n");
+
+	for (int chunk = 0; chunk < chunks; ++chunk)
+	{
+		fprintf(out, "def c%d : (a : integer) -> (integer)\n{\n", chunk);
+
+		for (int i = chunk * GEN_MODULE_PER_CHUNK; i < called && i < (chunk + 1) * GEN_MODULE_PER_CHUNK; ++i)
+		{
+			fprintf(out, "\ta = m%d(a);\n", i);
+		}
+
+		fprintf(out, "\treturn a;\n}\n\n");
+	}
+
+	for (int i = 0; i < size; ++i)
+	{
+		fprintf(out,
+			"def m%d : (a : integer) -> (integer)\n"
+			"{\n"
+			"\tlet x = a * %d + %d;\n"
+			"\n"
+			"\tif (x %% 2 == 0)\n"
+			"\t\tx = x / 2;\n"
+			"\telse\n"
+			"\t\tx = x * 3 + 1;\n"
+			"\n"
+			"\twhile (x > 1000)\n"
+			"\t\tx = x - 997;\n"
+			"\n"
+			"\treturn x;\n"
+			"}\n\n",
+			i, i % 7 + 1, i);
+	}
+}
+
+static const char fib_rec_source[] =
+	"def fib : (n : integer) -> (integer)\n"
+	"{\n"
+	"\tif (n <= 2)\n"
+	"\t\treturn 1;\n"
+	"\telse\n"
+	"\t\treturn fib(n - 1) + fib(n - 2);\n"
+	"}\n"
+	"def run : (n : integer) -> (integer)\n"
+	"{\n"
+	"\treturn fib(n);\n"
+	"}\n";
+
+static const char fib_lin_source[] =
+	"def fib : (n : integer) -> (integer)\n"
+	"{\n"
+	"\tlet x = 2;\n"
+	"\tlet fib_x_minus2, fib_x_minus1 = 1, 1;\n"
+	"\twhile (x <= n)\n"
+	"\t{\n"
+	"\t\tlet temp = fib_x_minus1;\n"
+	"\t\tfib_x_minus1 = fib_x_minus1 + fib_x_minus2;\n"
+	"\t\tfib_x_minus2 = temp;\n"
+	"\t\tx = x + 1;\n"
+	"\t}\n"
+	"\treturn fib_x_minus1;\n"
+	"}\n"
+	"def run : (n : integer) -> (integer)\n"
+	"{\n"
+	"\tlet total = 0;\n"
+	"\tfor (i = 0, n)\n"
+	"\t\ttotal = total + fib(i % 40);\n"
+	"\treturn total;\n"
+	"}\n";
+
+static const char pi_series_source[] =
+	"def run : (term : integer) -> (real)\n"
+	"{\n"
+	"\tlet n, sum, is_odd_term = 0, 0., 1;\n"
+	"\twhile (n <= term)\n"
+	"\t{\n"
+	"\t\tif (is_odd_term)\n"
+	"\t\t{\n"
+	"\t\t\tsum = sum + 1. / (2. * (real)n + 1.);\n"
+	"\t\t\tis_odd_term = 0;\n"
+	"\t\t}\n"
+	"\t\telse\n"
+	"\t\t{\n"
+	"\t\t\tsum = sum - 1. / (2. * (real)n + 1.);\n"
+	"\t\t\tis_odd_term = 1;\n"
+	"\t\t}\n"
+	"\t\tn = n + 1;\n"
+	"\t}\n"
+	"\treturn sum * 4.;\n"
+	"}\n";
+
+static const char sin_wave_source[] =
+	"def run : (samples : integer) -> (real)\n"
+	"{\n"
+	"\tlet delta = 0.09817477042468103870195760572748;\n"
+	"\tlet n, sum = 0., 0.;\n"
+	"\tfor (i = 0, samples)\n"
+	"\t{\n"
+	"\t\tsum = sum + sin(n);\n"
+	"\t\tn = n + delta;\n"
+	"\t}\n"
+	"\treturn sum;\n"
+	"}\n";
+
+static const char calls_source[] =
+	"def leaf : (x : integer) -> (integer)\n"
+	"{\n"
+	"\treturn x + 1;\n"
+	"}\n"
+	"def pair : (x : integer, y : integer) -> (integer)\n"
+	"{\n"
+	"\treturn leaf(x) + leaf(y);\n"
+	"}\n"
+	"def nothing : () -> ()\n"
+	"{\n"
+	"\treturn;\n"
+	"}\n"
+	"def run : (n : integer) -> (integer)\n"
+	"{\n"
+	"\tlet total = 0;\n"
+	"\tfor (i = 0, n)\n"
+	"\t{\n"
+	"\t\tnothing();\n"
+	"\t\ttotal = pair(total, i) % 65536;\n"
+	"\t}\n"
+	"\treturn total;\n"
+	"}\n";
+
+static const char branchy_source[] =
+	"def classify : (x : integer) -> (integer)\n"
+	"{\n"
+	"\tif (x % 15 == 0)\n"
+	"\t\treturn 15;\n"
+	"\telse if (x % 3 == 0)\n"
+	"\t\treturn 3;\n"
+	"\telse if (x % 5 == 0)\n"
+	"\t\treturn 5;\n"
+	"\tswitch (x % 8)\n"
+	"\t{\n"
+	"\t\tcase 0: return 1;\n"
+	"\t\tcase 1, 2: return 2;\n"
+	"\t\tcase 3: return 4;\n"
+	"\t\tcase 5: return 6;\n"
+	"\t\tcase 6, 7: return 7;\n"
+	"\t}\n"
+	"\treturn 0;\n"
+	"}\n"
+	"def run : (n : integer) -> (integer)\n"
+	"{\n"
+	"\tlet total, odd = 0, 0;\n"
+	"\tfor (i = 0, n)\n"
+	"\t{\n"
+	"\t\ttotal = total + classify(i);\n"
+	"\t\tif (i % 2 == 1 and not (total % 3 == 0))\n"
+	"\t\t\todd = odd + 1;\n"
+	"\t}\n"
+	"\treturn total + odd;\n"
+	"}\n";
+
+const struct bench_workload bench_workloads[] =
+{
+	{ "fib_rec",	fib_rec_source,		NULL,		0,		"run",	18 },
+	{ "fib_lin",	fib_lin_source,		NULL,		0,		"run",	2000 },
+	{ "pi_series",	pi_series_source,	NULL,		0,		"run",	100000 },
+	{ "sin_wave",	sin_wave_source,	NULL,		0,		"run",	100000 },
+	{ "calls",		calls_source,		NULL,		0,		"run",	50000 },
+	{ "branchy",	branchy_source,		NULL,		0,		"run",	50000 },
+	{ "module",		NULL,				gen_module,	2000,	"run",	100 },
+};
+
+const int bench_workload_count = sizeof(bench_workloads) / sizeof(bench_workloads[0]);
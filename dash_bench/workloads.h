@@ -0,0 +1,29 @@
+#ifndef dash_bench_workloads_h
+#define dash_bench_workloads_h
+
+#include <stdio.h>
+
+/*
+ * The curated programs the benchmark suite compiles and runs.
+ */
+
+typedef void (*bench_generator)(FILE *out, int size);
+
+// Every workload has an entry taking one integer and returning one value, source is NULL when it's generated
+
+struct bench_workload
+{
+	const char		*name;
+	const char		*source;
+	bench_generator	 generator;
+	int				 size;
+	const char		*entry;
+	int				 argument;
+};
+
+extern const struct bench_workload bench_workloads[];
+extern const int bench_workload_count;
+
+void gen_module(FILE *out, int size);
+
+#endif
@@ -1,20 +1,97 @@
 #include "dash/vm.h"
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
-int main(int argc, char **argv)
+// The trace keeps the latest blocks main ran, enough for the hot paths of most scripts
+
+#define TRACE_CAPACITY (1 << 20)
+
+static void print_import_stats(struct dvm_import_stats *stats)
+{
+	fprintf(stderr, "import: %.3f ms%s\n", stats->total_time * 1000.0, stats->cache_hit ? " (cached)" : "");
+	fprintf(stderr, "\tlex:     %.3f ms, %u tokens\n", stats->lex_time * 1000.0, stats->tokens);
+	fprintf(stderr, "\tparse:   %.3f ms, %u nodes\n", stats->parse_time * 1000.0, stats->ast_nodes);
+	fprintf(stderr, "\tcodegen: %.3f ms, %u procedures, %u words\n", stats->codegen_time * 1000.0, stats->procedures, stats->bytecode_words);
+	fprintf(stderr, "\tgrowth:  %.3f ms, %u times\n", stats->growth_time * 1000.0, stats->growths);
+	fprintf(stderr, "\tarena:   %llu bytes\n", (unsigned long long)stats->arena_bytes);
+}
+
+static void print_trace(struct dvm_context *context)
 {
-	if (argc != 1 && argc != 2)
+	struct dvm_trace_record *records = (struct dvm_trace_record *)malloc(sizeof(struct dvm_trace_record) * TRACE_CAPACITY);
+
+	if (records == NULL)
 	{
-		printf("dash\nusage:\n\tdash [-d]\n");
-		return 0;
+		fprintf(stderr, "out of memory reading the trace.\n");
+		return;
+	}
+
+	size_t count = dvm_get_exec_trace(records, TRACE_CAPACITY, context);
+
+	dvm_dissasm_trace(records, count, stdout, context);
+
+	free(records);
+}
+
+// Adds what main ran to the profile and writes it out, for the next run to be compiled with
+
+static void save_profile(const char *filename, struct dvm_context *context)
+{
+	struct dvm_trace_record *records = (struct dvm_trace_record *)malloc(sizeof(struct dvm_trace_record) * TRACE_CAPACITY);
+
+	if (records == NULL)
+	{
+		fprintf(stderr, "out of memory reading the trace.\n");
+		return;
 	}
 
-	if (argc == 2 && strcmp(argv[1], "-d") != 0)
+	size_t count = dvm_get_exec_trace(records, TRACE_CAPACITY, context);
+
+	if (!dvm_profile_trace(records, count, context) || !dvm_save_profile(filename, context))
 	{
-		printf("dash\nusage:\n\tdash [-d]\n");
-		return 0;
+		fprintf(stderr, "couldn't save the profile.\n");
+	}
+
+	free(records);
+}
+
+int main(int argc, char **argv)
+{
+	int disassemble = 0;
+	int import_stats = 0;
+	int trace = 0;
+	const char *profile = NULL;
+	int perf = 0;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-d") == 0)
+		{
+			disassemble = 1;
+		}
+		else if (strcmp(argv[i], "-s") == 0)
+		{
+			import_stats = 1;
+		}
+		else if (strcmp(argv[i], "-t") == 0)
+		{
+			trace = 1;
+		}
+		else if (strcmp(argv[i], "-P") == 0)
+		{
+			perf = 1;
+		}
+		else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc)
+		{
+			profile = argv[++i];
+		}
+		else
+		{
+			printf("dash\nusage:\n\tdash [-d] [-s] [-t] [-p profile] [-P]\n");
+			return 0;
+		}
 	}
 
 	struct dvm_context *context = NULL;
@@ -25,6 +102,45 @@ int main(int argc, char **argv)
 		return 0;
 	}
 
+	dvm_enable_import_stats(import_stats, context);
+
+	// The procedures are named as they're imported, so a profiler has to be attached first
+
+	if (perf && !dvm_enable_perf(dvm_perf_map | dvm_perf_jitdump, context))
+	{
+		dvm_destroy_context(context);
+
+		fprintf(stderr, "couldn't attach a profiler.\n");
+		return 0;
+	}
+
+	// Without a profile one is recorded for the next run, with one the run is compiled with it
+
+	int record_profile = 0;
+
+	if (profile != NULL)
+	{
+		FILE *existing = fopen(profile, "r");
+
+		if (existing != NULL)
+		{
+			fclose(existing);
+
+			if (!dvm_load_profile(profile, context))
+			{
+				dvm_destroy_context(context);
+
+				fprintf(stderr, "couldn't load the profile.\n");
+				return 0;
+			}
+		}
+		else
+		{
+			record_profile = 1;
+			dvm_enable_profile_recording(1, context);
+		}
+	}
+
 	if (!dvm_import_source(stdin, context))
 	{
 		dvm_destroy_context(context);
@@ -32,8 +148,16 @@ int main(int argc, char **argv)
 		fprintf(stderr, "compilation error.\n");
 		return 0;
 	}
-		
-	if (argc == 2)
+
+	if (import_stats)
+	{
+		struct dvm_import_stats stats;
+
+		dvm_get_import_stats(&stats, context);
+		print_import_stats(&stats);
+	}
+
+	if (disassemble)
 	{
 		dvm_dissasm_module(stdout, context);
 	}
@@ -49,6 +173,14 @@ int main(int argc, char **argv)
 			return 0;
 		}
 
+		if ((trace || record_profile) && !dvm_enable_exec_trace(TRACE_CAPACITY, context))
+		{
+			dvm_destroy_context(context);
+
+			fprintf(stderr, "couldn't start a trace.\n");
+			return 0;
+		}
+
 		dvm_var out[1];
 
 		if (dvm_exec_proc(func, NULL, out, context))
@@ -59,6 +191,16 @@ int main(int argc, char **argv)
 		{
 			fprintf(stderr, "execution error.\n");
 		}
+
+		if (trace)
+		{
+			print_trace(context);
+		}
+
+		if (record_profile)
+		{
+			save_profile(profile, context);
+		}
 	}
 
 	dvm_destroy_context(context);
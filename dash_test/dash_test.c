@@ -0,0 +1,595 @@
+#include "dash/vm.h"
+
+#include "../dash/src/vm_internal.h"
+#include "../dash/src/vm/fastmath.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Tests of the embedding api, for what scripts alone can't reach. Each test returns nonzero when it passes.
+ */
+
+static void test_native_double(const dvm_var *in_registers, dvm_var *out_registers)
+{
+	out_registers[0].i = in_registers[0].i * 2;
+}
+
+// Imports a module of count procedures, each returning its own index
+
+static int import_procedures(int count, struct dvm_context *context)
+{
+	size_t capacity = (size_t)count * 64 + 1;
+	char *source = (char *)malloc(capacity);
+
+	if (source == NULL)
+	{
+		return 0;
+	}
+
+	size_t length = 0;
+
+	for (int i = 0; i < count; ++i)
+	{
+		length += (size_t)snprintf(source + length, capacity - length, "def p%d : () -> (integer) { return %d; }\n", i, i);
+	}
+
+	int result = dvm_import_source_text(source, length, context);
+
+	free(source);
+
+	return result;
+}
+
+static int run_integer(const char *name, int in, int *out, struct dvm_context *context)
+{
+	struct dvm_procedure *function = dvm_find_proc(name, 1, 1, context);
+
+	if (function == NULL)
+	{
+		return 0;
+	}
+
+	dvm_var in_register;
+	dvm_var out_register;
+
+	in_register.i = in;
+
+	if (!dvm_exec_proc(function, &in_register, &out_register, context))
+	{
+		return 0;
+	}
+
+	*out = out_register.i;
+
+	return 1;
+}
+
+static int test_native_before_import()
+{
+	struct dvm_context *context = NULL;
+
+	if (!dvm_create_context(&context, 4, 128))
+	{
+		return 0;
+	}
+
+	const enum dvm_type integer[] = { dvm_type_integer };
+	const char *source = "def main : (a : integer) -> (integer) { return double_i(a) + 1; }\n";
+
+	int result = 0;
+	int passed =
+		dvm_register_native("double_i", test_native_double, integer, 1, integer, 1, context) &&
+		dvm_import_source_text(source, strlen(source), context) &&
+		run_integer("main", 20, &result, context) &&
+		result == 41;
+
+	dvm_destroy_context(context);
+
+	return passed;
+}
+
+static int test_native_past_call_reach()
+{
+	struct dvm_context *context = NULL;
+
+	if (!dvm_create_context(&context, 4, 128))
+	{
+		return 0;
+	}
+
+	// The standard natives and this module fill the 256 procedures a call can reach
+
+	const enum dvm_type integer[] = { dvm_type_integer };
+
+	int passed =
+		import_procedures(240, context) &&
+		!dvm_register_native("double_i", test_native_double, integer, 1, integer, 1, context);
+
+	dvm_destroy_context(context);
+
+	return passed;
+}
+
+static int test_array_loop_bounded()
+{
+	struct dvm_context *context = NULL;
+
+	if (!dvm_create_context(&context, 4, 128))
+	{
+		return 0;
+	}
+
+	// Every call leaves an array behind, only the one in the global and the one handed back stay reachable
+
+	const char *source =
+		"let kept : integer[];\n"
+		"def keep : (n : integer) -> (integer) { kept = integer[n]; fill_i(kept, 3); return 0; }\n"
+		"def churn : (n : integer) -> (integer[]) { let values = integer[n]; fill_i(values, n); return values; }\n"
+		"def total : (n : integer) -> (integer) { return sum_i(kept); }\n";
+
+	int result = 0;
+	int passed =
+		dvm_import_source_text(source, strlen(source), context) &&
+		run_integer("keep", 16, &result, context);
+
+	struct dvm_procedure *churn = dvm_find_proc("churn", 1, 1, context);
+	struct dvm_array *returned = NULL;
+
+	for (int i = 0; passed && i < 20000; ++i)
+	{
+		dvm_var in_register;
+		dvm_var out_register;
+
+		in_register.i = 1000;
+
+		passed = churn != NULL && dvm_exec_proc(churn, &in_register, &out_register, context);
+
+		// The host destroys what it's handed back, except the first which it keeps to the end
+
+		if (i == 0)
+			returned = out_register.a;
+		else if (passed)
+			dvm_destroy_array(out_register.a, context);
+	}
+
+	// Looping in the script collects as it goes, without returning to the host
+
+	const char *loop = "def loop : (n : integer) -> (integer) { for (i = 0, n) { let scratch = real[1000]; } return 0; }\n";
+
+	passed = passed &&
+		dvm_import_source_text(loop, strlen(loop), context) &&
+		run_integer("loop", 20000, &result, context) &&
+		context->script_array_bytes <= context->script_array_limit &&
+		context->script_array_limit <= DVM_ARRAY_COLLECT_BYTES &&
+		run_integer("total", 0, &result, context) &&
+		result == 48 &&
+		dvm_array_length(returned) == 1000 &&
+		((int32_t *)dvm_array_data(returned))[999] == 1000;
+
+	dvm_destroy_context(context);
+
+	return passed;
+}
+
+static int test_array_suspended_execution()
+{
+	struct dvm_context *context = NULL;
+
+	if (!dvm_create_context(&context, 4, 128))
+	{
+		return 0;
+	}
+
+	// The first execution yields holding an array while the second makes enough garbage to collect
+
+	const char *source =
+		"def hold : (n : integer) -> (integer) { let values = integer[n]; fill_i(values, 7); yield; return sum_i(values); }\n"
+		"def churn : (n : integer) -> (integer) { for (i = 0, n) { let scratch = real[1000]; } return 0; }\n";
+
+	int result = 0;
+	int passed = dvm_import_source_text(source, strlen(source), context);
+
+	struct dvm_execution *execution = NULL;
+
+	if (passed)
+	{
+		dvm_var in_register;
+		dvm_var out_register;
+
+		in_register.i = 10;
+
+		execution = dvm_create_execution(dvm_find_proc("hold", 1, 1, context), &in_register, context);
+
+		passed = execution != NULL &&
+			dvm_resume_execution(execution, 0, &out_register) == dvm_exec_status_yielded &&
+			run_integer("churn", 5000, &result, context) &&
+			dvm_resume_execution(execution, 0, &out_register) == dvm_exec_status_done &&
+			out_register.i == 70;
+	}
+
+	dvm_destroy_execution(execution);
+	dvm_destroy_context(context);
+
+	return passed;
+}
+
+// Division and remainder by zero, and of the smallest value by -1, fail the execution instead of trapping
+
+static int test_division_traps()
+{
+	const char *source =
+		"def divi : (b : integer) -> (integer) { let a = -2147483647 - 1; return a / b; }\n"
+		"def modi : (b : integer) -> (integer) { let a = -2147483647 - 1; return a % b; }\n"
+		"def divl : (b : integer) -> (integer) { let a = -9223372036854775807l - 1l; return (integer)((a / (long)b) >> 32); }\n"
+		"def modl : (b : integer) -> (integer) { let a = -9223372036854775807l - 1l; return (integer)(a % (long)b); }\n";
+
+	struct dvm_context *context = NULL;
+
+	if (!dvm_create_context(&context, 4, 128))
+	{
+		return 0;
+	}
+
+	const char *names[] = { "divi", "modi", "divl", "modl" };
+	const int expected[] = { -1073741824, -3, -1073741824, -3 };
+
+	int result = 0;
+	int passed = dvm_import_source_text(source, strlen(source), context);
+
+	for (int i = 0; i < 4 && passed; ++i)
+	{
+		passed =
+			!run_integer(names[i], 0, &result, context) &&
+			!run_integer(names[i], -1, &result, context) &&
+			run_integer(names[i], i % 2 == 0 ? 2 : 5, &result, context) && result == expected[i];
+	}
+
+	dvm_destroy_context(context);
+
+	return passed;
+}
+
+// The array built-ins take the vector path and the math opcodes the scalar one, they have to agree on every input
+
+static int test_fast_math_paths_agree()
+{
+#if defined(DVM_SIMD_SSE)
+	float inputs[DVM_VF_WIDTH * 64];
+	int count = 0;
+
+	// Arguments halfway between multiples of 2 pi, where the two ways of rounding differ
+
+	for (int k = -1000; k < 1000 && count < DVM_VF_WIDTH * 32; ++k)
+	{
+		float x = ((float)k + 0.5f) / DVM_FAST_INV_2PI;
+
+		if (x * DVM_FAST_INV_2PI == (float)k + 0.5f)
+			inputs[count++] = x;
+	}
+
+	// Then a spread from small to far past where the reduction stays exact, and a few that aren't finite
+
+	for (float x = 0.1f; count < DVM_VF_WIDTH * 64 - 4; x *= 1.7f)
+	{
+		inputs[count++] = x;
+		inputs[count++] = -x;
+	}
+
+	inputs[count++] = INFINITY;
+	inputs[count++] = -INFINITY;
+	inputs[count++] = 0.0f;
+	inputs[count++] = -0.0f;
+
+	for (int i = 0; i + DVM_VF_WIDTH <= count; i += DVM_VF_WIDTH)
+	{
+		float sines[DVM_VF_WIDTH];
+		float cosines[DVM_VF_WIDTH];
+
+		dvm_vf_storeu(sines, dvm_fast_sin_vf(dvm_vf_loadu(inputs + i)));
+		dvm_vf_storeu(cosines, dvm_fast_cos_vf(dvm_vf_loadu(inputs + i)));
+
+		for (int j = 0; j < DVM_VF_WIDTH; ++j)
+		{
+			float sine = dvm_fast_sinf(inputs[i + j]);
+			float cosine = dvm_fast_cosf(inputs[i + j]);
+
+			if (memcmp(&sine, &sines[j], sizeof(float)) != 0 || memcmp(&cosine, &cosines[j], sizeof(float)) != 0 ||
+				!(sine >= -1.0f && sine <= 1.0f) || !(cosine >= -1.0f && cosine <= 1.0f))
+			{
+				printf("\tsin(%g) = %g or %g, cos(%g) = %g or %g\n", inputs[i + j], sine, sines[j], inputs[i + j], cosine, cosines[j]);
+				return 0;
+			}
+		}
+	}
+#endif
+
+	return 1;
+}
+
+// Cache images are found by the key of their source, which is internal to the compiler
+
+uint64_t dsc_source_key(const char *source, size_t length, struct dvm_context *context);
+
+#define TEST_CACHE_DIRECTORY "."
+
+static int cache_image_path(char *path, size_t capacity, const char *source, struct dvm_context *context)
+{
+	uint64_t key = dsc_source_key(source, strlen(source), context);
+	int length = snprintf(path, capacity, "%s/%016llx.dshc", TEST_CACHE_DIRECTORY, (unsigned long long)key);
+
+	return length > 0 && (size_t)length < capacity;
+}
+
+// Reads an image's bytecode, from after the header and the procedure table
+
+static long cache_image_bytecode(FILE *image, uint32_t *bytecode_count)
+{
+	uint32_t header[8];
+
+	if (fread(header, sizeof(uint32_t), 8, image) != 8)
+	{
+		return -1;
+	}
+
+	uint32_t function_count = header[5];
+	*bytecode_count = header[6];
+
+	return (long)(sizeof(header) + (sizeof(uint32_t) * 3 + 3) * function_count);
+}
+
+// Rewrites every call in an image to opcode, and its result register to result_register unless it's negative
+
+static int tamper_cache_image(const char *path, uint8_t opcode, int result_register, int *plain_calls)
+{
+	FILE *image = fopen(path, "r+b");
+
+	if (image == NULL)
+	{
+		return 0;
+	}
+
+	uint32_t bytecode_count = 0;
+	long bytecode_offset = cache_image_bytecode(image, &bytecode_count);
+	dvm_bc *bytecode = bytecode_offset >= 0 ? (dvm_bc *)malloc(sizeof(dvm_bc) * bytecode_count) : NULL;
+
+	int calls = 0;
+	int result = bytecode != NULL &&
+		fseek(image, bytecode_offset, SEEK_SET) == 0 &&
+		fread(bytecode, sizeof(dvm_bc), bytecode_count, image) == bytecode_count;
+
+	for (uint32_t pc = 0; result && pc < bytecode_count; pc += 1 + dvm_bc_immediate_count(bytecode[pc]))
+	{
+		if (!dvm_bc_is_call(bytecode[pc]))
+			continue;
+
+		if (bytecode[pc].opcode == dvm_opcode_call)
+			++*plain_calls;
+
+		bytecode[pc].opcode = opcode;
+
+		if (result_register >= 0)
+			bytecode[pc].c = (uint8_t)result_register;
+
+		++calls;
+	}
+
+	result = result && calls > 0 &&
+		fseek(image, bytecode_offset, SEEK_SET) == 0 &&
+		fwrite(bytecode, sizeof(dvm_bc), bytecode_count, image) == bytecode_count;
+
+	free(bytecode);
+	fclose(image);
+
+	return result;
+}
+
+// Imports source through the cache in a new context and runs main, filling in the cache stats it ended with
+
+static int run_cached(const char *source, int in, int *out, struct dvm_cache_stats *stats)
+{
+	struct dvm_context *context = NULL;
+
+	if (!dvm_create_context(&context, 4, 128))
+	{
+		return 0;
+	}
+
+	int passed =
+		dvm_enable_cache(TEST_CACHE_DIRECTORY, 0, 0, context) &&
+		dvm_import_source_text(source, strlen(source), context) &&
+		run_integer("main", in, out, context);
+
+	dvm_get_cache_stats(stats, context);
+	dvm_destroy_context(context);
+
+	return passed;
+}
+
+static int test_cache_images_relinked()
+{
+	const char *source =
+		"def twice : (a : integer) -> (integer) { return a * 2; }\n"
+		"def main : (a : integer) -> (integer) { return twice(a) + 1; }\n";
+
+	struct dvm_context *context = NULL;
+	char path[1024];
+
+	if (!dvm_create_context(&context, 4, 128))
+	{
+		return 0;
+	}
+
+	int have_path = cache_image_path(path, sizeof(path), source, context);
+
+	dvm_destroy_context(context);
+
+	if (!have_path)
+	{
+		return 0;
+	}
+
+	remove(path);
+
+	int result = 0;
+	int plain_calls = 0;
+	struct dvm_cache_stats stats;
+
+	// Images only hold plain calls, the call is linked to callr in the context that compiled it
+
+	int passed =
+		run_cached(source, 20, &result, &stats) && stats.stores == 1 && result == 41 &&
+		tamper_cache_image(path, dvm_opcode_calln, -1, &plain_calls) && plain_calls > 0;
+
+	// A linked opcode in an image isn't trusted, a calln into a procedure that isn't native is linked again as it should be
+
+	passed = passed &&
+		run_cached(source, 20, &result, &stats) && stats.hits == 1 && result == 41;
+
+	// and a callr whose results are outside the caller's frame fails validation, so the source is compiled again
+
+	passed = passed &&
+		tamper_cache_image(path, dvm_opcode_callr, 250, &plain_calls) &&
+		run_cached(source, 20, &result, &stats) && stats.hits == 0 && result == 41;
+
+	remove(path);
+	remove(TEST_CACHE_DIRECTORY "/index.dshi");
+
+	return passed;
+}
+
+// Runs main in slices of a little fuel, counting the yields, with or without a profiler attached
+
+static int run_sliced(const char *source, int perf, int in, int *out, int *yields, struct dvm_exec_stats *stats)
+{
+	struct dvm_context *context = NULL;
+
+	if (!dvm_create_context(&context, 4, 128))
+	{
+		return 0;
+	}
+
+	int passed =
+		dvm_enable_perf(perf ? dvm_perf_map : 0, context) &&
+		dvm_import_source_text(source, strlen(source), context);
+
+	dvm_var in_register;
+	dvm_var out_register;
+
+	in_register.i = in;
+	out_register.i = 0;
+
+	struct dvm_procedure *function = passed ? dvm_find_proc("main", 1, 1, context) : NULL;
+	struct dvm_execution *execution = function != NULL ? dvm_create_execution(function, &in_register, context) : NULL;
+
+	enum dvm_exec_status status = dvm_exec_status_error;
+
+	*yields = 0;
+
+	if (execution != NULL)
+	{
+		while ((status = dvm_resume_execution(execution, 40, &out_register)) == dvm_exec_status_budget_exhausted ||
+			status == dvm_exec_status_yielded)
+		{
+			*yields += status == dvm_exec_status_yielded;
+		}
+
+		dvm_get_execution_stats(stats, execution);
+	}
+
+	// The innermost callee has been given a trampoline of its own
+
+	if (perf && passed)
+	{
+		struct dvm_procedure *callee = dvm_find_proc("fib", 1, 1, context);
+
+		passed = callee != NULL && context->perf.trampolines[callee - context->function] != NULL;
+	}
+
+	*out = out_register.i;
+
+	dvm_destroy_execution(execution);
+	dvm_destroy_context(context);
+
+	return passed && status == dvm_exec_status_done;
+}
+
+// With a profiler attached every call runs in a dvm_run of its own, slices that end and yields made deep in those
+// have to come out the same as without one
+
+static int test_perf_nested_calls()
+{
+	const char *source =
+		"def fib : (n : integer) -> (integer) { if (n < 2) { return n; } return fib(n - 1) + fib(n - 2); }\n"
+		"def step : (n : integer) -> (integer) { yield; return fib(n); }\n"
+		"def main : (n : integer) -> (integer) { return step(n) + step(n - 1); }\n";
+
+	struct dvm_context *context = NULL;
+
+	if (!dvm_create_context(&context, 4, 128))
+	{
+		return 0;
+	}
+
+	int supported = dvm_enable_perf(dvm_perf_map, context);
+
+	dvm_destroy_context(context);
+
+	if (!supported)
+	{
+		return 1;
+	}
+
+	int plain_result = 0, perf_result = 0;
+	int plain_yields = 0, perf_yields = 0;
+	struct dvm_exec_stats plain_stats, perf_stats;
+
+	return
+		run_sliced(source, 0, 15, &plain_result, &plain_yields, &plain_stats) &&
+		run_sliced(source, 1, 15, &perf_result, &perf_yields, &perf_stats) &&
+		plain_result == 987 && perf_result == 987 &&
+		plain_yields == 2 && perf_yields == 2 &&
+		plain_stats.instructions == perf_stats.instructions &&
+		plain_stats.calls == perf_stats.calls &&
+		plain_stats.max_depth == perf_stats.max_depth;
+}
+
+struct test
+{
+	const char *name;
+	int(*run)();
+};
+
+static const struct test tests[] =
+{
+	{ "native before import", test_native_before_import },
+	{ "native past call reach", test_native_past_call_reach },
+	{ "array loop bounded", test_array_loop_bounded },
+	{ "array in suspended execution", test_array_suspended_execution },
+	{ "division traps", test_division_traps },
+	{ "fast math paths agree", test_fast_math_paths_agree },
+	{ "cache images relinked", test_cache_images_relinked },
+	{ "perf nested calls", test_perf_nested_calls },
+};
+
+int main()
+{
+	int failed = 0;
+
+	for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i)
+	{
+		int passed = tests[i].run();
+
+		printf("%-40s %s\n", tests[i].name, passed ? "ok" : "FAILED");
+
+		if (!passed)
+		{
+			++failed;
+		}
+	}
+
+	printf("%d failed.\n", failed);
+
+	return failed != 0;
+}